@@ -83,9 +83,13 @@ void CopyContext::flush(bool wait)
     }
 }
 
-CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
+CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(
+    const Texture* pTexture,
+    uint32_t subresourceIndex,
+    Buffer::SharedPtr pStagingBuffer
+)
 {
-    return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex);
+    return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex, std::move(pStagingBuffer));
 }
 
 std::vector<uint8_t> CopyContext::readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
@@ -266,7 +270,8 @@ void CopyContext::updateTextureSubresources(
 CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(
     CopyContext* pCtx,
     const Texture* pTexture,
-    uint32_t subresourceIndex
+    uint32_t subresourceIndex,
+    Buffer::SharedPtr pStagingBuffer
 )
 {
     SharedPtr pThis = SharedPtr(new ReadTextureTask);
@@ -285,8 +290,11 @@ CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(
     uint64_t rowCount = (pTexture->getHeight(mipLevel) + formatInfo.blockHeight - 1) / formatInfo.blockHeight;
     uint64_t size = pTexture->getDepth(mipLevel) * rowCount * pThis->mRowSize;
 
-    // Create buffer
-    pThis->mpBuffer = Buffer::create(pCtx->getDevice(), size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+    // Reuse the staging buffer if possible, otherwise create a new one
+    if (pStagingBuffer && pStagingBuffer->getSize() >= size && pStagingBuffer->getCpuAccess() == Buffer::CpuAccess::Read)
+        pThis->mpBuffer = std::move(pStagingBuffer);
+    else
+        pThis->mpBuffer = Buffer::create(pCtx->getDevice(), size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
 
     // Copy from texture to buffer
     pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
@@ -308,7 +316,7 @@ CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(
     // Create a fence and signal
     pThis->mpFence = GpuFence::create(pCtx->mpDevice);
     pCtx->flush(false);
-    pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
+    pThis->mFenceValue = pThis->mpFence->gpuSignal(pCtx->getLowLevelData()->getCommandQueue());
     pThis->mRowCount = (uint32_t)rowCount;
     pThis->mDepth = pTexture->getDepth(mipLevel);
     return pThis;
@@ -316,16 +324,22 @@ CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(
 
 std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
 {
-    mpFence->syncCpu();
+    std::vector<uint8_t> result(getDataSize());
+    getData(result.data());
+    return result;
+}
+
+void CopyContext::ReadTextureTask::getData(void* pDst)
+{
+    mpFence->syncCpu(mFenceValue);
     // Get buffer data
-    std::vector<uint8_t> result;
-    result.resize((size_t)mRowCount * mActualRowSize);
-    uint8_t* pData = reinterpret_cast<uint8_t*>(mpBuffer->map(Buffer::MapType::Read));
+    uint8_t* pResult = reinterpret_cast<uint8_t*>(pDst);
+    const uint8_t* pData = reinterpret_cast<const uint8_t*>(mpBuffer->map(Buffer::MapType::Read));
 
     for (uint32_t z = 0; z < mDepth; z++)
     {
         const uint8_t* pSrcZ = pData + z * (size_t)mRowSize * mRowCount;
-        uint8_t* pDstZ = result.data() + z * (size_t)mActualRowSize * mRowCount;
+        uint8_t* pDstZ = pResult + z * (size_t)mActualRowSize * mRowCount;
         for (uint32_t y = 0; y < mRowCount; y++)
         {
             const uint8_t* pSrc = pSrcZ + y * (size_t)mRowSize;
@@ -335,7 +349,11 @@ std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
     }
 
     mpBuffer->unmap();
-    return result;
+}
+
+bool CopyContext::ReadTextureTask::isReady() const
+{
+    return mpFence->getGpuValue() >= mFenceValue;
 }
 
 bool CopyContext::textureBarrier(const Texture* pTexture, Resource::State newState)
@@ -48,12 +48,50 @@ public:
     {
     public:
         using SharedPtr = std::shared_ptr<ReadTextureTask>;
-        static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex);
+        /**
+         * Record a copy of a texture subresource into a CPU-readable staging buffer and submit it.
+         * @param[in] pCtx Context to record the copy on.
+         * @param[in] pTexture Texture to read.
+         * @param[in] subresourceIndex Subresource to read.
+         * @param[in] pStagingBuffer Optional staging buffer to reuse. A new buffer is created if it is null or too small.
+         */
+        static SharedPtr create(
+            CopyContext* pCtx,
+            const Texture* pTexture,
+            uint32_t subresourceIndex,
+            Buffer::SharedPtr pStagingBuffer = nullptr
+        );
+
+        /**
+         * Wait for the copy to finish and return the texture data without row padding.
+         */
         std::vector<uint8_t> getData();
 
+        /**
+         * Wait for the copy to finish and write the texture data without row padding to user memory.
+         * @param[out] pData Destination, must hold at least getDataSize() bytes.
+         */
+        void getData(void* pData);
+
+        /**
+         * Check if the GPU has finished the copy, i.e. getData() will not block.
+         */
+        bool isReady() const;
+
+        /**
+         * Get the size of the texture data returned by getData().
+         */
+        size_t getDataSize() const { return (size_t)mDepth * mRowCount * mActualRowSize; }
+
+        /**
+         * Get the staging buffer. It can be passed to create() for reuse once the data has been read.
+         */
+        const Buffer::SharedPtr& getStagingBuffer() const { return mpBuffer; }
+
     private:
         ReadTextureTask() = default;
         GpuFence::SharedPtr mpFence;
+        uint64_t mFenceValue = 0;
         Buffer::SharedPtr mpBuffer;
         CopyContext* mpContext;
         uint32_t mRowCount;
@@ -164,8 +202,13 @@ public:
 
     /**
      * Read texture data Asynchronously
+     * @param[in] pStagingBuffer Optional staging buffer from a previous read to reuse. See ReadTextureTask::create().
      */
-    ReadTextureTask::SharedPtr asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
+    ReadTextureTask::SharedPtr asyncReadTextureSubresource(
+        const Texture* pTexture,
+        uint32_t subresourceIndex,
+        Buffer::SharedPtr pStagingBuffer = nullptr
+    );
 
     /**
      * Get the low-level context data
@@ -168,11 +168,18 @@ double GpuTimer::getElapsedTime()
         double end = (double)result[1];
         double range = end - start;
         mElapsedTime = range * mpDevice->getGpuTimestampFrequency();
+        mStartTime = start * mpDevice->getGpuTimestampFrequency();
         mDataPending = false;
     }
     return mElapsedTime;
 }
 
+double GpuTimer::getStartTime()
+{
+    getElapsedTime();
+    return mStartTime;
+}
+
 FALCOR_SCRIPT_BINDING(GpuTimer)
 {
     pybind11::class_<GpuTimer, GpuTimer::SharedPtr>(m, "GpuTimer");
@@ -81,6 +81,13 @@ public:
      */
     double getElapsedTime();
 
+    /**
+     * Get the GPU timestamp in milliseconds of the last resolved begin() call.
+     * The timestamp is relative to an unspecified origin and can only be compared to other GPU timestamps.
+     * The same requirements as for getElapsedTime() apply.
+     */
+    double getStartTime();
+
 private:
     GpuTimer(std::shared_ptr<Device> pDevice);
 
@@ -97,6 +104,7 @@ private:
     uint32_t mStart = 0;
     uint32_t mEnd = 0;
     double mElapsedTime = 0.0;
+    double mStartTime = 0.0;
     bool mDataPending = false; ///< Set to true when resolved timings are available for readback.
 
     Buffer::SharedPtr mpResolveBuffer;        ///< GPU memory used as destination for resolving timestamp queries.
@@ -390,9 +390,11 @@ const ProgramVersion::SharedConstPtr& Program::getActiveVersion() const
         const auto& it = mProgramVersions.find(mDefineList);
         if (it == mProgramVersions.end())
         {
+            // Use the version compiled in the background if there is one, waiting for it if it is still compiling.
+            // Otherwise link the program now.
             // Note that link() updates mActiveProgram only if the operation was successful.
             // On error we get false, and mActiveProgram points to the last successfully compiled version.
-            if (link() == false)
+            if (finishPendingVersion() == false && link() == false)
             {
                 throw RuntimeError("Program linkage failed");
             }
@@ -440,12 +442,52 @@ bool Program::link() const
     }
 }
 
+bool Program::finishPendingVersion() const
+{
+    std::shared_ptr<PendingVersion> pPending;
+    {
+        std::lock_guard<std::mutex> lock(mPendingVersionsMutex);
+        auto it = mPendingVersions.find(mDefineList);
+        if (it == mPendingVersions.end())
+            return false;
+        pPending = it->second;
+        mPendingVersions.erase(it);
+    }
+
+    // Wait for the background compilation. If it failed, the caller links the program again to report the error.
+    try
+    {
+        pPending->task.finish();
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Background compilation of program failed: {}", e.what());
+        return false;
+    }
+    if (!pPending->pVersion)
+        return false;
+
+    if (!pPending->log.empty())
+    {
+        std::string warn = "Warnings in program:\n" + getProgramDescString() + "\n" + pPending->log;
+        logWarning(warn);
+    }
+
+    mFileTimeMap = std::move(pPending->fileTimeMap);
+    mpActiveVersion = pPending->pVersion;
+    return true;
+}
+
 void Program::reset()
 {
     mpActiveVersion = nullptr;
     mProgramVersions.clear();
     mFileTimeMap.clear();
     mLinkRequired = true;
+
+    // Discard versions compiled in the background from outdated sources.
+    std::lock_guard<std::mutex> lock(mPendingVersionsMutex);
+    mPendingVersions.clear();
 }
 
 FALCOR_SCRIPT_BINDING(Program)
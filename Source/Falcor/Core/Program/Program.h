@@ -30,8 +30,10 @@
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Shader.h"
+#include "Utils/Threading.h"
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string_view>
 #include <string>
 #include <map>
@@ -296,6 +298,8 @@ public:
 
     /**
      * Get the API handle of the active program.
+     * If the version for the current defines is still being compiled in the background (see ProgramManager::compileProgramVersionsAsync()),
+     * the previously active version is returned until the background compilation has finished.
      * @return The active program version, or an exception is thrown on failure.
      */
     const ProgramVersion::SharedConstPtr& getActiveVersion() const;
@@ -418,6 +422,25 @@ protected:
     using string_time_map = std::unordered_map<std::string, time_t>;
     mutable string_time_map mFileTimeMap;
 
+    /// Program version compiled in the background by ProgramManager::compileProgramVersionsAsync().
+    struct PendingVersion
+    {
+        Threading::Task task;
+        ProgramVersion::SharedPtr pVersion; ///< Compiled version, or nullptr if compilation failed. Valid once the task has finished.
+        std::string log;
+        string_time_map fileTimeMap;
+    };
+
+    mutable std::map<DefineList, std::shared_ptr<PendingVersion>> mPendingVersions;
+    mutable std::mutex mPendingVersionsMutex;
+
+    /**
+     * Make the version compiled in the background for the current defines the active version.
+     * Waits for the background compilation if it has not finished yet.
+     * @return True if the background version was made the active version, false if there is none or its compilation failed.
+     */
+    bool finishPendingVersion() const;
+
     bool checkIfFilesChanged();
     void reset();
 };
@@ -102,11 +102,22 @@ inline bool doSlangReflection(
 ProgramManager::ProgramManager(std::weak_ptr<Device> pDevice) : mpDevice(pDevice) {}
 
 ProgramVersion::SharedPtr ProgramManager::createProgramVersion(const Program& program, std::string& log) const
+{
+    return createProgramVersion(program, program.getDefineList(), getGlobalCompilationSettings(), log, program.mFileTimeMap);
+}
+
+ProgramVersion::SharedPtr ProgramManager::createProgramVersion(
+    const Program& program,
+    const Program::DefineList& defines,
+    const GlobalCompilationSettings& settings,
+    std::string& log,
+    FileTimeMap& fileTimeMap
+) const
 {
     CpuTimer timer;
     timer.update();
 
-    auto pSlangRequest = createSlangCompileRequest(program);
+    auto pSlangRequest = createSlangCompileRequest(program, defines, settings);
     if (pSlangRequest == nullptr)
         return nullptr;
 
@@ -121,8 +132,6 @@ ProgramVersion::SharedPtr ProgramManager::createProgramVersion(const Program& pr
     ComPtr<slang::IComponentType> pSlangGlobalScope;
     spCompileRequest_getProgram(pSlangRequest, pSlangGlobalScope.writeRef());
 
-    ComPtr<slang::ISession> pSlangSession(pSlangGlobalScope->getSession());
-
     // Prepare entry points.
     std::vector<ComPtr<slang::IComponentType>> pSlangEntryPoints;
     uint32_t entryPointCount = (uint32_t)program.mDesc.mEntryPoints.size();
@@ -148,12 +157,13 @@ ProgramVersion::SharedPtr ProgramManager::createProgramVersion(const Program& pr
     }
 
     // Extract list of files referenced, for dependency-tracking purposes.
+    fileTimeMap.clear();
     int depFileCount = spGetDependencyFileCount(pSlangRequest);
     for (int ii = 0; ii < depFileCount; ++ii)
     {
         std::string depFilePath = spGetDependencyFilePath(pSlangRequest, ii);
         if (std::filesystem::exists(depFilePath))
-            program.mFileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
+            fileTimeMap[depFilePath] = getFileModifiedTime(depFilePath);
     }
 
     // Note: the `ProgramReflection` needs to be able to refer back to the
@@ -179,9 +189,6 @@ ProgramVersion::SharedPtr ProgramManager::createProgramVersion(const Program& pr
     // to just use `pSlangGlobalScope` for the reflection step instead
     // of `pSlangProgram`.
     //
-    ComPtr<slang::IComponentType> pSlangProgram;
-    spCompileRequest_getProgram(pSlangRequest, pSlangProgram.writeRef());
-
     ProgramReflection::SharedPtr pReflector;
     if (!doSlangReflection(*pVersion, pSlangGlobalScope, pSlangEntryPoints, pReflector, log))
     {
@@ -189,18 +196,54 @@ ProgramVersion::SharedPtr ProgramManager::createProgramVersion(const Program& pr
     }
 
     auto descStr = program.getProgramDescString();
-    pVersion->init(program.getDefineList(), pReflector, descStr, pSlangEntryPoints);
+    pVersion->init(defines, pReflector, descStr, pSlangEntryPoints);
 
     timer.update();
     double time = timer.delta();
-    mCompilationStats.programVersionCount++;
-    mCompilationStats.programVersionTotalTime += time;
-    mCompilationStats.programVersionMaxTime = std::max(mCompilationStats.programVersionMaxTime, time);
-    logDebug("Created program version in {:.3f} s: {}", timer.delta(), descStr);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCompilationStats.programVersionCount++;
+        mCompilationStats.programVersionTotalTime += time;
+        mCompilationStats.programVersionMaxTime = std::max(mCompilationStats.programVersionMaxTime, time);
+    }
+    logDebug("Created program version in {:.3f} s: {}", time, descStr);
 
     return pVersion;
 }
 
+Threading::Task ProgramManager::compileProgramVersionsAsync(const std::vector<ProgramSpecialization>& specializations) const
+{
+    std::vector<Threading::Task> tasks;
+    const GlobalCompilationSettings settings = getGlobalCompilationSettings();
+
+    for (const auto& specialization : specializations)
+    {
+        const Program::SharedPtr& pProgram = specialization.pProgram;
+        FALCOR_ASSERT(pProgram);
+
+        std::lock_guard<std::mutex> lock(pProgram->mPendingVersionsMutex);
+        if (pProgram->mProgramVersions.count(specialization.defines) > 0 || pProgram->mPendingVersions.count(specialization.defines) > 0)
+            continue;
+
+        // The task holds a reference to the program, so it stays alive until the compilation has finished.
+        auto pPending = std::make_shared<Program::PendingVersion>();
+        pProgram->mPendingVersions[specialization.defines] = pPending;
+        pPending->task = Threading::dispatchTask(
+            [this, pProgram, defines = specialization.defines, settings, pPending]()
+            { pPending->pVersion = createProgramVersion(*pProgram, defines, settings, pPending->log, pPending->fileTimeMap); }
+        );
+        tasks.push_back(pPending->task);
+    }
+
+    return Threading::dispatchTask(
+        [tasks]() mutable
+        {
+            for (auto& task : tasks)
+                task.finish();
+        }
+    );
+}
+
 ProgramKernels::SharedPtr ProgramManager::createProgramKernels(
     const Program& program,
     const ProgramVersion& programVersion,
@@ -479,9 +522,12 @@ ProgramKernels::SharedPtr ProgramManager::createProgramKernels(
 
     timer.update();
     double time = timer.delta();
-    mCompilationStats.programKernelsCount++;
-    mCompilationStats.programKernelsTotalTime += time;
-    mCompilationStats.programKernelsMaxTime = std::max(mCompilationStats.programKernelsMaxTime, time);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCompilationStats.programKernelsCount++;
+        mCompilationStats.programKernelsTotalTime += time;
+        mCompilationStats.programKernelsMaxTime = std::max(mCompilationStats.programKernelsMaxTime, time);
+    }
     logDebug("Created program kernels in {:.3f} s: {}", time, descStr);
 
     return pProgramKernels;
@@ -596,42 +642,68 @@ bool ProgramManager::reloadAllPrograms(bool forceReload)
 
 void ProgramManager::addGlobalDefines(const Program::DefineList& defineList)
 {
-    mGlobalDefineList.add(defineList);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mGlobalDefineList.add(defineList);
+    }
     reloadAllPrograms(true);
 }
 
 void ProgramManager::removeGlobalDefines(const Program::DefineList& defineList)
 {
-    mGlobalDefineList.remove(defineList);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mGlobalDefineList.remove(defineList);
+    }
     reloadAllPrograms(true);
 }
 
 void ProgramManager::setGenerateDebugInfoEnabled(bool enabled)
 {
+    std::lock_guard<std::mutex> lock(mMutex);
     mGenerateDebugInfo = enabled;
 }
 
 bool ProgramManager::isGenerateDebugInfoEnabled()
 {
+    std::lock_guard<std::mutex> lock(mMutex);
     return mGenerateDebugInfo;
 }
 
 void ProgramManager::setForcedCompilerFlags(ForcedCompilerFlags forcedCompilerFlags)
 {
-    mForcedCompilerFlags = forcedCompilerFlags;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mForcedCompilerFlags = forcedCompilerFlags;
+    }
     reloadAllPrograms(true);
 }
 
 ProgramManager::ForcedCompilerFlags ProgramManager::getForcedCompilerFlags()
 {
+    std::lock_guard<std::mutex> lock(mMutex);
     return mForcedCompilerFlags;
 }
 
-SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& program) const
+ProgramManager::GlobalCompilationSettings ProgramManager::getGlobalCompilationSettings() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return GlobalCompilationSettings{mGlobalDefineList, mForcedCompilerFlags, mGenerateDebugInfo};
+}
+
+SlangCompileRequest* ProgramManager::createSlangCompileRequest(
+    const Program& program,
+    const Program::DefineList& defines,
+    const GlobalCompilationSettings& settings
+) const
 {
     auto pDevice = mpDevice.lock();
     FALCOR_ASSERT(pDevice);
 
+    // The Slang global session is not thread-safe. Compile requests are created under the Slang lock,
+    // the compilation itself runs concurrently in separate sessions.
+    std::lock_guard<std::mutex> slangLock(mSlangMutex);
+
     slang::IGlobalSession* pSlangGlobalSession = pDevice->getSlangGlobalSession();
     FALCOR_ASSERT(pSlangGlobalSession);
 
@@ -665,8 +737,8 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
 
     // Get compiler flags and adjust with forced flags.
     Shader::CompilerFlags compilerFlags = program.mDesc.getCompilerFlags();
-    compilerFlags &= ~mForcedCompilerFlags.disabled;
-    compilerFlags |= mForcedCompilerFlags.enabled;
+    compilerFlags &= ~settings.forcedCompilerFlags.disabled;
+    compilerFlags |= settings.forcedCompilerFlags.enabled;
 
     // Set floating point mode. If no shader compiler flags for this were set, we use Slang's default mode.
     bool flagFast = is_set(compilerFlags, Shader::CompilerFlags::FloatingPointModeFast);
@@ -714,9 +786,9 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     const auto addSlangDefine = [&slangDefines](const char* name, const char* value) { slangDefines.push_back({name, value}); };
 
     // Add global followed by program specific defines.
-    for (const auto& shaderDefine : mGlobalDefineList)
+    for (const auto& shaderDefine : settings.defines)
         addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
-    for (const auto& shaderDefine : program.getDefineList())
+    for (const auto& shaderDefine : defines)
         addSlangDefine(shaderDefine.first.c_str(), shaderDefine.second.c_str());
 
     // Add a `#define`s based on the target and shader model.
@@ -742,8 +814,6 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     pSlangGlobalSession->createSession(sessionDesc, pSlangSession.writeRef());
     FALCOR_ASSERT(pSlangSession);
 
-    program.mFileTimeMap.clear(); // TODO @skallweit
-
     if (!program.mDesc.mLanguagePrelude.empty())
     {
         if (targetDesc.format == SLANG_DXIL)
@@ -769,7 +839,7 @@ SlangCompileRequest* ProgramManager::createSlangCompileRequest(const Program& pr
     spSetDumpIntermediates(pSlangRequest, dumpIR);
 
     // Set debug level
-    if (mGenerateDebugInfo || is_set(program.mDesc.getCompilerFlags(), Shader::CompilerFlags::GenerateDebugInfo))
+    if (settings.generateDebugInfo || is_set(program.mDesc.getCompilerFlags(), Shader::CompilerFlags::GenerateDebugInfo))
         spSetDebugInfoLevel(pSlangRequest, SLANG_DEBUG_INFO_LEVEL_STANDARD);
 
     // Configure any flags for the Slang compilation step
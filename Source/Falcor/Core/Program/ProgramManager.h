@@ -28,13 +28,18 @@
 #pragma once
 #include "Program.h"
 #include "Core/API/fwd.h"
+#include "Utils/Threading.h"
 
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace Falcor
 {
 
-class ProgramManager
+class FALCOR_API ProgramManager
 {
 public:
     ProgramManager(std::weak_ptr<Device> pDevice);
@@ -62,8 +67,29 @@ public:
     Program::Desc applyForcedCompilerFlags(Program::Desc desc) const;
     void registerProgramForReload(const Program::SharedPtr& pProg);
 
+    /**
+     * Specialization of a program for a list of defines.
+     */
+    struct ProgramSpecialization
+    {
+        Program::SharedPtr pProgram;
+        Program::DefineList defines;
+    };
+
     ProgramVersion::SharedPtr createProgramVersion(const Program& program, std::string& log) const;
 
+    /**
+     * Compile program versions for a list of specializations in the background.
+     * The specializations are compiled concurrently on the worker threads. When a program switches to the defines of a
+     * specialization, its active version is the background result, waiting for it if it has not finished compiling yet.
+     * Specializations that are already compiled or pending are skipped. Compilation errors are reported when the program
+     * uses the specialization. The global compilation settings are copied when the compilation is started. Changing them
+     * reloads all programs, which discards the pending results.
+     * @param[in] specializations List of program specializations.
+     * @return Task that finishes once all specializations have been compiled.
+     */
+    Threading::Task compileProgramVersionsAsync(const std::vector<ProgramSpecialization>& specializations) const;
+
     ProgramKernels::SharedPtr ProgramManager::createProgramKernels(
         const Program& program,
         const ProgramVersion& programVersion,
@@ -125,11 +151,49 @@ public:
     void resetCompilationStats() { mCompilationStats = {}; }
 
 private:
-    SlangCompileRequest* createSlangCompileRequest(const Program& program) const;
+    using FileTimeMap = std::unordered_map<std::string, time_t>;
+
+    /**
+     * Compilation settings applied to all programs.
+     * They are copied when a compilation is started, so that compilations running on worker threads are not affected by changes.
+     */
+    struct GlobalCompilationSettings
+    {
+        Program::DefineList defines;
+        ForcedCompilerFlags forcedCompilerFlags;
+        bool generateDebugInfo = false;
+    };
+
+    GlobalCompilationSettings getGlobalCompilationSettings() const;
+
+    /**
+     * Create a program version for a given set of defines. This can be called from any thread.
+     * @param[in] program The program.
+     * @param[in] defines The program defines.
+     * @param[in] settings The global compilation settings.
+     * @param[out] log Diagnostic output.
+     * @param[out] fileTimeMap Modification times of all files the compilation depended on.
+     * @return The program version, or nullptr if compilation failed.
+     */
+    ProgramVersion::SharedPtr createProgramVersion(
+        const Program& program,
+        const Program::DefineList& defines,
+        const GlobalCompilationSettings& settings,
+        std::string& log,
+        FileTimeMap& fileTimeMap
+    ) const;
+
+    SlangCompileRequest* createSlangCompileRequest(
+        const Program& program,
+        const Program::DefineList& defines,
+        const GlobalCompilationSettings& settings
+    ) const;
 
     std::weak_ptr<Device> mpDevice;
 
     std::vector<std::weak_ptr<Program>> mLoadedPrograms;
+    mutable std::mutex mMutex;      ///< Protects the compilation stats and the global compilation settings.
+    mutable std::mutex mSlangMutex; ///< Protects the Slang global session.
     mutable CompilationStats mCompilationStats;
 
     Program::DefineList mGlobalDefineList;
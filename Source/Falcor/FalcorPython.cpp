@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Core/API/Device.h"
 #include "Core/Plugin.h"
+#include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
 
 #include <pybind11/pybind11.h>
@@ -55,6 +56,10 @@ PYBIND11_MODULE(falcor, m)
     {
         Falcor::Device::enableAgilitySDK();
         Falcor::PluginManager::instance().loadAllPlugins();
+
+        // Shut down the logger when the interpreter exits, before the static destructors run.
+        auto atexit = pybind11::module_::import("atexit");
+        atexit.attr("register")(pybind11::cpp_function([]() { Falcor::Logger::shutdown(); }));
     }
 
     m.doc() = "Falcor python bindings";
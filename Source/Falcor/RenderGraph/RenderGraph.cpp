@@ -30,9 +30,11 @@
 #include "RenderGraphImportExport.h"
 #include "RenderGraphCompiler.h"
 #include "Core/API/Device.h"
+#include "Utils/StringUtils.h"
 #include "Utils/Algorithm/DirectedGraphTraversal.h"
 #include "Utils/Scripting/Scripting.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include <fmt/format.h>
 
 namespace Falcor
 {
@@ -114,7 +116,7 @@ namespace Falcor
             mNameToIndex[passName] = passIndex;
         }
 
-        pPass->mPassChangedCB = [this]() { mRecompile = true; };
+        pPass->mPassChangedCB = [this, passIndex]() { mChangedPasses.insert(passIndex); };
         pPass->mName = passName;
 
         if (mpScene) pPass->setScene(mpDevice->getRenderContext(), mpScene);
@@ -181,11 +183,12 @@ namespace Falcor
         std::string passTypeName = pOldPass->getType();
         auto pPass = RenderPass::create(passTypeName, mpDevice, dict);
         pPassIt->second.pPass = pPass;
-        pPass->mPassChangedCB = [this]() { mRecompile = true; };
+        pPass->mPassChangedCB = [this, index]() { mChangedPasses.insert(index); };
         pPass->mName = pOldPass->getName();
 
         if (mpScene) pPass->setScene(mpDevice->getRenderContext(), mpScene);
-        mRecompile = true;
+        // The graph topology is unchanged, so only this pass needs to be recompiled
+        mChangedPasses.insert(index);
     }
 
     const RenderPass::SharedPtr& RenderGraph::getPass(const std::string& name) const
@@ -421,13 +424,27 @@ namespace Falcor
 
     bool RenderGraph::compile(RenderContext* pRenderContext, std::string& log)
     {
-        if (!mRecompile) return true;
+        if (!mRecompile && mChangedPasses.empty()) return true;
+
+        // If only passes changed, try to recompile just the affected passes and resources
+        if (!mRecompile && mpExe)
+        {
+            auto pExe = RenderGraphCompiler::recompile(*this, pRenderContext, mCompilerDeps, *mpExe, mChangedPasses);
+            if (pExe)
+            {
+                mpExe = pExe;
+                mChangedPasses.clear();
+                return true;
+            }
+        }
+
         mpExe = nullptr;
 
         try
         {
             mpExe = RenderGraphCompiler::compile(*this, pRenderContext, mCompilerDeps);
             mRecompile = false;
+            mChangedPasses.clear();
             return true;
         }
         catch (const std::exception& e)
@@ -595,6 +612,13 @@ namespace Falcor
         }
     }
 
+    void RenderGraph::setTransientResourceAliasing(bool enabled)
+    {
+        if (mCompilerDeps.aliasTransientResources == enabled) return;
+        mCompilerDeps.aliasTransientResources = enabled;
+        mRecompile = true;
+    }
+
     bool RenderGraph::isGraphOutput(const std::string& name) const
     {
         str_pair strPair;
@@ -678,6 +702,12 @@ namespace Falcor
 
     void RenderGraph::renderUI(RenderContext* pRenderContext, Gui::Widgets& widget)
     {
+        if (mpExe && isTransientResourceAliasingEnabled())
+        {
+            const auto& stats = mpExe->getResourceAllocationStats();
+            widget.text(fmt::format("Transient resources: {} allocated, {} saved, {} peak",
+                formatByteSize(stats.allocatedBytes), formatByteSize(stats.getSavedBytes()), formatByteSize(stats.peakBytes)));
+        }
         if (mpExe) mpExe->renderUI(pRenderContext, widget);
     }
 
@@ -739,6 +769,7 @@ namespace Falcor
         renderGraph.def(RenderGraphIR::kUnmarkOutput, &RenderGraph::unmarkOutput, "name"_a);
         renderGraph.def("getPass", &RenderGraph::getPass, "name"_a);
         renderGraph.def("getOutput", pybind11::overload_cast<const std::string&>(&RenderGraph::getOutput), "name"_a);
+        renderGraph.def(RenderGraphIR::kSetTransientResourceAliasing, &RenderGraph::setTransientResourceAliasing, "enabled"_a);
         auto printGraph = [](RenderGraph::SharedPtr pGraph) { pybind11::print(RenderGraphExporter::getIR(pGraph)); };
         renderGraph.def("print", printGraph);
 
@@ -179,6 +179,17 @@ namespace Falcor
         */
         bool isGraphOutput(const std::string& name) const;
 
+        /** Enable/disable aliasing of transient resources.
+            When enabled, resources of fields with identical properties whose lifetimes don't overlap within a graph execution share the same resource.
+            Graph outputs, internal fields and persistent fields are never aliased. Passes must not rely on the content of their other outputs being preserved between frames.
+            Changing this setting triggers a recompilation.
+        */
+        void setTransientResourceAliasing(bool enabled);
+
+        /** Check if aliasing of transient resources is enabled.
+        */
+        bool isTransientResourceAliasingEnabled() const { return mCompilerDeps.aliasTransientResources; }
+
         /** Call this when the swap chain was resized.
         */
         void onResize(const Fbo* pTargetFbo);
@@ -306,6 +317,7 @@ namespace Falcor
         RenderGraphExe::SharedPtr mpExe;                            ///< Helper for allocating resources and executing the graph.
         RenderGraphCompiler::Dependencies mCompilerDeps;            ///< Data needed by the graph compiler.
         bool mRecompile = false;                                    ///< Set to true to trigger a recompilation after any graph changes (topology/scene/size/passes/etc.)
+        std::unordered_set<uint32_t> mChangedPasses;                ///< Node IDs of passes that requested a recompilation. Only these passes and their neighbors are recompiled if the graph didn't change otherwise.
 
         friend class RenderGraphUI;
         friend class RenderGraphExporter;
@@ -29,6 +29,7 @@
 #include "RenderGraph.h"
 #include "RenderPasses/ResolvePass.h"
 #include "Utils/Algorithm/DirectedGraphTraversal.h"
+#include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
 
 namespace Falcor
@@ -61,15 +62,57 @@ namespace Falcor
         c.validateGraph();
         c.allocateResources(pRenderContext->getDevice(), pResourcesCache.get());
 
+        auto pExe = c.createExe(pResourcesCache);
+        pExe->mHasGeneratedPasses = !c.mCompilationChanges.generatedPasses.empty();
+        c.restoreCompilationChanges();
+        return pExe;
+    }
+
+    RenderGraphExe::SharedPtr RenderGraphCompiler::recompile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies, const RenderGraphExe& prevExe, const std::unordered_set<uint32_t>& changedPasses)
+    {
+        // Passes generated by the previous compilation were removed from the graph afterwards, so its execution list can't be reused
+        if (prevExe.mHasGeneratedPasses) return nullptr;
+
+        RenderGraphCompiler c = RenderGraphCompiler(graph, dependencies);
+        if (!c.restoreExecutionOrder(prevExe)) return nullptr;
+
+        try
+        {
+            std::unordered_set<uint32_t> passesToCompile;
+            if (!c.reflectChangedPasses(changedPasses, passesToCompile)) return nullptr;
+
+            for (auto& p : c.mExecutionList)
+            {
+                if (passesToCompile.count(p.index)) p.pPass->compile(pRenderContext, c.prepPassCompilationData(p));
+            }
+            c.validateGraph();
+
+            auto pResourcesCache = ResourceCache::create();
+            for (const auto&[name, pRes] : dependencies.externalResources) pResourcesCache->registerExternalResource(name, pRes);
+            c.allocateResources(pRenderContext->getDevice(), pResourcesCache.get(), prevExe.mpResourceCache.get());
+
+            return c.createExe(pResourcesCache);
+        }
+        catch (const std::exception& e)
+        {
+            // Let the full compilation handle and report the error
+            logDebug("RenderGraphCompiler: Incremental recompilation failed, falling back to full compilation. {}", e.what());
+            return nullptr;
+        }
+    }
+
+    RenderGraphExe::SharedPtr RenderGraphCompiler::createExe(const ResourceCache::SharedPtr& pResourceCache) const
+    {
         auto pExe = RenderGraphExe::create();
-        pExe->mExecutionList.reserve(c.mExecutionList.size());
+        pExe->mExecutionList.reserve(mExecutionList.size());
 
-        for (auto e : c.mExecutionList)
+        for (const auto& e : mExecutionList)
         {
             pExe->insertPass(e.name, e.pPass);
+            pExe->mPassNodeIndices.push_back(e.index);
+            pExe->mPassReflections.push_back(e.reflector);
         }
-        c.restoreCompilationChanges();
-        pExe->mpResourceCache = pResourcesCache;
+        pExe->mpResourceCache = pResourceCache;
         return pExe;
     }
 
@@ -157,6 +200,93 @@ namespace Falcor
         }
     }
 
+    bool RenderGraphCompiler::restoreExecutionOrder(const RenderGraphExe& prevExe)
+    {
+        mExecutionList.clear();
+
+        for (size_t i = 0; i < prevExe.mPassNodeIndices.size(); i++)
+        {
+            uint32_t node = prevExe.mPassNodeIndices[i];
+            auto it = mGraph.mNodeData.find(node);
+            if (it == mGraph.mNodeData.end()) return false;
+
+            // The pass object may have been replaced by RenderGraph::updatePass()
+            mExecutionList.push_back({ node, it->second.pPass, it->second.name, prevExe.mPassReflections[i] });
+        }
+
+        return true;
+    }
+
+    bool RenderGraphCompiler::reflectChangedPasses(const std::unordered_set<uint32_t>& changedPasses, std::unordered_set<uint32_t>& passesToCompile)
+    {
+        auto findPass = [this](uint32_t node) -> PassData*
+        {
+            for (auto& p : mExecutionList) if (p.index == node) return &p;
+            return nullptr;
+        };
+
+        // Reflect a pass with the resources connected to it, like the retry in compilePasses(). Returns true if the reflection changed.
+        auto reflectPass = [this](PassData& p)
+        {
+            auto reflection = p.pPass->reflect(prepPassCompilationData(p));
+            if (reflection == p.reflector) return false;
+            p.reflector = reflection;
+            return true;
+        };
+
+        // Reflect the changed passes. Passes that are not executed are not compiled either.
+        std::vector<uint32_t> reflectionChanged;
+        for (auto& p : mExecutionList)
+        {
+            if (changedPasses.count(p.index) == 0) continue;
+            passesToCompile.insert(p.index);
+            if (reflectPass(p)) reflectionChanged.push_back(p.index);
+        }
+
+        // Passes connected to a pass whose reflection changed see different connected resources.
+        // Their reflection may depend on them, so reflect them again and compile them. Repeat until no reflection changes.
+        auto visitEdge = [&](uint32_t edgeIndex, PassData* pNeighbor)
+        {
+            const auto& edgeData = mGraph.mEdgeData.at(edgeIndex);
+            if (edgeData.srcField.empty() || !pNeighbor) return true; // Execution edge or pass that is not executed
+
+            if (reflectPass(*pNeighbor)) reflectionChanged.push_back(pNeighbor->index);
+
+            // Inserting an MSAA resolve pass changes the execution order, which requires a full compilation
+            const auto& pEdge = mGraph.mpGraph->getEdge(edgeIndex);
+            const PassData* pSrc = findPass(pEdge->getSourceNode());
+            const PassData* pDst = findPass(pEdge->getDestNode());
+            const auto pSrcField = pSrc->reflector.getField(edgeData.srcField);
+            const auto pDstField = pDst->reflector.getField(edgeData.dstField);
+            if (!pSrcField || !pDstField || canAutoResolve(*pSrcField, *pDstField)) return false;
+
+            passesToCompile.insert(pSrc->index);
+            passesToCompile.insert(pDst->index);
+            return true;
+        };
+
+        // Reflections that keep changing are left to the full compilation to report
+        const size_t maxReflectionChanges = mExecutionList.size() * mExecutionList.size();
+        for (size_t i = 0; i < reflectionChanged.size(); i++)
+        {
+            if (i >= maxReflectionChanges) return false;
+
+            const DirectedGraph::Node* pNode = mGraph.mpGraph->getNode(reflectionChanged[i]);
+            for (uint32_t e = 0; e < pNode->getIncomingEdgeCount(); e++)
+            {
+                uint32_t edgeIndex = pNode->getIncomingEdge(e);
+                if (!visitEdge(edgeIndex, findPass(mGraph.mpGraph->getEdge(edgeIndex)->getSourceNode()))) return false;
+            }
+            for (uint32_t e = 0; e < pNode->getOutgoingEdgeCount(); e++)
+            {
+                uint32_t edgeIndex = pNode->getOutgoingEdge(e);
+                if (!visitEdge(edgeIndex, findPass(mGraph.mpGraph->getEdge(edgeIndex)->getDestNode()))) return false;
+            }
+        }
+
+        return true;
+    }
+
     bool RenderGraphCompiler::insertAutoPasses()
     {
         bool addedPasses = false;
@@ -242,15 +372,8 @@ namespace Falcor
         return addedPasses;
     }
 
-    void RenderGraphCompiler::allocateResources(Device* pDevice, ResourceCache* pResourceCache)
+    void RenderGraphCompiler::allocateResources(Device* pDevice, ResourceCache* pResourceCache, const ResourceCache* pPrevResourceCache)
     {
-        // Build list to look up execution order index from the pass
-        std::unordered_map<RenderPass*, uint32_t> passToIndex;
-        for (size_t i = 0; i < mExecutionList.size(); i++)
-        {
-            passToIndex.emplace(mExecutionList[i].pPass.get(), uint32_t(i));
-        }
-
         for (size_t i = 0; i < mExecutionList.size(); i++)
         {
             uint32_t nodeIndex = mExecutionList[i].index;
@@ -312,13 +435,13 @@ namespace Falcor
                 std::string srcFieldName = mGraph.mNodeData[pEdge->getSourceNode()].name + '.' + edgeData.srcField;
                 std::string dstFieldName = mGraph.mNodeData[nodeIndex].name + '.' + dstField.getName();
 
-                const auto& pSrcPass = mGraph.mNodeData[pEdge->getSourceNode()].pPass.get();
-                const auto& srcReflection = mExecutionList[passToIndex.at(pSrcPass)].reflector;
-                pResourceCache->registerField(dstFieldName, dstField, passToIndex[pSrcPass], srcFieldName);
+                // The resource must stay alive until this pass has executed
+                pResourceCache->registerField(dstFieldName, dstField, uint32_t(i), srcFieldName);
             }
         }
 
-        pResourceCache->allocateResources(pDevice, mDependencies.defaultResourceProps);
+        pResourceCache->setTransientAliasingEnabled(mDependencies.aliasTransientResources);
+        pResourceCache->allocateResources(pDevice, mDependencies.defaultResourceProps, pPrevResourceCache);
     }
 
 
@@ -32,6 +32,7 @@
 #include "RenderGraphExe.h"
 #include "Core/Macros.h"
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -46,9 +47,24 @@ namespace Falcor
         {
             ResourceCache::DefaultProperties defaultResourceProps;
             ResourceCache::ResourcesMap externalResources;
+            bool aliasTransientResources = false;   ///< Share resources between transient fields with non-overlapping lifetimes.
         };
         static RenderGraphExe::SharedPtr compile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies);
 
+        /** Recompile a graph after some of its passes changed, without changes to the graph topology, outputs or dependencies.
+            The execution order of the previous compilation is kept. The changed passes are reflected again with their connected resources,
+            and so are the passes connected to a pass whose reflection changed, until no reflection changes.
+            Passes are compiled if they changed or if they are connected to a pass whose reflection changed.
+            Resources whose properties didn't change are taken over from the previous compilation.
+            \param[in] graph The render graph.
+            \param[in] pRenderContext The render context.
+            \param[in] dependencies Compiler dependencies. Must be the same as for the previous compilation.
+            \param[in] prevExe The result of the previous compilation of the graph.
+            \param[in] changedPasses Node indices of the passes that changed since the previous compilation.
+            \return The new executable graph, or nullptr if the graph needs a full compilation.
+        */
+        static RenderGraphExe::SharedPtr recompile(RenderGraph& graph, RenderContext* pRenderContext, const Dependencies& dependencies, const RenderGraphExe& prevExe, const std::unordered_set<uint32_t>& changedPasses);
+
     private:
         RenderGraphCompiler(RenderGraph& graph, const Dependencies& dependencies);
 
@@ -73,9 +89,12 @@ namespace Falcor
         } mCompilationChanges;
 
         void resolveExecutionOrder();
+        bool restoreExecutionOrder(const RenderGraphExe& prevExe);
         void compilePasses(RenderContext* pRenderContext);
+        bool reflectChangedPasses(const std::unordered_set<uint32_t>& changedPasses, std::unordered_set<uint32_t>& passesToCompile);
         bool insertAutoPasses();
-        void allocateResources(Device* pDevice, ResourceCache* pResourceCache);
+        void allocateResources(Device* pDevice, ResourceCache* pResourceCache, const ResourceCache* pPrevResourceCache = nullptr);
+        RenderGraphExe::SharedPtr createExe(const ResourceCache::SharedPtr& pResourceCache) const;
         void validateGraph() const;
         void restoreCompilationChanges();
         RenderPass::CompileData prepPassCompilationData(const PassData& passData);
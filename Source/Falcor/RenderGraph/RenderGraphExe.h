@@ -89,6 +89,10 @@ namespace Falcor
         */
         void setInput(const std::string& name, const Resource::SharedPtr& pResource);
 
+        /** Get memory statistics of the resources allocated for the graph.
+        */
+        const TransientResourceAllocator::Stats& getResourceAllocationStats() const { return mpResourceCache->getAllocationStats(); }
+
     private:
         friend class RenderGraphCompiler;
         static SharedPtr create() { return SharedPtr(new RenderGraphExe); }
@@ -107,5 +111,10 @@ namespace Falcor
 
         std::vector<Pass> mExecutionList;
         ResourceCache::SharedPtr mpResourceCache;
+
+        // Compilation results used for incremental recompilation
+        std::vector<uint32_t> mPassNodeIndices;                 ///< Graph node index of each pass in the execution list.
+        std::vector<RenderPassReflection> mPassReflections;     ///< Reflection of each pass in the execution list.
+        bool mHasGeneratedPasses = false;                       ///< True if the compiler inserted passes (e.g. MSAA resolve) that are no longer part of the graph.
     };
 }
@@ -42,6 +42,7 @@ namespace Falcor
     const char* RenderGraphIR::kUpdatePass = "updatePass";
     const char* RenderGraphIR::kLoadPassLibrary = "loadRenderPassLibrary";
     const char* RenderGraphIR::kCreatePass = "createPass";
+    const char* RenderGraphIR::kSetTransientResourceAliasing = "setTransientResourceAliasing";
     const char* RenderGraphIR::kRenderGraph = "RenderGraph";
 
     std::string RenderGraphIR::getFuncName(const std::string& graphName)
@@ -123,4 +124,9 @@ namespace Falcor
     {
         mIR += mIndentation + ScriptWriter::makeFunc(RenderGraphIR::kLoadPassLibrary, name);
     }
+
+    void RenderGraphIR::setTransientResourceAliasing(bool enabled)
+    {
+        mIR += mGraphPrefix + ScriptWriter::makeFunc(RenderGraphIR::kSetTransientResourceAliasing, enabled);
+    }
 }
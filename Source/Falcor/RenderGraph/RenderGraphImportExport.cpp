@@ -152,6 +152,8 @@ namespace Falcor
             }
         }
 
+        if (pGraph->isTransientResourceAliasingEnabled()) pIR->setTransientResourceAliasing(true);
+
         return pIR->getIR();
     }
 
@@ -214,6 +214,7 @@ namespace Falcor
         /** Request a recompilation of the render graph.
             Call this function if the I/O requirements of the pass have changed.
             During the recompile, reflect() will be called for the pass to report the new requirements.
+            Unless the graph itself changed, only this pass and the passes connected to resources whose requirements changed are compiled again.
         */
         void requestRecompile() { mPassChangedCB(); }
 
@@ -29,7 +29,12 @@
 #include "Core/API/Device.h"
 #include "Core/API/Texture.h"
 #include "Core/API/Buffer.h"
+#include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/StringUtils.h"
+#include "Utils/Math/Common.h"
+#include <algorithm>
+#include <unordered_set>
 
 namespace Falcor
 {
@@ -42,6 +47,7 @@ namespace Falcor
     {
         mNameToIndex.clear();
         mResourceData.clear();
+        mAllocationStats = {};
     }
 
     const Resource::SharedPtr& ResourceCache::getResource(const std::string& name) const
@@ -88,6 +94,13 @@ namespace Falcor
         range.second = std::max(range.second, newTime);
     }
 
+    inline bool isTransientField(const RenderPassReflection::Field& field)
+    {
+        // Internal fields are often used to carry data across frames, so we never alias them.
+        return !is_set(field.getFlags(), RenderPassReflection::Field::Flags::Persistent) &&
+            !is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
+    }
+
     void ResourceCache::registerField(const std::string& name, const RenderPassReflection::Field& field, uint32_t timePoint, const std::string& alias)
     {
         FALCOR_ASSERT(mNameToIndex.find(name) == mNameToIndex.end());
@@ -104,7 +117,7 @@ namespace Falcor
             FALCOR_ASSERT(mNameToIndex.count(name) == 0);
             mNameToIndex[name] = (uint32_t)mResourceData.size();
             bool resolveBindFlags = (field.getBindFlags() == ResourceBindFlags::None);
-            mResourceData.push_back({ field, {timePoint, timePoint}, nullptr, resolveBindFlags, name });
+            mResourceData.push_back({ field, {timePoint, timePoint}, nullptr, resolveBindFlags, name, isTransientField(field) });
         }
         else // Add alias
         {
@@ -114,81 +127,201 @@ namespace Falcor
             mergeTimePoint(mResourceData[index].lifetime, timePoint);
             mResourceData[index].pResource = nullptr;
             mResourceData[index].resolveBindFlags = mResourceData[index].resolveBindFlags || (field.getBindFlags() == ResourceBindFlags::None);
+            mResourceData[index].transient = mResourceData[index].transient && isTransientField(field);
         }
     }
 
-    inline Resource::SharedPtr createResourceForPass(Device* pDevice, const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags, const std::string& resourceName)
+    namespace
     {
-        uint32_t width = field.getWidth() ? field.getWidth() : params.dims.x;
-        uint32_t height = field.getHeight() ? field.getHeight() : params.dims.y;
-        uint32_t depth = field.getDepth() ? field.getDepth() : 1;
-        uint32_t sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
-        auto bindFlags = field.getBindFlags();
-        auto arraySize = field.getArraySize();
-        auto mipLevels = field.getMipCount();
+        /** Fully resolved properties of a resource to be created for a field.
+        */
+        struct ResourceDesc
+        {
+            RenderPassReflection::Field::Type type;
+            uint32_t width;
+            uint32_t height;
+            uint32_t depth;
+            uint32_t sampleCount;
+            uint32_t arraySize;
+            uint32_t mipLevels;
+            ResourceFormat format;
+            ResourceBindFlags bindFlags;
 
-        ResourceFormat format = ResourceFormat::Unknown;
+            bool operator==(const ResourceDesc& other) const
+            {
+                return type == other.type && width == other.width && height == other.height && depth == other.depth &&
+                    sampleCount == other.sampleCount && arraySize == other.arraySize && mipLevels == other.mipLevels &&
+                    format == other.format && bindFlags == other.bindFlags;
+            }
+        };
 
-        if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
+        ResourceDesc resolveResourceDesc(Device* pDevice, const ResourceCache::DefaultProperties& params, const RenderPassReflection::Field& field, bool resolveBindFlags)
         {
-            format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
-            if (resolveBindFlags)
+            ResourceDesc desc;
+            desc.type = field.getType();
+            desc.width = field.getWidth() ? field.getWidth() : params.dims.x;
+            desc.height = field.getHeight() ? field.getHeight() : params.dims.y;
+            desc.depth = field.getDepth() ? field.getDepth() : 1;
+            desc.sampleCount = field.getSampleCount() ? field.getSampleCount() : 1;
+            desc.arraySize = field.getArraySize();
+            desc.mipLevels = field.getMipCount();
+            desc.bindFlags = field.getBindFlags();
+            desc.format = ResourceFormat::Unknown;
+
+            if (field.getType() != RenderPassReflection::Field::Type::RawBuffer)
             {
-                ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
-                bool isOutput = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Output);
-                bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
-                if (isOutput || isInternal) mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
-                auto supported = pDevice->getFormatBindFlags(format);
-                mask &= supported;
-                bindFlags |= mask;
+                desc.format = field.getFormat() == ResourceFormat::Unknown ? params.format : field.getFormat();
+                if (resolveBindFlags)
+                {
+                    ResourceBindFlags mask = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+                    bool isOutput = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Output);
+                    bool isInternal = is_set(field.getVisibility(), RenderPassReflection::Field::Visibility::Internal);
+                    if (isOutput || isInternal) mask |= Resource::BindFlags::DepthStencil | Resource::BindFlags::RenderTarget;
+                    auto supported = pDevice->getFormatBindFlags(desc.format);
+                    mask &= supported;
+                    desc.bindFlags |= mask;
+                }
             }
+            else // RawBuffer
+            {
+                if (resolveBindFlags) desc.bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
+            }
+            return desc;
         }
-        else // RawBuffer
-        {
-            if (resolveBindFlags) bindFlags = Resource::BindFlags::UnorderedAccess | Resource::BindFlags::ShaderResource;
-        }
-        Resource::SharedPtr pResource;
 
-        switch (field.getType())
+        /** Estimate the memory footprint of a resource. This ignores alignment and padding done by the driver.
+        */
+        uint64_t estimateResourceSize(const ResourceDesc& desc)
         {
-        case RenderPassReflection::Field::Type::RawBuffer:
-            pResource = Buffer::create(pDevice, width, bindFlags, Buffer::CpuAccess::None);
-            break;
-        case RenderPassReflection::Field::Type::Texture1D:
-            pResource = Texture::create1D(pDevice, width, format, arraySize, mipLevels, nullptr, bindFlags);
-            break;
-        case RenderPassReflection::Field::Type::Texture2D:
-            if (sampleCount > 1)
+            if (desc.type == RenderPassReflection::Field::Type::RawBuffer) return desc.width;
+
+            uint32_t height = desc.type == RenderPassReflection::Field::Type::Texture1D ? 1 : desc.height;
+            uint32_t depth = desc.type == RenderPassReflection::Field::Type::Texture3D ? desc.depth : 1;
+            uint32_t layers = desc.type == RenderPassReflection::Field::Type::TextureCube ? desc.arraySize * 6 : desc.arraySize;
+
+            uint32_t mipLevels = desc.sampleCount > 1 ? 1 : desc.mipLevels;
+            uint32_t maxMipLevels = bitScanReverse(desc.width | height | depth) + 1;
+            mipLevels = std::min(mipLevels, maxMipLevels);
+
+            uint32_t widthRatio = getFormatWidthCompressionRatio(desc.format);
+            uint32_t heightRatio = getFormatHeightCompressionRatio(desc.format);
+            uint64_t size = 0;
+            for (uint32_t mip = 0; mip < mipLevels; mip++)
             {
-                pResource = Texture::create2DMS(pDevice, width, height, format, sampleCount, arraySize, bindFlags);
+                uint64_t w = div_round_up(std::max(desc.width >> mip, 1u), widthRatio);
+                uint64_t h = div_round_up(std::max(height >> mip, 1u), heightRatio);
+                uint64_t d = std::max(depth >> mip, 1u);
+                size += w * h * d;
             }
-            else
+            return size * getFormatBytesPerBlock(desc.format) * layers * desc.sampleCount;
+        }
+
+        Resource::SharedPtr createResource(Device* pDevice, const ResourceDesc& desc, const std::string& resourceName)
+        {
+            Resource::SharedPtr pResource;
+
+            switch (desc.type)
             {
-                pResource = Texture::create2D(pDevice, width, height, format, arraySize, mipLevels, nullptr, bindFlags);
+            case RenderPassReflection::Field::Type::RawBuffer:
+                pResource = Buffer::create(pDevice, desc.width, desc.bindFlags, Buffer::CpuAccess::None);
+                break;
+            case RenderPassReflection::Field::Type::Texture1D:
+                pResource = Texture::create1D(pDevice, desc.width, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            case RenderPassReflection::Field::Type::Texture2D:
+                if (desc.sampleCount > 1)
+                {
+                    pResource = Texture::create2DMS(pDevice, desc.width, desc.height, desc.format, desc.sampleCount, desc.arraySize, desc.bindFlags);
+                }
+                else
+                {
+                    pResource = Texture::create2D(pDevice, desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                }
+                break;
+            case RenderPassReflection::Field::Type::Texture3D:
+                pResource = Texture::create3D(pDevice, desc.width, desc.height, desc.depth, desc.format, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            case RenderPassReflection::Field::Type::TextureCube:
+                pResource = Texture::createCube(pDevice, desc.width, desc.height, desc.format, desc.arraySize, desc.mipLevels, nullptr, desc.bindFlags);
+                break;
+            default:
+                FALCOR_UNREACHABLE();
+                return nullptr;
             }
-            break;
-        case RenderPassReflection::Field::Type::Texture3D:
-            pResource = Texture::create3D(pDevice, width, height, depth, format, mipLevels, nullptr, bindFlags);
-            break;
-        case RenderPassReflection::Field::Type::TextureCube:
-            pResource = Texture::createCube(pDevice, width, height, format, arraySize, mipLevels, nullptr, bindFlags);
-            break;
-        default:
-            FALCOR_UNREACHABLE();
-            return nullptr;
+            pResource->setName(resourceName);
+            return pResource;
         }
-        pResource->setName(resourceName);
-        return pResource;
     }
 
-    void ResourceCache::allocateResources(Device* pDevice, const DefaultProperties& params)
+    void ResourceCache::allocateResources(Device* pDevice, const DefaultProperties& params, const ResourceCache* pPrevious)
     {
-        for (auto& data : mResourceData)
+        // Gather the resources that need to be created.
+        // Fields with identical resource properties are put in the same compatibility class.
+        std::vector<uint32_t> dataIndices;
+        std::vector<ResourceDesc> descs;
+        std::vector<ResourceDesc> classDescs;
+        std::vector<TransientResourceAllocator::Request> requests;
+
+        for (uint32_t i = 0; i < (uint32_t)mResourceData.size(); i++)
+        {
+            const auto& data = mResourceData[i];
+            if ((data.pResource != nullptr) || (data.field.isValid() == false)) continue;
+
+            ResourceDesc desc = resolveResourceDesc(pDevice, params, data.field, data.resolveBindFlags);
+            auto classIt = std::find(classDescs.begin(), classDescs.end(), desc);
+            if (classIt == classDescs.end()) classIt = classDescs.insert(classDescs.end(), desc);
+
+            TransientResourceAllocator::Request request;
+            request.compatibilityClass = (uint32_t)(classIt - classDescs.begin());
+            request.firstUse = data.lifetime.first;
+            request.lastUse = data.lifetime.second;
+            request.size = estimateResourceSize(desc);
+            // Graph outputs live until the end of the graph execution and are read back by the user afterwards.
+            request.aliasable = mTransientAliasingEnabled && data.transient && data.lifetime.second != uint32_t(-1);
+
+            dataIndices.push_back(i);
+            descs.push_back(desc);
+            requests.push_back(request);
+        }
+
+        auto plan = TransientResourceAllocator::plan(requests);
+        std::vector<Resource::SharedPtr> allocations(plan.allocationSizes.size());
+
+        // Take over resources from the previous cache. The resource description only depends on the merged field, the default properties
+        // and whether bind flags are resolved, so a resource can be reused if these match for the resource data of the same name.
+        if (pPrevious && pPrevious->mDefaultProperties.dims == params.dims && pPrevious->mDefaultProperties.format == params.format)
         {
-            if ((data.pResource == nullptr) && (data.field.isValid()))
+            std::unordered_set<const Resource*> reused;
+            for (size_t r = 0; r < requests.size(); r++)
             {
-                data.pResource = createResourceForPass(pDevice, params, data.field, data.resolveBindFlags, data.name);
+                const auto& data = mResourceData[dataIndices[r]];
+                auto it = pPrevious->mNameToIndex.find(data.name);
+                if (it == pPrevious->mNameToIndex.end()) continue;
+
+                const auto& prevData = pPrevious->mResourceData[it->second];
+                if (prevData.pResource == nullptr || prevData.name != data.name || prevData.field != data.field || prevData.resolveBindFlags != data.resolveBindFlags) continue;
+
+                // A resource that was shared between fields can only be taken over by one allocation
+                auto& pResource = allocations[plan.allocationIndices[r]];
+                if (pResource == nullptr && reused.insert(prevData.pResource.get()).second) pResource = prevData.pResource;
             }
         }
+
+        // Create one resource per remaining allocation and bind it to all of its fields.
+        for (size_t r = 0; r < requests.size(); r++)
+        {
+            auto& data = mResourceData[dataIndices[r]];
+            auto& pResource = allocations[plan.allocationIndices[r]];
+            if (pResource == nullptr) pResource = createResource(pDevice, descs[r], data.name);
+            data.pResource = pResource;
+        }
+
+        mDefaultProperties = params;
+        mAllocationStats = plan.stats;
+        if (mTransientAliasingEnabled)
+        {
+            logDebug("ResourceCache: Allocated {} resources for {} fields. Allocated {}, saved {}, peak {}.",
+                plan.stats.allocationCount, plan.stats.requestCount, formatByteSize(plan.stats.allocatedBytes), formatByteSize(plan.stats.getSavedBytes()), formatByteSize(plan.stats.peakBytes));
+        }
     }
 }
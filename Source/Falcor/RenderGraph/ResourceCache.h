@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "RenderPassReflection.h"
+#include "TransientResourceAllocator.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
@@ -81,8 +82,26 @@ namespace Falcor
 
         /** Allocate all resources that need to be created/updated.
             This includes new resources, resources whose properties have been updated since last allocation call.
+            If transient resource aliasing is enabled, fields with identical resource properties and non-overlapping lifetimes share the same resource.
+            \param[in] pDevice GPU device.
+            \param[in] params Default resource properties.
+            \param[in] pPrevious Optional. Cache of a previous compilation of the same graph. Resources of fields whose properties didn't change are reused instead of being reallocated.
         */
-        void allocateResources(Device* pDevice, const DefaultProperties& params);
+        void allocateResources(Device* pDevice, const DefaultProperties& params, const ResourceCache* pPrevious = nullptr);
+
+        /** Enable/disable aliasing of transient resources. Takes effect on the next allocateResources() call.
+            A resource is transient if it is not a graph output, not an internal field and none of its fields are marked as persistent.
+            The content of a transient resource is undefined outside of its lifetime.
+        */
+        void setTransientAliasingEnabled(bool enabled) { mTransientAliasingEnabled = enabled; }
+
+        /** Check if aliasing of transient resources is enabled.
+        */
+        bool isTransientAliasingEnabled() const { return mTransientAliasingEnabled; }
+
+        /** Get memory statistics of the last allocateResources() call.
+        */
+        const TransientResourceAllocator::Stats& getAllocationStats() const { return mAllocationStats; }
 
         /** Clears all registered field/resource properties and allocated resources.
         */
@@ -98,6 +117,7 @@ namespace Falcor
             Resource::SharedPtr pResource;          // The resource
             bool resolveBindFlags;                  // Whether or not we should resolve the field's bind-flags before creating the resource
             std::string name;                       // Full name of the resource, including the pass name
+            bool transient;                         // Whether or not the resource may share memory with resources of non-overlapping lifetime
         };
 
         // Resources and properties for fields within (and therefore owned by) a render graph
@@ -106,6 +126,10 @@ namespace Falcor
 
         // References to output resources not to be allocated by the render graph
         ResourcesMap mExternalResources;
+
+        DefaultProperties mDefaultProperties;  // Default properties used by the last allocation
+        bool mTransientAliasingEnabled = false;
+        TransientResourceAllocator::Stats mAllocationStats;
     };
 
 }
@@ -0,0 +1,144 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TransientResourceAllocator.h"
+#include "Core/Assert.h"
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace Falcor
+{
+    namespace
+    {
+        /** Compute the highest amount of memory used by simultaneously live requests.
+        */
+        uint64_t computePeakBytes(const std::vector<TransientResourceAllocator::Request>& requests)
+        {
+            // Each request adds its size at its first use and removes it after its last use.
+            // Times are stored as 64-bit to allow lastUse + 1 for requests that live until the end.
+            struct Event
+            {
+                uint64_t time;
+                int64_t delta;
+            };
+
+            std::vector<Event> events;
+            events.reserve(requests.size() * 2);
+            for (const auto& r : requests)
+            {
+                events.push_back({ r.firstUse, int64_t(r.size) });
+                events.push_back({ uint64_t(r.lastUse) + 1, -int64_t(r.size) });
+            }
+
+            // Process removals before additions at the same time point.
+            std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return a.time != b.time ? a.time < b.time : a.delta < b.delta; });
+
+            int64_t current = 0;
+            int64_t peak = 0;
+            for (const auto& e : events)
+            {
+                current += e.delta;
+                peak = std::max(peak, current);
+            }
+            return uint64_t(peak);
+        }
+    }
+
+    TransientResourceAllocator::Plan TransientResourceAllocator::plan(const std::vector<Request>& requests)
+    {
+        Plan plan;
+        plan.allocationIndices.resize(requests.size(), kInvalidIndex);
+        plan.stats.requestCount = (uint32_t)requests.size();
+
+        // Process requests in order of first use.
+        std::vector<uint32_t> order(requests.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return requests[a].firstUse < requests[b].firstUse; });
+
+        // Per compatibility class state. Active allocations are kept in a min-heap ordered by the last use of their current owner.
+        using ActiveAllocation = std::pair<uint32_t, uint32_t>; // (lastUse, allocation index)
+        struct ClassState
+        {
+            std::priority_queue<ActiveAllocation, std::vector<ActiveAllocation>, std::greater<ActiveAllocation>> active;
+            std::vector<uint32_t> free;
+        };
+        std::unordered_map<uint32_t, ClassState> classes;
+
+        auto createAllocation = [&plan]()
+        {
+            plan.allocationSizes.push_back(0);
+            return (uint32_t)plan.allocationSizes.size() - 1;
+        };
+
+        for (uint32_t i : order)
+        {
+            const auto& r = requests[i];
+            FALCOR_ASSERT(r.firstUse <= r.lastUse);
+
+            uint32_t allocation = kInvalidIndex;
+            if (r.aliasable)
+            {
+                auto& state = classes[r.compatibilityClass];
+
+                // Release allocations whose owners are no longer live.
+                while (!state.active.empty() && state.active.top().first < r.firstUse)
+                {
+                    state.free.push_back(state.active.top().second);
+                    state.active.pop();
+                }
+
+                if (!state.free.empty())
+                {
+                    allocation = state.free.back();
+                    state.free.pop_back();
+                }
+                else
+                {
+                    allocation = createAllocation();
+                }
+                state.active.push({ r.lastUse, allocation });
+            }
+            else
+            {
+                allocation = createAllocation();
+            }
+
+            plan.allocationIndices[i] = allocation;
+            plan.allocationSizes[allocation] = std::max(plan.allocationSizes[allocation], r.size);
+            plan.stats.requestedBytes += r.size;
+        }
+
+        plan.stats.allocationCount = (uint32_t)plan.allocationSizes.size();
+        plan.stats.allocatedBytes = std::accumulate(plan.allocationSizes.begin(), plan.allocationSizes.end(), uint64_t(0));
+        plan.stats.peakBytes = computePeakBytes(requests);
+        return plan;
+    }
+}
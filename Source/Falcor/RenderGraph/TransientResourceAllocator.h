@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Plans the sharing of transient render graph resources based on their lifetimes.
+        Each request describes a resource that is live during an inclusive range of time points
+        (normally indices into the render graph execution order). Requests of the same compatibility
+        class whose lifetimes don't overlap are assigned to the same allocation, so that a single
+        resource can back all of them.
+        The planner is a pure CPU algorithm and doesn't create any GPU resources.
+    */
+    class FALCOR_API TransientResourceAllocator
+    {
+    public:
+        static constexpr uint32_t kInvalidIndex = uint32_t(-1);
+
+        /** Describes a resource that needs backing memory.
+        */
+        struct Request
+        {
+            uint32_t compatibilityClass = 0;    ///< Requests can only share an allocation if they have the same compatibility class.
+            uint32_t firstUse = 0;              ///< First time point at which the resource is used.
+            uint32_t lastUse = 0;               ///< Last time point at which the resource is used (inclusive).
+            uint64_t size = 0;                  ///< Size of the resource in bytes. Only used for reporting.
+            bool aliasable = true;              ///< If false, the request always gets a dedicated allocation.
+        };
+
+        /** Memory statistics of a plan.
+        */
+        struct Stats
+        {
+            uint32_t requestCount = 0;          ///< Number of requests.
+            uint32_t allocationCount = 0;       ///< Number of allocations needed by the plan.
+            uint64_t requestedBytes = 0;        ///< Memory needed without aliasing.
+            uint64_t allocatedBytes = 0;        ///< Memory needed by the plan.
+            uint64_t peakBytes = 0;             ///< Highest amount of memory used by simultaneously live requests. This is a lower bound for allocatedBytes.
+
+            uint64_t getSavedBytes() const { return requestedBytes - allocatedBytes; }
+        };
+
+        /** Result of the planning.
+        */
+        struct Plan
+        {
+            std::vector<uint32_t> allocationIndices;    ///< Allocation index for each request.
+            std::vector<uint64_t> allocationSizes;      ///< Size in bytes of each allocation.
+            Stats stats;
+        };
+
+        /** Assign requests to allocations.
+            Requests are processed in order of their first use. Within each compatibility class, a request reuses
+            an allocation whose previous owners are no longer live, or gets a new allocation if there is none.
+            This uses the minimum number of allocations per compatibility class.
+            \param[in] requests List of requests.
+            \return The plan.
+        */
+        static Plan plan(const std::vector<Request>& requests);
+    };
+}
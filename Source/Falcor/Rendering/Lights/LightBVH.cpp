@@ -136,6 +136,9 @@ namespace Falcor
         mNodeIndices.clear();
         mPerDepthRefitEntryInfo.clear();
         mMaxTriangleCountPerLeaf = 0;
+        mTriangleIndices.clear();
+        mTriangleBitmasks.clear();
+        mNodeBuildQuality.clear();
         mBVHStats = BVHStats();
         mIsValid = false;
         mIsCpuDataValid = false;
@@ -108,6 +108,10 @@ namespace Falcor
         */
         const BVHStats& getStats() const { return mBVHStats; }
 
+        /** Returns the packed BVH nodes in depth-first order. The data is synced from the GPU if needed.
+        */
+        const std::vector<PackedNode>& getNodes() const { syncDataToCPU(); return mNodes; }
+
         /** Is the BVH valid.
             \return true if the BVH is ready for use.
         */
@@ -153,6 +157,9 @@ namespace Falcor
         std::vector<uint32_t>                 mNodeIndices;             ///< Array of all node indices sorted by tree depth.
         std::vector<RefitEntryInfo>           mPerDepthRefitEntryInfo;  ///< Array containing for each level the number of internal nodes as well as the corresponding offset into 'mpNodeIndicesBuffer'; the very last entry contains the same data, but for all leaf nodes instead.
         uint32_t                              mMaxTriangleCountPerLeaf = 0; ///< After the BVH is built, this contains the maximum light count per leaf node.
+        std::vector<uint32_t>                 mTriangleIndices;         ///< CPU-side copy of the triangle indices sorted by leaf node. Only stored for incremental updates.
+        std::vector<uint64_t>                 mTriangleBitmasks;        ///< CPU-side copy of the per triangle bit patterns. Only stored for incremental updates.
+        std::vector<float>                    mNodeBuildQuality;        ///< Quality of each subtree when it was built, indexed by root node index. Only stored for incremental updates, see LightBVHBuilder::update().
         BVHStats                              mBVHStats;
         bool                                  mIsValid = false;         ///< True when the BVH has been built.
         mutable bool                          mIsCpuDataValid = false;  ///< Indicates whether the CPU-side data matches the GPU buffers.
@@ -29,9 +29,11 @@
 #include "Core/Assert.h"
 #include "Core/Errors.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include <algorithm>
+#include <unordered_map>
 
 namespace
 {
@@ -44,6 +46,81 @@ namespace
     // Define the maximum supported leaf triangle count and offsets.
     const uint32_t kMaxLeafTriangleCount = 1 << PackedNode::kTriangleCountBits;
     const uint32_t kMaxLeafTriangleOffset = 1 << PackedNode::kTriangleOffsetBits;
+    const uint32_t kMaxNodeIndex = 1u << 31; // The MSB of the first dword marks leaf nodes.
+
+    // Bitmask of triangles that are not included in the BVH.
+    const uint64_t kInvalidBitmask = std::numeric_limits<uint64_t>::max();
+
+    // Subtrees with at least this many triangles are built concurrently.
+    const uint32_t kParallelBuildMinTriangleCount = 16384;
+
+    // Triangle ranges are reduced (node bounds, split bin bounds/counts, cone angles) in chunks of this many triangles.
+    const uint32_t kReduceChunkSize = 8192;
+
+    /** Reduces a range of triangles by splitting it into fixed-size chunks that are processed in parallel.
+        The chunk results are merged in order, but the per-triangle values are not accumulated in sequence.
+        This must therefore only be used for exact reductions whose result does not depend on the evaluation order
+        (bounds, counts, min/max), so that the result is identical to a serial build. Floating-point sums such as
+        flux and cone directions must be accumulated serially in triangle order.
+        \param[in] parallel Process the chunks in parallel. Otherwise, the whole range is reduced serially.
+        \param[in] begin First triangle.
+        \param[in] end One past the last triangle.
+        \param[in] init Initial value of each chunk result.
+        \param[in] chunkFunc Function accumulating the triangles in [begin, end) into a chunk result.
+        \param[in] mergeFunc Function merging the second chunk result into the first.
+        \return The merged result.
+    */
+    template<typename T, typename ChunkFunc, typename MergeFunc>
+    T reduceChunked(bool parallel, uint32_t begin, uint32_t end, const T& init, const ChunkFunc& chunkFunc, const MergeFunc& mergeFunc)
+    {
+        const uint32_t chunkCount = (end - begin + kReduceChunkSize - 1) / kReduceChunkSize;
+        if (!parallel || chunkCount <= 1)
+        {
+            T result = init;
+            chunkFunc(begin, end, result);
+            return result;
+        }
+
+        std::vector<T> chunkResults(chunkCount, init);
+        Threading::parallelFor(0, chunkCount, [&](size_t chunk)
+        {
+            const uint32_t chunkBegin = begin + (uint32_t)chunk * kReduceChunkSize;
+            chunkFunc(chunkBegin, std::min(chunkBegin + kReduceChunkSize, end), chunkResults[chunk]);
+        }, 1);
+
+        for (uint32_t chunk = 1; chunk < chunkCount; ++chunk) mergeFunc(chunkResults[0], chunkResults[chunk]);
+        return std::move(chunkResults[0]);
+    }
+
+    /** Offsets the right child index (internal nodes) or triangle offset (leaf nodes) of a node
+        that was built as part of a separate subtree. Only the index bits are modified,
+        so the packed node attributes are preserved exactly.
+        Throws if the rebased index does not fit into the index bits of the node.
+    */
+    void rebaseNode(PackedNode& node, uint32_t nodeOffset, uint32_t triangleOffset)
+    {
+        if (node.isLeaf())
+        {
+            const uint64_t offset = (uint64_t)(node.data[0].x & (kMaxLeafTriangleOffset - 1)) + triangleOffset;
+            if (offset >= kMaxLeafTriangleOffset) throw RuntimeError("Light BVH triangle offset {} exceeds the maximum supported ({})", offset, kMaxLeafTriangleOffset - 1);
+            node.data[0].x += triangleOffset;
+        }
+        else
+        {
+            const uint64_t index = (uint64_t)node.data[0].x + nodeOffset;
+            if (index >= kMaxNodeIndex) throw RuntimeError("Light BVH node index {} exceeds the maximum supported ({})", index, kMaxNodeIndex - 1);
+            node.data[0].x = (uint32_t)index;
+        }
+    }
+
+    /** Sets the right child index of an internal node without repacking the node attributes.
+    */
+    void setRightChildIndex(PackedNode& node, uint32_t rightChildIdx)
+    {
+        FALCOR_ASSERT(!node.isLeaf());
+        if (rightChildIdx >= kMaxNodeIndex) throw RuntimeError("Light BVH node index {} exceeds the maximum supported ({})", rightChildIdx, kMaxNodeIndex - 1);
+        node.data[0].x = rightChildIdx; // The MSB is 0 for internal nodes, so the index is stored as is.
+    }
 
     inline float safeACos(float v)
     {
@@ -254,18 +331,7 @@ namespace Falcor
         {
             if (!mOptions.usePreintegration || triangles[i].flux > 0.f)
             {
-                LightBVHBuilder::TriangleSortData tri;
-                for (uint32_t j = 0; j < 3; j++)
-                {
-                    tri.bounds |= triangles[i].vtx[j].pos;
-                }
-                tri.center = triangles[i].getCenter();
-                tri.coneDirection = triangles[i].normal;
-                tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
-                tri.flux = triangles[i].flux;
-                tri.triangleIndex = static_cast<uint32_t>(i);
-
-                data.trianglesData.push_back(tri);
+                data.trianglesData.push_back(createTriangleSortData(triangles[i], static_cast<uint32_t>(i)));
             }
         }
 
@@ -290,23 +356,31 @@ namespace Falcor
         data.nodes.reserve(2 * data.trianglesData.size());
         data.triangleIndices.reserve(data.trianglesData.size());
 
-        const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
-        data.triangleBitmasks.resize(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
+        data.triangleBitmasks.resize(triangles.size(), kInvalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
 
         // Build the tree.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
-        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
+        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data, data.nodes, data.triangleIndices);
         FALCOR_ASSERT(!data.nodes.empty());
 
         size_t numValid = 0;
         for (auto mask : data.triangleBitmasks)
-            if (mask != invalidBitmask) numValid++;
+            if (mask != kInvalidBitmask) numValid++;
         FALCOR_ASSERT(numValid == data.trianglesData.size());
 
         // Compute per-node light bounding cones.
         float cosConeAngle;
         computeLightingConesInternal(0, data, cosConeAngle);
 
+        // Keep the data needed for incremental updates.
+        if (mOptions.useIncrementalUpdates)
+        {
+            bvh.mNodeBuildQuality.resize(data.nodes.size());
+            computeQualityInternal(0, data, bvh.mNodeBuildQuality);
+            bvh.mTriangleIndices = data.triangleIndices;
+            bvh.mTriangleBitmasks = data.triangleBitmasks;
+        }
+
         // The BVH is ready, mark it as valid and upload the data.
         bvh.mIsValid = true;
         bvh.mMaxTriangleCountPerLeaf = mOptions.maxTriangleCountPerLeaf;
@@ -316,6 +390,131 @@ namespace Falcor
         bvh.finalize();
     }
 
+    void LightBVHBuilder::update(RenderContext* pRenderContext, LightBVH& bvh)
+    {
+        FALCOR_PROFILE(pRenderContext, "LightBVHBuilder::update()");
+
+        FALCOR_ASSERT(bvh.mpLightCollection);
+        const auto& triangles = bvh.mpLightCollection->getMeshLightTriangles(pRenderContext);
+
+        // Fall back to a full build if there is no data for incremental updates or if the set of lights has changed.
+        bool canUpdate = bvh.isValid() && mOptions.useIncrementalUpdates && !bvh.mNodeBuildQuality.empty() && bvh.mTriangleBitmasks.size() == triangles.size();
+        for (size_t i = 0; canUpdate && i < triangles.size(); i++)
+        {
+            const bool isIncluded = !mOptions.usePreintegration || triangles[i].flux > 0.f;
+            canUpdate = isIncluded == (bvh.mTriangleBitmasks[i] != kInvalidBitmask);
+        }
+        if (!canUpdate)
+        {
+            build(pRenderContext, bvh);
+            return;
+        }
+
+        // Prepare the triangle data in leaf order, so that the triangles of each subtree form a contiguous range.
+        BuildingData data(bvh.mNodes);
+        data.triangleIndices = bvh.mTriangleIndices;
+        data.triangleBitmasks = bvh.mTriangleBitmasks;
+        data.trianglesData.resize(data.triangleIndices.size());
+        Threading::parallelFor(0, data.trianglesData.size(), [&](size_t i)
+        {
+            const uint32_t triangleIndex = data.triangleIndices[i];
+            data.trianglesData[i] = createTriangleSortData(triangles[triangleIndex], triangleIndex);
+        });
+
+        // Refit all nodes to the current light data and evaluate the quality of all subtrees.
+        std::vector<Range> triangleRanges(data.nodes.size(), Range(0, 0));
+        AABB bounds;
+        refitInternal(0, data, triangleRanges, bounds);
+        float cosConeAngle;
+        computeLightingConesInternal(0, data, cosConeAngle);
+
+        std::vector<float> quality(data.nodes.size(), 0.f);
+        computeQualityInternal(0, data, quality);
+
+        std::vector<SubtreeLocation> subtrees;
+        findDegradedSubtrees(SubtreeLocation{ 0, 0, 0ull }, data.nodes, quality, bvh.mNodeBuildQuality, subtrees);
+
+        if (!subtrees.empty())
+        {
+            // Rebuild the degraded subtrees. They cover disjoint ranges of triangles, so they can be built concurrently.
+            // The triangle indices of a rebuilt subtree replace the previous ones in the same range.
+            SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
+            std::vector<std::vector<PackedNode>> subtreeNodes(subtrees.size());
+            Threading::parallelFor(0, subtrees.size(), [&](size_t i)
+            {
+                const SubtreeLocation& subtree = subtrees[i];
+                const Range& triangleRange = triangleRanges[subtree.nodeIndex];
+                std::vector<uint32_t> triangleIndices;
+                triangleIndices.reserve(triangleRange.length());
+                buildInternal(mOptions, splitFunc, subtree.bitmask, subtree.depth, triangleRange, data, subtreeNodes[i], triangleIndices);
+                FALCOR_ASSERT(triangleIndices.size() == triangleRange.length());
+                std::copy(triangleIndices.begin(), triangleIndices.end(), data.triangleIndices.begin() + triangleRange.begin);
+            }, 1);
+
+            // Create the new node list by copying the nodes in depth-first order, replacing the degraded subtrees by the rebuilt ones.
+            // The build quality of the rebuilt nodes is evaluated once the new lighting cones are known.
+            std::unordered_map<uint32_t, size_t> subtreeIndices;
+            for (size_t i = 0; i < subtrees.size(); ++i) subtreeIndices[subtrees[i].nodeIndex] = i;
+
+            std::vector<PackedNode> nodes;
+            std::vector<float> buildQuality;
+            std::vector<bool> isRebuilt;
+            nodes.reserve(data.nodes.size());
+            buildQuality.reserve(data.nodes.size());
+            isRebuilt.reserve(data.nodes.size());
+
+            std::function<void(uint32_t)> spliceNodes = [&](uint32_t nodeIndex)
+            {
+                FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+                const uint32_t newNodeIndex = (uint32_t)nodes.size();
+                if (auto it = subtreeIndices.find(nodeIndex); it != subtreeIndices.end())
+                {
+                    for (PackedNode node : subtreeNodes[it->second])
+                    {
+                        rebaseNode(node, newNodeIndex, triangleRanges[nodeIndex].begin);
+                        nodes.push_back(node);
+                        buildQuality.push_back(0.f);
+                        isRebuilt.push_back(true);
+                    }
+                }
+                else
+                {
+                    const PackedNode& node = data.nodes[nodeIndex];
+                    nodes.push_back(node);
+                    buildQuality.push_back(bvh.mNodeBuildQuality[nodeIndex]);
+                    isRebuilt.push_back(false);
+                    if (!node.isLeaf())
+                    {
+                        spliceNodes(nodeIndex + 1);
+                        setRightChildIndex(nodes[newNodeIndex], (uint32_t)nodes.size());
+                        spliceNodes(node.getInternalNode().rightChildIdx);
+                    }
+                }
+            };
+            spliceNodes(0);
+
+            data.nodes = std::move(nodes);
+
+            // Update the lighting cones of the ancestors of the rebuilt subtrees.
+            computeLightingConesInternal(0, data, cosConeAngle);
+
+            quality.assign(data.nodes.size(), 0.f);
+            computeQualityInternal(0, data, quality);
+            for (size_t i = 0; i < data.nodes.size(); ++i)
+            {
+                if (isRebuilt[i]) buildQuality[i] = quality[i];
+            }
+            bvh.mNodeBuildQuality = std::move(buildQuality);
+        }
+
+        bvh.mTriangleIndices = std::move(data.triangleIndices);
+        bvh.mTriangleBitmasks = std::move(data.triangleBitmasks);
+        bvh.uploadCPUBuffers(bvh.mTriangleIndices, bvh.mTriangleBitmasks);
+
+        // Update the metadata if the topology has changed.
+        if (!subtrees.empty()) bvh.finalize();
+    }
+
     bool LightBVHBuilder::renderUI(Gui::Widgets& widget)
     {
         // Render the build options.
@@ -327,6 +526,15 @@ namespace Falcor
         bool optionsChanged = false;
 
         optionsChanged |= widget.checkbox("Allow refitting", options.allowRefitting);
+        if (options.allowRefitting)
+        {
+            optionsChanged |= widget.checkbox("Use incremental updates", options.useIncrementalUpdates);
+            widget.tooltip("Refit the BVH on the CPU and only rebuild the subtrees whose quality has degraded.", true);
+            if (options.useIncrementalUpdates)
+            {
+                optionsChanged |= widget.var("Rebuild quality threshold", options.rebuildQualityThreshold, 1.f, 16.f);
+            }
+        }
         optionsChanged |= widget.var("Max triangle count per leaf", options.maxTriangleCountPerLeaf, 1u, kMaxLeafTriangleCount);
         optionsChanged |= widget.dropdown("Split heuristic", kSplitHeuristicList, (uint32_t&)options.splitHeuristicSelection);
 
@@ -354,25 +562,21 @@ namespace Falcor
             }
         }
 
+        optionsChanged |= widget.checkbox("Use parallel build", options.useParallelBuild);
+        widget.tooltip("Build large subtrees in parallel. The resulting BVH is identical to a serial build.", true);
+
         return optionsChanged;
     }
 
-    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
+    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices)
     {
         FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
 
         // Compute the AABB and total flux of the node.
         float nodeFlux = 0.f;
-        AABB nodeBounds;
-        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
-        {
-            nodeBounds |= data.trianglesData[dataIndex].bounds;
-            nodeFlux += data.trianglesData[dataIndex].flux;
-        }
+        AABB nodeBounds = computeBoundsAndFlux(options, triangleRange, data, nodeFlux);
         FALCOR_ASSERT(nodeBounds.valid());
 
-        data.currentNodeFlux = nodeFlux;
-
         bool trySplitting = triangleRange.length() > (options.createLeavesASAP ? options.maxTriangleCountPerLeaf : 1);
         const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, options) : SplitResult();
 
@@ -386,9 +590,9 @@ namespace Falcor
             std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + splitResult.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
 
             // Allocate internal node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.push_back({});
 
             InternalNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -402,13 +606,41 @@ namespace Falcor
                 throw RuntimeError("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
             }
 
-            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data);
+            const Range leftRange(triangleRange.begin, splitResult.triangleIndex);
+            const Range rightRange(splitResult.triangleIndex, triangleRange.end);
+            uint32_t leftIndex, rightIndex;
+
+            if (options.useParallelBuild && triangleRange.length() >= kParallelBuildMinTriangleCount)
+            {
+                // Build the right subtree concurrently into separate lists. The subtrees operate on disjoint triangle ranges.
+                // Once both are done, the right subtree is appended after the left one, which gives the same layout as a serial build.
+                std::vector<PackedNode> rightNodes;
+                std::vector<uint32_t> rightTriangleIndices;
+                Threading::TaskGroup rightTask;
+                rightTask.run([&]()
+                {
+                    buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, rightNodes, rightTriangleIndices);
+                });
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, nodes, triangleIndices);
+                rightTask.wait();
+
+                FALCOR_ASSERT(nodes.size() + rightNodes.size() < std::numeric_limits<uint32_t>::max());
+                rightIndex = (uint32_t)nodes.size();
+                const uint32_t triangleOffset = (uint32_t)triangleIndices.size();
+                for (PackedNode& rightNode : rightNodes) rebaseNode(rightNode, rightIndex, triangleOffset);
+                nodes.insert(nodes.end(), rightNodes.begin(), rightNodes.end());
+                triangleIndices.insert(triangleIndices.end(), rightTriangleIndices.begin(), rightTriangleIndices.end());
+            }
+            else
+            {
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, nodes, triangleIndices);
+                rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, nodes, triangleIndices);
+            }
 
             FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
             node.rightChildIdx = rightIndex;
 
-            data.nodes[nodeIndex].setInternalNode(node);
+            nodes[nodeIndex].setInternalNode(node);
             return nodeIndex;
         }
         else // No split => create leaf node
@@ -416,9 +648,9 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.length() <= options.maxTriangleCountPerLeaf);
 
             // Allocate leaf node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.push_back({});
 
             LeafNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -428,19 +660,19 @@ namespace Falcor
             node.attribs.cosConeAngle = cosTheta;
 
             node.triangleCount = triangleRange.length();
-            node.triangleOffset = (uint32_t)data.triangleIndices.size();
+            node.triangleOffset = (uint32_t)triangleIndices.size();
             FALCOR_ASSERT(node.triangleCount < kMaxLeafTriangleCount);
             FALCOR_ASSERT(node.triangleOffset < kMaxLeafTriangleOffset);
 
             for (uint32_t triangleIdx = triangleRange.begin, index = 0; triangleIdx < triangleRange.end; ++triangleIdx, ++index)
             {
                 uint32_t globalTriangleIndex = data.trianglesData[triangleIdx].triangleIndex;
-                data.triangleIndices.push_back(globalTriangleIndex);
+                triangleIndices.push_back(globalTriangleIndex);
                 data.triangleBitmasks[globalTriangleIndex] = bitmask;
             }
-            FALCOR_ASSERT(data.triangleIndices.size() == node.triangleOffset + node.triangleCount);
+            FALCOR_ASSERT(triangleIndices.size() == node.triangleOffset + node.triangleCount);
 
-            data.nodes[nodeIndex].setLeafNode(node);
+            nodes[nodeIndex].setLeafNode(node);
             return nodeIndex;
         }
     }
@@ -480,6 +712,22 @@ namespace Falcor
         }
     }
 
+    AABB LightBVHBuilder::computeBoundsAndFlux(const Options& options, const Range& triangleRange, const BuildingData& data, float& flux)
+    {
+        AABB bounds = reduceChunked(options.useParallelBuild, triangleRange.begin, triangleRange.end, AABB(),
+            [&data](uint32_t begin, uint32_t end, AABB& chunkBounds)
+            {
+                for (uint32_t dataIndex = begin; dataIndex < end; ++dataIndex) chunkBounds |= data.trianglesData[dataIndex].bounds;
+            },
+            [](AABB& dst, const AABB& src) { dst |= src; });
+
+        // The flux is summed serially in triangle order so that it is bit-identical to a serial build.
+        flux = 0.f;
+        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex) flux += data.trianglesData[dataIndex].flux;
+
+        return bounds;
+    }
+
     float3 LightBVHBuilder::computeLightingCone(const Range& triangleRange, const BuildingData& data, float& cosTheta)
     {
         float3 coneDirection = float3(0.0f);
@@ -556,32 +804,40 @@ namespace Falcor
         std::vector<Bin> bins(parameters.binCount);
         std::vector<float> costs(parameters.binCount - 1);
 
+        const auto mergeBins = [](std::vector<Bin>& dstBins, const std::vector<Bin>& srcBins)
+        {
+            for (size_t i = 0; i < dstBins.size(); ++i) dstBins[i] |= srcBins[i];
+        };
+
         /** Helper function that computes the best split along the given dimension using the SAH metric.
             The triangles are binned to n bins, storing only the aggregate parameters (triangle count and bounds).
             Then the cost metric is evaluated for each of the n-1 potential splits.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds](uint32_t dimension)
+        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds, &mergeBins](uint32_t dimension)
         {
             // Helper to compute the bin id for a given triangle.
+            const float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
+            FALCOR_ASSERT(bmin < bmax);
+            const float scale = (float)parameters.binCount / (bmax - bmin);
             auto getBinId = [&](const TriangleSortData& td)
             {
-                float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
-                FALCOR_ASSERT(bmin < bmax);
-                float scale = (float)parameters.binCount / (bmax - bmin);
                 float p = td.bounds.center()[dimension];
                 FALCOR_ASSERT(bmin <= p && p <= bmax);
                 return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
             };
 
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            // Large ranges are binned in parallel into per-chunk bins that are merged in order. The bins only hold bounds and counts, so this is exact.
+            bins = reduceChunked(parameters.useParallelBuild, triangleRange.begin, triangleRange.end, std::vector<Bin>(parameters.binCount),
+                [&](uint32_t begin, uint32_t end, std::vector<Bin>& chunkBins)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        const auto& td = data.trianglesData[i];
+                        chunkBins[getBinId(td)] |= td;
+                    }
+                },
+                mergeBins);
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -722,6 +978,27 @@ namespace Falcor
         std::vector<Bin> bins(parameters.binCount);
         std::vector<float> costs(parameters.binCount - 1);
 
+        // Merges per-chunk bin bounds and triangle counts. The flux and cone directions are accumulated separately in triangle order.
+        const auto mergeBins = [](std::vector<Bin>& dstBins, const std::vector<Bin>& srcBins)
+        {
+            for (size_t i = 0; i < dstBins.size(); ++i)
+            {
+                dstBins[i].bounds |= srcBins[i].bounds;
+                dstBins[i].triangleCount += srcBins[i].triangleCount;
+            }
+        };
+
+        // Merges per-chunk bin cone angles. computeCosConeAngle() takes the minimum over all lights unless a cone becomes invalid,
+        // so merging in any order gives the same result as processing all lights in sequence.
+        const auto mergeCosConeAngles = [](std::vector<float>& dstCosConeAngles, const std::vector<float>& srcCosConeAngles)
+        {
+            for (size_t i = 0; i < dstCosConeAngles.size(); ++i)
+            {
+                const float a = dstCosConeAngles[i], b = srcCosConeAngles[i];
+                dstCosConeAngles[i] = (a == kInvalidCosConeAngle || b == kInvalidCosConeAngle) ? kInvalidCosConeAngle : std::min(a, b);
+            }
+        };
+
         /** Helper function that computes the best split along the given dimension using the SAOH metric.
             The triangles are binned to n bins, storing only the aggregate parameters (triangle count, bounds, flux, and cone direction).
             Then the cost metric is evaluated for each of the n-1 potential splits.
@@ -729,45 +1006,69 @@ namespace Falcor
             the bounding cones are approximates based on the bins' bounding cones. This is less expensive,
             but also less precise than computing them directly from the triangles.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds, largestDimension, dimensions](uint32_t dimension)
+        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds, &mergeBins, &mergeCosConeAngles, largestDimension, dimensions](uint32_t dimension)
         {
             // Helper to compute the bin id for a given triangle.
+            const float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
+            const float w = bmax - bmin;
+            FALCOR_ASSERT(w >= 0.f); // The node bounds can be zero if all primitives are axis-aligned and coplanar
+            const float scale = w > FLT_MIN ? (float)parameters.binCount / w : 0.f;
             auto getBinId = [&](const TriangleSortData& td)
             {
-                float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
-                float w = bmax - bmin;
-                FALCOR_ASSERT(w >= 0.f); // The node bounds can be zero if all primitives are axis-aligned and coplanar
-                float scale = w > FLT_MIN ? (float)parameters.binCount / w : 0.f;
                 float p = td.bounds.center()[dimension];
                 FALCOR_ASSERT(bmin <= p && p <= bmax);
                 return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
             };
 
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
             // Fill the bins with all triangles.
+            // Large ranges are binned in parallel into per-chunk bins that are merged in order. Only the bounds and counts are
+            // reduced in chunks. The flux and cone directions are floating-point sums that are accumulated serially in triangle order,
+            // so that the bins are bit-identical to a serial build.
+            std::vector<uint32_t> binIds(triangleRange.length());
+            bins = reduceChunked(parameters.useParallelBuild, triangleRange.begin, triangleRange.end, std::vector<Bin>(parameters.binCount),
+                [&](uint32_t begin, uint32_t end, std::vector<Bin>& chunkBins)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        const auto& td = data.trianglesData[i];
+                        const uint32_t binId = getBinId(td);
+                        binIds[i - triangleRange.begin] = binId;
+                        chunkBins[binId].bounds |= td.bounds;
+                        chunkBins[binId].triangleCount++;
+                    }
+                },
+                mergeBins);
             for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
             {
                 const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
+                Bin& bin = bins[binIds[i - triangleRange.begin]];
+                bin.flux += td.flux;
+                bin.coneDirection += td.coneDirection;
             }
 
             // Compute the lighting cones for each bin.
             // The cone direction is the average direction over all lights in the bin and the cone angle is grown to include all.
             // If the vector is zero length (no lights or if all directions cancelled out), the cone is marked as invalid.
             // TODO: Switch to a more sophisticated algorithm to get narrower cones.
-            for (Bin& bin : bins)
+            std::vector<float> cosConeAngles(bins.size());
+            for (size_t i = 0; i < bins.size(); ++i)
             {
-                bin.cosConeAngle = glm::length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
+                Bin& bin = bins[i];
+                cosConeAngles[i] = glm::length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
                 bin.coneDirection = glm::normalize(bin.coneDirection);
             }
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
-                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
-            }
+            cosConeAngles = reduceChunked(parameters.useParallelBuild, triangleRange.begin, triangleRange.end, cosConeAngles,
+                [&](uint32_t begin, uint32_t end, std::vector<float>& chunkCosConeAngles)
+                {
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        const auto& td = data.trianglesData[i];
+                        const uint32_t binId = binIds[i - triangleRange.begin];
+                        chunkCosConeAngles[binId] = computeCosConeAngle(bins[binId].coneDirection, chunkCosConeAngles[binId], td.coneDirection, td.cosConeAngle);
+                    }
+                },
+                mergeCosConeAngles);
+            for (size_t i = 0; i < bins.size(); ++i) bins[i].cosConeAngle = cosConeAngles[i];
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -866,13 +1167,109 @@ namespace Falcor
             // Evaluate the cost metric for the node. This requires us to first compute the cone angle.
             float cosTheta = kInvalidCosConeAngle;
             computeLightingCone(triangleRange, data, cosTheta);
-            float leafCost = evalSAOH(nodeBounds, data.currentNodeFlux, cosTheta, parameters);
+            float nodeFlux = 0.f;
+            computeBoundsAndFlux(parameters, triangleRange, data, nodeFlux);
+            float leafCost = evalSAOH(nodeBounds, nodeFlux, cosTheta, parameters);
             if (leafCost <= overallBestSplit.first) return SplitResult();
         }
 
         return overallBestSplit.second;
     }
 
+    float LightBVHBuilder::refitInternal(const uint32_t nodeIndex, BuildingData& data, std::vector<Range>& triangleRanges, AABB& bounds)
+    {
+        float flux = 0.f;
+        if (!data.nodes[nodeIndex].isLeaf())
+        {
+            auto node = data.nodes[nodeIndex].getInternalNode();
+
+            uint32_t leftIndex = nodeIndex + 1;
+            uint32_t rightIndex = node.rightChildIdx;
+
+            AABB rightBounds;
+            flux = refitInternal(leftIndex, data, triangleRanges, bounds);
+            flux += refitInternal(rightIndex, data, triangleRanges, rightBounds);
+            bounds |= rightBounds;
+
+            FALCOR_ASSERT(triangleRanges[leftIndex].end == triangleRanges[rightIndex].begin);
+            triangleRanges[nodeIndex] = Range(triangleRanges[leftIndex].begin, triangleRanges[rightIndex].end);
+
+            // The lighting cone is updated by computeLightingConesInternal() once all leaf nodes have been refit.
+            node.attribs.setAABB(bounds.minPoint, bounds.maxPoint);
+            node.attribs.flux = flux;
+            data.nodes[nodeIndex].setNodeAttributes(node.attribs);
+        }
+        else
+        {
+            auto node = data.nodes[nodeIndex].getLeafNode();
+
+            const Range triangleRange(node.triangleOffset, node.triangleOffset + node.triangleCount);
+            triangleRanges[nodeIndex] = triangleRange;
+
+            bounds = computeBoundsAndFlux(mOptions, triangleRange, data, flux);
+            FALCOR_ASSERT(bounds.valid());
+
+            node.attribs.setAABB(bounds.minPoint, bounds.maxPoint);
+            node.attribs.flux = flux;
+            float cosTheta;
+            node.attribs.coneDirection = computeLightingCone(triangleRange, data, cosTheta);
+            node.attribs.cosConeAngle = cosTheta;
+            data.nodes[nodeIndex].setNodeAttributes(node.attribs);
+        }
+        return flux;
+    }
+
+    float LightBVHBuilder::computeQualityInternal(const uint32_t nodeIndex, const BuildingData& data, std::vector<float>& quality) const
+    {
+        auto attribs = data.nodes[nodeIndex].getNodeAttributes();
+        float3 aabbMin, aabbMax;
+        attribs.getAABB(aabbMin, aabbMax);
+        const float nodeCost = evalSAOH(AABB(aabbMin, aabbMax), attribs.flux, attribs.cosConeAngle, mOptions);
+
+        float cost = nodeCost;
+        if (!data.nodes[nodeIndex].isLeaf())
+        {
+            cost += computeQualityInternal(nodeIndex + 1, data, quality);
+            cost += computeQualityInternal(data.nodes[nodeIndex].getInternalNode().rightChildIdx, data, quality);
+        }
+
+        quality[nodeIndex] = nodeCost > 0.f ? cost / nodeCost : 0.f;
+        return cost;
+    }
+
+    void LightBVHBuilder::findDegradedSubtrees(const SubtreeLocation& location, const std::vector<PackedNode>& nodes, const std::vector<float>& quality, const std::vector<float>& buildQuality, std::vector<SubtreeLocation>& subtrees) const
+    {
+        // Leaf nodes have no hierarchy to rebuild.
+        const PackedNode& node = nodes[location.nodeIndex];
+        if (node.isLeaf()) return;
+
+        // Rebuild the whole subtree if its quality has degraded too much. Subtrees without a build quality are never rebuilt.
+        const float nodeBuildQuality = buildQuality[location.nodeIndex];
+        if (nodeBuildQuality > 0.f && quality[location.nodeIndex] > nodeBuildQuality * mOptions.rebuildQualityThreshold)
+        {
+            subtrees.push_back(location);
+            return;
+        }
+
+        findDegradedSubtrees(SubtreeLocation{ location.nodeIndex + 1, location.depth + 1, location.bitmask | (0ull << location.depth) }, nodes, quality, buildQuality, subtrees);
+        findDegradedSubtrees(SubtreeLocation{ node.getInternalNode().rightChildIdx, location.depth + 1, location.bitmask | (1ull << location.depth) }, nodes, quality, buildQuality, subtrees);
+    }
+
+    LightBVHBuilder::TriangleSortData LightBVHBuilder::createTriangleSortData(const LightCollection::MeshLightTriangle& triangle, uint32_t triangleIndex)
+    {
+        TriangleSortData tri;
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            tri.bounds |= triangle.vtx[j].pos;
+        }
+        tri.center = triangle.getCenter();
+        tri.coneDirection = triangle.normal;
+        tri.cosConeAngle = 1.f; // Single flat emitter => normal bounding cone angle is zero.
+        tri.flux = triangle.flux;
+        tri.triangleIndex = triangleIndex;
+        return tri;
+    }
+
     LightBVHBuilder::SplitHeuristicFunction LightBVHBuilder::getSplitFunction(SplitHeuristic heuristic)
     {
         switch (heuristic)
@@ -907,8 +1304,11 @@ namespace Falcor
         options.field(useLeafCreationCost);
         options.field(createLeavesASAP);
         options.field(allowRefitting);
+        options.field(useIncrementalUpdates);
+        options.field(rebuildQualityThreshold);
         options.field(usePreintegration);
         options.field(useLightingCones);
+        options.field(useParallelBuild);
 #undef field
     }
 }
@@ -69,8 +69,11 @@ namespace Falcor
             bool           useLeafCreationCost = true;                           ///< Set to true to avoid splitting when the cost is higher than the cost of creating a leaf node. Only used when 'createLeavesASAP' is disabled.
             bool           createLeavesASAP = true;                              ///< Rather than creating a leaf only once splitting stops, create it as soon as we can.
             bool           allowRefitting = true;                                ///< Rather than always rebuilding the BVH from scratch, keep the hierarchy but update the bounds and lighting cones.
+            bool           useIncrementalUpdates = false;                        ///< Refit the BVH on the CPU and rebuild the subtrees whose quality has degraded, rather than refitting on the GPU. Only used when 'allowRefitting' is enabled.
+            float          rebuildQualityThreshold = 1.5f;                       ///< A subtree is rebuilt when its SAOH cost relative to its root has grown by more than this factor since it was built. Only used when 'useIncrementalUpdates' is enabled.
             bool           usePreintegration = true;                             ///< Use pre-integration for culling out emissive triangles and use their flux when computing the splits. Only valid when using the BinnedSAOH split heuristic.
             bool           useLightingCones = true;                              ///< Use lighting cones when computing the splits. Only valid when using the BinnedSAOH split heuristic.
+            bool           useParallelBuild = true;                              ///< Build large subtrees and reduce large triangle ranges in parallel. The resulting BVH is identical to a serial build.
         };
 
         /** Constructor.
@@ -83,6 +86,16 @@ namespace Falcor
         */
         void build(RenderContext* pRenderContext, LightBVH& bvh);
 
+        /** Incrementally update the BVH to the current light geometry.
+            All nodes are refit on the CPU, then the subtrees whose quality has degraded past
+            'rebuildQualityThreshold' are rebuilt and spliced back into the node list.
+            The quality of a subtree is the sum of the SAOH costs of its nodes divided by the cost of its root,
+            which is invariant to uniform scaling and translation of the subtree's lights.
+            Falls back to a full build if the BVH was not built with 'useIncrementalUpdates' or if the set of lights has changed.
+            \param[in,out] bvh The light BVH to update.
+        */
+        void update(RenderContext* pRenderContext, LightBVH& bvh);
+
         bool renderUI(Gui::Widgets& widget);
 
         const Options& getOptions() const { return mOptions; }
@@ -120,13 +133,19 @@ namespace Falcor
             uint32_t triangleIndex = MeshLightData::kInvalidIndex; ///< Index into global triangle list.
         };
 
+        struct SubtreeLocation
+        {
+            uint32_t nodeIndex;                             ///< Index of the subtree's root node.
+            uint32_t depth;                                 ///< Depth of the subtree's root node.
+            uint64_t bitmask;                               ///< Bit pattern retracing the tree traversal to reach the root node.
+        };
+
         struct BuildingData
         {
             std::vector<PackedNode>& nodes;                 ///< BVH nodes generated by the builder.
             std::vector<TriangleSortData> trianglesData;    ///< Compact list of triangles to include in build.
             std::vector<uint32_t> triangleIndices;          ///< Triangle indices sorted by leaf node. Each leaf node refers to a contiguous array of triangle indices.
             std::vector<uint64_t> triangleBitmasks;         ///< Array containing the per triangle bit pattern retracing the tree traversal to reach the triangle: 0=left child, 1=right child; this array gets filled in during the build process. Indexed by global triangle index.
-            float currentNodeFlux = 0.f;                    ///< Used by computeSAOHSplit() as the leaf creation cost.
 
             BuildingData(std::vector<PackedNode>& bvhNodes) : nodes(bvhNodes) {}
         };
@@ -144,14 +163,45 @@ namespace Falcor
         bool renderOptions(Gui::Widgets& widget, Options& options) const;
 
         /** Recursive BVH build.
+            Large subtrees are built concurrently into separate node and triangle index lists, which are then spliced
+            into the parent's lists in depth-first order. The result is identical to a serial build.
             \param[in] splitHeuristic The splitting heuristic to be used.
             \param[in] bitmask Bit pattern retracing the tree traversal to reach the node to be built: 0=left child, 1=right child.
             \param[in] depth Depth of the node to be built
             \param[in] triangleRange Range of triangles to process.
             \param[in,out] data Prepared light data.
-            \return Index of the allocated node.
+            \param[in,out] nodes Node list to append the generated nodes to.
+            \param[in,out] triangleIndices Triangle index list to append the leaf nodes' triangle indices to.
+            \return Index of the allocated node in 'nodes'.
+        */
+        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, std::vector<PackedNode>& nodes, std::vector<uint32_t>& triangleIndices);
+
+        /** Recursive CPU refit of the node bounds, flux and leaf lighting cones to the current light data.
+            The lighting cones of internal nodes are not updated, see computeLightingConesInternal().
+            \param[in] nodeIndex Index of the current node.
+            \param[in,out] data Prepared light data, with the triangles stored in leaf order. The nodes are updated.
+            \param[out] triangleRanges Range of triangles of each node, indexed by node index.
+            \param[out] bounds Bounds of the current node.
+            \return Total flux of the current node.
+        */
+        float refitInternal(const uint32_t nodeIndex, BuildingData& data, std::vector<Range>& triangleRanges, AABB& bounds);
+
+        /** Recursive computation of the quality of all subtrees (see update()).
+            \param[in] nodeIndex Index of the current node.
+            \param[in] data Prepared light data.
+            \param[out] quality Quality of each subtree, indexed by root node index. Zero if the root node has no cost.
+            \return Sum of the SAOH costs of all nodes in the subtree.
         */
-        uint32_t buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data);
+        float computeQualityInternal(const uint32_t nodeIndex, const BuildingData& data, std::vector<float>& quality) const;
+
+        /** Recursive search for the topmost subtrees whose quality has degraded past the rebuild threshold.
+            \param[in] location Location of the current node.
+            \param[in] nodes BVH nodes.
+            \param[in] quality Current quality of each subtree.
+            \param[in] buildQuality Quality of each subtree when it was built.
+            \param[out] subtrees Subtrees to rebuild, in depth-first order.
+        */
+        void findDegradedSubtrees(const SubtreeLocation& location, const std::vector<PackedNode>& nodes, const std::vector<float>& quality, const std::vector<float>& buildQuality, std::vector<SubtreeLocation>& subtrees) const;
 
         /** Recursive computation of lighting cones for all internal nodes.
             \param[in] nodeIndex Index of the current node.
@@ -161,6 +211,16 @@ namespace Falcor
         */
         float3 computeLightingConesInternal(const uint32_t nodeIndex, BuildingData& data, float& cosConeAngle);
 
+        /** Compute the bounds and total flux for a range of triangles.
+            The bounds of large ranges are computed in parallel. The flux is summed in triangle order, so the result is identical to a serial computation.
+            \param[in] options The options to use.
+            \param[in] triangleRange Range of triangles to process.
+            \param[in] data Prepared light data.
+            \param[out] flux Total flux of the triangles.
+            \return Bounds of the triangles.
+        */
+        static AABB computeBoundsAndFlux(const Options& options, const Range& triangleRange, const BuildingData& data, float& flux);
+
         /** Compute lighting cone for a range of triangles.
             \param[in] triangleRange Range of triangles to process.
             \param[in] data Prepared light data.
@@ -176,6 +236,8 @@ namespace Falcor
 
         static SplitHeuristicFunction getSplitFunction(SplitHeuristic heuristic);
 
+        static TriangleSortData createTriangleSortData(const LightCollection::MeshLightTriangle& triangle, uint32_t triangleIndex);
+
         // Configuration
         Options mOptions;
     };
@@ -75,7 +75,8 @@ namespace Falcor
         }
         else if (needsRefit)
         {
-            mpBVH->refit(pRenderContext);
+            if (mOptions.buildOptions.useIncrementalUpdates) mpBVHBuilder->update(pRenderContext, *mpBVH);
+            else mpBVH->refit(pRenderContext);
             samplerChanged = true;
         }
 
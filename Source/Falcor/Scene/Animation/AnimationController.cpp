@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "AnimationController.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 #include "Scene/Scene.h"
 #include <fstream>
@@ -39,6 +40,8 @@ namespace Falcor
         const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
         const std::string kPrevWorldMatrices = "prevWorldMatrices";
         const std::string kPrevInverseTransposeWorldMatrices = "prevInverseTransposeWorldMatrices";
+
+        const size_t kWorldMatricesGrainSize = 256; ///< Number of nodes per task when updating world matrices.
     }
 
     AnimationController::AnimationController(std::shared_ptr<Device> pDevice, Scene* pScene, const StaticVertexVector& staticVertexData, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<Animation::SharedPtr>& animations)
@@ -85,6 +88,8 @@ namespace Falcor
 
         createSkinningPass(staticVertexData, skinningVertexData);
 
+        initSceneGraphLevels();
+
         // Determine length of global animation loop.
         for (const auto& pAnimation : mAnimations)
         {
@@ -187,6 +192,42 @@ namespace Falcor
         }
     }
 
+    void AnimationController::initSceneGraphLevels()
+    {
+        const auto& sceneGraph = mpScene->mSceneGraph;
+        const uint32_t nodeCount = (uint32_t)sceneGraph.size();
+
+        // Compute the depth of each node. Parents are stored before their children.
+        mNodeLevels.resize(nodeCount);
+        uint32_t levelCount = 0;
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            NodeID parent = sceneGraph[i].parent;
+            FALCOR_ASSERT(parent == NodeID::Invalid() || parent.get() < i);
+            mNodeLevels[i] = parent != NodeID::Invalid() ? mNodeLevels[parent.get()] + 1 : 0;
+            levelCount = std::max(levelCount, mNodeLevels[i] + 1);
+        }
+
+        // Store the children of each node in a flat list.
+        mChildOffsets.assign(nodeCount + 1, 0);
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            if (sceneGraph[i].parent != NodeID::Invalid()) mChildOffsets[sceneGraph[i].parent.get() + 1]++;
+        }
+        for (uint32_t i = 0; i < nodeCount; i++) mChildOffsets[i + 1] += mChildOffsets[i];
+
+        mChildNodes.resize(mChildOffsets[nodeCount]);
+        std::vector<uint32_t> childCounts(nodeCount, 0);
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            if (sceneGraph[i].parent == NodeID::Invalid()) continue;
+            uint32_t parent = sceneGraph[i].parent.get();
+            mChildNodes[mChildOffsets[parent] + childCounts[parent]++] = i;
+        }
+
+        mUpdateNodes.resize(levelCount);
+    }
+
     void AnimationController::initLocalMatrices()
     {
         for (size_t i = 0; i < mLocalMatrices.size(); i++)
@@ -304,32 +345,54 @@ namespace Falcor
 
     void AnimationController::updateWorldMatrices(bool updateAll)
     {
-        const auto& sceneGraph = mpScene->mSceneGraph;
+        // Collect the nodes to update, grouped by scene graph level.
+        // Without updateAll, these are the changed nodes. Their descendants are added below, level by level.
+        for (auto& nodes : mUpdateNodes) nodes.clear();
+        for (uint32_t i = 0; i < (uint32_t)mGlobalMatrices.size(); i++)
+        {
+            if (updateAll || mMatricesChanged[i]) mUpdateNodes[mNodeLevels[i]].push_back(i);
+        }
 
-        for (size_t i = 0; i < mGlobalMatrices.size(); i++)
+        // Process the levels in order. Nodes on the same level only depend on their parents on the previous level,
+        // so they are updated in parallel.
+        for (size_t level = 0; level < mUpdateNodes.size(); level++)
         {
-            // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != NodeID::Invalid())
+            const auto& nodes = mUpdateNodes[level];
+            Threading::parallelFor(0, nodes.size(), [&](size_t i) { updateWorldMatrix(nodes[i]); }, kWorldMatricesGrainSize);
+
+            // Propagate matrix change flag to children. Only the subtrees of changed nodes are visited.
+            if (level + 1 == mUpdateNodes.size()) break;
+            for (uint32_t nodeIndex : nodes)
             {
-                mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent.get()];
+                if (!mMatricesChanged[nodeIndex]) continue;
+                for (uint32_t j = mChildOffsets[nodeIndex]; j < mChildOffsets[nodeIndex + 1]; j++)
+                {
+                    uint32_t child = mChildNodes[j];
+                    if (mMatricesChanged[child]) continue;
+                    mMatricesChanged[child] = true;
+                    if (!updateAll) mUpdateNodes[level + 1].push_back(child);
+                }
             }
+        }
+    }
 
-            if (!mMatricesChanged[i] && !updateAll) continue;
+    void AnimationController::updateWorldMatrix(uint32_t nodeIndex)
+    {
+        const auto& node = mpScene->mSceneGraph[nodeIndex];
 
-            mGlobalMatrices[i] = mLocalMatrices[i];
+        mGlobalMatrices[nodeIndex] = mLocalMatrices[nodeIndex];
 
-            if (mpScene->mSceneGraph[i].parent != NodeID::Invalid())
-            {
-                mGlobalMatrices[i] = mGlobalMatrices[sceneGraph[i].parent.get()] * mGlobalMatrices[i];
-            }
+        if (node.parent != NodeID::Invalid())
+        {
+            mGlobalMatrices[nodeIndex] = mGlobalMatrices[node.parent.get()] * mGlobalMatrices[nodeIndex];
+        }
 
-            mInvTransposeGlobalMatrices[i] = transpose(inverse(mGlobalMatrices[i]));
+        mInvTransposeGlobalMatrices[nodeIndex] = transpose(inverse(mGlobalMatrices[nodeIndex]));
 
-            if (mpSkinningPass)
-            {
-                mSkinningMatrices[i] = mGlobalMatrices[i] * sceneGraph[i].localToBindSpace;
-                mInvTransposeSkinningMatrices[i] = transpose(inverse(mSkinningMatrices[i]));
-            }
+        if (mpSkinningPass)
+        {
+            mSkinningMatrices[nodeIndex] = mGlobalMatrices[nodeIndex] * node.localToBindSpace;
+            mInvTransposeSkinningMatrices[nodeIndex] = transpose(inverse(mSkinningMatrices[nodeIndex]));
         }
     }
 
@@ -150,9 +150,11 @@ namespace Falcor
         friend class SceneBuilder;
         AnimationController(std::shared_ptr<Device> pDevice, Scene* pScene, const StaticVertexVector& staticVertexData, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<Animation::SharedPtr>& animations);
 
+        void initSceneGraphLevels();
         void initLocalMatrices();
         void updateLocalMatrices(double time);
         void updateWorldMatrices(bool updateAll = false);
+        void updateWorldMatrix(uint32_t nodeIndex);
         void uploadWorldMatrices(bool uploadAll = false);
 
         void bindBuffers();
@@ -170,6 +172,12 @@ namespace Falcor
         std::vector<float4x4> mInvTransposeGlobalMatrices;
         std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
 
+        // Scene graph hierarchy
+        std::vector<uint32_t> mNodeLevels;          ///< Depth of each node in the scene graph (roots are at level 0).
+        std::vector<uint32_t> mChildOffsets;        ///< Offset of the first child of each node in mChildNodes (node count + 1 entries).
+        std::vector<uint32_t> mChildNodes;          ///< Child node indices of all nodes.
+        std::vector<std::vector<uint32_t>> mUpdateNodes; ///< Scratch lists of nodes to update per level.
+
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
         bool mPrevEnabled = false;      ///< True if animations were enabled in previous frame.
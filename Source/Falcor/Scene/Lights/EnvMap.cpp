@@ -132,6 +132,7 @@ namespace Falcor
 
         pybind11::class_<EnvMap, EnvMap::SharedPtr> envMap(m, "EnvMap");
         auto createFromFile = [](const std::filesystem::path &path) {
+            getActivePythonSceneBuilder().addDependency(path);
             return EnvMap::createFromFile(getActivePythonSceneBuilder().getDevice(), path);
         };
         envMap.def(pybind11::init(createFromFile), "path"_a); // PYTHONDEPRECATED
@@ -618,6 +618,38 @@ namespace Falcor
         return true;
     }
 
+    uint64_t BasicMaterial::computeHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+
+        // 32-bit floats compare by value and are hashed with -0 normalized, 16-bit floats compare bitwise.
+#define hash_field(_a) hash.insert(mData._a)
+#define hash_float_field(_a) hashFloats(hash, reinterpret_cast<const float*>(&mData._a), sizeof(mData._a) / sizeof(float))
+        hash_field(flags);
+        hash_float_field(displacementScale);
+        hash_float_field(displacementOffset);
+        hash_field(baseColor);
+        hash_field(specular);
+        hash_float_field(emissive);
+        hash_float_field(emissiveFactor);
+        hash_field(IoR);
+        hash_field(diffuseTransmission);
+        hash_field(specularTransmission);
+        hash_field(transmission);
+        hash_field(volumeAbsorption);
+        hash_field(volumeAnisotropy);
+        hash_field(volumeScattering);
+#undef hash_float_field
+#undef hash_field
+
+        hashSamplerDesc(hash, mpDefaultSampler->getDesc());
+        hashSamplerDesc(hash, mpDisplacementMinSampler->getDesc());
+        hashSamplerDesc(hash, mpDisplacementMaxSampler->getDesc());
+
+        return hash.get();
+    }
+
     void BasicMaterial::updateAlphaMode()
     {
         if (!isAlphaSupported())
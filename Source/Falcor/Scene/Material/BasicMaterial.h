@@ -67,6 +67,11 @@ namespace Falcor
         */
         bool isEqual(const Material::SharedPtr& pOther) const override;
 
+        /** Compute a hash of the material properties.
+            \return Hash of all material properties *except* the name.
+        */
+        uint64_t computeHash() const override;
+
         /** Set the alpha mode.
         */
         void setAlphaMode(AlphaMode alphaMode) override;
@@ -150,6 +150,15 @@ namespace Falcor
         return true;
     }
 
+    uint64_t MERLMaterial::computeHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        auto path = mPath.string();
+        hash.insert(path.data(), path.size());
+        return hash.get();
+    }
+
     Program::ShaderModuleList MERLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
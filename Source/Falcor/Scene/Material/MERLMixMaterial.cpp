@@ -240,6 +240,24 @@ namespace Falcor
         return true;
     }
 
+    uint64_t MERLMixMaterial::computeHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+
+        hash.insert((uint64_t)mBRDFs.size());
+        for (const auto& brdf : mBRDFs)
+        {
+            auto path = brdf.path.string();
+            hash.insert(brdf.name.data(), brdf.name.size());
+            hash.insert(path.data(), path.size());
+        }
+
+        hashSamplerDesc(hash, mpDefaultSampler->getDesc());
+
+        return hash.get();
+    }
+
     Program::ShaderModuleList MERLMixMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
@@ -32,6 +32,7 @@
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Rendering/Materials/LobeType.slang"
+#include "Scene/SceneBuilderAccess.h"
 
 namespace Falcor
 {
@@ -306,6 +307,80 @@ namespace Falcor
         return true;
     }
 
+    uint64_t Material::computeHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        return hash.get();
+    }
+
+    void Material::hashBase(FNVHash64& hash) const
+    {
+        // Hashes the same data that is compared in isBaseEqual().
+        hash.insert(mHeader.packedData);
+        const glm::quat& rotation = mTextureTransform.getRotation();
+        const float rotationValues[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+        hashFloats(hash, &mTextureTransform.getTranslation().x, 3);
+        hashFloats(hash, &mTextureTransform.getScaling().x, 3);
+        hashFloats(hash, rotationValues, 4);
+
+        FALCOR_ASSERT(mTextureSlotInfo.size() == mTextureSlotData.size());
+        for (size_t i = 0; i < mTextureSlotInfo.size(); i++)
+        {
+            auto slot = (TextureSlot)i;
+            if (!hasTextureSlot(slot)) continue;
+
+            const auto& info = mTextureSlotInfo[i];
+            hash.insert((uint32_t)i);
+            hash.insert(info.name.data(), info.name.size());
+            hash.insert(info.mask);
+            hash.insert(info.srgb);
+            // Textures are compared by identity, but hashed by source and format so the hash doesn't depend on
+            // the texture's address. Different textures loaded from the same file share a hash but don't compare equal.
+            const auto& pTexture = mTextureSlotData[i].pTexture;
+            hash.insert(pTexture != nullptr);
+            if (pTexture)
+            {
+                const std::string path = pTexture->getSourcePath().string();
+                hash.insert(path.data(), path.size());
+                hash.insert(pTexture->getFormat());
+                hash.insert(pTexture->getWidth());
+                hash.insert(pTexture->getHeight());
+                hash.insert(pTexture->getDepth());
+                hash.insert(pTexture->getMipCount());
+                hash.insert(pTexture->getArraySize());
+            }
+        }
+    }
+
+    void Material::hashFloats(FNVHash64& hash, const float* pValues, size_t count)
+    {
+        // Hash -0 as +0 so that values that compare equal hash equally.
+        for (size_t i = 0; i < count; i++)
+        {
+            const float value = pValues[i] == 0.f ? 0.f : pValues[i];
+            hash.insert(value);
+        }
+    }
+
+    void Material::hashSamplerDesc(FNVHash64& hash, const Sampler::Desc& desc)
+    {
+        // Hash field by field as the desc may contain padding.
+        hash.insert(desc.magFilter);
+        hash.insert(desc.minFilter);
+        hash.insert(desc.mipFilter);
+        hash.insert(desc.maxAnisotropy);
+        hashFloats(hash, &desc.maxLod, 1);
+        hashFloats(hash, &desc.minLod, 1);
+        hashFloats(hash, &desc.lodBias, 1);
+        hash.insert(desc.comparisonMode);
+        hash.insert(desc.reductionMode);
+        hash.insert(desc.addressModeU);
+        hash.insert(desc.addressModeV);
+        hash.insert(desc.addressModeW);
+        hashFloats(hash, &desc.borderColor.x, 4);
+    }
+
     NormalMapType Material::detectNormalMapType(const Texture::SharedPtr& pNormalMap)
     {
         NormalMapType type = NormalMapType::None;
@@ -375,7 +450,12 @@ namespace Falcor
 
         material.def("setTexture", &Material::setTexture, "slot"_a, "texture"_a);
         material.def("getTexture", &Material::getTexture, "slot"_a);
-        material.def("loadTexture", &Material::loadTexture, "slot"_a, "path"_a, "useSrgb"_a = true);
+        auto loadTexture = [] (Material* pMaterial, Material::TextureSlot slot, const std::filesystem::path& path, bool useSrgb)
+        {
+            addActivePythonSceneDependency(path);
+            return pMaterial->loadTexture(slot, path, useSrgb);
+        };
+        material.def("loadTexture", loadTexture, "slot"_a, "path"_a, "useSrgb"_a = true);
         material.def("clearTexture", &Material::clearTexture, "slot"_a);
     }
 }
@@ -35,6 +35,7 @@
 #include "Core/API/Texture.h"
 #include "Core/API/Sampler.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/UI/Gui.h"
 #include "Scene/Transform.h"
 #include "MaterialTypeRegistry.h"
@@ -157,6 +158,14 @@ namespace Falcor
         */
         virtual bool isEqual(const Material::SharedPtr& pOther) const = 0;
 
+        /** Compute a hash of the material properties.
+            The hash covers the same properties as isEqual(), so materials that compare equal have identical hashes.
+            Derived classes that compare additional properties in isEqual() should override this to include them.
+            Textures are hashed by source path and format, so the hash is stable across runs.
+            \return Hash of all material properties *except* the name.
+        */
+        virtual uint64_t computeHash() const;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -328,6 +337,9 @@ namespace Falcor
         void updateTextureHandle(MaterialSystem* pOwner, const TextureSlot slot, TextureHandle& handle);
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const Sampler::SharedPtr& pSampler);
         bool isBaseEqual(const Material& other) const;
+        void hashBase(FNVHash64& hash) const;
+        static void hashSamplerDesc(FNVHash64& hash, const Sampler::Desc& desc);
+        static void hashFloats(FNVHash64& hash, const float* pValues, size_t count);
 
         static NormalMapType detectNormalMapType(const Texture::SharedPtr& pNormalMap);
 
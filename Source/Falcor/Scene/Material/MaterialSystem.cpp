@@ -30,8 +30,10 @@
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Threading.h"
 #include "MaterialTypeRegistry.h"
 #include <numeric>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -290,20 +292,29 @@ namespace Falcor
         std::vector<Material::SharedPtr> uniqueMaterials;
         idMap.resize(mMaterials.size());
 
+        // Compute material hashes in parallel.
+        std::vector<uint64_t> hashes(mMaterials.size());
+        Threading::parallelFor(0, mMaterials.size(), [&](size_t i) { hashes[i] = mMaterials[i]->computeHash(); });
+
         // Find unique set of materials.
+        // Materials are bucketed by hash, so full comparisons are only needed within a bucket.
+        std::unordered_map<uint64_t, std::vector<MaterialID>> buckets;
+        buckets.reserve(mMaterials.size());
         for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            auto& bucket = buckets[hashes[id.get()]];
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](MaterialID uniqueID) { return uniqueMaterials[uniqueID.get()]->isEqual(pMaterial); });
+            if (it == bucket.end())
             {
                 idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
+                bucket.push_back(idMap[id.get()]);
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[it->get()]->getName());
+                idMap[id.get()] = *it;
             }
         }
 
@@ -138,6 +138,15 @@ namespace Falcor
         return true;
     }
 
+    uint64_t RGLMaterial::computeHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        auto path = mFilePath.string();
+        hash.insert(path.data(), path.size());
+        return hash.get();
+    }
+
     Program::ShaderModuleList RGLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
@@ -0,0 +1,714 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PLYReader.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Threading.h"
+#include <fast_float/fast_float.h>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        /// Number of records per chunk when converting binary elements on multiple threads.
+        const size_t kRecordsPerChunk = 1 << 16;
+
+        enum class Format
+        {
+            Ascii,
+            BinaryLittleEndian,
+            BinaryBigEndian,
+        };
+
+        enum class Type
+        {
+            Int8,
+            UInt8,
+            Int16,
+            UInt16,
+            Int32,
+            UInt32,
+            Float32,
+            Float64,
+        };
+
+        size_t getTypeSize(Type type)
+        {
+            switch (type)
+            {
+            case Type::Int8: case Type::UInt8: return 1;
+            case Type::Int16: case Type::UInt16: return 2;
+            case Type::Int32: case Type::UInt32: case Type::Float32: return 4;
+            case Type::Float64: return 8;
+            }
+            FALCOR_UNREACHABLE();
+            return 0;
+        }
+
+        std::optional<Type> parseType(std::string_view str)
+        {
+            if (str == "char" || str == "int8") return Type::Int8;
+            if (str == "uchar" || str == "uint8") return Type::UInt8;
+            if (str == "short" || str == "int16") return Type::Int16;
+            if (str == "ushort" || str == "uint16") return Type::UInt16;
+            if (str == "int" || str == "int32") return Type::Int32;
+            if (str == "uint" || str == "uint32") return Type::UInt32;
+            if (str == "float" || str == "float32") return Type::Float32;
+            if (str == "double" || str == "float64") return Type::Float64;
+            return {};
+        }
+
+        struct Property
+        {
+            std::string name;
+            Type type;
+            bool isList = false;
+            Type countType = Type::UInt8;
+        };
+
+        struct Element
+        {
+            std::string name;
+            size_t count = 0;
+            std::vector<Property> properties;
+
+            bool hasLists() const { return std::any_of(properties.begin(), properties.end(), [](const Property& p) { return p.isList; }); }
+
+            int findProperty(std::initializer_list<std::string_view> names) const
+            {
+                for (auto candidate : names)
+                {
+                    for (size_t i = 0; i < properties.size(); ++i)
+                    {
+                        if (properties[i].name == candidate) return (int)i;
+                    }
+                }
+                return -1;
+            }
+        };
+
+        struct Header
+        {
+            Format format = Format::Ascii;
+            std::vector<Element> elements;
+            size_t dataOffset = 0;
+        };
+
+        bool isSpace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        std::vector<std::string_view> splitTokens(std::string_view line)
+        {
+            std::vector<std::string_view> tokens;
+            size_t pos = 0;
+            while (pos < line.size())
+            {
+                while (pos < line.size() && isSpace(line[pos])) ++pos;
+                size_t start = pos;
+                while (pos < line.size() && !isSpace(line[pos])) ++pos;
+                if (pos > start) tokens.push_back(line.substr(start, pos - start));
+            }
+            return tokens;
+        }
+
+        size_t parseCount(std::string_view str)
+        {
+            size_t value = 0;
+            auto result = std::from_chars(str.data(), str.data() + str.size(), value);
+            if (result.ec != std::errc() || result.ptr != str.data() + str.size())
+            {
+                throw RuntimeError("Invalid element count '{}'.", str);
+            }
+            return value;
+        }
+
+        Header parseHeader(std::string_view data)
+        {
+            Header header;
+
+            size_t pos = 0;
+            auto nextLine = [&]() -> std::optional<std::string_view>
+            {
+                if (pos >= data.size()) return {};
+                size_t end = data.find('\n', pos);
+                if (end == std::string_view::npos) end = data.size();
+                std::string_view line = data.substr(pos, end - pos);
+                pos = std::min(end + 1, data.size());
+                return line;
+            };
+
+            auto magic = nextLine();
+            if (!magic || splitTokens(*magic) != std::vector<std::string_view>{"ply"})
+            {
+                throw RuntimeError("Missing 'ply' magic number.");
+            }
+
+            bool hasFormat = false;
+            while (true)
+            {
+                auto line = nextLine();
+                if (!line) throw RuntimeError("Missing 'end_header'.");
+
+                auto tokens = splitTokens(*line);
+                if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info") continue;
+
+                if (tokens[0] == "end_header")
+                {
+                    break;
+                }
+                else if (tokens[0] == "format")
+                {
+                    if (tokens.size() != 3) throw RuntimeError("Invalid format line.");
+                    if (tokens[1] == "ascii") header.format = Format::Ascii;
+                    else if (tokens[1] == "binary_little_endian") header.format = Format::BinaryLittleEndian;
+                    else if (tokens[1] == "binary_big_endian") header.format = Format::BinaryBigEndian;
+                    else throw RuntimeError("Unknown format '{}'.", tokens[1]);
+                    hasFormat = true;
+                }
+                else if (tokens[0] == "element")
+                {
+                    if (tokens.size() != 3) throw RuntimeError("Invalid element line.");
+                    Element element;
+                    element.name = tokens[1];
+                    element.count = parseCount(tokens[2]);
+                    header.elements.push_back(std::move(element));
+                }
+                else if (tokens[0] == "property")
+                {
+                    if (header.elements.empty()) throw RuntimeError("Property defined before any element.");
+                    Property property;
+                    std::optional<Type> type;
+                    if (tokens.size() == 5 && tokens[1] == "list")
+                    {
+                        auto countType = parseType(tokens[2]);
+                        type = parseType(tokens[3]);
+                        if (!countType || !type) throw RuntimeError("Invalid list property types '{} {}'.", tokens[2], tokens[3]);
+                        if (*countType == Type::Float32 || *countType == Type::Float64) throw RuntimeError("List count type must be an integer type.");
+                        property.isList = true;
+                        property.countType = *countType;
+                        property.name = tokens[4];
+                    }
+                    else if (tokens.size() == 3)
+                    {
+                        type = parseType(tokens[1]);
+                        if (!type) throw RuntimeError("Invalid property type '{}'.", tokens[1]);
+                        property.name = tokens[2];
+                    }
+                    else
+                    {
+                        throw RuntimeError("Invalid property line.");
+                    }
+                    property.type = *type;
+                    header.elements.back().properties.push_back(std::move(property));
+                }
+                else
+                {
+                    throw RuntimeError("Unknown header keyword '{}'.", tokens[0]);
+                }
+            }
+
+            if (!hasFormat) throw RuntimeError("Missing format line.");
+
+            header.dataOffset = pos;
+            return header;
+        }
+
+        template<typename S>
+        S loadScalar(const uint8_t* p, bool swap)
+        {
+            S value;
+            if (swap)
+            {
+                uint8_t bytes[sizeof(S)];
+                std::reverse_copy(p, p + sizeof(S), bytes);
+                std::memcpy(&value, bytes, sizeof(S));
+            }
+            else
+            {
+                std::memcpy(&value, p, sizeof(S));
+            }
+            return value;
+        }
+
+        template<typename T>
+        T loadBinary(const uint8_t* p, Type type, bool swap)
+        {
+            switch (type)
+            {
+            case Type::Int8: return (T)loadScalar<int8_t>(p, swap);
+            case Type::UInt8: return (T)loadScalar<uint8_t>(p, swap);
+            case Type::Int16: return (T)loadScalar<int16_t>(p, swap);
+            case Type::UInt16: return (T)loadScalar<uint16_t>(p, swap);
+            case Type::Int32: return (T)loadScalar<int32_t>(p, swap);
+            case Type::UInt32: return (T)loadScalar<uint32_t>(p, swap);
+            case Type::Float32: return (T)loadScalar<float>(p, swap);
+            case Type::Float64: return (T)loadScalar<double>(p, swap);
+            }
+            FALCOR_UNREACHABLE();
+            return T(0);
+        }
+
+        /** Properties of the vertex element that are converted to triangle mesh vertices.
+            Property indices are -1 if not available.
+        */
+        struct VertexLayout
+        {
+            int position[3];
+            int normal[3];
+            int texCoord[2];
+            bool hasNormals;
+            bool hasTexCoords;
+
+            VertexLayout(const Element& element)
+            {
+                position[0] = element.findProperty({"x"});
+                position[1] = element.findProperty({"y"});
+                position[2] = element.findProperty({"z"});
+                normal[0] = element.findProperty({"nx"});
+                normal[1] = element.findProperty({"ny"});
+                normal[2] = element.findProperty({"nz"});
+                texCoord[0] = element.findProperty({"u", "s", "texture_u", "texture_s"});
+                texCoord[1] = element.findProperty({"v", "t", "texture_v", "texture_t"});
+
+                for (int i : position)
+                {
+                    if (i < 0) throw RuntimeError("Vertex element is missing position properties.");
+                    if (element.properties[i].isList) throw RuntimeError("Vertex positions must not be list properties.");
+                }
+                hasNormals = normal[0] >= 0 && normal[1] >= 0 && normal[2] >= 0;
+                hasTexCoords = texCoord[0] >= 0 && texCoord[1] >= 0;
+                for (int i : normal) hasNormals = hasNormals && !element.properties[i].isList;
+                for (int i : texCoord) hasTexCoords = hasTexCoords && !element.properties[i].isList;
+            }
+
+            /** Convert a vertex record given a function returning the value of a property.
+            */
+            template<typename GetValue>
+            TriangleMesh::Vertex convert(GetValue getValue) const
+            {
+                TriangleMesh::Vertex vertex{};
+                vertex.position = float3(getValue(position[0]), getValue(position[1]), getValue(position[2]));
+                if (hasNormals) vertex.normal = float3(getValue(normal[0]), getValue(normal[1]), getValue(normal[2]));
+                if (hasTexCoords) vertex.texCoord = float2(getValue(texCoord[0]), getValue(texCoord[1]));
+                return vertex;
+            }
+        };
+
+        int findFaceIndicesProperty(const Element& element)
+        {
+            int indicesProperty = element.findProperty({"vertex_indices", "vertex_index"});
+            if (indicesProperty < 0) throw RuntimeError("Face element is missing the 'vertex_indices' property.");
+            if (!element.properties[indicesProperty].isList) throw RuntimeError("Face vertex indices must be a list property.");
+            const Type type = element.properties[indicesProperty].type;
+            if (type == Type::Float32 || type == Type::Float64) throw RuntimeError("Face vertex indices must be integers.");
+            return indicesProperty;
+        }
+
+        /** Append a polygon triangulated as a fan to the index list.
+        */
+        template<typename GetIndex>
+        void appendPolygon(size_t vertexCount, GetIndex getIndex, TriangleMesh::IndexList& indices)
+        {
+            for (size_t i = 1; i + 1 < vertexCount; ++i)
+            {
+                indices.push_back(getIndex(0));
+                indices.push_back(getIndex(i));
+                indices.push_back(getIndex(i + 1));
+            }
+        }
+
+        class BinaryReader
+        {
+        public:
+            BinaryReader(const uint8_t* pData, const uint8_t* pEnd, bool swap) : mpData(pData), mpEnd(pEnd), mSwap(swap) {}
+
+            void readElement(const Element& element, PLYReader::Result& result)
+            {
+                if (element.name == "vertex") readVertices(element, result);
+                else if (element.name == "face") readFaces(element, result);
+                else skipElement(element);
+            }
+
+        private:
+            void checkAvailable(const uint8_t* p, size_t size) const
+            {
+                if (size > size_t(mpEnd - p)) throw RuntimeError("Unexpected end of file.");
+            }
+
+            /** Compute the offsets of the properties in the record at p and return the size of the record.
+            */
+            size_t getRecordLayout(const Element& element, const uint8_t* p, std::vector<size_t>& offsets) const
+            {
+                size_t offset = 0;
+                for (size_t i = 0; i < element.properties.size(); ++i)
+                {
+                    const auto& property = element.properties[i];
+                    offsets[i] = offset;
+                    if (property.isList)
+                    {
+                        size_t countSize = getTypeSize(property.countType);
+                        checkAvailable(p + offset, countSize);
+                        size_t count = loadBinary<size_t>(p + offset, property.countType, mSwap);
+                        offset += countSize;
+                        if (count > size_t(mpEnd - (p + offset)) / getTypeSize(property.type)) throw RuntimeError("Unexpected end of file.");
+                        offset += count * getTypeSize(property.type);
+                    }
+                    else
+                    {
+                        offset += getTypeSize(property.type);
+                    }
+                }
+                checkAvailable(p, offset);
+                return offset;
+            }
+
+            /** Get the record size of an element without list properties.
+            */
+            static size_t getFixedRecordLayout(const Element& element, std::vector<size_t>& offsets)
+            {
+                size_t offset = 0;
+                for (size_t i = 0; i < element.properties.size(); ++i)
+                {
+                    offsets[i] = offset;
+                    offset += getTypeSize(element.properties[i].type);
+                }
+                return offset;
+            }
+
+            void skipElement(const Element& element)
+            {
+                std::vector<size_t> offsets(element.properties.size());
+                if (!element.hasLists())
+                {
+                    size_t recordSize = getFixedRecordLayout(element, offsets);
+                    if (recordSize != 0 && element.count > size_t(mpEnd - mpData) / recordSize) throw RuntimeError("Unexpected end of file.");
+                    mpData += element.count * recordSize;
+                    return;
+                }
+                for (size_t i = 0; i < element.count; ++i) mpData += getRecordLayout(element, mpData, offsets);
+            }
+
+            void readVertices(const Element& element, PLYReader::Result& result)
+            {
+                VertexLayout layout(element);
+                result.hasNormals = layout.hasNormals;
+                result.hasTexCoords = layout.hasTexCoords;
+                result.vertices.resize(element.count);
+
+                std::vector<size_t> offsets(element.properties.size());
+                auto convert = [&](const uint8_t* pRecord, const std::vector<size_t>& recordOffsets)
+                {
+                    return layout.convert([&](int i) { return loadBinary<float>(pRecord + recordOffsets[i], element.properties[i].type, mSwap); });
+                };
+
+                if (!element.hasLists())
+                {
+                    // Fixed-size records are converted in parallel.
+                    size_t recordSize = getFixedRecordLayout(element, offsets);
+                    if (element.count > size_t(mpEnd - mpData) / recordSize) throw RuntimeError("Unexpected end of file.");
+                    const uint8_t* pBase = mpData;
+                    Threading::parallelForRange(0, element.count, [&](size_t begin, size_t end)
+                    {
+                        for (size_t i = begin; i < end; ++i) result.vertices[i] = convert(pBase + i * recordSize, offsets);
+                    }, kRecordsPerChunk);
+                    mpData += element.count * recordSize;
+                }
+                else
+                {
+                    for (size_t i = 0; i < element.count; ++i)
+                    {
+                        size_t recordSize = getRecordLayout(element, mpData, offsets);
+                        result.vertices[i] = convert(mpData, offsets);
+                        mpData += recordSize;
+                    }
+                }
+            }
+
+            void readFaces(const Element& element, PLYReader::Result& result)
+            {
+                const int indicesProperty = findFaceIndicesProperty(element);
+                const Property& property = element.properties[indicesProperty];
+                const size_t indexSize = getTypeSize(property.type);
+
+                if (!readUniformFaces(element, indicesProperty, result))
+                {
+                    std::vector<size_t> offsets(element.properties.size());
+                    for (size_t i = 0; i < element.count; ++i)
+                    {
+                        size_t recordSize = getRecordLayout(element, mpData, offsets);
+                        const uint8_t* pList = mpData + offsets[indicesProperty];
+                        size_t vertexCount = loadBinary<size_t>(pList, property.countType, mSwap);
+                        const uint8_t* pIndices = pList + getTypeSize(property.countType);
+                        appendPolygon(vertexCount, [&](size_t j) { return loadBinary<uint32_t>(pIndices + j * indexSize, property.type, mSwap); }, result.indices);
+                        mpData += recordSize;
+                    }
+                }
+            }
+
+            /** Convert faces in parallel, assuming all faces have the same number of vertices and all other properties are fixed size.
+                This is the common case (e.g. all triangles or all quads).
+                \return Returns false without consuming any data if the faces are not uniform.
+            */
+            bool readUniformFaces(const Element& element, int indicesProperty, PLYReader::Result& result)
+            {
+                if (element.count == 0) return true;
+
+                // Determine the record layout from the first record.
+                for (size_t i = 0; i < element.properties.size(); ++i)
+                {
+                    if (element.properties[i].isList && i != (size_t)indicesProperty) return false;
+                }
+                std::vector<size_t> offsets(element.properties.size());
+                const size_t recordSize = getRecordLayout(element, mpData, offsets);
+                const Property& property = element.properties[indicesProperty];
+                const size_t listOffset = offsets[indicesProperty];
+                const size_t countSize = getTypeSize(property.countType);
+                const size_t indexSize = getTypeSize(property.type);
+                const size_t vertexCount = loadBinary<size_t>(mpData + listOffset, property.countType, mSwap);
+                if (vertexCount < 3) return false;
+                if (element.count > size_t(mpEnd - mpData) / recordSize) return false;
+
+                const size_t indicesPerFace = (vertexCount - 2) * 3;
+                const size_t indexBase = result.indices.size();
+                result.indices.resize(indexBase + element.count * indicesPerFace);
+
+                const uint8_t* pBase = mpData;
+                std::atomic<bool> isUniform{true};
+                Threading::parallelForRange(0, element.count, [&](size_t begin, size_t end)
+                {
+                    uint32_t* pDst = result.indices.data() + indexBase + begin * indicesPerFace;
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const uint8_t* pList = pBase + i * recordSize + listOffset;
+                        if (loadBinary<size_t>(pList, property.countType, mSwap) != vertexCount)
+                        {
+                            isUniform = false;
+                            return;
+                        }
+                        const uint8_t* pIndices = pList + countSize;
+                        const uint32_t first = loadBinary<uint32_t>(pIndices, property.type, mSwap);
+                        for (size_t j = 1; j + 1 < vertexCount; ++j)
+                        {
+                            *pDst++ = first;
+                            *pDst++ = loadBinary<uint32_t>(pIndices + j * indexSize, property.type, mSwap);
+                            *pDst++ = loadBinary<uint32_t>(pIndices + (j + 1) * indexSize, property.type, mSwap);
+                        }
+                    }
+                }, kRecordsPerChunk);
+
+                if (!isUniform)
+                {
+                    result.indices.resize(indexBase);
+                    return false;
+                }
+
+                mpData += element.count * recordSize;
+                return true;
+            }
+
+            const uint8_t* mpData;
+            const uint8_t* mpEnd;
+            bool mSwap;
+        };
+
+        class AsciiReader
+        {
+        public:
+            AsciiReader(const char* pData, const char* pEnd) : mpData(pData), mpEnd(pEnd) {}
+
+            void readElement(const Element& element, PLYReader::Result& result)
+            {
+                if (element.name == "vertex") readVertices(element, result);
+                else if (element.name == "face") readFaces(element, result);
+                else skipElement(element);
+            }
+
+        private:
+            double nextValue()
+            {
+                while (mpData < mpEnd && isSpace(*mpData)) ++mpData;
+                if (mpData == mpEnd) throw RuntimeError("Unexpected end of file.");
+
+                double value;
+                auto result = fast_float::from_chars(mpData, mpEnd, value);
+                if (result.ec != std::errc() || (result.ptr < mpEnd && !isSpace(*result.ptr)))
+                {
+                    const char* pTokenEnd = std::find_if(mpData, mpEnd, isSpace);
+                    throw RuntimeError("Invalid number '{}'.", std::string_view(mpData, pTokenEnd - mpData));
+                }
+                mpData = result.ptr;
+                return value;
+            }
+
+            size_t nextCount()
+            {
+                double value = nextValue();
+                if (value < 0.0 || value > (double)std::numeric_limits<uint32_t>::max() || value != std::floor(value)) throw RuntimeError("Invalid list count '{}'.", value);
+                return (size_t)value;
+            }
+
+            /** Read the values of a record. List properties are skipped.
+            */
+            void readRecord(const Element& element, std::vector<double>& values)
+            {
+                for (size_t i = 0; i < element.properties.size(); ++i)
+                {
+                    if (element.properties[i].isList)
+                    {
+                        size_t count = nextCount();
+                        for (size_t j = 0; j < count; ++j) nextValue();
+                    }
+                    else
+                    {
+                        values[i] = nextValue();
+                    }
+                }
+            }
+
+            void skipElement(const Element& element)
+            {
+                std::vector<double> values(element.properties.size());
+                for (size_t i = 0; i < element.count; ++i) readRecord(element, values);
+            }
+
+            void readVertices(const Element& element, PLYReader::Result& result)
+            {
+                VertexLayout layout(element);
+                result.hasNormals = layout.hasNormals;
+                result.hasTexCoords = layout.hasTexCoords;
+                result.vertices.resize(element.count);
+
+                std::vector<double> values(element.properties.size());
+                for (size_t i = 0; i < element.count; ++i)
+                {
+                    readRecord(element, values);
+                    result.vertices[i] = layout.convert([&](int j) { return (float)values[j]; });
+                }
+            }
+
+            void readFaces(const Element& element, PLYReader::Result& result)
+            {
+                const int indicesProperty = findFaceIndicesProperty(element);
+
+                std::vector<uint32_t> polygon;
+                for (size_t i = 0; i < element.count; ++i)
+                {
+                    for (size_t p = 0; p < element.properties.size(); ++p)
+                    {
+                        if ((int)p == indicesProperty)
+                        {
+                            size_t count = nextCount();
+                            polygon.resize(count);
+                            for (size_t j = 0; j < count; ++j)
+                            {
+                                double index = nextValue();
+                                if (index < 0.0 || index > (double)std::numeric_limits<uint32_t>::max()) throw RuntimeError("Invalid vertex index '{}'.", index);
+                                polygon[j] = (uint32_t)index;
+                            }
+                        }
+                        else if (element.properties[p].isList)
+                        {
+                            size_t count = nextCount();
+                            for (size_t j = 0; j < count; ++j) nextValue();
+                        }
+                        else
+                        {
+                            nextValue();
+                        }
+                    }
+                    appendPolygon(polygon.size(), [&](size_t j) { return polygon[j]; }, result.indices);
+                }
+            }
+
+            const char* mpData;
+            const char* mpEnd;
+        };
+    }
+
+    PLYReader::Result PLYReader::read(const std::filesystem::path& path)
+    {
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen()) throw RuntimeError("Failed to open file.");
+        return readFromMemory(file.getData(), file.getMappedSize());
+    }
+
+    PLYReader::Result PLYReader::readFromMemory(const void* pData, size_t size)
+    {
+        const char* pChars = static_cast<const char*>(pData);
+        Header header = parseHeader(std::string_view(pChars, size));
+
+        const Element* pVertexElement = nullptr;
+        for (const auto& element : header.elements)
+        {
+            if (element.name == "vertex") pVertexElement = &element;
+        }
+        if (!pVertexElement) throw RuntimeError("Missing vertex element.");
+        if (pVertexElement->count > std::numeric_limits<uint32_t>::max()) throw RuntimeError("Too many vertices ({}).", pVertexElement->count);
+
+        Result result;
+        if (header.format == Format::Ascii)
+        {
+            AsciiReader reader(pChars + header.dataOffset, pChars + size);
+            for (const auto& element : header.elements) reader.readElement(element, result);
+        }
+        else
+        {
+            // Assume a little endian host.
+            const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+            BinaryReader reader(pBytes + header.dataOffset, pBytes + size, header.format == Format::BinaryBigEndian);
+            for (const auto& element : header.elements) reader.readElement(element, result);
+        }
+
+        // Validate the vertex indices.
+        const uint32_t vertexCount = (uint32_t)result.vertices.size();
+        std::atomic<bool> isValid{true};
+        Threading::parallelForRange(0, result.indices.size(), [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (result.indices[i] >= vertexCount) isValid = false;
+            }
+        }, kRecordsPerChunk * 16);
+        if (!isValid) throw RuntimeError("Vertex index out of bounds.");
+
+        return result;
+    }
+}
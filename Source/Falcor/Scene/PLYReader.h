@@ -0,0 +1,66 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "TriangleMesh.h"
+#include "Core/Macros.h"
+#include <filesystem>
+
+namespace Falcor
+{
+    /** Reader for meshes stored in the PLY file format.
+        Supports ASCII and binary (little and big endian) files. The file is memory mapped and the vertex and face
+        elements are converted directly into triangle mesh vertex and index lists. Polygons are triangulated as fans.
+        Binary files with fixed-size vertex records and uniform face sizes are converted on multiple threads.
+    */
+    class FALCOR_API PLYReader
+    {
+    public:
+        struct Result
+        {
+            TriangleMesh::VertexList vertices;
+            TriangleMesh::IndexList indices;
+            bool hasNormals = false;    ///< True if the file contains vertex normals.
+            bool hasTexCoords = false;  ///< True if the file contains texture coordinates.
+        };
+
+        /** Read a PLY file.
+            Throws a RuntimeError if the file cannot be read or is malformed.
+            \param[in] path File path.
+            \return Returns the mesh data.
+        */
+        static Result read(const std::filesystem::path& path);
+
+        /** Read PLY data from memory.
+            Throws a RuntimeError if the data is malformed.
+            \param[in] pData Pointer to PLY data.
+            \param[in] size Size of PLY data in bytes.
+            \return Returns the mesh data.
+        */
+        static Result readFromMemory(const void* pData, size_t size);
+    };
+}
@@ -34,6 +34,8 @@
 #include "Utils/Logger.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Timing/CpuEventRecorder.h"
+#include "Utils/Timing/Profiler.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
@@ -192,7 +194,7 @@ namespace Falcor
 
         SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
         {
-            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
+            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache | SceneBuilder::Flags::MappedCache | SceneBuilder::Flags::HashCacheDependencies));
             SHA1 sha1;
             auto pathStr = path.string();
             sha1.update(pathStr.data(), pathStr.size());
@@ -211,6 +213,22 @@ namespace Falcor
         mSceneData.pMaterials = MaterialSystem::create(mpDevice);
     }
 
+    SceneBuilder::~SceneBuilder()
+    {
+        // Pending mesh tasks reference the builder, wait for them to finish.
+        for (auto& pendingMesh : mPendingMeshes)
+        {
+            try
+            {
+                pendingMesh.task.finish();
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to process mesh: {}", e.what());
+            }
+        }
+    }
+
     SceneBuilder::SharedPtr SceneBuilder::create(std::shared_ptr<Device> pDevice, const Settings& settings, Flags flags)
     {
         return SharedPtr(new SceneBuilder(pDevice, settings, flags));
@@ -254,6 +272,7 @@ namespace Falcor
 
     void SceneBuilder::import(const std::filesystem::path& path, const Dictionary& dict)
     {
+        FALCOR_PROFILE_CPU("importScene");
         logInfo("Importing scene: {}", path);
         std::filesystem::path fullPath;
         if (!findFileInDataDirectories(path, fullPath))
@@ -262,6 +281,7 @@ namespace Falcor
         }
 
         mSceneData.path = fullPath;
+        addDependency(fullPath);
         if (auto importer = Importer::create(getExtensionFromPath(fullPath)))
         {
             importer->importScene(fullPath, *this, dict);
@@ -272,10 +292,24 @@ namespace Falcor
         }
     }
 
+    void SceneBuilder::addDependency(const std::filesystem::path& path)
+    {
+        if (path.empty()) return;
+
+        // Files that can't be found are recorded as missing, the cache is invalidated if they appear later.
+        std::filesystem::path fullPath = path;
+        if (!findFileInDataDirectories(path, fullPath)) fullPath = std::filesystem::absolute(path);
+
+        std::lock_guard<std::mutex> lock(mDependencyMutex);
+        mDependencies.insert(fullPath.lexically_normal());
+    }
+
     Scene::SharedPtr SceneBuilder::getScene()
     {
         if (mpScene) return mpScene;
 
+        FALCOR_PROFILE_CPU("buildScene");
+
         // Finish loading textures. This blocks until all textures are loaded and assigned.
         mpMaterialTextureLoader.reset();
 
@@ -296,6 +330,10 @@ namespace Falcor
         // Post-process the scene data.
         TimeReport timeReport;
 
+        // Commit meshes that are still being processed asynchronously.
+        flushPendingMeshes();
+        timeReport.measure("Processing meshes");
+
         // Prepare displacement maps. This either removes them (if requested in build flags)
         // or makes sure that normal maps are removed if displacement is in use.
         prepareDisplacementMaps();
@@ -343,7 +381,8 @@ namespace Falcor
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
+            std::vector<std::filesystem::path> dependencies(mDependencies.begin(), mDependencies.end());
+            SceneCache::writeCache(mSceneData, mSceneCacheKey, dependencies, is_set(mFlags, Flags::MappedCache), is_set(mFlags, Flags::HashCacheDependencies));
             timeReport.measure("Writing cache");
         }
 
@@ -354,6 +393,9 @@ namespace Falcor
         timeReport.measure("Creating resources");
         timeReport.printToLog();
 
+        // Collect the profiler events recorded while loading, as no frames are rendered during import.
+        mpDevice->getProfiler()->drainEvents();
+
         return mpScene;
     }
 
@@ -369,18 +411,36 @@ namespace Falcor
         checkArgument(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
         checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
 
+        // Reserve the mesh ID now and process the mesh on the thread pool.
+        // The caller may modify or reuse the triangle mesh and material after this call, so the task works on a copy
+        // of the mesh data and the texture transform captured here.
+        MeshID meshID = reserveMesh(pMaterial);
+        const rmcv::mat4 textureTransform = pMaterial->getTextureTransform().getMatrix();
+        auto pSnapshot = std::make_shared<const TriangleMesh>(*pTriangleMesh);
+        auto pProcessedMesh = std::make_shared<ProcessedMesh>();
+        auto task = Threading::dispatchTask([this, pSnapshot, pMaterial, textureTransform, pProcessedMesh]()
+        {
+            *pProcessedMesh = processTriangleMesh(*pSnapshot, pMaterial, textureTransform);
+        });
+        mPendingMeshes.push_back({ meshID, std::move(task), std::move(pProcessedMesh) });
+
+        return meshID;
+    }
+
+    SceneBuilder::ProcessedMesh SceneBuilder::processTriangleMesh(const TriangleMesh& triangleMesh, const Material::SharedPtr& pMaterial, const rmcv::mat4& textureTransform) const
+    {
         Mesh mesh;
 
-        const auto& indices = pTriangleMesh->getIndices();
-        const auto& vertices = pTriangleMesh->getVertices();
+        const auto& indices = triangleMesh.getIndices();
+        const auto& vertices = triangleMesh.getVertices();
 
-        mesh.name = pTriangleMesh->getName();
+        mesh.name = triangleMesh.getName();
         mesh.faceCount = (uint32_t)(indices.size() / 3);
         mesh.vertexCount = (uint32_t)vertices.size();
         mesh.indexCount = (uint32_t)indices.size();
         mesh.pIndices = indices.data();
         mesh.topology = Vao::Topology::TriangleList;
-        mesh.isFrontFaceCW = pTriangleMesh->getFrontFaceCW();
+        mesh.isFrontFaceCW = triangleMesh.getFrontFaceCW();
         mesh.pMaterial = pMaterial;
 
         std::vector<float3> positions(vertices.size());
@@ -394,10 +454,16 @@ namespace Falcor
         mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
         mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
 
-        return addMesh(mesh);
+        return processMesh(mesh, textureTransform, nullptr);
+    }
+
+    SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh, MeshAttributeIndices* pAttributeIndices) const
+    {
+        const rmcv::mat4 textureTransform = mesh.pMaterial ? mesh.pMaterial->getTextureTransform().getMatrix() : rmcv::identity<rmcv::mat4>();
+        return processMesh(mesh, textureTransform, pAttributeIndices);
     }
 
-    SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices) const
+    SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, const rmcv::mat4& textureTransform, MeshAttributeIndices* pAttributeIndices) const
     {
         // This function preprocesses a mesh into the final runtime representation.
         // Note the function needs to be thread safe. The following steps are performed:
@@ -457,7 +523,7 @@ namespace Falcor
         std::vector<float2> transformedTexCoords;
         if (mesh.texCrds.pData != nullptr)
         {
-            const rmcv::mat4 xform = mesh.pMaterial->getTextureTransform().getMatrix();
+            const rmcv::mat4& xform = textureTransform;
             if (xform != rmcv::identity<rmcv::mat4>())
             {
                 size_t texCoordCount = mesh.getAttributeCount(mesh.texCrds);
@@ -657,14 +723,32 @@ namespace Falcor
 
     MeshID SceneBuilder::addProcessedMesh(const ProcessedMesh& mesh)
     {
-        const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
+        MeshID meshID = reserveMesh(mesh.pMaterial);
+        setMeshData(mMeshes[meshID.get()], ProcessedMesh(mesh));
+        return meshID;
+    }
 
+    MeshID SceneBuilder::reserveMesh(const Material::SharedPtr& pMaterial)
+    {
         MeshSpec spec;
+        spec.materialId = addMaterial(pMaterial);
 
-        // Add the mesh to the scene.
-        spec.name = mesh.name;
+        mMeshes.push_back(std::move(spec));
+
+        if (mMeshes.size() > std::numeric_limits<uint32_t>::max())
+        {
+            throw RuntimeError("Trying to build a scene that exceeds supported number of meshes");
+        }
+
+        return MeshID(mMeshes.size() - 1);
+    }
+
+    void SceneBuilder::setMeshData(MeshSpec& spec, ProcessedMesh&& mesh) const
+    {
+        const bool isIndexed = !is_set(mFlags, Flags::NonIndexedVertices);
+
+        spec.name = std::move(mesh.name);
         spec.topology = mesh.topology;
-        spec.materialId = addMaterial(mesh.pMaterial);
         spec.isFrontFaceCW = mesh.isFrontFaceCW;
         spec.skeletonNodeID = mesh.skeletonNodeId;
 
@@ -688,15 +772,34 @@ namespace Falcor
             spec.hasSkinningData = true;
             spec.prevVertexCount = spec.skinningVertexCount;
         }
+    }
 
-        mMeshes.push_back(spec);
-
-        if (mMeshes.size() > std::numeric_limits<uint32_t>::max())
+    void SceneBuilder::flushPendingMeshes()
+    {
+        // Wait for all tasks before anything else, as they reference the builder.
+        // The first error that occurred during processing is rethrown once all tasks are done.
+        std::exception_ptr pError;
+        for (auto& pendingMesh : mPendingMeshes)
         {
-            throw RuntimeError("Trying to build a scene that exceeds supported number of meshes");
+            try
+            {
+                pendingMesh.task.finish();
+            }
+            catch (...)
+            {
+                if (!pError) pError = std::current_exception();
+            }
         }
 
-        return MeshID(mMeshes.size() - 1);
+        auto pendingMeshes = std::move(mPendingMeshes);
+        mPendingMeshes.clear();
+        if (pError) std::rethrow_exception(pError);
+
+        // Commit in the order the meshes were added.
+        for (auto& pendingMesh : pendingMeshes)
+        {
+            setMeshData(mMeshes[pendingMesh.meshID.get()], std::move(*pendingMesh.pProcessedMesh));
+        }
     }
 
     void SceneBuilder::setCachedMeshes(std::vector<CachedMesh>&& cachedMeshes)
@@ -848,6 +951,7 @@ namespace Falcor
             mpMaterialTextureLoader.reset(new MaterialTextureLoader(mSceneData.pMaterials->getTextureManager(), !is_set(mFlags, Flags::AssumeLinearSpaceTextures)));
         }
         mpMaterialTextureLoader->loadTexture(pMaterial, slot, path);
+        addDependency(path);
     }
 
     void SceneBuilder::waitForMaterialTextureLoading()
@@ -904,6 +1008,7 @@ namespace Falcor
     void SceneBuilder::loadLightProfile(const std::string& filename, bool normalize)
     {
         mSceneData.pLightProfile = LightProfile::createFromIesProfile(mpDevice, std::filesystem::path(filename), normalize);
+        addDependency(filename);
     }
 
     // Cameras
@@ -2821,6 +2926,11 @@ namespace Falcor
         return *spActivePythonSceneBuilder;
     }
 
+    void addActivePythonSceneDependency(const std::filesystem::path& path)
+    {
+        if (spActivePythonSceneBuilder) spActivePythonSceneBuilder->addDependency(path);
+    }
+
     FALCOR_SCRIPT_BINDING(SceneBuilder)
     {
         using namespace pybind11::literals;
@@ -2856,6 +2966,8 @@ namespace Falcor
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
+        flags.value("MappedCache", SceneBuilder::Flags::MappedCache);
+        flags.value("HashCacheDependencies", SceneBuilder::Flags::HashCacheDependencies);
         ScriptBindings::addEnumBinaryOperators(flags);
 
         pybind11::class_<SceneBuilder, SceneBuilder::SharedPtr> sceneBuilder(m, "SceneBuilder");
@@ -2878,6 +2990,7 @@ namespace Falcor
         sceneBuilder.def("addMaterial", &SceneBuilder::addMaterial, "material"_a);
         sceneBuilder.def("replaceMaterial", &SceneBuilder::replaceMaterial, "material"_a, "replacement"_a);
         sceneBuilder.def("getMaterial", &SceneBuilder::getMaterial, "name"_a);
+        sceneBuilder.def("addDependency", &SceneBuilder::addDependency, "path"_a);
         sceneBuilder.def("loadMaterialTexture", &SceneBuilder::loadMaterialTexture, "material"_a, "slot"_a, "path"_a);
         sceneBuilder.def("waitForMaterialTextureLoading", &SceneBuilder::waitForMaterialTextureLoading);
         sceneBuilder.def("addGridVolume", &SceneBuilder::addGridVolume, "gridVolume"_a, "nodeID"_a = NodeID::kInvalidID);
@@ -42,9 +42,12 @@
 #include "Utils/Math/Matrix.h"
 #include "Utils/Scripting/Dictionary.h"
 #include "Utils/Settings.h"
+#include "Utils/Threading.h"
 
 #include <filesystem>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -78,8 +81,10 @@ namespace Falcor
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
 
+            HashCacheDependencies           = 0x08000000, ///< Store content hashes of all scene files in the scene cache. Files that were touched but not modified then don't invalidate the cache. Only affects writing the cache.
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
+            MappedCache                     = 0x40000000, ///< Store bulk mesh and curve data uncompressed in the scene cache so it is read directly from a memory-mapped file. Only affects writing the cache.
 
             Default = None
         };
@@ -340,6 +345,14 @@ namespace Falcor
         */
         void import(const std::filesystem::path& path, const Dictionary& dict = Dictionary());
 
+        /** Add a file the scene depends on.
+            The scene cache is invalidated when any of the dependencies changes. Scene files passed to import() and files
+            loaded through the scene builder are added automatically. Importers need to add other files they read.
+            This function is thread-safe.
+            \param[in] path File path. Relative paths are resolved using the data search directories.
+        */
+        void addDependency(const std::filesystem::path& path);
+
         /** Get the scene. Make sure to add all the objects before calling this function
             \return nullptr if something went wrong, otherwise a new Scene object
         */
@@ -388,6 +401,10 @@ namespace Falcor
         MeshID addMesh(const Mesh& mesh);
 
         /** Add a triangle mesh.
+            The mesh is processed asynchronously on the global thread pool. The mesh ID is reserved immediately
+            and the processed mesh is committed in the order meshes were added when building the scene.
+            The mesh data and the material's texture transform are copied when the mesh is added, so both can be modified afterwards.
+            Errors during processing are reported by getScene().
             \param The triangle mesh to add.
             \param pMaterial The material to use for the mesh.
             \return The ID of the mesh in the scene.
@@ -634,6 +651,8 @@ namespace Falcor
         */
         void setNodeInterpolationMode(NodeID nodeID, Animation::InterpolationMode interpolationMode, bool enableWarping);
 
+        ~SceneBuilder();
+
     private:
         SceneBuilder(std::shared_ptr<Device> pDevice, const Settings& settings, Flags buildFlags);
 
@@ -740,9 +759,23 @@ namespace Falcor
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
 
+        std::mutex mDependencyMutex;
+        std::set<std::filesystem::path> mDependencies;  ///< Files the scene depends on, recorded in the scene cache.
+
         SceneGraph mSceneGraph;
 
+        /** Mesh that is being processed asynchronously.
+            The mesh ID is reserved when the mesh is added, the mesh data is committed by flushPendingMeshes().
+        */
+        struct PendingMesh
+        {
+            MeshID meshID;
+            Threading::Task task;
+            std::shared_ptr<ProcessedMesh> pProcessedMesh;
+        };
+
         MeshList mMeshes;
+        std::vector<PendingMesh> mPendingMeshes;
         MeshGroupList mMeshGroups; ///< Groups of meshes. Each group represents all the geometries in a BLAS for ray tracing.
 
         CurveList mCurves;
@@ -751,6 +784,11 @@ namespace Falcor
         GpuFence::SharedPtr mpFence;
 
         // Helpers
+        MeshID reserveMesh(const Material::SharedPtr& pMaterial);
+        void setMeshData(MeshSpec& spec, ProcessedMesh&& mesh) const;
+        ProcessedMesh processMesh(const Mesh& mesh, const rmcv::mat4& textureTransform, MeshAttributeIndices* pAttributeIndices) const;
+        ProcessedMesh processTriangleMesh(const TriangleMesh& triangleMesh, const Material::SharedPtr& pMaterial, const rmcv::mat4& textureTransform) const;
+        void flushPendingMeshes();
         bool doesNodeHaveAnimation(NodeID nodeID) const;
         void updateLinkedObjects(NodeID oldNodeID, NodeID newNodeID);
         bool collapseNodes(NodeID parentNodeID, NodeID childNodeID);
@@ -29,6 +29,7 @@
 
 #include "Core/Macros.h"
 #include "SceneBuilder.h"
+#include <filesystem>
 
 namespace Falcor
 {
@@ -43,4 +44,7 @@ namespace Falcor
 FALCOR_API void setActivePythonSceneBuilder(SceneBuilder* pSceneBuilder);
 FALCOR_API SceneBuilder& getActivePythonSceneBuilder();
 
+/// Adds a file dependency to the active scene builder. Does nothing outside of a Python scene building context.
+FALCOR_API void addActivePythonSceneDependency(const std::filesystem::path& path);
+
 } // namespace Falcor
@@ -30,12 +30,16 @@
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/Common.h"
 
-#include <lz4_stream/lz4_stream.h>
+#include <lz4.h>
 
-#include <sstream>
+#include <atomic>
 #include <fstream>
+#include <limits>
 
 namespace Falcor
 {
@@ -44,14 +48,22 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 27;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
         const std::string kDirectory = "NVIDIA/Falcor/SceneCache";
 
+        /** Size of independently compressed blocks.
+            Each section is split into blocks of this size which are (de)compressed in parallel.
+        */
         const size_t kBlockSize = 1 * 1024 * 1024;
 
+        /** Alignment of uncompressed sections in the cache file.
+            Uncompressed sections are read directly from the memory-mapped file.
+        */
+        const size_t kRawSectionAlignment = 4096;
+
         const char* kMagic = "FalcorS$";
         struct Header
         {
@@ -63,18 +75,179 @@ namespace Falcor
                 return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
             }
         };
+
+        /** Sections of the cache file.
+            Sections are serialized independently and can be written and read concurrently.
+        */
+        enum class Section : uint32_t
+        {
+            Scene,          ///< Path, render settings, cameras, lights, scene graph, metadata and custom primitives.
+            Grids,          ///< Grids, grid volumes and the environment map.
+            Materials,      ///< Materials.
+            Animations,     ///< Animations.
+            Meshes,         ///< Mesh descriptors, instances, groups and cached meshes.
+            MeshIndexData,  ///< Mesh index data.
+            MeshVertexData, ///< Mesh static and skinning vertex data.
+            Curves,         ///< Curve descriptors, instances and cached curves.
+            CurveVertexData,///< Curve index and vertex data.
+            Count
+        };
+
+        const uint32_t kSectionCount = (uint32_t)Section::Count;
+
+        /** Returns true if the section holds bulk vertex/index data that can be stored uncompressed.
+        */
+        bool isBulkDataSection(uint32_t section)
+        {
+            switch ((Section)section)
+            {
+            case Section::MeshIndexData:
+            case Section::MeshVertexData:
+            case Section::CurveVertexData:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        enum class SectionEncoding : uint32_t
+        {
+            LZ4Blocks,      ///< Independently compressed LZ4 blocks listed in the block table.
+            Raw,            ///< Uncompressed data at a page-aligned file offset.
+        };
+
+        /** Section table entry. Written after the header, one entry per section.
+        */
+        struct SectionDesc
+        {
+            uint32_t id{};
+            SectionEncoding encoding{};
+            uint32_t blockCount{};      ///< Number of blocks in the block table (LZ4Blocks encoding only).
+            uint32_t padding{};
+            uint64_t size{};            ///< Uncompressed size in bytes.
+            uint64_t offset{};          ///< File offset of the section data (Raw encoding only).
+        };
+
+        /** Block table entry. Written after the section table, one entry per block in section order.
+            Compressed block data follows the block table in the same order.
+        */
+        struct BlockDesc
+        {
+            uint32_t compressedSize{};
+            uint32_t size{};            ///< Uncompressed size in bytes.
+        };
+
+        /** Specifies the current dependency manifest version.
+            This needs to be incremented every time the manifest format changes!
+        */
+        const uint32_t kDependencyVersion = 1;
+
+        const char* kDependencyMagic = "FalcorD$";
+        struct DependencyHeader
+        {
+            uint8_t magic[8]{};
+            uint32_t version{};
+
+            bool isValid() const
+            {
+                return std::memcmp(magic, kDependencyMagic, sizeof(DependencyHeader::magic)) == 0 && version == kDependencyVersion;
+            }
+        };
+
+        const uint64_t kMissingFile = std::numeric_limits<uint64_t>::max();
+
+        /** State of a dependency as recorded in the manifest. Written after the path of each dependency.
+        */
+        struct FileState
+        {
+            uint64_t size = kMissingFile;   ///< File size in bytes (zero for directories) or kMissingFile if the file does not exist.
+            int64_t modifiedTime = 0;       ///< Last write time in file clock ticks.
+            uint64_t contentHash = 0;       ///< Hash of the file contents or zero if not hashed.
+        };
+
+        FileState getFileState(const std::filesystem::path& path)
+        {
+            FileState state;
+            std::error_code ec;
+            auto status = std::filesystem::status(path, ec);
+            if (ec || !std::filesystem::exists(status)) return state;
+            auto size = std::filesystem::is_directory(status) ? 0 : std::filesystem::file_size(path, ec);
+            if (ec) return state;
+            auto time = std::filesystem::last_write_time(path, ec);
+            if (ec) return state;
+            state.size = size;
+            state.modifiedTime = time.time_since_epoch().count();
+            return state;
+        }
+
+        /** Compute a fast non-cryptographic 64-bit hash of a file's contents.
+            The file is memory-mapped and hashed in four interleaved 64-bit lanes.
+            \param[in] path File path.
+            \param[in] size File size in bytes.
+            \return Returns the hash or zero if the file can't be read.
+        */
+        uint64_t hashFileContents(const std::filesystem::path& path, uint64_t size)
+        {
+            const uint64_t kPrime1 = 0x9e3779b185ebca87ull;
+            const uint64_t kPrime2 = 0xc2b2ae3d27d4eb4full;
+            auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+
+            MemoryMappedFile file;
+            const uint8_t* pData = nullptr;
+            if (size > 0)
+            {
+                if (!file.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan) || file.getMappedSize() != size) return 0;
+                pData = static_cast<const uint8_t*>(file.getData());
+            }
+
+            uint64_t lanes[4] = { kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1 };
+            size_t offset = 0;
+            for (; offset + 32 <= size; offset += 32)
+            {
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    uint64_t word;
+                    std::memcpy(&word, pData + offset + i * 8, sizeof(word));
+                    lanes[i] = rotl(lanes[i] + word * kPrime2, 31) * kPrime1;
+                }
+            }
+
+            uint64_t hash = size;
+            for (size_t i = 0; i < 4; ++i) hash = rotl(hash ^ (rotl(lanes[i] * kPrime2, 31) * kPrime1), 27) * kPrime1 + kPrime2;
+            for (; offset < size; ++offset) hash = rotl(hash ^ (pData[offset] * kPrime1), 11) * kPrime2;
+
+            // Final avalanche, zero is reserved for files that were not hashed.
+            hash ^= hash >> 33;
+            hash *= kPrime2;
+            hash ^= hash >> 29;
+            hash *= kPrime1;
+            hash ^= hash >> 32;
+            return hash != 0 ? hash : 1;
+        }
+
+        /** Check if a dependency still matches its recorded state.
+            Files whose modification time changed are compared by content if a content hash was recorded.
+        */
+        bool isFileUnchanged(const std::filesystem::path& path, const FileState& recorded)
+        {
+            FileState current = getFileState(path);
+            if (current.size != recorded.size) return false;
+            if (current.size == kMissingFile || current.modifiedTime == recorded.modifiedTime) return true;
+            return recorded.contentHash != 0 && hashFileContents(path, current.size) == recorded.contentHash;
+        }
     }
 
-    /** Wrapper around std::ostream to ease serialization of basic types.
+    /** Helper to ease serialization of basic types into a memory buffer.
     */
     class SceneCache::OutputStream
     {
     public:
-        OutputStream(std::ostream& stream) : mStream(stream) {}
+        OutputStream(std::vector<uint8_t>& buffer) : mBuffer(buffer) {}
 
         void write(const void* data, size_t len)
         {
-            mStream.write(reinterpret_cast<const char*>(data), len);
+            const uint8_t* pData = reinterpret_cast<const uint8_t*>(data);
+            mBuffer.insert(mBuffer.end(), pData, pData + len);
         }
 
         template<typename T>
@@ -121,19 +294,47 @@ namespace Falcor
         }
 
     private:
-        std::ostream& mStream;
+        std::vector<uint8_t>& mBuffer;
     };
 
-    /** Wrapper around std::istream to ease serialization of basic types.
+    /** Helper to ease deserialization of basic types from a memory buffer.
+        The buffer is either a section in the memory-mapped cache file or a compressed section,
+        which is decompressed into a buffer owned by the stream. This keeps only the sections
+        currently being deserialized in memory.
     */
     class SceneCache::InputStream
     {
     public:
-        InputStream(std::istream& stream) : mStream(stream) {}
+        InputStream(const SectionData& data)
+            : mpData(data.pData)
+            , mSize(data.size)
+        {
+            if (data.blocks.empty()) return;
+
+            mBuffer.resize(data.size);
+            std::vector<size_t> offsets(data.blocks.size());
+            size_t offset = 0;
+            for (size_t i = 0; i < data.blocks.size(); ++i)
+            {
+                offsets[i] = offset;
+                offset += data.blocks[i].size;
+            }
+            if (offset != mBuffer.size()) throw RuntimeError("Invalid block table in scene cache data.");
+
+            Threading::parallelFor(0, data.blocks.size(), [&](size_t i)
+            {
+                const auto& block = data.blocks[i];
+                int size = LZ4_decompress_safe(reinterpret_cast<const char*>(block.pData), reinterpret_cast<char*>(mBuffer.data() + offsets[i]), (int)block.compressedSize, (int)block.size);
+                if (size != (int)block.size) throw RuntimeError("Failed to decompress scene cache block.");
+            }, 1);
+            mpData = mBuffer.data();
+        }
 
         void read(void* data, size_t len)
         {
-            mStream.read(reinterpret_cast<char*>(data), len);
+            if (len > mSize - mOffset) throw RuntimeError("Unexpected end of scene cache data.");
+            std::memcpy(data, mpData + mOffset, len);
+            mOffset += len;
         }
 
         template<typename T>
@@ -189,7 +390,10 @@ namespace Falcor
         }
 
     private:
-        std::istream& mStream;
+        std::vector<uint8_t> mBuffer;
+        const uint8_t* mpData;
+        size_t mSize;
+        size_t mOffset = 0;
     };
 
     bool SceneCache::hasValidCache(const Key& key)
@@ -204,15 +408,72 @@ namespace Falcor
         // Verify header.
         Header header;
         fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        return !fs.eof() && header.isValid();
+        if (fs.eof() || !header.isValid()) return false;
+
+        return hasValidDependencies(key);
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, const std::vector<std::filesystem::path>& dependencies, bool uncompressedBulkData, bool hashDependencies)
     {
         auto cachePath = getCachePath(key);
 
         logInfo("Writing scene cache to '{}'.", cachePath);
 
+        // Remove the old manifest first so a partially written cache is never considered valid.
+        std::error_code ec;
+        std::filesystem::remove(getDependencyPath(key), ec);
+
+        // Serialize sections.
+        SectionBuffers sections(kSectionCount);
+        writeSceneData(sections, sceneData);
+
+        // Split compressed sections into blocks and compress them in parallel.
+        struct Block
+        {
+            const uint8_t* pData;
+            size_t size;
+            std::vector<uint8_t> compressed;
+        };
+
+        std::vector<SectionDesc> sectionDescs(kSectionCount);
+        std::vector<Block> blocks;
+        for (uint32_t i = 0; i < kSectionCount; ++i)
+        {
+            const auto& section = sections[i];
+            sectionDescs[i].id = i;
+            sectionDescs[i].size = section.size();
+            sectionDescs[i].encoding = uncompressedBulkData && isBulkDataSection(i) ? SectionEncoding::Raw : SectionEncoding::LZ4Blocks;
+            if (sectionDescs[i].encoding != SectionEncoding::LZ4Blocks) continue;
+            for (size_t offset = 0; offset < section.size(); offset += kBlockSize)
+            {
+                blocks.push_back({ section.data() + offset, std::min(kBlockSize, section.size() - offset), {} });
+                sectionDescs[i].blockCount++;
+            }
+        }
+
+        Threading::parallelFor(0, blocks.size(), [&blocks](size_t i)
+        {
+            auto& block = blocks[i];
+            block.compressed.resize(LZ4_compressBound((int)block.size));
+            int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(block.pData), reinterpret_cast<char*>(block.compressed.data()), (int)block.size, (int)block.compressed.size());
+            if (compressedSize <= 0) throw RuntimeError("Failed to compress scene cache block.");
+            block.compressed.resize(compressedSize);
+        }, 1);
+
+        std::vector<BlockDesc> blockDescs(blocks.size());
+        for (size_t i = 0; i < blocks.size(); ++i) blockDescs[i] = { (uint32_t)blocks[i].compressed.size(), (uint32_t)blocks[i].size };
+
+        // Uncompressed sections are placed at aligned offsets after the compressed blocks.
+        uint64_t fileOffset = sizeof(Header) + sizeof(kSectionCount) + sectionDescs.size() * sizeof(SectionDesc) + blockDescs.size() * sizeof(BlockDesc);
+        for (const auto& block : blocks) fileOffset += block.compressed.size();
+        for (auto& desc : sectionDescs)
+        {
+            if (desc.encoding != SectionEncoding::Raw) continue;
+            fileOffset = align_to((uint64_t)kRawSectionAlignment, fileOffset);
+            desc.offset = fileOffset;
+            fileOffset += desc.size;
+        }
+
         // Create directories if not existing.
         std::filesystem::create_directories(cachePath.parent_path());
 
@@ -220,17 +481,33 @@ namespace Falcor
         std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
         if (fs.bad()) throw RuntimeError("Failed to create scene cache file '{}'.", cachePath);
 
-        // Write header (uncompressed).
+        // Write header.
         Header header;
         std::memcpy(header.magic, kMagic, sizeof(Header::magic));
         header.version = kVersion;
         fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
+        // Write section and block tables.
+        fs.write(reinterpret_cast<const char*>(&kSectionCount), sizeof(kSectionCount));
+        fs.write(reinterpret_cast<const char*>(sectionDescs.data()), sectionDescs.size() * sizeof(SectionDesc));
+        fs.write(reinterpret_cast<const char*>(blockDescs.data()), blockDescs.size() * sizeof(BlockDesc));
+
+        // Write compressed blocks.
+        for (const auto& block : blocks) fs.write(reinterpret_cast<const char*>(block.compressed.data()), block.compressed.size());
+
+        // Write uncompressed sections.
+        for (const auto& desc : sectionDescs)
+        {
+            if (desc.encoding != SectionEncoding::Raw) continue;
+            std::vector<char> padding(desc.offset - (uint64_t)fs.tellp(), 0);
+            fs.write(padding.data(), padding.size());
+            fs.write(reinterpret_cast<const char*>(sections[desc.id].data()), sections[desc.id].size());
+        }
+
         if (fs.bad()) throw RuntimeError("Failed to write scene cache file to '{}'.", cachePath);
+        fs.close();
+
+        writeDependencies(key, dependencies, hashDependencies);
     }
 
     Scene::SceneData SceneCache::readCache(std::shared_ptr<Device> pDevice, const Key& key)
@@ -239,21 +516,69 @@ namespace Falcor
 
         logInfo("Loading scene cache from '{}'.", cachePath);
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+        // Map file. The mapping is kept alive until all sections are deserialized.
+        MemoryMappedFile file(cachePath, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+
+        const uint8_t* pFileData = reinterpret_cast<const uint8_t*>(file.getData());
+        const size_t fileSize = file.getSize();
+        size_t fileOffset = 0;
+        auto readFile = [&](void* pDst, size_t size)
+        {
+            if (size > fileSize - fileOffset) throw RuntimeError("Unexpected end of scene cache file '{}'.", cachePath);
+            std::memcpy(pDst, pFileData + fileOffset, size);
+            fileOffset += size;
+        };
 
-        // Read header (uncompressed).
+        // Read header.
         Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        readFile(&header, sizeof(header));
         if (!header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
 
-        // Read cache (compressed).
-        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
-        InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
-        if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
-        return sceneData;
+        // Read section and block tables.
+        uint32_t sectionCount = 0;
+        readFile(&sectionCount, sizeof(sectionCount));
+        if (sectionCount != kSectionCount) throw RuntimeError("Invalid section count in scene cache file '{}'.", cachePath);
+
+        std::vector<SectionDesc> sectionDescs(sectionCount);
+        readFile(sectionDescs.data(), sectionDescs.size() * sizeof(SectionDesc));
+
+        size_t blockCount = 0;
+        for (const auto& desc : sectionDescs) blockCount += desc.blockCount;
+        std::vector<BlockDesc> blockDescs(blockCount);
+        readFile(blockDescs.data(), blockDescs.size() * sizeof(BlockDesc));
+
+        // Setup sections. Uncompressed sections reference the mapped file directly,
+        // compressed sections are decompressed on demand by the stream deserializing them.
+        std::vector<SectionData> sections(kSectionCount);
+        size_t blockIndex = 0;
+        for (uint32_t i = 0; i < kSectionCount; ++i)
+        {
+            const auto& sectionDesc = sectionDescs[i];
+            if (sectionDesc.encoding == SectionEncoding::Raw)
+            {
+                if (sectionDesc.offset > fileSize || sectionDesc.size > fileSize - sectionDesc.offset) throw RuntimeError("Invalid section table in scene cache file '{}'.", cachePath);
+                sections[i].pData = pFileData + sectionDesc.offset;
+                sections[i].size = (size_t)sectionDesc.size;
+                continue;
+            }
+
+            auto& section = sections[i];
+            section.size = (size_t)sectionDesc.size;
+            section.blocks.reserve(sectionDesc.blockCount);
+            size_t dstOffset = 0;
+            for (uint32_t j = 0; j < sectionDesc.blockCount; ++j)
+            {
+                const auto& desc = blockDescs[blockIndex++];
+                if (dstOffset + desc.size > section.size || desc.compressedSize > fileSize - fileOffset) throw RuntimeError("Invalid block table in scene cache file '{}'.", cachePath);
+                section.blocks.push_back({ pFileData + fileOffset, desc.compressedSize, desc.size });
+                fileOffset += desc.compressedSize;
+                dstOffset += desc.size;
+            }
+            if (dstOffset != section.size) throw RuntimeError("Invalid block table in scene cache file '{}'.", cachePath);
+        }
+
+        return readSceneData(sections, pDevice);
     }
 
     std::filesystem::path SceneCache::getCachePath(const Key& key)
@@ -261,240 +586,419 @@ namespace Falcor
         return getAppDataDirectory() / kDirectory / SHA1::toString(key);
     }
 
-    // SceneData
-
-    void SceneCache::writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData)
+    std::filesystem::path SceneCache::getDependencyPath(const Key& key)
     {
-        writeMarker(stream, "Path");
-        stream.write(sceneData.path);
+        return getAppDataDirectory() / kDirectory / (SHA1::toString(key) + ".deps");
+    }
+
+    // Dependencies
 
-        writeMarker(stream, "RenderSettings");
-        stream.write(sceneData.renderSettings);
+    void SceneCache::writeDependencies(const Key& key, const std::vector<std::filesystem::path>& dependencies, bool hashContents)
+    {
+        // Query file states (and hash file contents) in parallel.
+        std::vector<FileState> states(dependencies.size());
+        Threading::parallelFor(0, dependencies.size(), [&](size_t i)
+        {
+            states[i] = getFileState(dependencies[i]);
+            if (hashContents && states[i].size != kMissingFile && !std::filesystem::is_directory(dependencies[i]))
+            {
+                states[i].contentHash = hashFileContents(dependencies[i], states[i].size);
+            }
+        }, 1);
 
-        writeMarker(stream, "Cameras");
-        stream.write((uint32_t)sceneData.cameras.size());
-        for (const auto& pCamera : sceneData.cameras) writeCamera(stream, pCamera);
-        stream.write(sceneData.selectedCamera);
-        stream.write(sceneData.cameraSpeed);
+        auto dependencyPath = getDependencyPath(key);
+        std::filesystem::create_directories(dependencyPath.parent_path());
+        std::ofstream fs(dependencyPath.c_str(), std::ios_base::binary);
+        if (fs.bad()) throw RuntimeError("Failed to create scene cache manifest '{}'.", dependencyPath);
 
-        writeMarker(stream, "Lights");
-        stream.write((uint32_t)sceneData.lights.size());
-        for (const auto& pLight : sceneData.lights) writeLight(stream, pLight);
+        DependencyHeader header;
+        std::memcpy(header.magic, kDependencyMagic, sizeof(DependencyHeader::magic));
+        header.version = kDependencyVersion;
+        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
-        writeMarker(stream, "Grids");
-        stream.write((uint32_t)sceneData.grids.size());
-        for (const auto& pGrid : sceneData.grids) writeGrid(stream, pGrid);
+        uint32_t count = (uint32_t)dependencies.size();
+        fs.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (size_t i = 0; i < dependencies.size(); ++i)
+        {
+            std::string path = dependencies[i].string();
+            uint32_t length = (uint32_t)path.size();
+            fs.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            fs.write(path.data(), length);
+            fs.write(reinterpret_cast<const char*>(&states[i]), sizeof(FileState));
+        }
 
-        writeMarker(stream, "GridVolumes");
-        stream.write((uint32_t)sceneData.gridVolumes.size());
-        for (const auto& pGridVolume : sceneData.gridVolumes) writeGridVolume(stream, pGridVolume, sceneData.grids);
+        if (fs.bad()) throw RuntimeError("Failed to write scene cache manifest to '{}'.", dependencyPath);
+    }
 
-        writeMarker(stream, "EnvMap");
-        bool hasEnvMap = sceneData.pEnvMap != nullptr;
-        stream.write(hasEnvMap);
-        if (hasEnvMap) writeEnvMap(stream, sceneData.pEnvMap);
+    bool SceneCache::hasValidDependencies(const Key& key)
+    {
+        // Caches without a manifest can't be validated and need to be rebuilt.
+        std::ifstream fs(getDependencyPath(key).c_str(), std::ios_base::binary);
+        if (!fs.good()) return false;
 
-        writeMarker(stream, "Materials");
-        writeMaterials(stream, sceneData.pMaterials);
+        DependencyHeader header;
+        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!fs.good() || !header.isValid()) return false;
 
-        writeMarker(stream, "SceneGraph");
-        stream.write((uint32_t)sceneData.sceneGraph.size());
-        for (const auto& node : sceneData.sceneGraph)
+        uint32_t count = 0;
+        fs.read(reinterpret_cast<char*>(&count), sizeof(count));
+        std::vector<std::pair<std::filesystem::path, FileState>> dependencies;
+        for (uint32_t i = 0; i < count && fs.good(); ++i)
         {
-            stream.write(node.name);
-            stream.write(node.parent);
-            stream.write(node.transform);
-            stream.write(node.meshBind);
-            stream.write(node.localToBindSpace);
+            uint32_t length = 0;
+            fs.read(reinterpret_cast<char*>(&length), sizeof(length));
+            std::string path(length, '\0');
+            fs.read(path.data(), length);
+            FileState state;
+            fs.read(reinterpret_cast<char*>(&state), sizeof(FileState));
+            dependencies.emplace_back(path, state);
         }
+        if (!fs.good()) return false;
 
-        writeMarker(stream, "Animations");
-        stream.write((uint32_t)sceneData.animations.size());
-        for (const auto& pAnimation : sceneData.animations)
+        // Check dependencies in parallel. Stat calls are cheap but add up for scenes with many files on network drives.
+        std::atomic<bool> valid = true;
+        Threading::parallelFor(0, dependencies.size(), [&](size_t i)
         {
-            writeAnimation(stream, pAnimation);
-        }
+            if (!valid) return;
+            const auto& [path, state] = dependencies[i];
+            if (!isFileUnchanged(path, state))
+            {
+                logInfo("Scene cache is out of date, '{}' has changed.", path);
+                valid = false;
+            }
+        }, 1);
 
-        writeMarker(stream, "Metadata");
-        writeMetadata(stream, sceneData.metadata);
+        return valid;
+    }
 
-        writeMarker(stream, "Meshes");
-        stream.write(sceneData.meshDesc);
-        stream.write(sceneData.meshNames);
-        stream.write(sceneData.meshBBs);
-        stream.write(sceneData.meshInstanceData);
-        stream.write((uint32_t)sceneData.meshIdToInstanceIds.size());
-        for (const auto& item : sceneData.meshIdToInstanceIds)
+    // SceneData
+
+    void SceneCache::writeSceneData(SectionBuffers& sections, const Scene::SceneData& sceneData)
+    {
+        FALCOR_ASSERT(sections.size() == kSectionCount);
+
+        // Sections only read from the scene data and are serialized concurrently.
+        Threading::TaskGroup group;
+        auto writeSection = [&](Section section, std::function<void(OutputStream&)> func)
         {
-            stream.write(item);
-        }
-        stream.write((uint32_t)sceneData.meshGroups.size());
-        for (const auto& group : sceneData.meshGroups)
+            group.run([&sections, section, func = std::move(func)]()
+            {
+                OutputStream stream(sections[(size_t)section]);
+                func(stream);
+            });
+        };
+
+        writeSection(Section::Scene, [&sceneData](OutputStream& stream)
         {
-            stream.write(group.meshList);
-            stream.write(group.isStatic);
-            stream.write(group.isDisplaced);
-        }
-        stream.write((uint32_t)sceneData.cachedMeshes.size());
-        for (const auto& cachedMesh : sceneData.cachedMeshes)
+            writeMarker(stream, "Path");
+            stream.write(sceneData.path);
+
+            writeMarker(stream, "RenderSettings");
+            stream.write(sceneData.renderSettings);
+
+            writeMarker(stream, "Cameras");
+            stream.write((uint32_t)sceneData.cameras.size());
+            for (const auto& pCamera : sceneData.cameras) writeCamera(stream, pCamera);
+            stream.write(sceneData.selectedCamera);
+            stream.write(sceneData.cameraSpeed);
+
+            writeMarker(stream, "Lights");
+            stream.write((uint32_t)sceneData.lights.size());
+            for (const auto& pLight : sceneData.lights) writeLight(stream, pLight);
+
+            writeMarker(stream, "SceneGraph");
+            stream.write((uint32_t)sceneData.sceneGraph.size());
+            for (const auto& node : sceneData.sceneGraph)
+            {
+                stream.write(node.name);
+                stream.write(node.parent);
+                stream.write(node.transform);
+                stream.write(node.meshBind);
+                stream.write(node.localToBindSpace);
+            }
+
+            writeMarker(stream, "Metadata");
+            writeMetadata(stream, sceneData.metadata);
+
+            writeMarker(stream, "CustomPrimitives");
+            stream.write(sceneData.customPrimitiveDesc);
+            stream.write(sceneData.customPrimitiveAABBs);
+        });
+
+        writeSection(Section::Grids, [&sceneData](OutputStream& stream)
         {
-            stream.write(cachedMesh.meshID);
-            stream.write(cachedMesh.timeSamples);
-            stream.write((uint32_t)cachedMesh.vertexData.size());
-            for (const auto& data : cachedMesh.vertexData) stream.write(data);
-        }
-        stream.write(sceneData.useCompressedHitInfo);
-        stream.write(sceneData.has16BitIndices);
-        stream.write(sceneData.has32BitIndices);
-        stream.write(sceneData.meshDrawCount);
-        stream.write(sceneData.meshIndexData);
-        stream.write(sceneData.meshStaticData);
-        stream.write(sceneData.meshSkinningData);
+            writeMarker(stream, "Grids");
+            stream.write((uint32_t)sceneData.grids.size());
+            for (const auto& pGrid : sceneData.grids) writeGrid(stream, pGrid);
 
-        writeMarker(stream, "Curves");
-        stream.write(sceneData.curveDesc);
-        stream.write(sceneData.curveBBs);
-        stream.write(sceneData.curveInstanceData);
-        stream.write(sceneData.curveIndexData);
-        stream.write(sceneData.curveStaticData);
+            writeMarker(stream, "GridVolumes");
+            stream.write((uint32_t)sceneData.gridVolumes.size());
+            for (const auto& pGridVolume : sceneData.gridVolumes) writeGridVolume(stream, pGridVolume, sceneData.grids);
 
-        stream.write((uint32_t)sceneData.cachedCurves.size());
-        for (const auto& cachedCurve : sceneData.cachedCurves)
+            writeMarker(stream, "EnvMap");
+            bool hasEnvMap = sceneData.pEnvMap != nullptr;
+            stream.write(hasEnvMap);
+            if (hasEnvMap) writeEnvMap(stream, sceneData.pEnvMap);
+        });
+
+        writeSection(Section::Materials, [&sceneData](OutputStream& stream)
         {
-            stream.write(cachedCurve.tessellationMode);
-            stream.write(cachedCurve.geometryID);
-            stream.write(cachedCurve.timeSamples);
-            stream.write(cachedCurve.indexData);
-            stream.write((uint32_t)cachedCurve.vertexData.size());
-            for (const auto& data : cachedCurve.vertexData) stream.write(data);
-        }
+            writeMarker(stream, "Materials");
+            writeMaterials(stream, sceneData.pMaterials);
+        });
+
+        writeSection(Section::Animations, [&sceneData](OutputStream& stream)
+        {
+            writeMarker(stream, "Animations");
+            stream.write((uint32_t)sceneData.animations.size());
+            for (const auto& pAnimation : sceneData.animations)
+            {
+                writeAnimation(stream, pAnimation);
+            }
+        });
 
-        writeMarker(stream, "CustomPrimitives");
-        stream.write(sceneData.customPrimitiveDesc);
-        stream.write(sceneData.customPrimitiveAABBs);
+        writeSection(Section::Meshes, [&sceneData](OutputStream& stream)
+        {
+            writeMarker(stream, "Meshes");
+            stream.write(sceneData.meshDesc);
+            stream.write(sceneData.meshNames);
+            stream.write(sceneData.meshBBs);
+            stream.write(sceneData.meshInstanceData);
+            stream.write((uint32_t)sceneData.meshIdToInstanceIds.size());
+            for (const auto& item : sceneData.meshIdToInstanceIds)
+            {
+                stream.write(item);
+            }
+            stream.write((uint32_t)sceneData.meshGroups.size());
+            for (const auto& group : sceneData.meshGroups)
+            {
+                stream.write(group.meshList);
+                stream.write(group.isStatic);
+                stream.write(group.isDisplaced);
+            }
+            stream.write((uint32_t)sceneData.cachedMeshes.size());
+            for (const auto& cachedMesh : sceneData.cachedMeshes)
+            {
+                stream.write(cachedMesh.meshID);
+                stream.write(cachedMesh.timeSamples);
+                stream.write((uint32_t)cachedMesh.vertexData.size());
+                for (const auto& data : cachedMesh.vertexData) stream.write(data);
+            }
+            stream.write(sceneData.useCompressedHitInfo);
+            stream.write(sceneData.has16BitIndices);
+            stream.write(sceneData.has32BitIndices);
+            stream.write(sceneData.meshDrawCount);
+        });
 
-        writeMarker(stream, "End");
+        writeSection(Section::MeshIndexData, [&sceneData](OutputStream& stream)
+        {
+            writeMarker(stream, "MeshIndexData");
+            stream.write(sceneData.meshIndexData);
+        });
+
+        writeSection(Section::MeshVertexData, [&sceneData](OutputStream& stream)
+        {
+            writeMarker(stream, "MeshVertexData");
+            stream.write(sceneData.meshStaticData);
+            stream.write(sceneData.meshSkinningData);
+        });
+
+        writeSection(Section::Curves, [&sceneData](OutputStream& stream)
+        {
+            writeMarker(stream, "Curves");
+            stream.write(sceneData.curveDesc);
+            stream.write(sceneData.curveBBs);
+            stream.write(sceneData.curveInstanceData);
+
+            stream.write((uint32_t)sceneData.cachedCurves.size());
+            for (const auto& cachedCurve : sceneData.cachedCurves)
+            {
+                stream.write(cachedCurve.tessellationMode);
+                stream.write(cachedCurve.geometryID);
+                stream.write(cachedCurve.timeSamples);
+                stream.write(cachedCurve.indexData);
+                stream.write((uint32_t)cachedCurve.vertexData.size());
+                for (const auto& data : cachedCurve.vertexData) stream.write(data);
+            }
+        });
+
+        writeSection(Section::CurveVertexData, [&sceneData](OutputStream& stream)
+        {
+            writeMarker(stream, "CurveVertexData");
+            stream.write(sceneData.curveIndexData);
+            stream.write(sceneData.curveStaticData);
+        });
+
+        group.wait();
     }
 
-    Scene::SceneData SceneCache::readSceneData(InputStream& stream, std::shared_ptr<Device> pDevice)
+    Scene::SceneData SceneCache::readSceneData(const std::vector<SectionData>& sections, std::shared_ptr<Device> pDevice)
     {
+        FALCOR_ASSERT(sections.size() == kSectionCount);
+
         Scene::SceneData sceneData;
         sceneData.pMaterials = MaterialSystem::create(pDevice);
 
-        readMarker(stream, "Path");
-        stream.read(sceneData.path);
+        // Sections that don't create any device resources are deserialized on worker threads
+        // while the remaining sections are read on the calling thread.
+        Threading::TaskGroup group;
+        auto readSectionAsync = [&](Section section, std::function<void(InputStream&)> func)
+        {
+            group.run([&sections, section, func = std::move(func)]()
+            {
+                InputStream stream(sections[(size_t)section]);
+                func(stream);
+            });
+        };
 
-        readMarker(stream, "RenderSettings");
-        stream.read(sceneData.renderSettings);
+        readSectionAsync(Section::Scene, [&sceneData](InputStream& stream)
+        {
+            readMarker(stream, "Path");
+            stream.read(sceneData.path);
 
-        readMarker(stream, "Cameras");
-        sceneData.cameras.resize(stream.read<uint32_t>());
-        for (auto& pCamera : sceneData.cameras) pCamera = readCamera(stream);
-        stream.read(sceneData.selectedCamera);
-        stream.read(sceneData.cameraSpeed);
+            readMarker(stream, "RenderSettings");
+            stream.read(sceneData.renderSettings);
 
-        readMarker(stream, "Lights");
-        sceneData.lights.resize(stream.read<uint32_t>());
-        for (auto& pLight : sceneData.lights) pLight = readLight(stream);
+            readMarker(stream, "Cameras");
+            sceneData.cameras.resize(stream.read<uint32_t>());
+            for (auto& pCamera : sceneData.cameras) pCamera = readCamera(stream);
+            stream.read(sceneData.selectedCamera);
+            stream.read(sceneData.cameraSpeed);
 
-        readMarker(stream, "Grids");
-        sceneData.grids.resize(stream.read<uint32_t>());
-        for (auto& pGrid : sceneData.grids) pGrid = readGrid(stream, pDevice);
+            readMarker(stream, "Lights");
+            sceneData.lights.resize(stream.read<uint32_t>());
+            for (auto& pLight : sceneData.lights) pLight = readLight(stream);
 
-        readMarker(stream, "GridVolumes");
-        sceneData.gridVolumes.resize(stream.read<uint32_t>());
-        for (auto& pGridVolume : sceneData.gridVolumes) pGridVolume = readGridVolume(stream, sceneData.grids, pDevice);
+            readMarker(stream, "SceneGraph");
+            sceneData.sceneGraph.resize(stream.read<uint32_t>());
+            for (auto &node : sceneData.sceneGraph)
+            {
+                stream.read(node.name);
+                stream.read(node.parent);
+                stream.read(node.transform);
+                stream.read(node.meshBind);
+                stream.read(node.localToBindSpace);
+            }
 
-        readMarker(stream, "EnvMap");
-        auto hasEnvMap = stream.read<bool>();
-        if (hasEnvMap) sceneData.pEnvMap = readEnvMap(stream, pDevice);
+            readMarker(stream, "Metadata");
+            sceneData.metadata = readMetadata(stream);
 
-        // Material textures are loaded asynchronously to allow loading other data
-        // in parallel while loading textures from files and uploading them to the GPU.
-        // Due to the current implementation, we need to make sure no other GPU operations (transfers)
-        // are executed while loading material textures. Due to this, we load volume grids and the envmap
-        // before material textures, as they upload buffers to the GPU when created.
-        // Make sure no other GPU operations are executed until calling pMaterialTextureLoader.reset()
-        // further down which blocks until all textures are loaded.
-        auto pMaterialTextureLoader = std::make_unique<MaterialTextureLoader>(sceneData.pMaterials->getTextureManager(), true);
+            readMarker(stream, "CustomPrimitives");
+            stream.read(sceneData.customPrimitiveDesc);
+            stream.read(sceneData.customPrimitiveAABBs);
+        });
 
-        readMarker(stream, "Materials");
-        readMaterials(stream, sceneData.pMaterials, *pMaterialTextureLoader, pDevice);
+        readSectionAsync(Section::Animations, [&sceneData](InputStream& stream)
+        {
+            readMarker(stream, "Animations");
+            sceneData.animations.resize(stream.read<uint32_t>());
+            for (auto& pAnimation : sceneData.animations) pAnimation = readAnimation(stream);
+        });
 
-        readMarker(stream, "SceneGraph");
-        sceneData.sceneGraph.resize(stream.read<uint32_t>());
-        for (auto &node : sceneData.sceneGraph)
+        readSectionAsync(Section::Meshes, [&sceneData](InputStream& stream)
         {
-            stream.read(node.name);
-            stream.read(node.parent);
-            stream.read(node.transform);
-            stream.read(node.meshBind);
-            stream.read(node.localToBindSpace);
-        }
+            readMarker(stream, "Meshes");
+            stream.read(sceneData.meshDesc);
+            stream.read(sceneData.meshNames);
+            stream.read(sceneData.meshBBs);
+            stream.read(sceneData.meshInstanceData);
+            sceneData.meshIdToInstanceIds.resize(stream.read<uint32_t>());
+            for (auto& item : sceneData.meshIdToInstanceIds)
+            {
+                stream.read(item);
+            }
+            sceneData.meshGroups.resize(stream.read<uint32_t>());
+            for (auto& group : sceneData.meshGroups)
+            {
+                stream.read(group.meshList);
+                stream.read(group.isStatic);
+                stream.read(group.isDisplaced);
+            }
+            sceneData.cachedMeshes.resize(stream.read<uint32_t>());
+            for (auto& cachedMesh : sceneData.cachedMeshes)
+            {
+                stream.read(cachedMesh.meshID);
+                stream.read(cachedMesh.timeSamples);
+                cachedMesh.vertexData.resize(stream.read<uint32_t>());
+                for (auto& data : cachedMesh.vertexData) stream.read(data);
+            }
+            stream.read(sceneData.useCompressedHitInfo);
+            stream.read(sceneData.has16BitIndices);
+            stream.read(sceneData.has32BitIndices);
+            stream.read(sceneData.meshDrawCount);
+        });
 
-        readMarker(stream, "Animations");
-        sceneData.animations.resize(stream.read<uint32_t>());
-        for (auto& pAnimation : sceneData.animations) pAnimation = readAnimation(stream);
+        readSectionAsync(Section::MeshIndexData, [&sceneData](InputStream& stream)
+        {
+            readMarker(stream, "MeshIndexData");
+            stream.read(sceneData.meshIndexData);
+        });
 
-        readMarker(stream, "Metadata");
-        sceneData.metadata = readMetadata(stream);
+        readSectionAsync(Section::MeshVertexData, [&sceneData](InputStream& stream)
+        {
+            readMarker(stream, "MeshVertexData");
+            stream.read(sceneData.meshStaticData);
+            stream.read(sceneData.meshSkinningData);
+        });
 
-        readMarker(stream, "Meshes");
-        stream.read(sceneData.meshDesc);
-        stream.read(sceneData.meshNames);
-        stream.read(sceneData.meshBBs);
-        stream.read(sceneData.meshInstanceData);
-        sceneData.meshIdToInstanceIds.resize(stream.read<uint32_t>());
-        for (auto& item : sceneData.meshIdToInstanceIds)
+        readSectionAsync(Section::Curves, [&sceneData](InputStream& stream)
         {
-            stream.read(item);
-        }
-        sceneData.meshGroups.resize(stream.read<uint32_t>());
-        for (auto& group : sceneData.meshGroups)
+            readMarker(stream, "Curves");
+            stream.read(sceneData.curveDesc);
+            stream.read(sceneData.curveBBs);
+            stream.read(sceneData.curveInstanceData);
+
+            sceneData.cachedCurves.resize(stream.read<uint32_t>());
+            for (auto& cachedCurve : sceneData.cachedCurves)
+            {
+                stream.read(cachedCurve.tessellationMode);
+                stream.read(cachedCurve.geometryID);
+                stream.read(cachedCurve.timeSamples);
+                stream.read(cachedCurve.indexData);
+                cachedCurve.vertexData.resize(stream.read<uint32_t>());
+                for (auto& data : cachedCurve.vertexData) stream.read(data);
+            }
+        });
+
+        readSectionAsync(Section::CurveVertexData, [&sceneData](InputStream& stream)
         {
-            stream.read(group.meshList);
-            stream.read(group.isStatic);
-            stream.read(group.isDisplaced);
-        }
-        sceneData.cachedMeshes.resize(stream.read<uint32_t>());
-        for (auto& cachedMesh : sceneData.cachedMeshes)
+            readMarker(stream, "CurveVertexData");
+            stream.read(sceneData.curveIndexData);
+            stream.read(sceneData.curveStaticData);
+        });
+
         {
-            stream.read(cachedMesh.meshID);
-            stream.read(cachedMesh.timeSamples);
-            cachedMesh.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedMesh.vertexData) stream.read(data);
+            InputStream stream(sections[(size_t)Section::Grids]);
+
+            readMarker(stream, "Grids");
+            sceneData.grids.resize(stream.read<uint32_t>());
+            for (auto& pGrid : sceneData.grids) pGrid = readGrid(stream, pDevice);
+
+            readMarker(stream, "GridVolumes");
+            sceneData.gridVolumes.resize(stream.read<uint32_t>());
+            for (auto& pGridVolume : sceneData.gridVolumes) pGridVolume = readGridVolume(stream, sceneData.grids, pDevice);
+
+            readMarker(stream, "EnvMap");
+            auto hasEnvMap = stream.read<bool>();
+            if (hasEnvMap) sceneData.pEnvMap = readEnvMap(stream, pDevice);
         }
-        stream.read(sceneData.useCompressedHitInfo);
-        stream.read(sceneData.has16BitIndices);
-        stream.read(sceneData.has32BitIndices);
-        stream.read(sceneData.meshDrawCount);
-        stream.read(sceneData.meshIndexData);
-        stream.read(sceneData.meshStaticData);
-        stream.read(sceneData.meshSkinningData);
 
-        readMarker(stream, "Curves");
-        stream.read(sceneData.curveDesc);
-        stream.read(sceneData.curveBBs);
-        stream.read(sceneData.curveInstanceData);
-        stream.read(sceneData.curveIndexData);
-        stream.read(sceneData.curveStaticData);
+        // Material textures are loaded asynchronously to allow loading other data
+        // in parallel while loading textures from files and uploading them to the GPU.
+        // Due to the current implementation, we need to make sure no other GPU operations (transfers)
+        // are executed while loading material textures. Due to this, we load volume grids and the envmap
+        // before material textures, as they upload buffers to the GPU when created.
+        // Make sure no other GPU operations are executed until calling pMaterialTextureLoader.reset()
+        // further down which blocks until all textures are loaded.
+        auto pMaterialTextureLoader = std::make_unique<MaterialTextureLoader>(sceneData.pMaterials->getTextureManager(), true);
 
-        sceneData.cachedCurves.resize(stream.read<uint32_t>());
-        for (auto& cachedCurve : sceneData.cachedCurves)
         {
-            stream.read(cachedCurve.tessellationMode);
-            stream.read(cachedCurve.geometryID);
-            stream.read(cachedCurve.timeSamples);
-            stream.read(cachedCurve.indexData);
-            cachedCurve.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedCurve.vertexData) stream.read(data);
+            InputStream stream(sections[(size_t)Section::Materials]);
+            readMarker(stream, "Materials");
+            readMaterials(stream, sceneData.pMaterials, *pMaterialTextureLoader, pDevice);
         }
 
-        readMarker(stream, "CustomPrimitives");
-        stream.read(sceneData.customPrimitiveDesc);
-        stream.read(sceneData.customPrimitiveAABBs);
-
-        readMarker(stream, "End");
+        group.wait();
 
         pMaterialTextureLoader.reset();
 
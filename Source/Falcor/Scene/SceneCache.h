@@ -50,6 +50,10 @@ namespace Falcor
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+        The data is split into sections which are compressed as independent LZ4 blocks, allowing
+        the cache to be compressed, decompressed and deserialized on multiple threads.
+        Next to the cache file, a manifest records the size and modification time (and optionally a content hash)
+        of every file the scene was imported from. The cache is only valid while all of these files are unchanged.
     */
     class FALCOR_API SceneCache
     {
@@ -57,16 +61,23 @@ namespace Falcor
         using Key = SHA1::MD;
 
         /** Check if there is a valid scene cache for a given cache key.
+            The files recorded in the dependency manifest are checked in parallel.
             \param[in] key Cache key.
-            \return Returns true if a valid cache exists.
+            \return Returns true if a valid cache exists and none of the scene's dependencies have changed.
         */
         static bool hasValidCache(const Key& key);
 
         /** Write a scene cache.
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] dependencies Absolute paths of the files the scene was imported from.
+            \param[in] uncompressedBulkData Store mesh and curve vertex/index data uncompressed and page-aligned.
+                This increases the file size, but the data is read directly from the memory-mapped cache file
+                without intermediate buffers, which reduces peak memory and makes reloads from the OS page cache fast.
+            \param[in] hashDependencies Store a content hash of each dependency. A dependency whose modification time
+                changed is then only considered changed if its contents differ.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, const std::vector<std::filesystem::path>& dependencies, bool uncompressedBulkData = false, bool hashDependencies = false);
 
         /** Read a scene cache.
             \param[in] pDevice GPU device.
@@ -76,13 +87,39 @@ namespace Falcor
         static Scene::SceneData readCache(std::shared_ptr<Device> pDevice, const Key& key);
 
     private:
+        friend struct SceneCacheTestAccess; ///< Gives the unit tests access to the dependency manifest.
+
         class OutputStream;
         class InputStream;
 
+        /// Serialized data of each cache file section.
+        using SectionBuffers = std::vector<std::vector<uint8_t>>;
+
+        /// LZ4 compressed block of a cache file section.
+        struct CompressedBlock
+        {
+            const uint8_t* pData = nullptr;
+            uint32_t compressedSize = 0;
+            uint32_t size = 0;
+        };
+
+        /// View of the serialized data of a cache file section.
+        /// Compressed sections are only decompressed while being deserialized.
+        struct SectionData
+        {
+            const uint8_t* pData = nullptr;         ///< Uncompressed data, or nullptr if the section is compressed.
+            size_t size = 0;                        ///< Uncompressed size in bytes.
+            std::vector<CompressedBlock> blocks;    ///< Compressed blocks in section order.
+        };
+
         static std::filesystem::path getCachePath(const Key& key);
+        static std::filesystem::path getDependencyPath(const Key& key);
+
+        static void writeDependencies(const Key& key, const std::vector<std::filesystem::path>& dependencies, bool hashContents);
+        static bool hasValidDependencies(const Key& key);
 
-        static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
-        static Scene::SceneData readSceneData(InputStream& stream, std::shared_ptr<Device> pDevice);
+        static void writeSceneData(SectionBuffers& sections, const Scene::SceneData& sceneData);
+        static Scene::SceneData readSceneData(const std::vector<SectionData>& sections, std::shared_ptr<Device> pDevice);
 
         static void writeMetadata(OutputStream& stream, const Scene::Metadata& metadata);
         static Scene::Metadata readMetadata(InputStream& stream);
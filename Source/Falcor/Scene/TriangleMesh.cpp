@@ -26,7 +26,10 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TriangleMesh.h"
+#include "PLYReader.h"
+#include "SceneBuilderAccess.h"
 #include "Core/Assert.h"
+#include "Core/Errors.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
@@ -42,9 +45,9 @@ namespace Falcor
         return SharedPtr(new TriangleMesh());
     }
 
-    TriangleMesh::SharedPtr TriangleMesh::create(const VertexList& vertices, const IndexList& indices, bool frontFaceCW)
+    TriangleMesh::SharedPtr TriangleMesh::create(VertexList vertices, IndexList indices, bool frontFaceCW)
     {
-        return SharedPtr(new TriangleMesh(vertices, indices, frontFaceCW));
+        return SharedPtr(new TriangleMesh(std::move(vertices), std::move(indices), frontFaceCW));
     }
 
     TriangleMesh::SharedPtr TriangleMesh::createDummy()
@@ -201,6 +204,13 @@ namespace Falcor
             return nullptr;
         }
 
+        // Load PLY files with the dedicated reader, avoiding the conversion through an Assimp scene.
+        bool isCompressed = hasExtension(fullPath, "gz");
+        if (hasExtension(isCompressed ? fullPath.stem() : fullPath, "ply"))
+        {
+            return createFromPLY(fullPath, isCompressed, smoothNormals);
+        }
+
         Assimp::Importer importer;
 
         unsigned int flags =
@@ -267,6 +277,79 @@ namespace Falcor
         return create(vertices, indices);
     }
 
+    TriangleMesh::SharedPtr TriangleMesh::createFromPLY(const std::filesystem::path& path, bool isCompressed, bool smoothNormals)
+    {
+        PLYReader::Result result;
+        try
+        {
+            if (isCompressed)
+            {
+                auto decompressed = decompressFile(path);
+                result = PLYReader::readFromMemory(decompressed.data(), decompressed.size());
+            }
+            else
+            {
+                result = PLYReader::read(path);
+            }
+        }
+        catch (const RuntimeError& e)
+        {
+            logWarning("Failed to load triangle mesh from '{}': {}", path, e.what());
+            return nullptr;
+        }
+
+        VertexList& vertices = result.vertices;
+        IndexList& indices = result.indices;
+
+        // Match the Assimp import (aiProcess_FlipUVs).
+        if (result.hasTexCoords)
+        {
+            for (auto& vertex : vertices) vertex.texCoord.y = 1.f - vertex.texCoord.y;
+        }
+
+        // Generate normals if the file has none (aiProcess_GenSmoothNormals or aiProcess_GenNormals).
+        if (!result.hasNormals)
+        {
+            if (smoothNormals)
+            {
+                // Accumulate area weighted face normals.
+                for (auto& vertex : vertices) vertex.normal = float3(0.f);
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    auto& v0 = vertices[indices[i]];
+                    auto& v1 = vertices[indices[i + 1]];
+                    auto& v2 = vertices[indices[i + 2]];
+                    float3 n = glm::cross(v1.position - v0.position, v2.position - v0.position);
+                    v0.normal += n;
+                    v1.normal += n;
+                    v2.normal += n;
+                }
+                for (auto& vertex : vertices)
+                {
+                    float len = glm::length(vertex.normal);
+                    vertex.normal = len > 0.f ? vertex.normal / len : float3(0.f);
+                }
+            }
+            else
+            {
+                // Facet normals need separate vertices per triangle.
+                VertexList faceVertices(indices.size());
+                for (size_t i = 0; i < indices.size(); i += 3)
+                {
+                    for (size_t j = 0; j < 3; ++j) faceVertices[i + j] = vertices[indices[i + j]];
+                    float3 n = glm::cross(faceVertices[i + 1].position - faceVertices[i].position, faceVertices[i + 2].position - faceVertices[i].position);
+                    float len = glm::length(n);
+                    n = len > 0.f ? n / len : float3(0.f);
+                    for (size_t j = 0; j < 3; ++j) faceVertices[i + j].normal = n;
+                }
+                for (size_t i = 0; i < indices.size(); ++i) indices[i] = (uint32_t)i;
+                vertices = std::move(faceVertices);
+            }
+        }
+
+        return create(std::move(vertices), std::move(indices));
+    }
+
     uint32_t TriangleMesh::addVertex(float3 position, float3 normal, float2 texCoord)
     {
         mVertices.emplace_back(Vertex{position, normal, texCoord});
@@ -304,9 +387,9 @@ namespace Falcor
     TriangleMesh::TriangleMesh()
     {}
 
-    TriangleMesh::TriangleMesh(const VertexList& vertices, const IndexList& indices, bool frontFaceCW)
-        : mVertices(vertices)
-        , mIndices(indices)
+    TriangleMesh::TriangleMesh(VertexList vertices, IndexList indices, bool frontFaceCW)
+        : mVertices(std::move(vertices))
+        , mIndices(std::move(indices))
         , mFrontFaceCW(frontFaceCW)
     {}
 
@@ -326,7 +409,12 @@ namespace Falcor
         triangleMesh.def_static("createDisk", &TriangleMesh::createDisk, "radius"_a = 1.f, "segments"_a = 32);
         triangleMesh.def_static("createCube", &TriangleMesh::createCube, "size"_a = float3(1.f));
         triangleMesh.def_static("createSphere", &TriangleMesh::createSphere, "radius"_a = 1.f, "segmentsU"_a = 32, "segmentsV"_a = 32);
-        triangleMesh.def_static("createFromFile", &TriangleMesh::createFromFile, "path"_a, "smoothNormals"_a = false);
+        auto createFromFile = [] (const std::filesystem::path& path, bool smoothNormals)
+        {
+            addActivePythonSceneDependency(path);
+            return TriangleMesh::createFromFile(path, smoothNormals);
+        };
+        triangleMesh.def_static("createFromFile", createFromFile, "path"_a, "smoothNormals"_a = false);
 
         pybind11::class_<TriangleMesh::Vertex> vertex(triangleMesh, "Vertex");
         vertex.def_readwrite("position", &TriangleMesh::Vertex::position);
@@ -67,7 +67,7 @@ namespace Falcor
             \param[in] frontFaceCW Triangle winding.
             \return Returns the triangle mesh.
         */
-        static SharedPtr create(const VertexList& vertices, const IndexList& indices, bool frontFaceCW = false);
+        static SharedPtr create(VertexList vertices, IndexList indices, bool frontFaceCW = false);
 
         /** Creates a dummy mesh (single degenerate triangle).
             \return Returns the triangle mesh.
@@ -101,7 +101,8 @@ namespace Falcor
         static SharedPtr createSphere(float radius = 0.5f, uint32_t segmentsU = 32, uint32_t segmentsV = 16);
 
         /** Creates a triangle mesh from a file.
-            This is using ASSIMP to support a wide variety of asset formats.
+            This is using ASSIMP to support a wide variety of asset formats. PLY files (optionally gzip compressed) are loaded
+            with a dedicated reader instead.
             All geometry found in the asset is pre-transformed and merged into the same triangle mesh.
             \param[in] path File path to load mesh from.
             \param[in] smoothNormals If no normals are defined in the model, generate smooth instead of facet normals.
@@ -170,7 +171,9 @@ namespace Falcor
 
     private:
         TriangleMesh();
-        TriangleMesh(const VertexList& vertices, const IndexList& indices, bool frontFaceCW);
+        TriangleMesh(VertexList vertices, IndexList indices, bool frontFaceCW);
+
+        static SharedPtr createFromPLY(const std::filesystem::path& path, bool isCompressed, bool smoothNormals);
 
         std::string mName;
         std::vector<Vertex> mVertices;
@@ -328,6 +328,7 @@ namespace Falcor
 
         auto createFromFile = [] (const std::filesystem::path& path, const std::string& gridname)
         {
+            addActivePythonSceneDependency(path);
             return Grid::createFromFile(getActivePythonSceneBuilder().getDevice(), path, gridname);
         };
         grid.def_static("createFromFile", createFromFile, "path"_a, "gridname"_a); // PYTHONDEPRECATED
@@ -28,10 +28,13 @@
 #pragma once
 #include "BrickedGrid.h"
 #include "BC4Encode.h"
+#include "Core/Assert.h"
+#include "Core/API/Device.h"
 #include "Core/API/Formats.h"
+#include "Core/API/RenderContext.h"
 #include "Utils/Logger.h"
 #include "Utils/HostDeviceShared.slangh"
-#include "Utils/NumericRange.h"
+#include "Utils/Threading.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Timing/CpuTimer.h"
 
@@ -45,8 +48,6 @@
 #endif
 
 #include <algorithm>
-#include <atomic>
-#include <execution>
 #include <vector>
 
 namespace Falcor
@@ -56,6 +57,15 @@ namespace Falcor
     using NanoVDBConverterUNORM8 = NanoVDBToBricksConverter<uint8_t, 8>;
     using NanoVDBConverterUNORM16 = NanoVDBToBricksConverter<uint16_t, 16>;
 
+    /** Converts a NanoVDB float grid to a bricked grid (range/indirection textures and a brick atlas).
+
+        The conversion runs in three parallel stages:
+        1. The value range of each leaf (including its 1-voxel halo) is computed, one leaf slice per task.
+        2. Non-empty leaves are assigned atlas bricks in scan order, so the atlas layout does not depend on the thread count,
+           and the range mips are reduced in parallel.
+        3. The bricks are encoded in batches of atlas slices and uploaded to the atlas texture batch by batch.
+           This bounds the host working set to kMaxBatchByteSize instead of the full atlas.
+    */
     template <typename TexelType, unsigned int kBitsPerTexel>
     struct NanoVDBToBricksConverter
     {
@@ -68,13 +78,23 @@ namespace Falcor
     private:
         const static uint32_t kBrickSize = 8; // Must be 8, to match both NanoVDB leaf size.
         const static int32_t kBC4Compress = kBitsPerTexel == 4;
+        const static size_t kMaxBatchByteSize = size_t(64) << 20; // Upper bound on the host memory used for encoding atlas bricks.
 
-        void convertSlice(int z);
-        void computeMip(int mip);
+        uint32_t computeSliceRanges(int z);
+        void assignSliceBricks(int z, uint32_t firstBrick);
+        void computeMipSlice(int mip, int z);
+        void encodeBrick(uint32_t brick, uint32_t firstAtlasSlice, TexelType* pBatchData);
 
+        inline uint32_t getLeafIndex(int x, int y, int z) const { return x + mLeafDim[0].x * (y + mLeafDim[0].y * z); }
         inline uint3 getAtlasSizeBricks() const { return mAtlasSizeBricks; }
         inline uint3 getAtlasSizePixels() const { return mAtlasSizeBricks * kBrickSize; }
         inline uint32_t getAtlasMaxBrick() const { return mAtlasSizeBricks.x * mAtlasSizeBricks.y * mAtlasSizeBricks.z; }
+        inline size_t getAtlasSliceTexelCount() const
+        {
+            // Number of stored texels (or BC4 blocks) per slice of atlas bricks.
+            size_t texelCount = size_t(getAtlasSizePixels().x) * getAtlasSizePixels().y * kBrickSize;
+            return kBC4Compress ? texelCount / 16 : texelCount;
+        }
 
         inline ResourceFormat getAtlasFormat() {
             switch (kBitsPerTexel) {
@@ -107,16 +127,15 @@ namespace Falcor
         int3 mLeafDim[4];
         int3 mBBMin, mBBMax, mPixDim;
         uint32_t mLeafCount[4];
+        uint32_t mBrickCount = 0;
         std::vector<uint32_t> mRangeData;
         std::vector<uint32_t> mPtrData;
-        std::vector<TexelType> mAtlasData;
-        std::atomic_uint32_t mNonEmptyCount;
+        std::vector<uint32_t> mBrickLeafIndex; ///< Mip 0 leaf index for each atlas brick.
     };
 
     template <typename TexelType, unsigned int kBitsPerTexel>
     NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::NanoVDBToBricksConverter(const nanovdb::FloatGrid* grid)
     {
-        mNonEmptyCount.store(0);
         mpFloatGrid = grid;
         auto& voxelbox = mpFloatGrid->indexBBox();
         mBBMin = (int3(voxelbox.min().x(), voxelbox.min().y(), voxelbox.min().z())) & (~7);
@@ -128,28 +147,16 @@ namespace Falcor
             mLeafDim[i] = mPixDim / (8 << i);
             mLeafCount[i] = (mLeafDim[i].x * mLeafDim[i].y * mLeafDim[i].z) + (i ? mLeafCount[i - 1] : 0); // Cumulative leaf count up the mips.
         }
-        uint leafCount = grid->tree().nodeCount(0);
-        uint approxdim = 1u << uint(log2f((float)leafCount + 1.f) / 3.f); // Choose the first 2 dimensions to be powers of 2.
-        uint lastdim = (leafCount + approxdim * approxdim - 1) / (approxdim * approxdim);
-        mAtlasSizeBricks = uint3(approxdim, approxdim, lastdim);
-        uint3 atlasSizePixels = getAtlasSizePixels();
-        uint leafTexelCount = atlasSizePixels.x * atlasSizePixels.y * atlasSizePixels.z;
         mRangeData.resize(mLeafCount[3]);
         mPtrData.resize(mLeafCount[0]);
-        mAtlasData.resize(kBC4Compress ? (leafTexelCount / 16) : leafTexelCount);
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convertSlice(int z)
+    uint32_t NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeSliceRanges(int z)
     {
-        uint3 atlasSizePixels = getAtlasSizePixels();
-        uint brickMax = getAtlasMaxBrick();
-        uint bricksPerSlice = mAtlasSizeBricks.x * mAtlasSizeBricks.y;
-        uint pixelsPerSlice = atlasSizePixels.x * atlasSizePixels.y;
-
-        size_t offset = z * mLeafDim[0].x * mLeafDim[0].y;
-        uint32_t* rangedst = mRangeData.data() + offset;
-        uint32_t* ptrdst = mPtrData.data() + offset;
+        uint32_t* rangedst = mRangeData.data() + getLeafIndex(0, 0, z);
+        uint32_t* ptrdst = mPtrData.data() + getLeafIndex(0, 0, z);
+        uint32_t nonEmptyCount = 0;
         auto a = mpFloatGrid->getAccessor();
         for (int y = 0; y < mLeafDim[0].y; ++y)
         {
@@ -159,7 +166,6 @@ namespace Falcor
                 auto val = a.getValue(ijk);
                 auto leaf = a.probeLeaf(ijk);
                 float minorant = val, majorant = val;
-                uint myleaf = 0;
                 if (leaf)
                 {
                     // Nanovdb only stores minorant/majorant for active voxels, but we need all of them... Grab the central 8x8x8 first the quick way.
@@ -176,82 +182,45 @@ namespace Falcor
                     for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, -1)), minorant, majorant);
                     for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(-1, j, kBrickSize)), minorant, majorant);
                     for (int j = -1; j <= kBrickSize; ++j) expandMinorantMajorant(a.getValue(ijk + nanovdb::Coord(kBrickSize, j, kBrickSize)), minorant, majorant);
-
-                    if (minorant != majorant) myleaf = mNonEmptyCount.fetch_add(1);
                 }
-                if (majorant == minorant || myleaf >= brickMax || leaf == nullptr)
+                if (majorant == minorant || leaf == nullptr)
                 {
                     *rangedst++ = f32tof16(majorant) + (f32tof16(majorant) << 16); // force identical major and minor
                     *ptrdst++ = 0;
                 }
                 else
                 {
-                    const float* data = leaf->data()->mValues;
                     majorant = f16tof32(f32tof16(majorant) + 1);
                     minorant = f16tof32(f32tof16(minorant));
                     *rangedst++ = f32tof16(majorant) + (f32tof16(minorant) << 16);
-                    uint32_t atlasx = myleaf % mAtlasSizeBricks.x;
-                    uint32_t atlasy = (myleaf / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
-                    uint32_t atlasz = myleaf / bricksPerSlice;
-                    *ptrdst++ = (atlasx + (atlasy << 8) + (atlasz << 16));
-
-                    if (!kBC4Compress) {
-                        float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
-                        TexelType* atlasdst = (TexelType*)mAtlasData.data() + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
-                        {
-                            for (int pixy = 0; pixy < kBrickSize; ++pixy)
-                            {
-                                for (int pixx = 0; pixx < kBrickSize; ++pixx)
-                                {
-                                    float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
-                                    *atlasdst++ = TexelType((f - minorant) * invRange);
-                                }
-                                atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
-                            }
-                            atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
-                        }
-                    }
-                    else {
-                        // BC4 compression:
-                        float invRange = (255.f) / (majorant - minorant);
-                        uint64_t* atlasdst = ((uint64_t*)mAtlasData.data() + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
-                        for (int pixz = 0; pixz < kBrickSize; ++pixz)
-                        {
-                            for (int tiley = 0; tiley < kBrickSize; tiley += 4)
-                            {
-                                for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
-                                    uint8_t tilevals[4][4];
-                                    uint8_t tileminorant = 255, tilemajorant = 0;
-                                    for (int pixy = 0; pixy < 4; ++pixy)
-                                    {
-                                        for (int pixx = 0; pixx < 4; ++pixx)
-                                        {
-                                            float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
-                                            uint8_t voxel = uint8_t((f - minorant) * invRange);
-                                            tileminorant = std::min(tileminorant, voxel);
-                                            tilemajorant = std::max(tilemajorant, voxel);
-                                            tilevals[pixy][pixx] = voxel;
-                                        }
-                                    }
-                                    CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
-                                    atlasdst++;
-                                }
-                                atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
-                            }
-                            atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
-                        } // z slice loop
-                    } // bc4 compress?
-                } // non empty brick?
+                    *ptrdst++ = 1; // mark as non-empty, the brick is assigned in assignSliceBricks()
+                    nonEmptyCount++;
+                }
             } // x brick loop
         } // y brick loop
+        return nonEmptyCount;
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::assignSliceBricks(int z, uint32_t firstBrick)
+    {
+        // Bricks are assigned in leaf scan order, starting at the first brick of the slice.
+        const uint32_t bricksPerSlice = mAtlasSizeBricks.x * mAtlasSizeBricks.y;
+        uint32_t brick = firstBrick;
+        for (uint32_t leafIndex = getLeafIndex(0, 0, z); leafIndex < getLeafIndex(0, 0, z + 1); ++leafIndex)
+        {
+            if (mPtrData[leafIndex] == 0) continue;
+            uint32_t atlasx = brick % mAtlasSizeBricks.x;
+            uint32_t atlasy = (brick / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
+            uint32_t atlasz = brick / bricksPerSlice;
+            mPtrData[leafIndex] = (atlasx + (atlasy << 8) + (atlasz << 16));
+            mBrickLeafIndex[brick++] = leafIndex;
+        }
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
-    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMip(int mip)
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::computeMipSlice(int mip, int z)
     {
-        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1];
-        uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0);
         int3 leafdim_src = mLeafDim[mip - 1];
         uint32_t rowstride_src = leafdim_src.x;
         uint32_t slicestride_src = leafdim_src.y * rowstride_src;
@@ -260,42 +229,157 @@ namespace Falcor
         uint32_t rowstride_tgt = leafdim_tgt.x;
         uint32_t slicestride_tgt = leafdim_tgt.y * rowstride_tgt;
 
-        for (int z = 0; z < leafdim_tgt.z; ++z, rangesrc += slicestride_src)
+        uint32_t* rangedst = mRangeData.data() + mLeafCount[mip - 1] + z * slicestride_tgt;
+        const uint32_t* rangesrc = mRangeData.data() + ((mip > 1) ? mLeafCount[mip - 2] : 0) + 2 * z * slicestride_src;
+
+        for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
         {
-            for (int y = 0; y < leafdim_tgt.y; ++y, rangesrc += rowstride_src)
+            for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
             {
-                for (int x = 0; x < leafdim_tgt.x; ++x, rangesrc += 2)
+                float2 majmin_dst = combineMajMin(
+                    combineMajMin(
+                        combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
+                        combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
+                    ),
+                    combineMajMin(
+                        combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
+                        combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
+                    )
+                );
+                *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
+            } // x
+        } // y
+    }
+
+    template <typename TexelType, unsigned int kBitsPerTexel>
+    void NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::encodeBrick(uint32_t brick, uint32_t firstAtlasSlice, TexelType* pBatchData)
+    {
+        uint3 atlasSizePixels = getAtlasSizePixels();
+        uint32_t bricksPerSlice = mAtlasSizeBricks.x * mAtlasSizeBricks.y;
+        uint32_t pixelsPerSlice = atlasSizePixels.x * atlasSizePixels.y;
+
+        // Find the leaf of the brick.
+        uint32_t leafIndex = mBrickLeafIndex[brick];
+        int x = leafIndex % mLeafDim[0].x;
+        int y = (leafIndex / mLeafDim[0].x) % mLeafDim[0].y;
+        int z = leafIndex / (mLeafDim[0].x * mLeafDim[0].y);
+        nanovdb::Coord ijk = { x * 8 + mBBMin.x, y * 8 + mBBMin.y, z * 8 + mBBMin.z };
+        auto a = mpFloatGrid->getAccessor();
+        auto leaf = a.probeLeaf(ijk);
+        FALCOR_ASSERT(leaf);
+        const float* data = leaf->data()->mValues;
+
+        // Use the exact range stored in the range texture.
+        float2 majmin = unpackMajMin(&mRangeData[leafIndex]);
+        float majorant = majmin.x;
+        float minorant = majmin.y;
+
+        // Brick location relative to the first atlas slice of the batch.
+        uint32_t atlasx = brick % mAtlasSizeBricks.x;
+        uint32_t atlasy = (brick / mAtlasSizeBricks.x) % mAtlasSizeBricks.y;
+        uint32_t atlasz = brick / bricksPerSlice - firstAtlasSlice;
+
+        if (!kBC4Compress) {
+            float invRange = ((1 << kBitsPerTexel) - 1.f) / (majorant - minorant);
+            TexelType* atlasdst = pBatchData + atlasx * kBrickSize + atlasy * (atlasSizePixels.x * kBrickSize) + atlasz * (pixelsPerSlice * kBrickSize);
+            for (int pixz = 0; pixz < kBrickSize; ++pixz)
+            {
+                for (int pixy = 0; pixy < kBrickSize; ++pixy)
+                {
+                    for (int pixx = 0; pixx < kBrickSize; ++pixx)
+                    {
+                        float f = data[pixx * kBrickSize * kBrickSize + pixy * kBrickSize + pixz];
+                        *atlasdst++ = TexelType((f - minorant) * invRange);
+                    }
+                    atlasdst += (atlasSizePixels.x - kBrickSize); // next scanline
+                }
+                atlasdst += (pixelsPerSlice - (atlasSizePixels.x * kBrickSize)); // next slice
+            }
+        }
+        else {
+            // BC4 compression:
+            float invRange = (255.f) / (majorant - minorant);
+            uint64_t* atlasdst = ((uint64_t*)pBatchData + atlasx * (kBrickSize / 4) + atlasy * ((atlasSizePixels.x / 4) * kBrickSize / 4) + atlasz * (pixelsPerSlice / 16 * kBrickSize));
+            for (int pixz = 0; pixz < kBrickSize; ++pixz)
+            {
+                for (int tiley = 0; tiley < kBrickSize; tiley += 4)
                 {
-                    float2 majmin_dst = combineMajMin(
-                        combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc), unpackMajMin(rangesrc + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + rowstride_src), unpackMajMin(rangesrc + 1 + rowstride_src))
-                        ),
-                        combineMajMin(
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src), unpackMajMin(rangesrc + slicestride_src + 1)),
-                            combineMajMin(unpackMajMin(rangesrc + slicestride_src + rowstride_src), unpackMajMin(rangesrc + slicestride_src + 1 + rowstride_src))
-                        )
-                    );
-                    *rangedst++ = f32tof16(majmin_dst.x) + (f32tof16(majmin_dst.y) << 16);
-                } // x
-            } // y
-        } // z
+                    for (int tilex = 0; tilex < kBrickSize; tilex += 4) {
+                        uint8_t tilevals[4][4];
+                        for (int pixy = 0; pixy < 4; ++pixy)
+                        {
+                            for (int pixx = 0; pixx < 4; ++pixx)
+                            {
+                                float f = data[(pixx + tilex) * (kBrickSize * kBrickSize) + (pixy + tiley) * kBrickSize + pixz];
+                                tilevals[pixy][pixx] = uint8_t((f - minorant) * invRange);
+                            }
+                        }
+                        CompressAlphaDxt5((uint8_t*)&tilevals[0][0], atlasdst);
+                        atlasdst++;
+                    }
+                    atlasdst += (atlasSizePixels.x / 4 - kBrickSize / 4); // next scanline
+                }
+                atlasdst += (pixelsPerSlice / 16 - (atlasSizePixels.x / 4 * kBrickSize / 4)); // next slice
+            } // z slice loop
+        } // bc4 compress?
     }
 
     template <typename TexelType, unsigned int kBitsPerTexel>
     BrickedGrid NanoVDBToBricksConverter<TexelType, kBitsPerTexel>::convert(Device* pDevice)
     {
         auto t0 = CpuTimer::getCurrentTimePoint();
-        auto range = NumericRange<int>(0, mLeafDim[0].z);
-        std::for_each(std::execution::par, range.begin(), range.end(), [&](int z) { convertSlice(z); });
-        for (int mip = 1; mip < 4; ++mip) computeMip(mip);
-        double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
-        logInfo("converted in {}ms: mNonEmptyCount {} vs max {}", dt, mNonEmptyCount, getAtlasMaxBrick());
+
+        // Compute the value ranges of all leaves at mip 0.
+        std::vector<uint32_t> sliceBrickOffsets(mLeafDim[0].z + 1, 0);
+        Threading::parallelFor(0, mLeafDim[0].z, [&](size_t z) { sliceBrickOffsets[z + 1] = computeSliceRanges(int(z)); }, 1);
+
+        // Allocate the non-empty leaves in the atlas. The first 2 dimensions are chosen to be powers of 2.
+        for (int z = 0; z < mLeafDim[0].z; ++z) sliceBrickOffsets[z + 1] += sliceBrickOffsets[z];
+        mBrickCount = sliceBrickOffsets.back();
+        uint approxdim = 1u << uint(log2f((float)mBrickCount + 1.f) / 3.f);
+        uint lastdim = std::max(1u, (mBrickCount + approxdim * approxdim - 1) / (approxdim * approxdim));
+        mAtlasSizeBricks = uint3(approxdim, approxdim, lastdim);
+        mBrickLeafIndex.resize(mBrickCount);
+        Threading::parallelFor(0, mLeafDim[0].z, [&](size_t z) { assignSliceBricks(int(z), sliceBrickOffsets[z]); }, 1);
+
+        // Reduce the ranges to the coarser mips. Each mip depends on the previous one, but its slices are independent.
+        for (int mip = 1; mip < 4; ++mip)
+        {
+            Threading::parallelFor(0, mLeafDim[mip].z, [&](size_t z) { computeMipSlice(mip, int(z)); }, 1);
+        }
 
         BrickedGrid bricks;
         bricks.range = Texture::create3D(pDevice, mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RG16Float, 4, mRangeData.data(), ResourceBindFlags::ShaderResource, false);
         bricks.indirection = Texture::create3D(pDevice, mLeafDim[0].x, mLeafDim[0].y, mLeafDim[0].z, ResourceFormat::RGBA8Uint, 1, mPtrData.data(), ResourceBindFlags::ShaderResource, false);
-        bricks.atlas = Texture::create3D(pDevice, getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, mAtlasData.data(), ResourceBindFlags::ShaderResource, false);
+        bricks.atlas = Texture::create3D(pDevice, getAtlasSizePixels().x, getAtlasSizePixels().y, getAtlasSizePixels().z, getAtlasFormat(), 1, nullptr, ResourceBindFlags::ShaderResource, false);
+
+        // Encode and upload the atlas in batches of whole atlas slices to bound the host memory usage.
+        RenderContext* pRenderContext = pDevice->getRenderContext();
+        const uint32_t bricksPerSlice = mAtlasSizeBricks.x * mAtlasSizeBricks.y;
+        const size_t sliceTexelCount = getAtlasSliceTexelCount();
+        const uint32_t slicesPerBatch = (uint32_t)std::clamp<size_t>(kMaxBatchByteSize / (sliceTexelCount * sizeof(TexelType)), 1, mAtlasSizeBricks.z);
+        std::vector<TexelType> batchData(slicesPerBatch * sliceTexelCount);
+
+        for (uint32_t firstSlice = 0; firstSlice < mAtlasSizeBricks.z; firstSlice += slicesPerBatch)
+        {
+            uint32_t sliceCount = std::min(slicesPerBatch, mAtlasSizeBricks.z - firstSlice);
+            uint32_t firstBrick = firstSlice * bricksPerSlice;
+            uint32_t lastBrick = std::min(mBrickCount, (firstSlice + sliceCount) * bricksPerSlice);
+
+            // Clear unused bricks at the end of the atlas.
+            if (lastBrick < (firstSlice + sliceCount) * bricksPerSlice) std::fill(batchData.begin(), batchData.end(), TexelType(0));
+
+            Threading::parallelFor(firstBrick, lastBrick, [&](size_t brick) { encodeBrick(uint32_t(brick), firstSlice, batchData.data()); });
+
+            uint3 offset(0, 0, firstSlice * kBrickSize);
+            uint3 size(getAtlasSizePixels().x, getAtlasSizePixels().y, sliceCount * kBrickSize);
+            pRenderContext->updateSubresourceData(bricks.atlas.get(), 0, batchData.data(), offset, size);
+            pRenderContext->flush(false);
+        }
+
+        double dt = CpuTimer::calcDuration(t0, CpuTimer::getCurrentTimePoint());
+        logInfo("Converted NanoVDB grid in {}ms: {} non-empty bricks of {} leaves.", dt, mBrickCount, mLeafCount[0]);
+
         return bricks;
     }
 }
@@ -392,13 +392,30 @@ namespace Falcor
             return GridVolume::create(getActivePythonSceneBuilder().getDevice(), name);
         };
         volume.def(pybind11::init(create), "name"_a); // PYTHONDEPRECATED
-        volume.def("loadGrid", &GridVolume::loadGrid, "slot"_a, "path"_a, "gridname"_a);
-        volume.def("loadGridSequence",
-            pybind11::overload_cast<GridVolume::GridSlot, const std::vector<std::filesystem::path>&, const std::string&, bool>(&GridVolume::loadGridSequence),
-            "slot"_a, "paths"_a, "gridname"_a, "keepEmpty"_a = true);
-        volume.def("loadGridSequence",
-            pybind11::overload_cast<GridVolume::GridSlot, const std::filesystem::path&, const std::string&, bool>(&GridVolume::loadGridSequence),
-            "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
+        auto loadGrid = [] (GridVolume* pVolume, GridVolume::GridSlot slot, const std::filesystem::path& path, const std::string& gridname)
+        {
+            addActivePythonSceneDependency(path);
+            return pVolume->loadGrid(slot, path, gridname);
+        };
+        volume.def("loadGrid", loadGrid, "slot"_a, "path"_a, "gridname"_a);
+        auto loadGridSequence = [] (GridVolume* pVolume, GridVolume::GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty)
+        {
+            for (const auto& path : paths) addActivePythonSceneDependency(path);
+            return pVolume->loadGridSequence(slot, paths, gridname, keepEmpty);
+        };
+        volume.def("loadGridSequence", loadGridSequence, "slot"_a, "paths"_a, "gridname"_a, "keepEmpty"_a = true);
+        auto loadGridSequenceFromDirectory = [] (GridVolume* pVolume, GridVolume::GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
+        {
+            // Depend on the directory itself to detect added or removed grid files.
+            addActivePythonSceneDependency(path);
+            std::filesystem::path fullPath;
+            if (findFileInDataDirectories(path, fullPath) && std::filesystem::is_directory(fullPath))
+            {
+                for (const auto& entry : std::filesystem::directory_iterator(fullPath)) addActivePythonSceneDependency(entry.path());
+            }
+            return pVolume->loadGridSequence(slot, path, gridname, keepEmpty);
+        };
+        volume.def("loadGridSequence", loadGridSequenceFromDirectory, "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
 
         pybind11::enum_<GridVolume::GridSlot> gridSlot(volume, "GridSlot");
         gridSlot.value("Density", GridVolume::GridSlot::Density);
@@ -0,0 +1,192 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "AsyncImageDecoder.h"
+#include "Core/Assert.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuEventRecorder.h"
+
+namespace Falcor
+{
+    AsyncImageDecoder::AsyncImageDecoder(size_t threadCount, size_t memoryBudget, DecodeFunction decodeFunc)
+        : mDecodeFunc(std::move(decodeFunc))
+        , mMemoryBudget(memoryBudget)
+    {
+        if (!mDecodeFunc)
+        {
+            mDecodeFunc = [](const std::filesystem::path& path) { return Bitmap::createFromFile(path, true /* top-down */); };
+        }
+
+        threadCount = std::max<size_t>(threadCount, 1);
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            mThreads.emplace_back(&AsyncImageDecoder::runWorker, this);
+        }
+    }
+
+    AsyncImageDecoder::~AsyncImageDecoder()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+
+        mCondition.notify_all();
+
+        for (auto& thread : mThreads) thread.join();
+    }
+
+    AsyncImageDecoder::RequestID AsyncImageDecoder::decode(const std::filesystem::path& path, int32_t priority, CompletionCallback callback)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const RequestID id = mNextRequestID++;
+        mRequests.emplace(id, Request{ path, priority, std::move(callback) });
+        mQueue.insert(QueueEntry{ priority, id });
+        mCondition.notify_all();
+        return id;
+    }
+
+    bool AsyncImageDecoder::setPriority(RequestID id, int32_t priority)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mRequests.find(id);
+        if (it == mRequests.end()) return false;
+
+        mQueue.erase(QueueEntry{ it->second.priority, id });
+        it->second.priority = priority;
+        mQueue.insert(QueueEntry{ priority, id });
+        return true;
+    }
+
+    bool AsyncImageDecoder::cancel(RequestID id)
+    {
+        Request request;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mRequests.find(id);
+            if (it == mRequests.end()) return false;
+
+            mQueue.erase(QueueEntry{ it->second.priority, id });
+            request = std::move(it->second);
+            mRequests.erase(it);
+        }
+
+        if (request.callback) request.callback(nullptr, true);
+
+        mCondition.notify_all();
+        return true;
+    }
+
+    void AsyncImageDecoder::release(size_t byteSize)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            FALCOR_ASSERT(byteSize <= mDecodedByteSize);
+            mDecodedByteSize -= std::min(byteSize, mDecodedByteSize);
+        }
+
+        mCondition.notify_all();
+    }
+
+    void AsyncImageDecoder::waitForAll()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [&]() { return mRequests.empty() && mActiveCount == 0; });
+    }
+
+    size_t AsyncImageDecoder::getRequestCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mRequests.size() + mActiveCount;
+    }
+
+    size_t AsyncImageDecoder::getDecodedByteSize() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mDecodedByteSize;
+    }
+
+    void AsyncImageDecoder::runWorker()
+    {
+        // This function is the entry point for worker threads.
+        // The workers wait until there is a pending request and the memory budget allows decoding it.
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+
+            // A single image larger than the budget is still decoded when no other decoded memory is held.
+            // The budget is ignored when terminating, as the consumer may no longer release memory at that point.
+            auto hasBudget = [&]() { return mTerminate || mDecodedByteSize == 0 || mDecodedByteSize < mMemoryBudget; };
+            mCondition.wait(lock, [&]() { return (mTerminate && mQueue.empty()) || (!mQueue.empty() && hasBudget()); });
+
+            // Terminate thread once all requests have been started.
+            if (mQueue.empty()) break;
+
+            // Pop the highest priority request.
+            const RequestID id = mQueue.begin()->id;
+            mQueue.erase(mQueue.begin());
+            auto it = mRequests.find(id);
+            FALCOR_ASSERT(it != mRequests.end());
+            Request request = std::move(it->second);
+            mRequests.erase(it);
+            ++mActiveCount;
+
+            lock.unlock();
+
+            // Decode the image (this part is running in parallel).
+            Bitmap::UniqueConstPtr pBitmap;
+            try
+            {
+                FALCOR_PROFILE_CPU("decodeImage");
+                pBitmap = mDecodeFunc(request.path);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to decode image '{}': {}", request.path, e.what());
+            }
+
+            // The decoded memory is accounted for until the consumer releases it.
+            if (request.callback)
+            {
+                if (pBitmap)
+                {
+                    lock.lock();
+                    mDecodedByteSize += pBitmap->getSize();
+                    lock.unlock();
+                }
+                request.callback(std::move(pBitmap), false);
+            }
+
+            lock.lock();
+            --mActiveCount;
+            lock.unlock();
+
+            mCondition.notify_all();
+        }
+    }
+}
@@ -0,0 +1,170 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "Core/Macros.h"
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+    /** Utility class to decode image files to bitmaps asynchronously using multiple worker threads.
+
+        This is the CPU stage of the AsyncTextureLoader. It does not use the GPU, so it can be used and tested on its own.
+
+        Requests are decoded in priority order (higher priorities first, FIFO for equal priorities).
+        Pending requests can be re-prioritized or cancelled until a worker starts decoding them.
+
+        To bound host memory usage, the decoder keeps track of the size of all decoded bitmaps that have
+        not been released by the consumer. Workers do not start decoding while this exceeds the memory budget,
+        so at most one bitmap per worker is decoded on top of the budget. Consumers must call release()
+        with the bitmap size once they are done with a decoded bitmap.
+    */
+    class FALCOR_API AsyncImageDecoder
+    {
+    public:
+        using RequestID = uint64_t;
+
+        /** Function decoding an image file. Called on a worker thread.
+            \param[in] path File path of the image.
+            \return The decoded bitmap, or nullptr if decoding failed.
+        */
+        using DecodeFunction = std::function<Bitmap::UniqueConstPtr(const std::filesystem::path& path)>;
+
+        /** Function called when a request has completed.
+            This is called on a worker thread, or on the thread calling cancel() for cancelled requests.
+            \param[in] pBitmap The decoded bitmap, or nullptr if decoding failed or the request was cancelled.
+                The size of the bitmap is accounted against the memory budget until release() is called.
+            \param[in] cancelled True if the request was cancelled.
+        */
+        using CompletionCallback = std::function<void(Bitmap::UniqueConstPtr pBitmap, bool cancelled)>;
+
+        static constexpr size_t kDefaultMemoryBudget = size_t(2) << 30; ///< 2 GB of decoded images.
+
+        /** Constructor.
+            \param[in] threadCount Number of worker threads.
+            \param[in] memoryBudget Maximum size in bytes of decoded bitmaps that have not been released before workers stop decoding.
+            \param[in] decodeFunc Function decoding an image file. If empty, the image is loaded using Bitmap::createFromFile().
+        */
+        AsyncImageDecoder(size_t threadCount, size_t memoryBudget = kDefaultMemoryBudget, DecodeFunction decodeFunc = {});
+
+        /** Destructor.
+            Blocks until all pending requests have been decoded and all threads have terminated.
+            The memory budget is not enforced for requests that are still pending at this point.
+        */
+        ~AsyncImageDecoder();
+
+        AsyncImageDecoder(const AsyncImageDecoder&) = delete;
+        AsyncImageDecoder& operator=(const AsyncImageDecoder&) = delete;
+
+        /** Request decoding an image file.
+            \param[in] path File path of the image.
+            \param[in] priority Priority of the request. Requests with higher priority are decoded first.
+            \param[in] callback Function called once the request has completed.
+            \return ID of the request.
+        */
+        RequestID decode(const std::filesystem::path& path, int32_t priority, CompletionCallback callback);
+
+        /** Change the priority of a pending request.
+            \param[in] id ID of the request.
+            \param[in] priority New priority.
+            \return True if the request was pending, false if it has already been started or completed.
+        */
+        bool setPriority(RequestID id, int32_t priority);
+
+        /** Cancel a pending request. The completion callback is called with a nullptr bitmap before this returns.
+            \param[in] id ID of the request.
+            \return True if the request was cancelled, false if it has already been started or completed.
+        */
+        bool cancel(RequestID id);
+
+        /** Release decoded memory, allowing workers to continue decoding if the memory budget was exhausted.
+            \param[in] byteSize Size of a bitmap returned to the completion callback.
+        */
+        void release(size_t byteSize);
+
+        /** Block until all pending requests have completed.
+        */
+        void waitForAll();
+
+        /** Returns the number of requests that are pending or being decoded.
+        */
+        size_t getRequestCount() const;
+
+        /** Returns the size in bytes of decoded bitmaps that have not been released.
+        */
+        size_t getDecodedByteSize() const;
+
+        /** Returns the memory budget in bytes.
+        */
+        size_t getMemoryBudget() const { return mMemoryBudget; }
+
+    private:
+        void runWorker();
+
+        struct Request
+        {
+            std::filesystem::path path;
+            int32_t priority = 0;
+            CompletionCallback callback;
+        };
+
+        struct QueueEntry
+        {
+            int32_t priority;
+            RequestID id;
+
+            bool operator<(const QueueEntry& other) const
+            {
+                return priority != other.priority ? priority > other.priority : id < other.id;
+            }
+        };
+
+        DecodeFunction mDecodeFunc;
+        size_t mMemoryBudget;
+
+        mutable std::mutex mMutex;                      ///< Mutex for synchronizing access to shared resources.
+        std::condition_variable mCondition;             ///< Condition variable for workers and waiting threads.
+        std::vector<std::thread> mThreads;              ///< Worker threads.
+
+        // Internal state. Do not access outside of critical section.
+        std::unordered_map<RequestID, Request> mRequests; ///< Pending requests.
+        std::set<QueueEntry> mQueue;                    ///< Pending requests in decoding order.
+        RequestID mNextRequestID = 0;                   ///< ID of the next request.
+        size_t mActiveCount = 0;                        ///< Number of requests being decoded.
+        size_t mDecodedByteSize = 0;                    ///< Size of decoded bitmaps that have not been released.
+        bool mTerminate = false;                        ///< Flag to terminate worker threads.
+    };
+}
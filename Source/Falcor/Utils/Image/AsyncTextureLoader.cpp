@@ -26,88 +26,180 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "AsyncTextureLoader.h"
+#include "ImageIO.h"
 #include "Core/API/Device.h"
-#include "Utils/Threading.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuEventRecorder.h"
 
 namespace Falcor
 {
     namespace
     {
         constexpr size_t kUploadsPerFlush = 16; ///< Number of texture uploads before issuing a flush (to keep upload heap from growing).
+        constexpr size_t kUploadByteSizePerFlush = size_t(512) << 20; ///< Number of uploaded bytes before issuing a flush.
+
+        /** Decodes an image file for upload. DDS files contain GPU-ready data and are loaded directly by the upload thread.
+        */
+        Bitmap::UniqueConstPtr decodeImage(const std::filesystem::path& path)
+        {
+            if (hasExtension(path, "dds")) return nullptr;
+            return Bitmap::createFromFile(path, true /* top-down */);
+        }
     }
 
-    AsyncTextureLoader::AsyncTextureLoader(std::shared_ptr<Device> pDevice, size_t threadCount)
+    AsyncTextureLoader::AsyncTextureLoader(std::shared_ptr<Device> pDevice, size_t threadCount, size_t memoryBudget)
         : mpDevice(std::move(pDevice))
     {
-        runWorkers(threadCount);
+        mUploadThread = std::thread(&AsyncTextureLoader::runUploader, this);
+        mpDecoder = std::make_unique<AsyncImageDecoder>(threadCount, memoryBudget, decodeImage);
     }
 
     AsyncTextureLoader::~AsyncTextureLoader()
     {
-        terminateWorkers();
+        // Decode all pending requests first. The upload thread keeps running to release the decoded memory.
+        mpDecoder->waitForAll();
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTerminate = true;
+        }
+
+        mCondition.notify_all();
+        mUploadThread.join();
+
+        mpDecoder.reset();
 
         mpDevice->flushAndSync();
     }
 
-    std::future<Texture::SharedPtr> AsyncTextureLoader::loadFromFile(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, LoadCallback callback)
+    std::future<Texture::SharedPtr> AsyncTextureLoader::loadFromFile(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSrgb, Resource::BindFlags bindFlags, LoadCallback callback, int32_t priority)
     {
+        LoadRequest request{ path, generateMipLevels, loadAsSrgb, bindFlags, callback };
+        auto future = request.promise.get_future();
+
         std::lock_guard<std::mutex> lock(mMutex);
-        mLoadRequestQueue.push(LoadRequest{path, generateMipLevels, loadAsSrgb, bindFlags, callback });
-        mCondition.notify_one();
-        return mLoadRequestQueue.back().promise.get_future();
+
+        // Requests for missing files are completed by the upload thread to keep the callback off the calling thread.
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(path, fullPath))
+        {
+            logWarning("Error when loading image file. Can't find image file '{}'.", path);
+            mUploadQueue.push(UploadRequest{ std::move(request), nullptr });
+            mCondition.notify_one();
+            return future;
+        }
+        request.path = fullPath;
+
+        // Issue the decode request. The decoder doesn't call back into the loader before this function has released the lock.
+        const uint64_t requestID = mNextRequestID++;
+        request.decodeRequestID = mpDecoder->decode(fullPath, priority, [this, requestID](Bitmap::UniqueConstPtr pBitmap, bool cancelled)
+        {
+            onDecoded(requestID, std::move(pBitmap), cancelled);
+        });
+        mDecodeRequests.emplace(requestID, std::move(request));
+
+        return future;
     }
 
-    void AsyncTextureLoader::runWorkers(size_t threadCount)
+    void AsyncTextureLoader::setPriority(const std::filesystem::path& path, int32_t priority)
     {
-        // Create a barrier to synchronize worker threads before issuing a global flush.
-        mFlushBarrier = std::make_shared<Barrier>(threadCount, [&]() {
-            mpDevice->flushAndSync();
-            mFlushPending = false;
-            mUploadCounter = 0;
-            });
-
-        for (size_t i = 0; i < threadCount; ++i)
+        for (auto id : findDecodeRequests(path)) mpDecoder->setPriority(id, priority);
+    }
+
+    void AsyncTextureLoader::cancel(const std::filesystem::path& path)
+    {
+        for (auto id : findDecodeRequests(path)) mpDecoder->cancel(id);
+    }
+
+    std::vector<AsyncImageDecoder::RequestID> AsyncTextureLoader::findDecodeRequests(const std::filesystem::path& path)
+    {
+        std::filesystem::path fullPath;
+        if (!findFileInDataDirectories(path, fullPath)) return {};
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::vector<AsyncImageDecoder::RequestID> ids;
+        for (const auto& [requestID, request] : mDecodeRequests)
         {
-            mThreads.emplace_back(&AsyncTextureLoader::runWorker, this);
+            if (request.path == fullPath) ids.push_back(request.decodeRequestID);
         }
+        return ids;
     }
 
-    void AsyncTextureLoader::runWorker()
+    void AsyncTextureLoader::onDecoded(uint64_t requestID, Bitmap::UniqueConstPtr pBitmap, bool cancelled)
     {
-        // This function is the entry point for worker threads.
-        // The workers wait on the load request queue and load a texture when woken up.
-        // To avoid the upload heap growing too large, we synchronize the threads and
-        // issue a global GPU flush at regular intervals.
+        // This function is called by the decoder threads, or by the thread cancelling the request.
+        std::unique_lock<std::mutex> lock(mMutex);
+        auto it = mDecodeRequests.find(requestID);
+        FALCOR_ASSERT(it != mDecodeRequests.end());
+        LoadRequest request = std::move(it->second);
+        mDecodeRequests.erase(it);
+
+        if (cancelled)
+        {
+            lock.unlock();
+            request.promise.set_value(nullptr);
+            if (request.callback) request.callback(nullptr);
+            return;
+        }
+
+        // Pass the decoded image on to the upload thread.
+        mUploadQueue.push(UploadRequest{ std::move(request), std::move(pBitmap) });
+        mCondition.notify_one();
+    }
+
+    void AsyncTextureLoader::runUploader()
+    {
+        // This function is the entry point for the upload thread.
+        // It creates the textures from the decoded images in the order they finished decoding.
+        // To avoid the upload heap growing too large, we issue a global GPU flush at regular intervals.
 
         while (true)
         {
             // Wait on condition until more work is ready.
             std::unique_lock<std::mutex> lock(mMutex);
-            mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty() || mFlushPending; });
-
-            // Sync thread if a flush is pending.
-            if (mFlushPending)
-            {
-                lock.unlock();
-                mFlushBarrier->wait();
-                mCondition.notify_one();
-                continue;
-            }
+            mCondition.wait(lock, [&]() { return mTerminate || !mUploadQueue.empty(); });
 
             // Terminate thread unless there is more work to do.
-            if (mTerminate && mLoadRequestQueue.empty() && !mFlushPending) break;
+            if (mUploadQueue.empty()) break;
 
-            // Go back waiting if queue is currently empty.
-            if (mLoadRequestQueue.empty()) continue;
-
-            // Pop next load request from queue.
-            auto request = std::move(mLoadRequestQueue.front());
-            mLoadRequestQueue.pop();
+            UploadRequest upload = std::move(mUploadQueue.front());
+            mUploadQueue.pop();
 
             lock.unlock();
 
-            // Load the textures (this part is running in parallel).
-            Texture::SharedPtr pTexture = Texture::createFromFile(mpDevice.get(), request.path, request.generateMipLevels, request.loadAsSRGB, request.bindFlags);
+            LoadRequest& request = upload.request;
+            Texture::SharedPtr pTexture;
+            size_t byteSize = 0;
+            if (upload.pBitmap)
+            {
+                FALCOR_PROFILE_CPU("uploadTexture");
+                const Bitmap& bitmap = *upload.pBitmap;
+                ResourceFormat texFormat = request.loadAsSRGB ? linearToSrgbFormat(bitmap.getFormat()) : bitmap.getFormat();
+                pTexture = Texture::create2D(
+                    mpDevice.get(), bitmap.getWidth(), bitmap.getHeight(), texFormat, 1, request.generateMipLevels ? Texture::kMaxPossible : 1,
+                    bitmap.getData(), request.bindFlags
+                );
+
+                // The image data has been copied to the upload heap, so the decoded memory can be released.
+                byteSize = bitmap.getSize();
+                upload.pBitmap.reset();
+                mpDecoder->release(byteSize);
+            }
+            else if (hasExtension(request.path, "dds"))
+            {
+                try
+                {
+                    pTexture = ImageIO::loadTextureFromDDS(mpDevice.get(), request.path, request.loadAsSRGB);
+                }
+                catch (const std::exception& e)
+                {
+                    logWarning("Error loading '{}': {}", request.path, e.what());
+                }
+            }
+
+            if (pTexture) pTexture->setSourcePath(request.path);
+
             request.promise.set_value(pTexture);
 
             if (request.callback)
@@ -115,30 +207,18 @@ namespace Falcor
                 request.callback(pTexture);
             }
 
-            lock.lock();
-
             // Issue a global flush if necessary.
-            // TODO: It would be better to check the size of the upload heap instead.
-            if (!mTerminate && pTexture != nullptr &&
-                ++mUploadCounter >= kUploadsPerFlush)
+            if (pTexture)
             {
-                mFlushPending = true;
-                mCondition.notify_all();
+                ++mUploadCounter;
+                mUploadByteSize += byteSize;
+            }
+            if (mUploadCounter >= kUploadsPerFlush || mUploadByteSize >= kUploadByteSizePerFlush)
+            {
+                mpDevice->flushAndSync();
+                mUploadCounter = 0;
+                mUploadByteSize = 0;
             }
-
-            mCondition.notify_one();
-        }
-    }
-
-    void AsyncTextureLoader::terminateWorkers()
-    {
-        {
-            std::lock_guard<std::mutex> lock(mMutex);
-            mTerminate = true;
         }
-
-        mCondition.notify_all();
-
-        for (auto& thread : mThreads) thread.join();
     }
 }
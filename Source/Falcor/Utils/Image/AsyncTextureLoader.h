@@ -26,6 +26,8 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "AsyncImageDecoder.h"
+#include "Bitmap.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
@@ -34,16 +36,21 @@
 #include <filesystem>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace Falcor
 {
-    class Barrier;
+    /** Utility class to load textures asynchronously.
 
-    /** Utility class to load textures asynchronously using multiple worker threads.
+        Loading is split into two stages. Image files are decoded to bitmaps by an AsyncImageDecoder
+        using multiple worker threads, in priority order and within a host memory budget.
+        The decoded bitmaps are then uploaded to the GPU by a single upload thread, which also
+        issues a GPU flush at regular intervals. The decoders never wait on the GPU.
     */
     class FALCOR_API AsyncTextureLoader
     {
@@ -51,12 +58,13 @@ namespace Falcor
         using LoadCallback = std::function<void(Texture::SharedPtr pTexture)>;
 
         /** Constructor.
-            \param[in] threadCount Number of worker threads.
+            \param[in] threadCount Number of decoding worker threads.
+            \param[in] memoryBudget Maximum size in bytes of decoded images waiting to be uploaded before decoding is paused.
         */
-        AsyncTextureLoader(std::shared_ptr<Device> pDevice, size_t threadCount = std::thread::hardware_concurrency());
+        AsyncTextureLoader(std::shared_ptr<Device> pDevice, size_t threadCount = std::thread::hardware_concurrency(), size_t memoryBudget = AsyncImageDecoder::kDefaultMemoryBudget);
 
         /** Destructor.
-            Blocks until all threads have terminated.
+            Blocks until all requests have completed and all threads have terminated.
         */
         ~AsyncTextureLoader();
 
@@ -66,20 +74,34 @@ namespace Falcor
             \param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
             \param[in] bindFlags The bind flags for the texture resource.
             \param[in] callback Function called after the texture load has finished.
-            \return A future to a new texture, or nullptr if the texture failed to load.
+            \param[in] priority Priority of the request. Requests with higher priority are loaded first.
+            \return A future to a new texture, or nullptr if the texture failed to load or the request was cancelled.
         */
         std::future<Texture::SharedPtr> loadFromFile(
             const std::filesystem::path& path,
             bool generateMipLevels,
             bool loadAsSRGB,
             Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource,
-            LoadCallback callback = {}
+            LoadCallback callback = {},
+            int32_t priority = 0
         );
 
+        /** Change the priority of all requests for a texture file that have not started decoding yet.
+            \param[in] path File path of the texture.
+            \param[in] priority New priority.
+        */
+        void setPriority(const std::filesystem::path& path, int32_t priority);
+
+        /** Cancel all requests for a texture file that have not started decoding yet.
+            Cancelled requests complete with a nullptr texture.
+            \param[in] path File path of the texture.
+        */
+        void cancel(const std::filesystem::path& path);
+
     private:
-        void runWorkers(size_t threadCount);
-        void runWorker();
-        void terminateWorkers();
+        void runUploader();
+        void onDecoded(uint64_t requestID, Bitmap::UniqueConstPtr pBitmap, bool cancelled);
+        std::vector<AsyncImageDecoder::RequestID> findDecodeRequests(const std::filesystem::path& path);
 
         struct LoadRequest
         {
@@ -89,20 +111,30 @@ namespace Falcor
             Resource::BindFlags bindFlags;
             LoadCallback callback;
             std::promise<Texture::SharedPtr> promise;
+            AsyncImageDecoder::RequestID decodeRequestID = 0;
+        };
+
+        struct UploadRequest
+        {
+            LoadRequest request;
+            Bitmap::UniqueConstPtr pBitmap;         ///< Decoded image, or nullptr for DDS files and failed requests.
         };
 
         std::shared_ptr<Device> mpDevice;
 
         std::mutex mMutex;                          ///< Mutex for synchronizing access to shared resources.
-        std::condition_variable mCondition;         ///< Condition variable for workers to wait on.
-        std::shared_ptr<Barrier> mFlushBarrier;     ///< Barrier for flushing the GPU to upload textures.
-        std::vector<std::thread> mThreads;          ///< Worker threads.
+        std::condition_variable mCondition;         ///< Condition variable for the upload thread to wait on.
+        std::thread mUploadThread;                  ///< Upload thread.
+        std::unique_ptr<AsyncImageDecoder> mpDecoder; ///< Decoding stage.
 
         // Internal state. Do not access outside of critical section.
-        std::queue<LoadRequest> mLoadRequestQueue;  ///< Texture loading request queue.
+        std::unordered_map<uint64_t, LoadRequest> mDecodeRequests; ///< Requests that are being decoded.
+        std::queue<UploadRequest> mUploadQueue;     ///< Decoded requests waiting to be uploaded.
+        uint64_t mNextRequestID = 0;                ///< ID of the next request.
+        bool mTerminate = false;                    ///< Flag to terminate the upload thread.
 
-        bool mTerminate = false;                    ///< Flag to terminate worker threads.
-        bool mFlushPending = false;                 ///< Flag to indicate a GPU flush is pending.
-        uint32_t mUploadCounter = 0;                ///< Counter to issue a flush every few uploads.
+        // Upload thread state.
+        uint32_t mUploadCounter = 0;                ///< Number of uploads since the last flush.
+        size_t mUploadByteSize = 0;                 ///< Number of bytes uploaded since the last flush.
     };
 }
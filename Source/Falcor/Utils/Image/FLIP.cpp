@@ -0,0 +1,749 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FLIP.h"
+#include "FLIPColorMaps.slangh"
+#include "Core/Errors.h"
+#include "Utils/Threading.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Falcor
+{
+    namespace
+    {
+        // FLIP constants (see FLIPPass.cs.slang).
+        const float gqc = 0.7f;
+        const float gpc = 0.4f;
+        const float gpt = 0.95f;
+        const float gw = 0.082f;
+        const float gqf = 0.5f;
+
+        /// Minimum number of rows filtered by a single task.
+        const uint32_t kMinBandHeight = 16;
+
+        /** Contrast sensitivity function parameters (a1, a2, b1, b2) of one opponent color channel.
+        */
+        struct CSFParams
+        {
+            float a1, a2, b1, b2;
+        };
+
+        const CSFParams kCSFParamsA = { 1.0f, 0.0f, 0.0047f, 1.0e-5f };
+        const CSFParams kCSFParamsRG = { 1.0f, 0.0f, 0.0053f, 1.0e-5f };
+        const CSFParams kCSFParamsBY = { 34.1f, 13.5f, 0.04f, 0.025f };
+
+        /** Rows produced per image by the horizontal filter pass.
+            The CSF of the BY channel is a sum of two Gaussians, which are filtered separately.
+            The feature detection filters operate on the normalized luminance.
+        */
+        enum Plane : uint32_t
+        {
+            kPlaneY,        ///< Y filtered with the A channel CSF.
+            kPlaneCx,       ///< Cx filtered with the RG channel CSF.
+            kPlaneCz1,      ///< Cz filtered with the first BY channel CSF term.
+            kPlaneCz2,      ///< Cz filtered with the second BY channel CSF term.
+            kPlanePoint,    ///< Luminance filtered with the point detection kernel.
+            kPlaneGauss,    ///< Luminance filtered with the feature Gaussian.
+            kPlaneEdge,     ///< Luminance filtered with the edge detection kernel.
+            kPlaneCount
+        };
+
+        /** Separable decomposition of the FLIP spatial filter and feature detection kernels.
+            The 2D kernels evaluated by FLIPPass are products of 1D kernels (or sums of such products),
+            so filtering rows and then columns produces the same result at a fraction of the cost.
+        */
+        struct Filters
+        {
+            uint32_t radius = 0;
+            uint32_t taps = 0;
+            std::vector<float> horizontal[kPlaneCount];     ///< Kernels of the horizontal pass, one per plane.
+            std::vector<float> verticalY;                   ///< Column kernel for kPlaneY (includes the CSF normalization).
+            std::vector<float> verticalCx;                  ///< Column kernel for kPlaneCx (includes the CSF normalization).
+            std::vector<float> verticalCz1;                 ///< Column kernel for kPlaneCz1 (includes the CSF normalization).
+            std::vector<float> verticalCz2;                 ///< Column kernel for kPlaneCz2 (includes the CSF normalization).
+            std::vector<float> gauss;                       ///< Feature Gaussian.
+            std::vector<float> point;                       ///< Normalized point detection kernel.
+            std::vector<float> edge;                        ///< Normalized edge detection kernel.
+        };
+
+        /** Filtered values of one row of an image.
+        */
+        struct FilteredRow
+        {
+            std::vector<float> Y, Cx, Cz, pointX, pointY, edgeX, edgeY;
+
+            void resize(uint32_t width)
+            {
+                for (auto* v : { &Y, &Cx, &Cz, &pointX, &pointY, &edgeX, &edgeY }) v->resize(width);
+            }
+        };
+
+        /** Rational polynomial tone mapper coefficients (nominator k0..k2, denominator k3..k5).
+        */
+        struct ToneMapperCoefficients
+        {
+            float k[6] = {};
+        };
+
+        /** Returns the tone mapper coefficients computed the same way as toneMap() in FLIPToneMappers.slang.
+        */
+        ToneMapperCoefficients getToneMapperCoefficients(FLIPToneMapperType toneMapper)
+        {
+            ToneMapperCoefficients c;
+            float* k = c.k;
+            if (toneMapper == FLIPToneMapperType::ACES)
+            {
+                // Include pre-exposure cancelation in constants.
+                k[0] = 0.6f * 0.6f * 2.51f;
+                k[1] = 0.6f * 0.03f;
+                k[2] = 0.0f;
+                k[3] = 0.6f * 0.6f * 2.43f;
+                k[4] = 0.6f * 0.59f;
+                k[5] = 0.14f;
+            }
+            else if (toneMapper == FLIPToneMapperType::Hable)
+            {
+                const float A = 0.15f;
+                const float B = 0.50f;
+                const float C = 0.10f;
+                const float D = 0.20f;
+                const float E = 0.02f;
+                const float F = 0.30f;
+                k[0] = A * F - A * E;
+                k[1] = C * B * F - B * E;
+                k[2] = 0.0f;
+                k[3] = A * F;
+                k[4] = B * F;
+                k[5] = D * F * F;
+
+                const float W = 11.2f;
+                const float nom = k[0] * std::pow(W, 2.0f) + k[1] * W + k[2];
+                const float denom = k[3] * std::pow(W, 2.0f) + k[4] * W + k[5];
+                const float whiteScale = denom / nom;
+
+                // Include white scale and exposure bias in rational polynomial coefficients.
+                k[0] = 4.0f * k[0] * whiteScale;
+                k[1] = 2.0f * k[1] * whiteScale;
+                k[2] = k[2] * whiteScale;
+                k[3] = 4.0f * k[3];
+                k[4] = 2.0f * k[4];
+            }
+            return c;
+        }
+
+        /** Clamp to [0,1] with the GPU semantics of clamp() (NaN maps to zero).
+        */
+        float saturate(float x)
+        {
+            return std::fmin(std::fmax(x, 0.0f), 1.0f);
+        }
+
+        float3 saturate(float3 c)
+        {
+            return float3(saturate(c.x), saturate(c.y), saturate(c.z));
+        }
+
+        float3 toneMap(float3 col, FLIPToneMapperType toneMapper, const ToneMapperCoefficients& c)
+        {
+            if (toneMapper == FLIPToneMapperType::Reinhard)
+            {
+                float Y = luminance(col);
+                return saturate(col / (Y + 1.0f));
+            }
+
+            const float* k = c.k;
+            float3 result;
+            for (int i = 0; i < 3; i++)
+            {
+                float x = col[i];
+                float nom = k[0] * x * x + k[1] * x + k[2];
+                float denom = k[3] * x * x + k[4] * x + k[5];
+                if (std::isinf(denom)) denom = 1.0f; // Avoid inf / inf division.
+                result[i] = saturate(nom / denom);
+            }
+            return result;
+        }
+
+        float HyAB(float3 a, float3 b)
+        {
+            float3 diff = a - b;
+            return std::abs(diff.x) + std::sqrt(diff.y * diff.y + diff.z * diff.z);
+        }
+
+        float3 Hunt(float3 color)
+        {
+            float huntValue = 0.01f * color.x;
+            return float3(color.x, huntValue * color.y, huntValue * color.z);
+        }
+
+        float getMaxDistance()
+        {
+            static const float maxDistance = std::pow(HyAB(Hunt(linearRGBToCIELab(float3(0.0f, 1.0f, 0.0f))), Hunt(linearRGBToCIELab(float3(0.0f, 0.0f, 1.0f)))), gqc);
+            return maxDistance;
+        }
+
+        float redistributeErrors(float colorDifference, float featureDifference, float maxDistance)
+        {
+            float error = std::pow(colorDifference, gqc);
+
+            // Normalization.
+            float perceptualCutoff = gpc * maxDistance;
+
+            if (error < perceptualCutoff)
+            {
+                error *= (gpt / perceptualCutoff);
+            }
+            else
+            {
+                error = gpt + ((error - perceptualCutoff) / (maxDistance - perceptualCutoff)) * (1.0f - gpt);
+            }
+
+            return std::pow(error, (1.0f - featureDifference));
+        }
+
+        Filters createFilters(const FLIP::Options& options)
+        {
+            const float pixelsPerDegree = options.monitorDistanceMeters * (options.monitorWidthPixels / options.monitorWidthMeters) * float(M_PI / 180.0);
+            const float dx = 1.0f / pixelsPerDegree;
+
+            // Use radius of the spatial filter kernel, as it is always greater than or equal to the radius of the feature detection kernel.
+            Filters filters;
+            filters.radius = uint32_t(std::ceil(3.0f * std::sqrt(0.04f / float(2.0 * M_PI * M_PI)) * pixelsPerDegree));
+            filters.taps = 2 * filters.radius + 1;
+
+            const int r = int(filters.radius);
+            auto makeKernel = [&](auto func)
+            {
+                std::vector<float> kernel(filters.taps);
+                for (int x = -r; x <= r; x++) kernel[x + r] = func(x);
+                return kernel;
+            };
+
+            // CSF weights are a1 * sqrt(pi / b1) * exp(-pi^2 * |p|^2 / b1) + a2 * (...), with p in degrees.
+            // Each term factors into a Gaussian along x times a Gaussian along y.
+            auto csfGaussian = [&](float b)
+            {
+                return makeKernel([&](int x) { float p = x * dx; return std::exp(-(p * p) * float(M_PI * M_PI) / b); });
+            };
+            auto csfAmplitude = [](float a, float b) { return a * std::sqrt(float(M_PI) / b); };
+
+            // Normalize with the sum over the full 2D kernel, like FLIPPass.
+            auto csfSum = [&](const CSFParams& ab, const std::vector<float>& g1, const std::vector<float>& g2)
+            {
+                double sum = 0.0;
+                for (uint32_t y = 0; y < filters.taps; y++)
+                {
+                    for (uint32_t x = 0; x < filters.taps; x++)
+                    {
+                        sum += csfAmplitude(ab.a1, ab.b1) * g1[x] * g1[y] + csfAmplitude(ab.a2, ab.b2) * g2[x] * g2[y];
+                    }
+                }
+                return float(sum);
+            };
+            auto scaleKernel = [](std::vector<float> kernel, float scale)
+            {
+                for (float& w : kernel) w *= scale;
+                return kernel;
+            };
+
+            auto gA = csfGaussian(kCSFParamsA.b1);
+            auto gRG = csfGaussian(kCSFParamsRG.b1);
+            auto gBY1 = csfGaussian(kCSFParamsBY.b1);
+            auto gBY2 = csfGaussian(kCSFParamsBY.b2);
+            // The second terms of the A and RG channels have zero amplitude.
+            const float sumA = csfSum(kCSFParamsA, gA, csfGaussian(kCSFParamsA.b2));
+            const float sumRG = csfSum(kCSFParamsRG, gRG, csfGaussian(kCSFParamsRG.b2));
+            const float sumBY = csfSum(kCSFParamsBY, gBY1, gBY2);
+
+            filters.horizontal[kPlaneY] = gA;
+            filters.horizontal[kPlaneCx] = gRG;
+            filters.horizontal[kPlaneCz1] = gBY1;
+            filters.horizontal[kPlaneCz2] = gBY2;
+            filters.verticalY = scaleKernel(gA, csfAmplitude(kCSFParamsA.a1, kCSFParamsA.b1) / sumA);
+            filters.verticalCx = scaleKernel(gRG, csfAmplitude(kCSFParamsRG.a1, kCSFParamsRG.b1) / sumRG);
+            filters.verticalCz1 = scaleKernel(gBY1, csfAmplitude(kCSFParamsBY.a1, kCSFParamsBY.b1) / sumBY);
+            filters.verticalCz2 = scaleKernel(gBY2, csfAmplitude(kCSFParamsBY.a2, kCSFParamsBY.b2) / sumBY);
+
+            // Feature detection: the 2D Gaussian is g(x) * g(y), the point and edge kernels are derivatives of it along one axis.
+            const float sigmaFeatures = 0.5f * gw * pixelsPerDegree;
+            const float sigmaFeaturesSquared = sigmaFeatures * sigmaFeatures;
+            filters.gauss = makeKernel([&](int x) { return std::exp(-float(x * x) / (2.0f * sigmaFeaturesSquared)); });
+            auto pointWeight = makeKernel([&](int x) { return (float(x * x) / sigmaFeaturesSquared - 1.0f) * filters.gauss[x + r]; });
+            auto edgeWeight = makeKernel([&](int x) { return -float(x) * filters.gauss[x + r]; });
+
+            double positiveKernelSum = 0.0;
+            double negativeKernelSum = 0.0;
+            double edgeKernelSum = 0.0;
+            for (uint32_t y = 0; y < filters.taps; y++)
+            {
+                for (uint32_t x = 0; x < filters.taps; x++)
+                {
+                    float p = pointWeight[x] * filters.gauss[y];
+                    float e = edgeWeight[x] * filters.gauss[y];
+                    positiveKernelSum += p >= 0.0f ? p : 0.0f;
+                    negativeKernelSum += p < 0.0f ? -p : 0.0f;
+                    edgeKernelSum += e >= 0.0f ? e : 0.0f;
+                }
+            }
+
+            filters.point = pointWeight;
+            for (float& w : filters.point) w /= float(w >= 0.0f ? positiveKernelSum : negativeKernelSum);
+            filters.edge = scaleKernel(edgeWeight, 1.0f / float(edgeKernelSum));
+
+            filters.horizontal[kPlanePoint] = filters.point;
+            filters.horizontal[kPlaneGauss] = filters.gauss;
+            filters.horizontal[kPlaneEdge] = filters.edge;
+            return filters;
+        }
+
+        /** Convolve a padded row with a kernel: dst[x] = sum_k kernel[k] * src[x + k].
+        */
+        void convolveRow(const float* pSrc, const float* pKernel, uint32_t taps, uint32_t width, float* pDst)
+        {
+            uint32_t x = 0;
+            for (; x + 8 <= width; x += 8)
+            {
+                __m128 sum0 = _mm_setzero_ps();
+                __m128 sum1 = _mm_setzero_ps();
+                for (uint32_t k = 0; k < taps; k++)
+                {
+                    __m128 w = _mm_set1_ps(pKernel[k]);
+                    sum0 = _mm_add_ps(sum0, _mm_mul_ps(w, _mm_loadu_ps(pSrc + x + k)));
+                    sum1 = _mm_add_ps(sum1, _mm_mul_ps(w, _mm_loadu_ps(pSrc + x + k + 4)));
+                }
+                _mm_storeu_ps(pDst + x, sum0);
+                _mm_storeu_ps(pDst + x + 4, sum1);
+            }
+            for (; x < width; x++)
+            {
+                float sum = 0.0f;
+                for (uint32_t k = 0; k < taps; k++) sum += pKernel[k] * pSrc[x + k];
+                pDst[x] = sum;
+            }
+        }
+
+        /** Convolve a set of rows along the columns: dst[x] (+)= sum_k kernel[k] * rows[k][x].
+        */
+        void convolveColumns(const float* const* ppRows, const float* pKernel, uint32_t taps, uint32_t width, float* pDst, bool accumulate = false)
+        {
+            for (uint32_t k = 0; k < taps; k++)
+            {
+                const float* pRow = ppRows[k];
+                const __m128 w = _mm_set1_ps(pKernel[k]);
+                const bool init = k == 0 && !accumulate;
+                uint32_t x = 0;
+                for (; x + 4 <= width; x += 4)
+                {
+                    __m128 v = _mm_mul_ps(w, _mm_loadu_ps(pRow + x));
+                    _mm_storeu_ps(pDst + x, init ? v : _mm_add_ps(_mm_loadu_ps(pDst + x), v));
+                }
+                for (; x < width; x++)
+                {
+                    float v = pKernel[k] * pRow[x];
+                    pDst[x] = init ? v : pDst[x] + v;
+                }
+            }
+        }
+
+        /** Evaluates LDR-FLIP for a band of rows at a single exposure.
+            Rows are filtered horizontally into a ring buffer holding the rows of the vertical filter footprint,
+            so each band only filters its own rows plus the filter radius above and below.
+        */
+        class BandEvaluator
+        {
+        public:
+            BandEvaluator(const float4* pReference, const float4* pTest, uint32_t width, uint32_t height, const FLIP::Options& options, const Filters& filters)
+                : mpImages{ pReference, pTest }
+                , mWidth(width)
+                , mHeight(height)
+                , mOptions(options)
+                , mFilters(filters)
+                , mToneMapperCoefficients(getToneMapperCoefficients(options.toneMapper))
+                , mMaxDistance(getMaxDistance())
+            {
+                const size_t paddedWidth = mWidth + 2 * mFilters.radius;
+                for (auto& v : mPadded) v.resize(paddedWidth);
+                mRing.resize(size_t(2) * kPlaneCount * mFilters.taps * mWidth);
+                mRows.resize(mFilters.taps);
+                mValues.resize(mWidth);
+                for (auto& row : mFiltered) row.resize(mWidth);
+            }
+
+            /** Evaluate LDR-FLIP for rows [y0, y1).
+                \param[in] func Callback receiving the row index and FLIP values of each row.
+            */
+            template<typename Func>
+            void evaluate(uint32_t y0, uint32_t y1, float exposure, Func func)
+            {
+                const int r = int(mFilters.radius);
+                const float exposureScale = std::pow(2.0f, exposure);
+
+                for (int y = int(y0) - r; y < int(y0) + r; y++) filterRow(y, exposureScale);
+
+                for (uint32_t y = y0; y < y1; y++)
+                {
+                    filterRow(int(y) + r, exposureScale);
+                    filterColumns(0, int(y));
+                    filterColumns(1, int(y));
+                    computeValues(mValues.data());
+                    func(y, mValues.data());
+                }
+            }
+
+        private:
+            float3 getPixel(const float4& pixel, float exposureScale) const
+            {
+                float3 pixelCol = pixel.xyz;
+                if (mOptions.isHDR)
+                {
+                    pixelCol = mOptions.clampInput ? float3(std::fmax(pixelCol.x, 0.0f), std::fmax(pixelCol.y, 0.0f), std::fmax(pixelCol.z, 0.0f)) : pixelCol;
+                    pixelCol = exposureScale * pixelCol; // Exposure compensation.
+                    pixelCol = toneMap(pixelCol, mOptions.toneMapper, mToneMapperCoefficients);
+                }
+                else
+                {
+                    pixelCol = mOptions.clampInput ? saturate(pixelCol) : pixelCol;
+                }
+
+                return linearRGBToYCxCz(pixelCol);
+            }
+
+            float* getRingRow(uint32_t image, int y, uint32_t plane)
+            {
+                const uint32_t slot = uint32_t(y + int(mFilters.taps)) % mFilters.taps;
+                return mRing.data() + ((size_t(image) * mFilters.taps + slot) * kPlaneCount + plane) * mWidth;
+            }
+
+            /** Filter image row y (clamped to the image) horizontally into the ring buffer.
+            */
+            void filterRow(int y, float exposureScale)
+            {
+                const uint32_t r = mFilters.radius;
+                const uint32_t taps = mFilters.taps;
+                const size_t rowOffset = size_t(std::clamp(y, 0, int(mHeight) - 1)) * mWidth;
+
+                for (uint32_t i = 0; i < 2; i++)
+                {
+                    const float4* pSrc = mpImages[i] + rowOffset;
+                    float* pY = mPadded[0].data();
+                    float* pCx = mPadded[1].data();
+                    float* pCz = mPadded[2].data();
+                    float* pL = mPadded[3].data();
+
+                    for (uint32_t x = 0; x < mWidth; x++)
+                    {
+                        float3 color = getPixel(pSrc[x], exposureScale);
+                        pY[x + r] = color.x;
+                        pCx[x + r] = color.y;
+                        pCz[x + r] = color.z;
+                        pL[x + r] = (color.x + 16.0f) / 116.0f; // Normalized Y from YCxCz.
+                    }
+                    // Replicate the border pixels.
+                    for (auto& v : mPadded)
+                    {
+                        std::fill(v.begin(), v.begin() + r, v[r]);
+                        std::fill(v.end() - r, v.end(), v[r + mWidth - 1]);
+                    }
+
+                    convolveRow(pY, mFilters.horizontal[kPlaneY].data(), taps, mWidth, getRingRow(i, y, kPlaneY));
+                    convolveRow(pCx, mFilters.horizontal[kPlaneCx].data(), taps, mWidth, getRingRow(i, y, kPlaneCx));
+                    convolveRow(pCz, mFilters.horizontal[kPlaneCz1].data(), taps, mWidth, getRingRow(i, y, kPlaneCz1));
+                    convolveRow(pCz, mFilters.horizontal[kPlaneCz2].data(), taps, mWidth, getRingRow(i, y, kPlaneCz2));
+                    convolveRow(pL, mFilters.horizontal[kPlanePoint].data(), taps, mWidth, getRingRow(i, y, kPlanePoint));
+                    convolveRow(pL, mFilters.horizontal[kPlaneGauss].data(), taps, mWidth, getRingRow(i, y, kPlaneGauss));
+                    convolveRow(pL, mFilters.horizontal[kPlaneEdge].data(), taps, mWidth, getRingRow(i, y, kPlaneEdge));
+                }
+            }
+
+            /** Filter the ring buffer rows around row y vertically.
+            */
+            void filterColumns(uint32_t image, int y)
+            {
+                const int r = int(mFilters.radius);
+                const uint32_t taps = mFilters.taps;
+                FilteredRow& out = mFiltered[image];
+
+                auto convolve = [&](uint32_t plane, const std::vector<float>& kernel, float* pDst, bool accumulate = false)
+                {
+                    for (uint32_t k = 0; k < taps; k++) mRows[k] = getRingRow(image, y - r + int(k), plane);
+                    convolveColumns(mRows.data(), kernel.data(), taps, mWidth, pDst, accumulate);
+                };
+
+                convolve(kPlaneY, mFilters.verticalY, out.Y.data());
+                convolve(kPlaneCx, mFilters.verticalCx, out.Cx.data());
+                convolve(kPlaneCz1, mFilters.verticalCz1, out.Cz.data());
+                convolve(kPlaneCz2, mFilters.verticalCz2, out.Cz.data(), true);
+                convolve(kPlanePoint, mFilters.gauss, out.pointX.data());
+                convolve(kPlaneGauss, mFilters.point, out.pointY.data());
+                convolve(kPlaneEdge, mFilters.gauss, out.edgeX.data());
+                convolve(kPlaneGauss, mFilters.edge, out.edgeY.data());
+            }
+
+            /** Compute FLIP values from the filtered reference and test rows.
+            */
+            void computeValues(float* pValues) const
+            {
+                const FilteredRow& ref = mFiltered[0];
+                const FilteredRow& test = mFiltered[1];
+                for (uint32_t x = 0; x < mWidth; x++)
+                {
+                    // Color pipeline.
+                    float3 spatialFilteredReference = saturate(YCxCzToLinearRGB(float3(ref.Y[x], ref.Cx[x], ref.Cz[x])));
+                    float3 spatialFilteredTest = saturate(YCxCzToLinearRGB(float3(test.Y[x], test.Cx[x], test.Cz[x])));
+                    float colorDiff = HyAB(Hunt(linearRGBToCIELab(spatialFilteredReference)), Hunt(linearRGBToCIELab(spatialFilteredTest)));
+
+                    // Feature pipeline.
+                    float edgeDifference = std::abs(std::sqrt(ref.edgeX[x] * ref.edgeX[x] + ref.edgeY[x] * ref.edgeY[x]) - std::sqrt(test.edgeX[x] * test.edgeX[x] + test.edgeY[x] * test.edgeY[x]));
+                    float pointDifference = std::abs(std::sqrt(ref.pointX[x] * ref.pointX[x] + ref.pointY[x] * ref.pointY[x]) - std::sqrt(test.pointX[x] * test.pointX[x] + test.pointY[x] * test.pointY[x]));
+                    float featureDiff = std::pow(std::max(pointDifference, edgeDifference) * float(M_SQRT1_2), gqf);
+
+                    pValues[x] = redistributeErrors(colorDiff, featureDiff, mMaxDistance);
+                }
+            }
+
+            const float4* mpImages[2];
+            uint32_t mWidth;
+            uint32_t mHeight;
+            const FLIP::Options& mOptions;
+            const Filters& mFilters;
+            ToneMapperCoefficients mToneMapperCoefficients;
+            float mMaxDistance;
+
+            std::vector<float> mPadded[4];          ///< Y, Cx, Cz and normalized luminance of the current row, padded by the filter radius.
+            std::vector<float> mRing;               ///< Horizontally filtered rows [image][slot][plane][x].
+            std::vector<const float*> mRows;        ///< Ring buffer rows of the vertical filter footprint.
+            std::vector<float> mValues;             ///< FLIP values of the current row.
+            FilteredRow mFiltered[2];               ///< Filtered reference and test rows.
+        };
+
+        void solveSecondDegree(const float a, const float b, float c, float& xMin, float& xMax)
+        {
+            //  Solve a * x^2 + b * x + c = 0.
+            if (a == 0.0f)
+            {
+                xMin = xMax = -c / b;
+                return;
+            }
+
+            float d1 = -0.5f * (b / a);
+            float d2 = std::sqrt((d1 * d1) - (c / a));
+            xMin = d1 - d2;
+            xMax = d1 + d2;
+        }
+    }
+
+    FLIP::ExposureParameters FLIP::computeExposureParameters(FLIPToneMapperType toneMapper, float Ymedian, float Ymax)
+    {
+        std::vector<float> tmCoefficients;
+        if (toneMapper == FLIPToneMapperType::Reinhard)
+        {
+            tmCoefficients = { 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f };
+        }
+        else if (toneMapper == FLIPToneMapperType::ACES)
+        {
+            tmCoefficients = { 0.6f * 0.6f * 2.51f, 0.6f * 0.03f, 0.0f, 0.6f * 0.6f * 2.43f, 0.6f * 0.59f, 0.14f };  // 0.6 is pre-exposure cancellation.
+        }
+        else if (toneMapper == FLIPToneMapperType::Hable)
+        {
+            tmCoefficients = { 0.231683f, 0.013791f, 0.0f, 0.18f, 0.3f, 0.018f };
+        }
+        else
+        {
+            throw ArgumentError("Unknown FLIP tone mapper");
+        }
+
+        const float t = 0.85f;
+        const float a = tmCoefficients[0] - t * tmCoefficients[3];
+        const float b = tmCoefficients[1] - t * tmCoefficients[4];
+        const float c = tmCoefficients[2] - t * tmCoefficients[5];
+
+        float xMin = 0.0f;
+        float xMax = 0.0f;
+        solveSecondDegree(a, b, c, xMin, xMax);
+
+        ExposureParameters params;
+        params.startExposure = std::log2(xMax / Ymax);
+        params.stopExposure = std::log2(xMax / Ymedian);
+        params.numExposures = uint32_t(std::max(2.0f, std::ceil(params.stopExposure - params.startExposure)));
+        return params;
+    }
+
+    FLIP::ExposureParameters FLIP::computeExposureParameters(FLIPToneMapperType toneMapper, const float* pLuminance, size_t count)
+    {
+        if (!pLuminance || count == 0) throw ArgumentError("Can't compute FLIP exposure parameters without luminance values");
+
+        std::vector<float> values(pLuminance, pLuminance + count);
+        const size_t half = count / 2;
+        std::nth_element(values.begin(), values.begin() + half, values.end());
+        float median = values[half];
+        if ((count & 1) == 0) // Even number of values.
+        {
+            median = (*std::max_element(values.begin(), values.begin() + half) + median) * 0.5f;
+        }
+        float max = *std::max_element(values.begin() + half, values.end());
+
+        return computeExposureParameters(toneMapper, median, max);
+    }
+
+    FLIP::Result FLIP::compute(const float4* pReference, const float4* pTest, uint32_t width, uint32_t height, const Options& options)
+    {
+        if (!pReference || !pTest || width == 0 || height == 0) throw ArgumentError("Can't compute FLIP of empty images");
+        if (options.monitorWidthPixels == 0 || !(options.monitorWidthMeters > 0.f) || !(options.monitorDistanceMeters > 0.f))
+        {
+            throw ArgumentError("Invalid FLIP monitor information");
+        }
+
+        const size_t pixelCount = size_t(width) * height;
+        Result result;
+
+        // Determine the exposures to evaluate.
+        if (options.isHDR)
+        {
+            if (options.useCustomExposureParameters)
+            {
+                result.exposureParameters = options.exposureParameters;
+            }
+            else
+            {
+                std::vector<float> luminances(pixelCount);
+                Threading::parallelForRange(0, pixelCount, [&](size_t begin, size_t end)
+                {
+                    for (size_t i = begin; i < end; i++) luminances[i] = luminance(pReference[i].xyz);
+                }, size_t(1) << 16);
+                result.exposureParameters = computeExposureParameters(options.toneMapper, luminances.data(), pixelCount);
+            }
+            if (result.exposureParameters.numExposures < 2) throw ArgumentError("HDR-FLIP requires at least two exposures");
+        }
+
+        const uint32_t numExposures = options.isHDR ? result.exposureParameters.numExposures : 1;
+        const float startExposure = options.isHDR ? result.exposureParameters.startExposure : 0.0f;
+        const float exposureDelta = options.isHDR ? result.exposureParameters.getExposureDelta() : 0.0f;
+
+        const Filters filters = createFilters(options);
+        const uint32_t bandHeight = std::max(kMinBandHeight, 4 * filters.radius);
+        const uint32_t bandCount = (height + bandHeight - 1) / bandHeight;
+
+        result.errorMap.resize(pixelCount);
+        if (options.isHDR) result.exposureMap.resize(pixelCount);
+
+        std::vector<double> rowSums(height);
+        std::vector<float> rowMins(height);
+        std::vector<float> rowMaxs(height);
+
+        Threading::parallelForRange(0, bandCount, [&](size_t bandBegin, size_t bandEnd)
+        {
+            BandEvaluator evaluator(pReference, pTest, width, height, options, filters);
+            std::vector<float> flip;
+            std::vector<uint32_t> exposureIndices;
+
+            for (size_t band = bandBegin; band < bandEnd; band++)
+            {
+                const uint32_t y0 = uint32_t(band) * bandHeight;
+                const uint32_t y1 = std::min(height, y0 + bandHeight);
+                const size_t bandOffset = size_t(y0) * width;
+
+                // HDR-FLIP is maximum LDR-FLIP over a range of exposures.
+                if (options.isHDR)
+                {
+                    flip.assign(size_t(y1 - y0) * width, 0.0f);
+                    exposureIndices.assign(flip.size(), 0);
+                    for (uint32_t i = 0; i < numExposures; i++)
+                    {
+                        evaluator.evaluate(y0, y1, startExposure + i * exposureDelta, [&](uint32_t y, const float* pValues)
+                        {
+                            const size_t offset = size_t(y) * width - bandOffset;
+                            for (uint32_t x = 0; x < width; x++)
+                            {
+                                if (pValues[x] > flip[offset + x])
+                                {
+                                    flip[offset + x] = pValues[x];
+                                    exposureIndices[offset + x] = i;
+                                }
+                            }
+                        });
+                    }
+                }
+                else
+                {
+                    flip.resize(size_t(y1 - y0) * width);
+                    evaluator.evaluate(y0, y1, 0.0f, [&](uint32_t y, const float* pValues)
+                    {
+                        std::copy(pValues, pValues + width, flip.begin() + (size_t(y) * width - bandOffset));
+                    });
+                }
+
+                // Store error map, exposure map and per-row statistics.
+                for (uint32_t y = y0; y < y1; y++)
+                {
+                    double sum = 0.0;
+                    float minValue = std::numeric_limits<float>::max();
+                    float maxValue = std::numeric_limits<float>::lowest();
+                    for (uint32_t x = 0; x < width; x++)
+                    {
+                        const size_t index = size_t(y) * width + x;
+                        const float value = flip[index - bandOffset];
+                        float4& error = result.errorMap[index];
+                        if (std::isnan(value) || std::isinf(value) || value < 0.0f || value > 1.0f)
+                        {
+                            error = float4(1.0f, 0.0f, 0.0f, 1.0f);
+                        }
+                        else
+                        {
+                            float3 col = options.useMagma ? MagmaMap[int(value * 255.0f + 0.5f)] : float3(value);
+                            error = float4(col, value);
+                        }
+                        sum += error.w;
+                        minValue = std::min(minValue, error.w);
+                        maxValue = std::max(maxValue, error.w);
+
+                        if (options.isHDR)
+                        {
+                            float exposureMapFloatIndex = float(exposureIndices[index - bandOffset]) / (numExposures - 1.0f);
+                            result.exposureMap[index] = float4(sRGBToLinear(ViridisMap[int(exposureMapFloatIndex * 255.0f + 0.5f)]), 1.0f);
+                        }
+                    }
+                    rowSums[y] = sum;
+                    rowMins[y] = minValue;
+                    rowMaxs[y] = maxValue;
+                }
+            }
+        }, 1);
+
+        // Pool the per-row statistics in order, so the result does not depend on the thread count.
+        double sum = 0.0;
+        for (double rowSum : rowSums) sum += rowSum;
+        result.mean = float(sum / double(pixelCount));
+        result.min = *std::min_element(rowMins.begin(), rowMins.end());
+        result.max = *std::max_element(rowMaxs.begin(), rowMaxs.end());
+
+        return result;
+    }
+}
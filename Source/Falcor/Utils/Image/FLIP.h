@@ -0,0 +1,124 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "FLIPToneMappers.slang"
+#include "Core/Macros.h"
+#include "Utils/Math/Vector.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Falcor
+{
+    /** CPU implementation of the FLIP image difference evaluator.
+
+        This is a multithreaded reference implementation producing the same results as the FLIPPass render pass
+        (up to floating-point rounding), including HDR-FLIP with automatic exposure parameters.
+        The spatial filters are evaluated as separable convolutions over bands of rows, which makes the cost
+        linear in the filter radius instead of quadratic. Work is distributed over the global thread pool (see Threading).
+
+        See https://github.com/NVlabs/flip for details on the metric.
+    */
+    class FALCOR_API FLIP
+    {
+    public:
+        /** Exposure range used by HDR-FLIP.
+        */
+        struct ExposureParameters
+        {
+            float startExposure = 0.f;      ///< First exposure (log2 scale).
+            float stopExposure = 0.f;       ///< Last exposure (log2 scale).
+            uint32_t numExposures = 2;      ///< Number of exposures evaluated in [startExposure, stopExposure]. Must be at least 2.
+
+            /** Returns the exposure step such that startExposure + (numExposures - 1) * delta = stopExposure.
+            */
+            float getExposureDelta() const { return (stopExposure - startExposure) / (numExposures - 1.f); }
+        };
+
+        /** FLIP settings. The defaults match the defaults of FLIPPass.
+        */
+        struct Options
+        {
+            bool isHDR = false;                                     ///< Compute HDR-FLIP instead of LDR-FLIP.
+            bool useMagma = true;                                   ///< Store the magma color map in the error map (grayscale otherwise).
+            bool clampInput = false;                                ///< Clamp input to the expected range ([0,1] for LDR-FLIP and [0, inf) for HDR-FLIP).
+            FLIPToneMapperType toneMapper = FLIPToneMapperType::ACES; ///< Tone mapper assumed by HDR-FLIP.
+            bool useCustomExposureParameters = false;               ///< Use the exposure parameters below instead of computing them from the reference image.
+            ExposureParameters exposureParameters;                  ///< Custom HDR-FLIP exposure parameters.
+            uint32_t monitorWidthPixels = 3840;                     ///< Horizontal monitor resolution.
+            float monitorWidthMeters = 0.7f;                        ///< Width of the monitor in meters.
+            float monitorDistanceMeters = 0.7f;                     ///< Distance of monitor from the viewer in meters.
+        };
+
+        /** FLIP results.
+        */
+        struct Result
+        {
+            /** Per-pixel error map (row-major). Same content as the errorMap output of FLIPPass:
+                RGB holds the (linear) magma or grayscale color and alpha holds the FLIP value.
+                Pixels where FLIP is NaN, infinite or outside [0,1] are stored as (1,0,0,1).
+            */
+            std::vector<float4> errorMap;
+            /** Per-pixel HDR-FLIP exposure map (row-major), empty for LDR-FLIP.
+                Stores the viridis color of the exposure that produced the largest error, linearized
+                like the exposureMapDisplay output of FLIPPass before it is written to an sRGB target.
+            */
+            std::vector<float4> exposureMap;
+            ExposureParameters exposureParameters;  ///< Exposure parameters used (HDR-FLIP only).
+            float mean = 0.f;                       ///< Mean FLIP value over all pixels (taken from the error map alpha channel).
+            float min = 0.f;                        ///< Minimum FLIP value over all pixels.
+            float max = 0.f;                        ///< Maximum FLIP value over all pixels.
+        };
+
+        /** Compute FLIP between a reference and a test image.
+            \param[in] pReference Reference image in linear RGB (row-major, alpha is ignored).
+            \param[in] pTest Test image in linear RGB (row-major, alpha is ignored).
+            \param[in] width Image width in pixels.
+            \param[in] height Image height in pixels.
+            \param[in] options FLIP settings.
+            \return FLIP error map and pooled values. Throws if the settings are invalid.
+        */
+        static Result compute(const float4* pReference, const float4* pTest, uint32_t width, uint32_t height, const Options& options);
+
+        /** Compute the HDR-FLIP exposure parameters from the median and maximum luminance of the reference image.
+            \param[in] toneMapper Tone mapper assumed by HDR-FLIP.
+            \param[in] Ymedian Median luminance of the reference image.
+            \param[in] Ymax Maximum luminance of the reference image.
+            \return Exposure parameters.
+        */
+        static ExposureParameters computeExposureParameters(FLIPToneMapperType toneMapper, float Ymedian, float Ymax);
+
+        /** Compute the HDR-FLIP exposure parameters from the luminance values of the reference image.
+            \param[in] toneMapper Tone mapper assumed by HDR-FLIP.
+            \param[in] pLuminance Luminance values of the reference image.
+            \param[in] count Number of luminance values. Must be non-zero.
+            \return Exposure parameters.
+        */
+        static ExposureParameters computeExposureParameters(FLIPToneMapperType toneMapper, const float* pLuminance, size_t count);
+    };
+}
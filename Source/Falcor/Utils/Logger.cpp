@@ -28,19 +28,31 @@
 #include "Logger.h"
 #include "Core/Assert.h"
 #include "Core/Platform/OS.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
 
 namespace Falcor
 {
     namespace
     {
-        Logger::Level sVerbosity = Logger::Level::Info;
-        Logger::OutputFlags sOutputs = Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow;
+        std::atomic<Logger::Level> sVerbosity{Logger::Level::Info};
+        std::atomic<Logger::OutputFlags> sOutputs{Logger::OutputFlags::Console | Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow};
         std::filesystem::path sLogFilePath;
 
 #if FALCOR_ENABLE_LOGGER
-        bool sInitialized = false;
-        FILE* sLogFile = nullptr;
+        // Interval at which the sink thread wakes up when idle, to report repeated messages.
+        const auto kIdleInterval = std::chrono::milliseconds(100);
+
+        // Maximum number of messages per second written to the console and debug window.
+        // Additional messages are only written to the log file. Errors are never suppressed.
+        const uint32_t kMaxConsoleMessagesPerSecond = 200;
+
+        const char* getLogLevelString(Logger::Level level);
 
         std::filesystem::path generateLogFilePath()
         {
@@ -49,7 +61,7 @@ namespace Falcor
             return findAvailableFilename(prefix, directory, "log");
         }
 
-        FILE* openLogFile()
+        FILE* openLogFile(bool append)
         {
             FILE* pFile = nullptr;
 
@@ -58,7 +70,7 @@ namespace Falcor
                 sLogFilePath = generateLogFilePath();
             }
 
-            pFile = std::fopen(sLogFilePath.string().c_str(), "w");
+            pFile = std::fopen(sLogFilePath.string().c_str(), append ? "a" : "w");
             if (pFile != nullptr)
             {
                 // Success
@@ -70,18 +82,325 @@ namespace Falcor
             return pFile;
         }
 
-        void printToLogFile(const std::string& s)
+        struct Message
+        {
+            Message* pNext = nullptr;
+            Logger::Level level;
+            std::string text;
+        };
+
+        /** Lock-free multiple-producer/single-consumer message queue.
+            Producers push onto an intrusive stack, the consumer takes the whole stack at once and reverses it.
+        */
+        class MessageQueue
+        {
+        public:
+            /** Push a message.
+                \return Returns true if the queue was empty.
+            */
+            bool push(Message* pMessage)
+            {
+                Message* pHead = mpHead.load(std::memory_order_relaxed);
+                do
+                {
+                    pMessage->pNext = pHead;
+                } while (!mpHead.compare_exchange_weak(pHead, pMessage, std::memory_order_release, std::memory_order_relaxed));
+                return pHead == nullptr;
+            }
+
+            /** Remove all messages.
+                \return Returns a list of messages in the order they were pushed.
+            */
+            Message* popAll()
+            {
+                Message* pHead = mpHead.exchange(nullptr, std::memory_order_acquire);
+                Message* pList = nullptr;
+                while (pHead)
+                {
+                    Message* pNext = pHead->pNext;
+                    pHead->pNext = pList;
+                    pList = pHead;
+                    pHead = pNext;
+                }
+                return pList;
+            }
+
+            bool empty() const { return mpHead.load(std::memory_order_relaxed) == nullptr; }
+
+        private:
+            std::atomic<Message*> mpHead{nullptr};
+        };
+
+        /** Writes messages to the log outputs.
+            Repeated messages are collapsed, console output is rate limited and file output is batched until flush().
+        */
+        class LogWriter
         {
-            if (!sInitialized)
+        public:
+            void write(Logger::Level level, std::string_view text)
+            {
+                if (level == mLastLevel && text == mLastText && !mLastText.empty())
+                {
+                    ++mRepeatCount;
+                    return;
+                }
+
+                writeRepeats();
+                mLastLevel = level;
+                mLastText = text;
+                emit(level, text);
+            }
+
+            /** Write buffered output.
+                \param[in] final If true, pending repeat counts are written as well.
+            */
+            void flush(bool final)
+            {
+                if (final)
+                {
+                    writeRepeats();
+                    mLastText.clear();
+                    if (mSuppressedCount > 0 && std::chrono::steady_clock::now() - mWindowStart >= std::chrono::seconds(1)) writeSuppressed();
+                }
+
+                if (!mFileBuffer.empty())
+                {
+                    if (!mpFile) mpFile = openLogFile(mFileOpened);
+                    mFileOpened = true;
+                    if (mpFile)
+                    {
+                        std::fwrite(mFileBuffer.data(), 1, mFileBuffer.size(), mpFile);
+                        std::fflush(mpFile);
+                    }
+                    mFileBuffer.clear();
+                }
+
+                if (mConsoleWritten)
+                {
+                    std::cout.flush();
+                    std::cerr.flush();
+                    mConsoleWritten = false;
+                }
+            }
+
+            void close()
             {
-                sLogFile = openLogFile();
-                sInitialized = true;
+                flush(true);
+                if (mSuppressedCount > 0) writeSuppressed();
+                if (mpFile)
+                {
+                    std::fclose(mpFile);
+                    mpFile = nullptr;
+                }
             }
 
-            if (sLogFile)
+            bool isFileOpen() const { return mpFile != nullptr; }
+
+        private:
+            void writeRepeats()
+            {
+                if (mRepeatCount == 0) return;
+                uint64_t count = mRepeatCount;
+                mRepeatCount = 0;
+                emit(mLastLevel, fmt::format("Last message repeated {} times.", count));
+            }
+
+            void writeSuppressed()
+            {
+                std::string s = fmt::format("{} {} log messages were not printed to the console. See the log file for the full log.\n", getLogLevelString(Logger::Level::Warning), mSuppressedCount);
+                mSuppressedCount = 0;
+                writeConsole(Logger::Level::Warning, s);
+            }
+
+            void emit(Logger::Level level, std::string_view text)
+            {
+                std::string s = fmt::format("{} {}\n", getLogLevelString(level), text);
+                Logger::OutputFlags outputs = sOutputs.load(std::memory_order_relaxed);
+
+                // Write to file.
+                if (is_set(outputs, Logger::OutputFlags::File))
+                {
+                    mFileBuffer += s;
+                }
+
+                bool console = is_set(outputs, Logger::OutputFlags::Console);
+                bool debugWindow = is_set(outputs, Logger::OutputFlags::DebugWindow) && isDebuggerPresent();
+                if (!console && !debugWindow) return;
+
+                // Limit the number of messages printed to the console and debug window.
+                auto now = std::chrono::steady_clock::now();
+                if (now - mWindowStart >= std::chrono::seconds(1))
+                {
+                    if (mSuppressedCount > 0) writeSuppressed();
+                    mWindowStart = now;
+                    mWindowCount = 0;
+                }
+                if (level > Logger::Level::Error && mWindowCount++ >= kMaxConsoleMessagesPerSecond)
+                {
+                    ++mSuppressedCount;
+                    return;
+                }
+
+                // Write to console.
+                if (console) writeConsole(level, s);
+
+                // Write to debug window if debugger is attached.
+                if (debugWindow) printToDebugWindow(s);
+            }
+
+            void writeConsole(Logger::Level level, const std::string& s)
             {
-                std::fprintf(sLogFile, "%s", s.c_str());
-                std::fflush(sLogFile);
+                auto& os = level > Logger::Level::Error ? std::cout : std::cerr;
+                os << s;
+                mConsoleWritten = true;
+            }
+
+            FILE* mpFile = nullptr;
+            bool mFileOpened = false;           ///< True once the log file was opened, further opens append to it.
+            std::string mFileBuffer;            ///< Output pending to be written to the log file.
+            bool mConsoleWritten = false;
+
+            Logger::Level mLastLevel = Logger::Level::Disabled;
+            std::string mLastText;              ///< Last message written, used to collapse repeated messages.
+            uint64_t mRepeatCount = 0;          ///< Number of times the last message was repeated.
+
+            std::chrono::steady_clock::time_point mWindowStart;
+            uint32_t mWindowCount = 0;          ///< Number of console messages in the current one second window.
+            uint64_t mSuppressedCount = 0;      ///< Number of console messages suppressed in the current window.
+        };
+
+        enum class SinkState
+        {
+            Stopped,    ///< Sink thread is not started yet.
+            Running,    ///< Messages are written by the sink thread.
+            ShutDown,   ///< Logger was shut down, messages are written synchronously.
+        };
+
+        /** Global logger state. Intentionally leaked, as messages may be logged during static destruction.
+        */
+        struct LoggerState
+        {
+            MessageQueue queue;
+            LogWriter writer;
+            std::mutex writeMutex;              ///< Protects the writer and the log file path.
+
+            std::atomic<SinkState> sinkState{SinkState::Stopped};
+            std::thread sinkThread;
+            std::mutex sinkMutex;
+            std::condition_variable sinkCondition;
+            std::condition_variable flushedCondition;
+            bool stopSink = false;
+            uint64_t flushRequested = 0;
+            uint64_t flushCompleted = 0;
+
+            static LoggerState& get()
+            {
+                static LoggerState* pState = new LoggerState();
+                return *pState;
+            }
+        };
+
+        void writeMessages(LogWriter& writer, Message* pMessage)
+        {
+            while (pMessage)
+            {
+                writer.write(pMessage->level, pMessage->text);
+                Message* pNext = pMessage->pNext;
+                delete pMessage;
+                pMessage = pNext;
+            }
+        }
+
+        void runSink()
+        {
+            LoggerState& state = LoggerState::get();
+            std::unique_lock<std::mutex> lock(state.sinkMutex);
+
+            while (true)
+            {
+                bool idle = !state.sinkCondition.wait_for(lock, kIdleInterval, [&]() {
+                    return !state.queue.empty() || state.stopSink || state.flushRequested != state.flushCompleted;
+                });
+                // Read the flush request before draining, so all messages logged before the request are written.
+                uint64_t flushRequested = state.flushRequested;
+                bool stop = state.stopSink;
+                bool final = idle || stop || flushRequested != state.flushCompleted;
+                lock.unlock();
+
+                {
+                    std::lock_guard<std::mutex> writeLock(state.writeMutex);
+                    writeMessages(state.writer, state.queue.popAll());
+                    state.writer.flush(final);
+                }
+
+                lock.lock();
+                state.flushCompleted = flushRequested;
+                state.flushedCondition.notify_all();
+                if (stop && state.queue.empty()) break;
+            }
+        }
+
+        /** Start the sink thread if not started yet.
+            \return Returns true if the sink thread is running.
+        */
+        bool startSink()
+        {
+            LoggerState& state = LoggerState::get();
+            std::lock_guard<std::mutex> lock(state.sinkMutex);
+            if (state.sinkState == SinkState::Stopped)
+            {
+                state.stopSink = false;
+                state.sinkThread = std::thread(runSink);
+                state.sinkState = SinkState::Running;
+            }
+            return state.sinkState == SinkState::Running;
+        }
+
+        /** Stops the logger at program exit if it was not shut down explicitly.
+            This runs in a static destructor, where joining the sink thread can deadlock (e.g. under the loader lock on Windows,
+            where the thread may also have been terminated already). The sink thread is detached instead, and further messages
+            are written synchronously. Applications should call Logger::shutdown() before exiting.
+        */
+        struct ShutdownGuard
+        {
+            ~ShutdownGuard()
+            {
+                LoggerState& state = LoggerState::get();
+                state.sinkState = SinkState::ShutDown;
+                {
+                    std::unique_lock<std::mutex> lock(state.sinkMutex, std::try_to_lock);
+                    if (lock.owns_lock()) state.stopSink = true;
+                }
+                state.sinkCondition.notify_one();
+                if (state.sinkThread.joinable()) state.sinkThread.detach();
+
+                // Write the pending messages unless the writer is in use, without blocking.
+                std::unique_lock<std::mutex> lock(state.writeMutex, std::try_to_lock);
+                if (lock.owns_lock())
+                {
+                    writeMessages(state.writer, state.queue.popAll());
+                    state.writer.flush(true);
+                }
+            }
+        } sShutdownGuard;
+
+        const char* getLogLevelString(Logger::Level level)
+        {
+            switch (level)
+            {
+            case Logger::Level::Fatal:
+                return "(Fatal)";
+            case Logger::Level::Error:
+                return "(Error)";
+            case Logger::Level::Warning:
+                return "(Warning)";
+            case Logger::Level::Info:
+                return "(Info)";
+            case Logger::Level::Debug:
+                return "(Debug)";
+            default:
+                FALCOR_UNREACHABLE();
+                return nullptr;
             }
         }
 #endif
@@ -90,61 +409,68 @@ namespace Falcor
     void Logger::shutdown()
     {
 #if FALCOR_ENABLE_LOGGER
-        if(sLogFile)
+        LoggerState& state = LoggerState::get();
         {
-            fclose(sLogFile);
-            sLogFile = nullptr;
-            sInitialized = false;
+            std::lock_guard<std::mutex> lock(state.sinkMutex);
+            if (state.sinkState == SinkState::Running) state.stopSink = true;
+            state.sinkState = SinkState::ShutDown;
         }
+        state.sinkCondition.notify_one();
+        if (state.sinkThread.joinable()) state.sinkThread.join();
+
+        // Write messages queued while the sink thread was stopping and close the log file.
+        std::lock_guard<std::mutex> lock(state.writeMutex);
+        writeMessages(state.writer, state.queue.popAll());
+        state.writer.close();
 #endif
     }
 
-    const char* getLogLevelString(Logger::Level level)
+    void Logger::flush()
     {
-        switch (level)
-        {
-        case Logger::Level::Fatal:
-            return "(Fatal)";
-        case Logger::Level::Error:
-            return "(Error)";
-        case Logger::Level::Warning:
-            return "(Warning)";
-        case Logger::Level::Info:
-            return "(Info)";
-        case Logger::Level::Debug:
-            return "(Debug)";
-        default:
-            FALCOR_UNREACHABLE();
-            return nullptr;
+#if FALCOR_ENABLE_LOGGER
+        LoggerState& state = LoggerState::get();
+        std::unique_lock<std::mutex> lock(state.sinkMutex);
+        if (state.sinkState != SinkState::Running)
+        {
+            // Write synchronously if there is no sink thread.
+            lock.unlock();
+            std::lock_guard<std::mutex> writeLock(state.writeMutex);
+            writeMessages(state.writer, state.queue.popAll());
+            state.writer.flush(true);
+            return;
         }
+        if (std::this_thread::get_id() == state.sinkThread.get_id()) return;
+
+        uint64_t flushRequested = ++state.flushRequested;
+        state.sinkCondition.notify_one();
+        state.flushedCondition.wait(lock, [&]() { return state.flushCompleted >= flushRequested || state.sinkState != SinkState::Running; });
+#endif
     }
 
     void Logger::log(Level level, const std::string_view msg)
     {
 #if FALCOR_ENABLE_LOGGER
-        if (level <= sVerbosity)
+        if (level <= sVerbosity.load(std::memory_order_relaxed))
         {
-            std::string s = fmt::format("{} {}\n", getLogLevelString(level), msg);
+            LoggerState& state = LoggerState::get();
 
-            // Write to console.
-            if (is_set(sOutputs, OutputFlags::Console))
+            if (state.sinkState.load(std::memory_order_acquire) != SinkState::Running && !startSink())
             {
-                auto& os = level > Logger::Level::Error ? std::cout : std::cerr;
-                os << s;
-                os.flush();
+                // Write synchronously after shutdown.
+                std::lock_guard<std::mutex> lock(state.writeMutex);
+                state.writer.write(level, msg);
+                state.writer.flush(true);
+                return;
             }
 
-            // Write to file.
-            if (is_set(sOutputs, OutputFlags::File))
+            if (state.queue.push(new Message{nullptr, level, std::string(msg)}))
             {
-                printToLogFile(s);
+                std::lock_guard<std::mutex> lock(state.sinkMutex);
+                state.sinkCondition.notify_one();
             }
 
-            // Write to debug window if debugger is attached.
-            if (is_set(sOutputs, OutputFlags::DebugWindow) && isDebuggerPresent())
-            {
-                printToDebugWindow(s);
-            }
+            // Make sure errors are written out before the application possibly terminates.
+            if (level <= Level::Error) flush();
         }
 #endif
     }
@@ -152,7 +478,11 @@ namespace Falcor
     bool Logger::setLogFilePath(const std::filesystem::path& path)
     {
 #if FALCOR_ENABLE_LOGGER
-        if (sLogFile)
+        // The log file is opened by the sink thread, make sure all pending messages are written first.
+        flush();
+        LoggerState& state = LoggerState::get();
+        std::lock_guard<std::mutex> lock(state.writeMutex);
+        if (state.writer.isFileOpen())
         {
             return false;
         }
@@ -38,6 +38,9 @@ namespace Falcor
     /** Container class for logging messages.
         To enable log messages, make sure FALCOR_ENABLE_LOGGER is set to `1` in FalcorConfig.h.
         Messages are only printed to the selected outputs if they match the verbosity level.
+        Messages are queued without locking and written by a background thread, which batches file writes,
+        collapses repeated messages and limits the rate of console output. Errors and fatal errors are flushed
+        before log() returns. After shutdown(), messages are written synchronously.
     */
     class FALCOR_API Logger
     {
@@ -66,9 +69,16 @@ namespace Falcor
         };
 
         /** Shutdown the logger and close the log file.
+            Writes all pending messages and stops the background thread.
+            Applications should call this before exiting. Otherwise the background thread is only detached at static destruction,
+            which doesn't wait for messages that are being written.
         */
         static void shutdown();
 
+        /** Wait until all messages logged so far are written to the outputs.
+        */
+        static void flush();
+
         /** Set the logger verbosity.
             \param level Log level.
         */
@@ -92,6 +92,16 @@ public:
         insert(srcData8, srcData8 + size);
     }
 
+    /** Inserts the bytes of a plain value into the hash.
+        The object representation is hashed, so only use this for types without padding or indirection.
+        \param[in] value
+     */
+    template<typename U>
+    void insert(const U& value)
+    {
+        insert(&value, sizeof(U));
+    }
+
     T get() const { return mHash; }
 
 private:
@@ -27,68 +27,426 @@
  **************************************************************************/
 #include "Threading.h"
 #include "Core/Assert.h"
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <vector>
 
 namespace Falcor
 {
+    struct Threading::TaskGroup::State
+    {
+        std::atomic<size_t> pendingCount = 0;
+        std::mutex mutex;
+        std::exception_ptr exception;
+    };
+
+    struct Threading::Task::State
+    {
+        std::function<void(void)> func;
+        std::atomic<bool> done = false;
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::vector<std::shared_ptr<State>> continuations;
+        std::shared_ptr<TaskGroup::State> pGroup;
+    };
+
     namespace
     {
+        using TaskState = Threading::Task::State;
+        using TaskStatePtr = std::shared_ptr<TaskState>;
+
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<TaskStatePtr> tasks;
+        };
+
         struct ThreadingData
         {
-            bool initialized = false;
+            std::mutex startMutex;                  ///< Serializes start() and shutdown().
+            std::atomic<bool> initialized = false;
             std::vector<std::thread> threads;
-            uint32_t current;
+            std::vector<std::unique_ptr<Worker>> workers;
+            std::atomic<uint32_t> nextWorker = 0;   ///< Round-robin index for tasks dispatched from non-worker threads.
+
+            std::atomic<int64_t> queuedCount = 0;   ///< Number of tasks sitting in worker deques.
+            std::atomic<int64_t> activeCount = 0;   ///< Number of tasks dispatched but not finished yet.
+            std::atomic<uint32_t> sleeperCount = 0; ///< Number of threads blocked on the condition variable.
+            std::atomic<uint32_t> waiterCount = 0;  ///< Number of blocked threads waiting for task completion.
+
+            std::mutex mutex;
+            std::condition_variable cv;
+            bool stop = false;
         } gData; // TODO: REMOVEGLOBAL
+
+        thread_local int32_t tWorkerIndex = -1;
+
+        void wakeSleeper()
+        {
+            if (gData.sleeperCount.load() > 0)
+            {
+                { std::lock_guard<std::mutex> lock(gData.mutex); }
+                gData.cv.notify_one();
+            }
+        }
+
+        void wakeWaiters()
+        {
+            if (gData.waiterCount.load() > 0)
+            {
+                { std::lock_guard<std::mutex> lock(gData.mutex); }
+                gData.cv.notify_all();
+            }
+        }
+
+        void execute(const TaskStatePtr& pState);
+
+        void enqueue(TaskStatePtr pState)
+        {
+            if (!gData.initialized)
+            {
+                execute(pState);
+                return;
+            }
+
+            uint32_t workerCount = (uint32_t)gData.workers.size();
+            uint32_t index = tWorkerIndex >= 0 ? (uint32_t)tWorkerIndex : gData.nextWorker.fetch_add(1) % workerCount;
+            Worker& worker = *gData.workers[index];
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.tasks.push_back(std::move(pState));
+            }
+            gData.queuedCount.fetch_add(1);
+            wakeSleeper();
+        }
+
+        /** Pop a task. Workers take the most recently pushed task from their own deque,
+            otherwise the oldest task is stolen from another worker's deque.
+        */
+        TaskStatePtr pop(int32_t workerIndex)
+        {
+            if (gData.queuedCount.load() <= 0) return nullptr;
+
+            TaskStatePtr pState;
+            uint32_t workerCount = (uint32_t)gData.workers.size();
+
+            if (workerIndex >= 0)
+            {
+                Worker& worker = *gData.workers[workerIndex];
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                if (!worker.tasks.empty())
+                {
+                    pState = std::move(worker.tasks.back());
+                    worker.tasks.pop_back();
+                }
+            }
+
+            if (!pState)
+            {
+                uint32_t first = workerIndex >= 0 ? (uint32_t)workerIndex + 1 : gData.nextWorker.load();
+                for (uint32_t i = 0; i < workerCount && !pState; ++i)
+                {
+                    uint32_t victim = (first + i) % workerCount;
+                    if ((int32_t)victim == workerIndex) continue;
+                    Worker& worker = *gData.workers[victim];
+                    std::lock_guard<std::mutex> lock(worker.mutex);
+                    if (!worker.tasks.empty())
+                    {
+                        pState = std::move(worker.tasks.front());
+                        worker.tasks.pop_front();
+                    }
+                }
+            }
+
+            if (pState) gData.queuedCount.fetch_sub(1);
+            return pState;
+        }
+
+        void execute(const TaskStatePtr& pState)
+        {
+            try
+            {
+                pState->func();
+            }
+            catch (...)
+            {
+                pState->exception = std::current_exception();
+            }
+            pState->func = nullptr;
+
+            std::vector<TaskStatePtr> continuations;
+            {
+                std::lock_guard<std::mutex> lock(pState->mutex);
+                pState->done = true;
+                continuations.swap(pState->continuations);
+            }
+
+            if (auto pGroup = std::move(pState->pGroup))
+            {
+                if (pState->exception)
+                {
+                    std::lock_guard<std::mutex> lock(pGroup->mutex);
+                    if (!pGroup->exception) pGroup->exception = pState->exception;
+                }
+                pGroup->pendingCount.fetch_sub(1);
+            }
+
+            for (auto& pContinuation : continuations) enqueue(std::move(pContinuation));
+
+            gData.activeCount.fetch_sub(1);
+            wakeWaiters();
+        }
+
+        /** Execute pending tasks on the calling thread until the predicate is satisfied.
+        */
+        template<typename Pred>
+        void helpUntil(Pred isDone)
+        {
+            while (!isDone())
+            {
+                if (auto pState = pop(tWorkerIndex))
+                {
+                    execute(pState);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(gData.mutex);
+                gData.sleeperCount.fetch_add(1);
+                gData.waiterCount.fetch_add(1);
+                gData.cv.wait(lock, [&]() { return isDone() || gData.queuedCount.load() > 0; });
+                gData.waiterCount.fetch_sub(1);
+                gData.sleeperCount.fetch_sub(1);
+            }
+        }
+
+        void workerFunc(int32_t index)
+        {
+            tWorkerIndex = index;
+
+            while (true)
+            {
+                if (auto pState = pop(index))
+                {
+                    execute(pState);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(gData.mutex);
+                gData.sleeperCount.fetch_add(1);
+                gData.cv.wait(lock, []() { return gData.stop || gData.queuedCount.load() > 0; });
+                gData.sleeperCount.fetch_sub(1);
+                if (gData.stop && gData.queuedCount.load() <= 0) break;
+            }
+
+            tWorkerIndex = -1;
+        }
+
+        TaskStatePtr createTaskState(std::function<void(void)> func)
+        {
+            auto pState = std::make_shared<TaskState>();
+            pState->func = std::move(func);
+            gData.activeCount.fetch_add(1);
+            return pState;
+        }
     }
 
     void Threading::start(uint32_t threadCount)
     {
+        std::lock_guard<std::mutex> lock(gData.startMutex);
         if (gData.initialized) return;
 
-        gData.threads.resize(threadCount);
+        if (threadCount == 0) threadCount = std::max(1u, getLogicalThreadCount());
+
+        gData.workers.resize(threadCount);
+        for (auto& pWorker : gData.workers) pWorker = std::make_unique<Worker>();
+
+        gData.stop = false;
+        gData.threads.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i) gData.threads.emplace_back(workerFunc, (int32_t)i);
+
         gData.initialized = true;
     }
 
     void Threading::shutdown()
     {
+        std::lock_guard<std::mutex> lock(gData.startMutex);
+        if (!gData.initialized) return;
+
+        finish();
+
+        {
+            std::lock_guard<std::mutex> stopLock(gData.mutex);
+            gData.stop = true;
+        }
+        gData.cv.notify_all();
+
         for (auto& t : gData.threads)
         {
             if (t.joinable()) t.join();
         }
 
+        gData.threads.clear();
+        gData.workers.clear();
         gData.initialized = false;
     }
 
-    Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
+    bool Threading::isRunning()
     {
-        FALCOR_ASSERT(gData.initialized);
+        return gData.initialized;
+    }
 
-        std::thread& t = gData.threads[gData.current];
-        if (t.joinable()) t.join();
-        t = std::thread(func);
-        gData.current = (gData.current + 1) % gData.threads.size();
+    uint32_t Threading::getThreadCount()
+    {
+        return gData.initialized ? (uint32_t)gData.threads.size() : 0;
+    }
+
+    int32_t Threading::getWorkerIndex()
+    {
+        return tWorkerIndex;
+    }
 
-        return Task();
+    Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
+    {
+        auto pState = createTaskState(func);
+        enqueue(pState);
+        return Task(pState);
     }
 
     void Threading::finish()
     {
-        for (auto& t : gData.threads)
+        if (!gData.initialized) return;
+        FALCOR_ASSERT(tWorkerIndex < 0);
+
+        helpUntil([]() { return gData.activeCount.load() <= 0; });
+    }
+
+    void Threading::parallelForRange(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize)
+    {
+        if (begin >= end) return;
+
+        size_t count = end - begin;
+        size_t threadCount = getThreadCount();
+        if (grainSize == 0) grainSize = std::max<size_t>(1, count / (std::max<size_t>(1, threadCount) * 8));
+        size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+        std::atomic<size_t> nextChunk = 0;
+        auto runChunks = [&]()
         {
-            if (t.joinable()) t.join();
+            size_t chunk;
+            while ((chunk = nextChunk.fetch_add(1)) < chunkCount)
+            {
+                size_t chunkBegin = begin + chunk * grainSize;
+                size_t chunkEnd = std::min(end, chunkBegin + grainSize);
+                func(chunkBegin, chunkEnd);
+            }
+        };
+
+        if (threadCount == 0 || chunkCount == 1)
+        {
+            runChunks();
+            return;
+        }
+
+        // The calling thread works on chunks as well, so one helper task less than there are chunks is enough.
+        TaskGroup group;
+        size_t taskCount = std::min(threadCount, chunkCount - 1);
+        for (size_t i = 0; i < taskCount; ++i) group.run(runChunks);
+
+        std::exception_ptr exception;
+        try
+        {
+            runChunks();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
         }
+
+        // Tasks reference the stack, so always wait for them before returning or rethrowing.
+        group.wait();
+        if (exception) std::rethrow_exception(exception);
     }
 
-    Threading::Task::Task()
+    void Threading::parallelFor(size_t begin, size_t end, const std::function<void(size_t)>& func, size_t grainSize)
     {
+        parallelForRange(begin, end, [&func](size_t chunkBegin, size_t chunkEnd)
+        {
+            for (size_t i = chunkBegin; i < chunkEnd; ++i) func(i);
+        }, grainSize);
     }
 
-    bool Threading::Task::isRunning()
+    bool Threading::Task::isRunning() const
     {
-        FALCOR_UNIMPLEMENTED();
+        return mpState && !mpState->done.load();
     }
 
     void Threading::Task::finish()
     {
-        FALCOR_UNIMPLEMENTED();
+        if (!mpState) return;
+
+        auto pState = mpState;
+        helpUntil([&pState]() { return pState->done.load(); });
+        if (pState->exception) std::rethrow_exception(pState->exception);
+    }
+
+    Threading::Task Threading::Task::then(std::function<void(void)> func)
+    {
+        auto pContinuation = createTaskState(std::move(func));
+        if (!mpState)
+        {
+            enqueue(pContinuation);
+            return Task(pContinuation);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mpState->mutex);
+            if (!mpState->done)
+            {
+                mpState->continuations.push_back(pContinuation);
+                return Task(pContinuation);
+            }
+        }
+
+        enqueue(pContinuation);
+        return Task(pContinuation);
+    }
+
+    Threading::TaskGroup::TaskGroup()
+        : mpState(std::make_shared<State>())
+    {
+    }
+
+    Threading::TaskGroup::~TaskGroup()
+    {
+        // Tasks may reference data owned by the caller, never leave them running.
+        auto pState = mpState;
+        helpUntil([&pState]() { return pState->pendingCount.load() == 0; });
+    }
+
+    void Threading::TaskGroup::run(std::function<void(void)> func)
+    {
+        auto pTask = createTaskState(std::move(func));
+        pTask->pGroup = mpState;
+        mpState->pendingCount.fetch_add(1);
+        enqueue(std::move(pTask));
+    }
+
+    bool Threading::TaskGroup::isRunning() const
+    {
+        return mpState->pendingCount.load() > 0;
+    }
+
+    void Threading::TaskGroup::wait()
+    {
+        auto pState = mpState;
+        helpUntil([&pState]() { return pState->pendingCount.load() == 0; });
+
+        std::exception_ptr exception;
+        {
+            std::lock_guard<std::mutex> lock(pState->mutex);
+            std::swap(exception, pState->exception);
+        }
+        if (exception) std::rethrow_exception(exception);
     }
 }
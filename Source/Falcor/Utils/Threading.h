@@ -27,52 +27,130 @@
  **************************************************************************/
 #pragma once
 #include "Core/Macros.h"
+#include <atomic>
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <cstdint>
 
 namespace Falcor
 {
+    /** Global task scheduler.
+
+        Tasks are executed by a persistent pool of worker threads. Each worker owns a task deque.
+        Tasks dispatched from a worker are pushed onto its own deque and executed in LIFO order,
+        idle workers steal from the other end of the deques of busy workers.
+        Threads waiting on a task or task group help executing pending tasks instead of blocking,
+        so it is safe to wait on tasks from within other tasks.
+
+        If the thread pool is not started, tasks are executed synchronously on the calling thread.
+    */
     class FALCOR_API Threading
     {
     public:
-        const static uint32_t kDefaultThreadCount = 16;
-
-        /** Handle to a dispatched task
+        /** Default thread count. Zero means one worker per logical core.
+        */
+        const static uint32_t kDefaultThreadCount = 0;
 
-            TODO: Implementation
+        /** Handle to a dispatched task.
+            A default constructed handle does not refer to any task and is never running.
         */
-        class Task
+        class FALCOR_API Task
         {
         public:
+            Task() = default;
+
             /** Check if task is still executing
             */
-            bool isRunning();
+            bool isRunning() const;
 
-            /** Wait for task to finish executing
+            /** Wait for task to finish executing.
+                The calling thread executes other pending tasks while waiting.
+                Rethrows any exception thrown by the task.
             */
             void finish();
 
+            /** Add a continuation that is dispatched once this task has finished.
+                If the task has already finished, the continuation is dispatched immediately.
+                \param[in] func Function to run.
+                \return Handle to the continuation task.
+            */
+            Task then(std::function<void(void)> func);
+
+            /** Check if the handle refers to a task.
+            */
+            bool isValid() const { return mpState != nullptr; }
+
+            /// Opaque task state (implementation detail).
+            struct State;
+
         private:
-            Task();
+            Task(std::shared_ptr<State> pState) : mpState(std::move(pState)) {}
+            std::shared_ptr<State> mpState;
             friend class Threading;
         };
 
+        /** Group of tasks that can be waited on collectively.
+            Use this instead of keeping a list of task handles when dispatching many small tasks.
+        */
+        class FALCOR_API TaskGroup
+        {
+        public:
+            TaskGroup();
+            ~TaskGroup();
+
+            TaskGroup(const TaskGroup&) = delete;
+            TaskGroup& operator=(const TaskGroup&) = delete;
+
+            /** Dispatch a task as part of this group.
+                \param[in] func Function to run.
+            */
+            void run(std::function<void(void)> func);
+
+            /** Check if any task in the group is still executing.
+            */
+            bool isRunning() const;
+
+            /** Wait for all tasks in the group to finish.
+                The calling thread executes other pending tasks while waiting.
+                Rethrows the first exception thrown by any of the tasks.
+            */
+            void wait();
+
+            /// Opaque group state (implementation detail).
+            struct State;
+
+        private:
+            std::shared_ptr<State> mpState;
+        };
+
         /** Initializes the global thread pool
-            \param[in] threadCount Number of threads in the pool
+            \param[in] threadCount Number of threads in the pool. Zero uses the logical thread count.
         */
         static void start(uint32_t threadCount = kDefaultThreadCount);
 
-        /** Waits for all currently executing threads to finish
+        /** Waits for all currently executing tasks to finish
         */
         static void finish();
 
-        /** Waits for all currently executing threads to finish and shuts down the thread pool
+        /** Waits for all currently executing tasks to finish and shuts down the thread pool
         */
         static void shutdown();
 
+        /** Returns true if the thread pool is running.
+        */
+        static bool isRunning();
+
+        /** Returns the number of worker threads in the pool (zero if not started).
+        */
+        static uint32_t getThreadCount();
+
+        /** Returns the index of the calling worker thread or -1 if not called from a worker thread.
+        */
+        static int32_t getWorkerIndex();
+
         /** Returns the maximum number of concurrent threads supported by the hardware
         */
         static uint32_t getLogicalThreadCount() { return std::thread::hardware_concurrency(); }
@@ -81,6 +159,25 @@ namespace Falcor
             \return Handle to the task
         */
         static Task dispatchTask(const std::function<void(void)>& func);
+
+        /** Execute a function for each index in [begin, end) in parallel.
+            The range is split into chunks of grainSize indices that are distributed over the worker threads.
+            The calling thread participates in the work and returns once all indices have been processed.
+            \param[in] begin First index.
+            \param[in] end One past the last index.
+            \param[in] func Function called with each index.
+            \param[in] grainSize Number of indices per chunk. Zero chooses a chunk size based on the thread count.
+        */
+        static void parallelFor(size_t begin, size_t end, const std::function<void(size_t)>& func, size_t grainSize = 0);
+
+        /** Execute a function for chunks of the range [begin, end) in parallel.
+            Same as parallelFor() but the function is called once per chunk with the chunk's [begin, end) range.
+            \param[in] begin First index.
+            \param[in] end One past the last index.
+            \param[in] func Function called with the range of each chunk.
+            \param[in] grainSize Number of indices per chunk. Zero chooses a chunk size based on the thread count.
+        */
+        static void parallelForRange(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize = 0);
     };
 
     /** Simple thread barrier class.
@@ -0,0 +1,329 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CpuEventRecorder.h"
+#include "Core/Assert.h"
+#include "Utils/Threading.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        using EventId = CpuEventRecorder::EventId;
+        using Record = CpuEventRecorder::Record;
+
+        /** Single-producer/single-consumer ring buffer of event records.
+            The owning thread is the only producer, the drain is the only consumer.
+            When the ring buffer fills up, the producer moves its records to the staging list, so that threads recording
+            many events between drains don't drop them. The tail and the staging list are protected by the mutex.
+        */
+        struct ThreadBuffer
+        {
+            std::unique_ptr<Record[]> records{new Record[CpuEventRecorder::kBufferCapacity]};
+            std::atomic<uint64_t> head{0};      ///< Next record to write (producer).
+            std::atomic<uint64_t> tail{0};      ///< Next record to read (consumer, or producer when staging).
+            std::atomic<bool> exited{false};    ///< True once the owning thread has exited.
+            uint32_t threadIndex = 0;
+
+            std::mutex mutex;
+            std::vector<Record> stagedRecords;  ///< Records moved out of the ring buffer, older than the ones in the ring buffer.
+        };
+
+        struct ThreadState
+        {
+            std::shared_ptr<ThreadBuffer> pBuffer;
+            uint32_t depth = 0;                 ///< Current event nesting depth.
+            uint64_t recordedMask = 0;          ///< Bit i is set if the open event at depth i is recorded.
+            uint32_t pendingEnds = 0;           ///< Number of recorded events still waiting for their end record.
+
+            ~ThreadState()
+            {
+                if (pBuffer) pBuffer->exited.store(true, std::memory_order_release);
+            }
+        };
+
+        static_assert(CpuEventRecorder::kMaxDepth <= 64, "recordedMask holds one bit per depth");
+
+        /** Global recorder state. Intentionally leaked so it outlives thread_local destructors during shutdown.
+        */
+        struct Registry
+        {
+            std::mutex eventMutex;
+            std::unordered_map<std::string, EventId> eventIds;
+            std::deque<std::string> eventNames;
+
+            std::mutex threadMutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+            std::vector<std::string> threadNames;
+            std::vector<uint32_t> freeThreadIndices;    ///< Indices of released thread buffers, reused by new threads.
+
+            std::atomic<bool> enabled{false};
+            std::atomic<uint64_t> droppedEventCount{0};
+            std::atomic<bool> drainRequested{false};
+
+            static Registry& get()
+            {
+                static Registry* pRegistry = new Registry();
+                return *pRegistry;
+            }
+        };
+
+        thread_local ThreadState tThreadState;
+
+        ThreadBuffer& getThreadBuffer()
+        {
+            ThreadState& state = tThreadState;
+            if (!state.pBuffer)
+            {
+                auto pBuffer = std::make_shared<ThreadBuffer>();
+                int32_t workerIndex = Threading::getWorkerIndex();
+
+                Registry& registry = Registry::get();
+                std::lock_guard<std::mutex> lock(registry.threadMutex);
+                auto& freeIndices = registry.freeThreadIndices;
+                if (freeIndices.empty())
+                {
+                    pBuffer->threadIndex = (uint32_t)registry.threadNames.size();
+                    registry.threadNames.emplace_back();
+                }
+                else
+                {
+                    // Reuse the lowest free index to keep thread indices compact.
+                    auto it = std::min_element(freeIndices.begin(), freeIndices.end());
+                    pBuffer->threadIndex = *it;
+                    freeIndices.erase(it);
+                }
+                registry.threadNames[pBuffer->threadIndex] = workerIndex >= 0 ? fmt::format("Worker {}", workerIndex) : fmt::format("Thread {}", pBuffer->threadIndex);
+                registry.threadBuffers.push_back(pBuffer);
+                state.pBuffer = std::move(pBuffer);
+            }
+            return *state.pBuffer;
+        }
+
+        void writeRecord(ThreadBuffer& buffer, uint64_t head, EventId id, uint32_t data)
+        {
+            Record& record = buffer.records[head % CpuEventRecorder::kBufferCapacity];
+            record.time = CpuEventRecorder::getTime();
+            record.id = id;
+            record.data = data;
+            buffer.head.store(head + 1, std::memory_order_release);
+        }
+
+        /** Move the records of the calling thread's ring buffer to the staging list.
+            Called by the producer, does nothing if the buffer is being drained or the staging list is full.
+        */
+        void stageRecords(ThreadBuffer& buffer)
+        {
+            std::unique_lock<std::mutex> lock(buffer.mutex, std::try_to_lock);
+            if (!lock.owns_lock()) return;
+
+            uint64_t head = buffer.head.load(std::memory_order_relaxed);
+            uint64_t tail = buffer.tail.load(std::memory_order_relaxed);
+            if (buffer.stagedRecords.size() + (head - tail) > CpuEventRecorder::kMaxStagedRecords) return;
+
+            for (; tail != head; ++tail) buffer.stagedRecords.push_back(buffer.records[tail % CpuEventRecorder::kBufferCapacity]);
+            buffer.tail.store(tail, std::memory_order_release);
+        }
+    }
+
+    CpuEventRecorder::EventId CpuEventRecorder::registerEvent(std::string_view name)
+    {
+        Registry& registry = Registry::get();
+        std::lock_guard<std::mutex> lock(registry.eventMutex);
+        auto [it, inserted] = registry.eventIds.try_emplace(std::string(name), (EventId)registry.eventNames.size());
+        if (inserted) registry.eventNames.push_back(it->first);
+        return it->second;
+    }
+
+    const std::string& CpuEventRecorder::getEventName(EventId id)
+    {
+        Registry& registry = Registry::get();
+        std::lock_guard<std::mutex> lock(registry.eventMutex);
+        FALCOR_ASSERT(id < registry.eventNames.size());
+        return registry.eventNames[id];
+    }
+
+    void CpuEventRecorder::setEnabled(bool enabled)
+    {
+        Registry::get().enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool CpuEventRecorder::isEnabled()
+    {
+        return Registry::get().enabled.load(std::memory_order_relaxed);
+    }
+
+    bool CpuEventRecorder::beginEvent(EventId id, uint32_t payload)
+    {
+        ThreadState& state = tThreadState;
+        uint32_t depth = state.depth++;
+        if (depth >= kMaxDepth) return false;
+
+        // Only record events whose parent is recorded, so that dropped subtrees stay consistent.
+        const uint64_t bit = 1ull << depth;
+        bool parentRecorded = depth == 0 || (state.recordedMask & (bit >> 1)) != 0;
+        bool record = parentRecorded && isEnabled();
+        if (record)
+        {
+            ThreadBuffer& buffer = getThreadBuffer();
+            uint64_t head = buffer.head.load(std::memory_order_relaxed);
+            uint64_t tail = buffer.tail.load(std::memory_order_acquire);
+            // Keep room for the end records of all open events plus this event's begin and end record.
+            if (kBufferCapacity - (head - tail) < state.pendingEnds + 2)
+            {
+                Registry::get().droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+                record = false;
+            }
+            else
+            {
+                writeRecord(buffer, head, id, Record::kBeginBit | (payload & ~Record::kBeginBit));
+                state.pendingEnds++;
+                if (head + 1 - tail >= kDrainThreshold)
+                {
+                    Registry::get().drainRequested.store(true, std::memory_order_relaxed);
+                    stageRecords(buffer);
+                }
+            }
+        }
+
+        if (record) state.recordedMask |= bit;
+        else state.recordedMask &= ~bit;
+        return record;
+    }
+
+    void CpuEventRecorder::endEvent()
+    {
+        ThreadState& state = tThreadState;
+        FALCOR_ASSERT(state.depth > 0);
+        if (state.depth == 0) return;
+
+        uint32_t depth = --state.depth;
+        if (depth >= kMaxDepth) return;
+
+        const uint64_t bit = 1ull << depth;
+        if ((state.recordedMask & bit) == 0) return;
+        state.recordedMask &= ~bit;
+
+        // Space for the end record was reserved in beginEvent().
+        ThreadBuffer& buffer = *state.pBuffer;
+        writeRecord(buffer, buffer.head.load(std::memory_order_relaxed), kInvalidEventId, 0);
+        state.pendingEnds--;
+    }
+
+    uint32_t CpuEventRecorder::getThreadIndex()
+    {
+        return getThreadBuffer().threadIndex;
+    }
+
+    std::string CpuEventRecorder::getThreadName(uint32_t threadIndex)
+    {
+        Registry& registry = Registry::get();
+        std::lock_guard<std::mutex> lock(registry.threadMutex);
+        return threadIndex < registry.threadNames.size() ? registry.threadNames[threadIndex] : fmt::format("Thread {}", threadIndex);
+    }
+
+    uint64_t CpuEventRecorder::getDroppedEventCount()
+    {
+        return Registry::get().droppedEventCount.load(std::memory_order_relaxed);
+    }
+
+    bool CpuEventRecorder::isDrainRequested()
+    {
+        return Registry::get().drainRequested.load(std::memory_order_relaxed);
+    }
+
+    void CpuEventRecorder::drain(const DrainCallback& callback, const ReleaseCallback& releaseCallback)
+    {
+        Registry& registry = Registry::get();
+        registry.drainRequested.store(false, std::memory_order_relaxed);
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(registry.threadMutex);
+            buffers = registry.threadBuffers;
+        }
+
+        bool hasExited = false;
+        for (const auto& pBuffer : buffers)
+        {
+            std::lock_guard<std::mutex> lock(pBuffer->mutex);
+
+            // Staged records are older than the ones in the ring buffer.
+            for (const auto& record : pBuffer->stagedRecords) callback(pBuffer->threadIndex, record);
+            std::vector<Record>().swap(pBuffer->stagedRecords);
+
+            // Check for exit before loading the head, so that no records are written after the head we read.
+            bool exited = pBuffer->exited.load(std::memory_order_acquire);
+            uint64_t head = pBuffer->head.load(std::memory_order_acquire);
+            uint64_t tail = pBuffer->tail.load(std::memory_order_relaxed);
+            for (; tail != head; ++tail)
+            {
+                callback(pBuffer->threadIndex, pBuffer->records[tail % kBufferCapacity]);
+            }
+            pBuffer->tail.store(tail, std::memory_order_release);
+            hasExited |= exited;
+        }
+
+        // Release the buffers of exited threads. All their records have been drained above.
+        if (hasExited)
+        {
+            std::vector<uint32_t> releasedIndices;
+            {
+                std::lock_guard<std::mutex> lock(registry.threadMutex);
+                auto& threadBuffers = registry.threadBuffers;
+                threadBuffers.erase(std::remove_if(threadBuffers.begin(), threadBuffers.end(), [&](const auto& pBuffer) {
+                    bool released = pBuffer->exited.load(std::memory_order_acquire) && pBuffer->tail.load(std::memory_order_relaxed) == pBuffer->head.load(std::memory_order_acquire);
+                    if (released) releasedIndices.push_back(pBuffer->threadIndex);
+                    return released;
+                }), threadBuffers.end());
+            }
+
+            // Notify the consumer before the indices can be handed out to new threads.
+            if (releaseCallback)
+            {
+                for (uint32_t threadIndex : releasedIndices) releaseCallback(threadIndex);
+            }
+
+            std::lock_guard<std::mutex> lock(registry.threadMutex);
+            registry.freeThreadIndices.insert(registry.freeThreadIndices.end(), releasedIndices.begin(), releasedIndices.end());
+        }
+    }
+
+    uint64_t CpuEventRecorder::getTime()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
@@ -0,0 +1,167 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace Falcor
+{
+    /** Low-overhead recorder for hierarchical CPU profiler events.
+        Events are identified by interned IDs and can be recorded from any thread. Each thread keeps its own event stack
+        and writes begin/end records into its own single-producer/single-consumer ring buffer, so recording an event
+        usually neither allocates memory nor takes a lock. The records of all threads are drained periodically by a single
+        consumer (the Profiler, once per frame and whenever a ring buffer fills up, see isDrainRequested()).
+        When a ring buffer fills up before it is drained, e.g. on worker threads during scene loading, the recording thread
+        moves its records to a per-thread staging list, which is drained along with the ring buffer.
+        If the staging list is full as well, whole event subtrees are dropped, so drained begin/end records always match.
+    */
+    class FALCOR_API CpuEventRecorder
+    {
+    public:
+        using EventId = uint32_t;
+
+        static constexpr EventId kInvalidEventId = EventId(-1);
+        static constexpr uint32_t kMaxDepth = 64;               ///< Events nested deeper are not recorded.
+        static constexpr size_t kBufferCapacity = 1 << 16;      ///< Number of records per thread ring buffer.
+        static constexpr size_t kDrainThreshold = kBufferCapacity / 2; ///< Fill level of a ring buffer at which a drain is requested and the records are staged.
+        static constexpr size_t kMaxStagedRecords = 16 * kBufferCapacity; ///< Maximum number of staged records per thread.
+
+        struct Record
+        {
+            static constexpr uint32_t kBeginBit = 0x80000000u;
+
+            uint64_t time;      ///< Time stamp in nanoseconds (steady clock).
+            EventId id;         ///< Event ID.
+            uint32_t data;      ///< Record type and payload.
+
+            bool isBegin() const { return (data & kBeginBit) != 0; }
+            uint32_t getPayload() const { return data & ~kBeginBit; }
+        };
+
+        /** Callback receiving drained records.
+            \param[in] threadIndex Index of the thread that recorded the event.
+            \param[in] record The record.
+        */
+        using DrainCallback = std::function<void(uint32_t threadIndex, const Record& record)>;
+
+        /** Callback notified when the buffer of an exited thread is released.
+            The thread index is reused by threads created afterwards, so per-thread state of the consumer should be reset.
+            \param[in] threadIndex Index of the exited thread.
+        */
+        using ReleaseCallback = std::function<void(uint32_t threadIndex)>;
+
+        /** Register an event name. This is thread-safe but takes a lock, so IDs of fixed names should be kept in static variables.
+            \param[in] name Event name.
+            \return Returns the event ID, which is the same for all registrations of the same name.
+        */
+        static EventId registerEvent(std::string_view name);
+
+        /** Get the name of a registered event. Thread-safe.
+            \param[in] id Event ID.
+            \return Returns the event name.
+        */
+        static const std::string& getEventName(EventId id);
+
+        /** Enable/disable recording. Events that started while recording was disabled are not recorded.
+        */
+        static void setEnabled(bool enabled);
+
+        /** Check if recording is enabled.
+        */
+        static bool isEnabled();
+
+        /** Begin an event on the calling thread. Must be matched by a call to endEvent() on the same thread.
+            \param[in] id Event ID.
+            \param[in] payload User data passed on with the begin record (31 bits).
+            \return Returns true if the event is recorded.
+        */
+        static bool beginEvent(EventId id, uint32_t payload = 0);
+
+        /** End the innermost event on the calling thread.
+        */
+        static void endEvent();
+
+        /** Get the index of the calling thread. Thread indices are assigned when threads first record events.
+            Indices of exited threads are reused once all their records have been drained.
+        */
+        static uint32_t getThreadIndex();
+
+        /** Get the display name of a thread.
+            \param[in] threadIndex Thread index.
+            \return Returns the thread name.
+        */
+        static std::string getThreadName(uint32_t threadIndex);
+
+        /** Get the total number of events dropped due to full ring buffers.
+        */
+        static uint64_t getDroppedEventCount();
+
+        /** Check if a drain is requested because a ring buffer filled up to kDrainThreshold since the last drain.
+            Consumers that only drain periodically should check this during long-running work to avoid dropping events.
+        */
+        static bool isDrainRequested();
+
+        /** Drain the records of all threads.
+            Must not be called concurrently from multiple threads. Records of each thread are passed on in order.
+            \param[in] callback Function called for each record.
+            \param[in] releaseCallback Optional function called for each exited thread after its last record was drained.
+        */
+        static void drain(const DrainCallback& callback, const ReleaseCallback& releaseCallback = {});
+
+        /** Get the current time stamp as used for records.
+            \return Returns the time in nanoseconds.
+        */
+        static uint64_t getTime();
+    };
+
+    /** Helper class for recording CPU events using RAII (see FALCOR_PROFILE_CPU).
+    */
+    class ScopedCpuProfilerEvent
+    {
+    public:
+        ScopedCpuProfilerEvent(CpuEventRecorder::EventId id) { CpuEventRecorder::beginEvent(id); }
+        ~ScopedCpuProfilerEvent() { CpuEventRecorder::endEvent(); }
+
+        ScopedCpuProfilerEvent(const ScopedCpuProfilerEvent&) = delete;
+        ScopedCpuProfilerEvent& operator=(const ScopedCpuProfilerEvent&) = delete;
+    };
+}
+
+#if FALCOR_ENABLE_PROFILER
+/** Profile the CPU time of the enclosing scope. Can be used on any thread.
+    The event name is resolved once per call site, so it must not change between calls.
+*/
+#define FALCOR_PROFILE_CPU(_name) \
+    static const Falcor::CpuEventRecorder::EventId FALCOR_CONCAT_STRINGS(_profileEventId, __LINE__) = Falcor::CpuEventRecorder::registerEvent(_name); \
+    Falcor::ScopedCpuProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(FALCOR_CONCAT_STRINGS(_profileEventId, __LINE__))
+#else
+#define FALCOR_PROFILE_CPU(_name)
+#endif
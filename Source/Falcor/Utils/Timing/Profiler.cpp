@@ -30,7 +30,9 @@
 #include "Core/API/GpuTimer.h"
 #include "Utils/Logger.h"
 #include "Utils/Scripting/ScriptBindings.h"
+#include <algorithm>
 #include <fstream>
+#include <limits>
 
 namespace Falcor
 {
@@ -44,6 +46,10 @@ namespace Falcor
         // Size of the event history. The event history is keeping track of event times to allow
         // for computing statistics (min, max, mean, stddev) over the recent history.
         const size_t kMaxHistorySize = 512;
+
+        // Process IDs used for CPU and GPU events in traces.
+        const uint32_t kTraceCpuPid = 1;
+        const uint32_t kTraceGpuPid = 2;
     }
 
     // Profiler::Stats
@@ -88,8 +94,9 @@ namespace Falcor
 
     // Profiler::Event
 
-    Profiler::Event::Event(const std::string& name)
+    Profiler::Event::Event(const std::string& name, Event* pParent)
         : mName(name)
+        , mpParent(pParent)
         , mCpuTimeHistory(kMaxHistorySize, 0.f)
         , mGpuTimeHistory(kMaxHistorySize, 0.f)
     {}
@@ -104,70 +111,16 @@ namespace Falcor
         return Stats::compute(mGpuTimeHistory.data(), mHistorySize);
     }
 
-    void Profiler::Event::start(Profiler& profiler, uint32_t frameIndex)
+    void Profiler::Event::endFrame(const std::vector<GpuTimer::SharedPtr>& gpuTimers, uint32_t frameIndex)
     {
-        if (++mTriggered > 1)
-        {
-            logWarning("Profiler event '{}' was triggered while it is already running. Nesting profiler events with the same name is disallowed and you should probably fix that. Ignoring the new call.", mName);
-            return;
-        }
-
+        // Update CPU/GPU time from the frame measurement.
         auto& frameData = mFrameData[frameIndex % 2];
 
-        // Update CPU time.
-        frameData.cpuStartTime = CpuTimer::getCurrentTimePoint();
-
-        // Update GPU time.
-        FALCOR_ASSERT(frameData.pActiveTimer == nullptr);
-        FALCOR_ASSERT(frameData.currentTimer <= frameData.pTimers.size());
-        if (frameData.currentTimer == frameData.pTimers.size())
-        {
-            frameData.pTimers.push_back(GpuTimer::create(profiler.mpDevice));
-        }
-        frameData.pActiveTimer = frameData.pTimers[frameData.currentTimer++].get();
-        frameData.pActiveTimer->begin();
-        frameData.valid = false;
-    }
-
-    void Profiler::Event::end(uint32_t frameIndex)
-    {
-        if (--mTriggered != 0) return;
-
-        auto& frameData = mFrameData[frameIndex % 2];
-
-        // Update CPU time.
-        frameData.cpuTotalTime += (float)CpuTimer::calcDuration(frameData.cpuStartTime, CpuTimer::getCurrentTimePoint());
-
-        // Update GPU time.
-        FALCOR_ASSERT(frameData.pActiveTimer != nullptr);
-        frameData.pActiveTimer->end();
-        frameData.pActiveTimer = nullptr;
-        frameData.valid = true;
-    }
-
-    void Profiler::Event::endFrame(uint32_t frameIndex)
-    {
-        // Resolve GPU timers for the current frame measurements.
-        // This is necessary before we readback of results next frame.
-        {
-            auto& frameData = mFrameData[frameIndex % 2];
-            for (auto& pTimer : frameData.pTimers)
-            {
-                pTimer->resolve();
-            }
-        }
-
-        // Update CPU/GPU time from last frame measurement.
-        auto& frameData = mFrameData[(frameIndex + 1) % 2];
-
-        // Skip update if there are no measurements last frame.
-        if (!frameData.valid) return;
-
         mCpuTime = frameData.cpuTotalTime;
         mGpuTime = 0.f;
-        for (size_t i = 0; i < frameData.currentTimer; ++i) mGpuTime += (float)frameData.pTimers[i]->getElapsedTime();
+        for (uint32_t timerIndex : frameData.gpuTimers) mGpuTime += (float)gpuTimers[timerIndex]->getElapsedTime();
         frameData.cpuTotalTime = 0.f;
-        frameData.currentTimer = 0;
+        frameData.gpuTimers.clear();
 
         // Update EMA.
         mCpuTimeAverage = mCpuTimeAverage < 0.f ? mCpuTime : (kSigma * mCpuTimeAverage + (1.f - kSigma) * mCpuTime);
@@ -178,8 +131,6 @@ namespace Falcor
         mGpuTimeHistory[mHistoryWriteIndex] = mGpuTime;
         mHistoryWriteIndex = (mHistoryWriteIndex + 1) % kMaxHistorySize;
         mHistorySize = std::min(mHistorySize + 1, kMaxHistorySize);
-
-        mTriggered = 0;
     }
 
     // Profiler::Capture
@@ -281,51 +232,98 @@ namespace Falcor
 
     Profiler::Profiler(Device* pDevice)
         : mpDevice(pDevice)
+        , mThreadId(std::this_thread::get_id())
     {
         mpFence = GpuFence::create(mpDevice);
     }
 
-    void Profiler::startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
+    void Profiler::setEnabled(bool enabled)
     {
-        if (mEnabled && is_set(flags, Flags::Internal))
+        if (mEnabled && !enabled)
         {
-            // '/' is used as a "path delimiter", so it cannot be used in the event name.
-            if (name.find('/') != std::string::npos)
+            // Close events that are still open, their endEvent() calls are ignored while disabled.
+            while (!mActiveTimers.empty())
             {
-                logWarning("Profiler event names must not contain '/'. Ignoring this profiler event.");
-                return;
+                if (GpuTimer* pTimer = mActiveTimers.back()) pTimer->end();
+                mActiveTimers.pop_back();
+                CpuEventRecorder::endEvent();
             }
+        }
+        mEnabled = enabled;
+        updateRecorder();
+    }
 
-            mCurrentEventName = mCurrentEventName + "/" + name;
+    void Profiler::setPaused(bool paused)
+    {
+        mPaused = paused;
+        updateRecorder();
+    }
 
-            Event* pEvent = getEvent(mCurrentEventName);
-            FALCOR_ASSERT(pEvent != nullptr);
-            if (!mPaused) pEvent->start(*this, mFrameIndex);
+    Profiler::EventId Profiler::registerEventName(std::string_view name)
+    {
+        // '/' is used as a "path delimiter", so it cannot be used in the event name.
+        if (name.find('/') != std::string_view::npos)
+        {
+            logWarning("Profiler event names must not contain '/'. Ignoring this profiler event.");
+            return kInvalidEventId;
+        }
+        return CpuEventRecorder::registerEvent(name);
+    }
 
-            if (std::find(mCurrentFrameEvents.begin(), mCurrentFrameEvents.end(), pEvent) == mCurrentFrameEvents.end())
+    void Profiler::startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
+    {
+        startEvent(pRenderContext, registerEventName(name), flags);
+    }
+
+    void Profiler::startEvent(RenderContext* pRenderContext, EventId id, Flags flags)
+    {
+        if (id == kInvalidEventId) return;
+
+        if (mEnabled && is_set(flags, Flags::Internal))
+        {
+            // Drain early if a recorder buffer fills up, e.g. while worker threads record many events during loading.
+            if (CpuEventRecorder::isDrainRequested()) drainEvents();
+
+            // Reserve a GPU timer from the pool and pass its index along with the event record.
+            auto& pool = mGpuTimers[mFrameIndex % 2];
+            uint32_t payload = 0;
+            if (CpuEventRecorder::isEnabled())
+            {
+                if (pool.used == pool.timers.size()) pool.timers.push_back(GpuTimer::create(mpDevice));
+                payload = (uint32_t)pool.used + 1;
+            }
+
+            GpuTimer* pTimer = nullptr;
+            if (CpuEventRecorder::beginEvent(id, payload) && payload != 0)
             {
-                mCurrentFrameEvents.push_back(pEvent);
+                pTimer = pool.timers[pool.used++].get();
+                pTimer->begin();
             }
+            mActiveTimers.push_back(pTimer);
         }
+
         if (is_set(flags, Flags::Pix))
         {
             FALCOR_ASSERT(pRenderContext);
-            pRenderContext->getLowLevelData()->beginDebugEvent(name.c_str());
+            pRenderContext->getLowLevelData()->beginDebugEvent(CpuEventRecorder::getEventName(id).c_str());
         }
     }
 
     void Profiler::endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags)
     {
-        if (mEnabled && is_set(flags, Flags::Internal))
-        {
-            // '/' is used as a "path delimiter", so it cannot be used in the event name.
-            if (name.find('/') != std::string::npos) return;
+        // Invalid names were already reported in startEvent().
+        endEvent(pRenderContext, name.find('/') == std::string::npos ? CpuEventRecorder::registerEvent(name) : kInvalidEventId, flags);
+    }
 
-            Event* pEvent = getEvent(mCurrentEventName);
-            FALCOR_ASSERT(pEvent != nullptr);
-            if (!mPaused) pEvent->end(mFrameIndex);
+    void Profiler::endEvent(RenderContext* pRenderContext, EventId id, Flags flags)
+    {
+        if (id == kInvalidEventId) return;
 
-            mCurrentEventName.erase(mCurrentEventName.find_last_of("/"));
+        if (mEnabled && is_set(flags, Flags::Internal) && !mActiveTimers.empty())
+        {
+            CpuEventRecorder::endEvent();
+            if (GpuTimer* pTimer = mActiveTimers.back()) pTimer->end();
+            mActiveTimers.pop_back();
         }
 
         if (is_set(flags, Flags::Pix))
@@ -345,26 +343,48 @@ namespace Falcor
     {
         if (mPaused) return;
 
+        // Collect the events recorded on all threads during this frame.
+        drainEvents();
+
         // Wait for GPU timings to be available from last frame.
         // We use a single fence here instead of one per event, which gets too inefficient.
         // TODO: This code should refactored to batch the resolve and readback of timestamps.
         if (mFenceValue != uint64_t(-1)) mpFence->syncCpu();
 
-        for (Event* pEvent : mCurrentFrameEvents)
-        {
-            pEvent->endFrame(mFrameIndex);
-        }
+        // Resolve GPU timers for the current frame measurements.
+        // This is necessary before we readback of results next frame.
+        auto& pool = mGpuTimers[mFrameIndex % 2];
+        for (size_t i = 0; i < pool.used; ++i) pool.timers[i]->resolve();
+
+        // Update CPU/GPU times of the events from last frame.
+        const uint32_t lastFrameIndex = mFrameIndex + 1; // Same buffer index as mFrameIndex - 1.
+        auto& lastPool = mGpuTimers[lastFrameIndex % 2];
+        auto& lastEvents = mFrameEvents[lastFrameIndex % 2];
+        for (Event* pEvent : lastEvents) pEvent->endFrame(lastPool.timers, lastFrameIndex);
+        auto& lastGpuTraceEvents = mGpuTraceEvents[lastFrameIndex % 2];
+        if (mpTraceWriter) writeGpuTraceEvents(lastPool.timers, lastGpuTraceEvents);
+        lastGpuTraceEvents.clear();
+        lastPool.used = 0;
 
         // Flush and insert signal for synchronization of GPU timings.
         pRenderContext->flush(false);
         mFenceValue = mpFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
 
-        if (mpCapture) mpCapture->captureEvents(mCurrentFrameEvents);
+        mLastFrameEvents = std::move(lastEvents);
+        lastEvents.clear();
+
+        if (mpCapture) mpCapture->captureEvents(mLastFrameEvents);
 
-        mLastFrameEvents = std::move(mCurrentFrameEvents);
         ++mFrameIndex;
     }
 
+    void Profiler::drainEvents()
+    {
+        // The event hierarchy is not thread-safe, so only the profiler's thread resolves events.
+        if (std::this_thread::get_id() != mThreadId) return;
+        processRecords(CpuEventRecorder::getThreadIndex());
+    }
+
     void Profiler::startCapture(size_t reservedFrames)
     {
         setEnabled(true);
@@ -384,6 +404,36 @@ namespace Falcor
         return mpCapture != nullptr;
     }
 
+    void Profiler::startTrace(const std::filesystem::path& path)
+    {
+        endTrace();
+
+        mpTraceWriter = std::make_unique<TraceWriter>(path);
+        mpTraceWriter->setProcessName(kTraceCpuPid, "CPU");
+        mpTraceWriter->setProcessName(kTraceGpuPid, "GPU");
+        mpTraceWriter->setThreadName(kTraceGpuPid, 0, "Command queue");
+        mTraceStartTime = CpuEventRecorder::getTime();
+        for (auto& [threadIndex, thread] : mThreads) thread.traceNamed = false;
+        for (auto& events : mGpuTraceEvents) events.clear();
+
+        mTraceWasEnabled = mEnabled;
+        setEnabled(true);
+    }
+
+    void Profiler::endTrace()
+    {
+        if (!mpTraceWriter) return;
+
+        // Write the CPU events recorded since the last frame. GPU events of unfinished frames are not written.
+        drainEvents();
+
+        mpTraceWriter->close();
+        logInfo("Profiler: Wrote trace to '{}'.", mpTraceWriter->getPath());
+        mpTraceWriter.reset();
+
+        setEnabled(mTraceWasEnabled);
+    }
+
     pybind11::dict Profiler::getPythonEvents() const
     {
         pybind11::dict result;
@@ -407,9 +457,9 @@ namespace Falcor
         return result;
     }
 
-    Profiler::Event* Profiler::createEvent(const std::string& name)
+    Profiler::Event* Profiler::createEvent(const std::string& name, Event* pParent)
     {
-        auto pEvent = std::shared_ptr<Event>(new Event(name));
+        auto pEvent = std::shared_ptr<Event>(new Event(name, pParent));
         mEvents.emplace(name, pEvent);
         return pEvent.get();
     }
@@ -420,19 +470,140 @@ namespace Falcor
         return (event == mEvents.end()) ? nullptr : event->second.get();
     }
 
+    Profiler::Event* Profiler::getChildEvent(Event* pParent, EventId id)
+    {
+        auto& children = pParent ? pParent->mChildren : mRootEvents;
+        for (const auto& [childId, pChild] : children)
+        {
+            if (childId == id) return pChild;
+        }
+
+        std::string name = (pParent ? pParent->mName : "") + "/" + CpuEventRecorder::getEventName(id);
+        Event* pEvent = findEvent(name);
+        if (pEvent) pEvent->mpParent = pParent; // Event previously created through getEvent().
+        else pEvent = createEvent(name, pParent);
+        children.emplace_back(id, pEvent);
+        return pEvent;
+    }
+
+    void Profiler::registerFrameEvent(Event* pEvent)
+    {
+        if (pEvent->mRegisteredFrame == mFrameIndex) return;
+
+        // Register ancestors first to keep the event list in hierarchical order.
+        if (pEvent->mpParent) registerFrameEvent(pEvent->mpParent);
+        pEvent->mRegisteredFrame = mFrameIndex;
+        mFrameEvents[mFrameIndex % 2].push_back(pEvent);
+    }
+
+    void Profiler::processRecords(uint32_t profilerThreadIndex)
+    {
+        const uint32_t frameIndex = mFrameIndex;
+
+        CpuEventRecorder::drain([&](uint32_t threadIndex, const CpuEventRecorder::Record& record)
+        {
+            auto [it, inserted] = mThreads.try_emplace(threadIndex);
+            ThreadData& thread = it->second;
+            if (inserted && threadIndex != profilerThreadIndex)
+            {
+                thread.pRoot = getChildEvent(nullptr, CpuEventRecorder::registerEvent(CpuEventRecorder::getThreadName(threadIndex)));
+            }
+
+            if (mpTraceWriter && !thread.traceNamed)
+            {
+                mpTraceWriter->setThreadName(kTraceCpuPid, threadIndex, threadIndex == profilerThreadIndex ? "Main thread" : CpuEventRecorder::getThreadName(threadIndex));
+                thread.traceNamed = true;
+            }
+
+            if (record.isBegin())
+            {
+                Event* pParent = thread.stack.empty() ? thread.pRoot : thread.stack.back().pEvent;
+                Event* pEvent = getChildEvent(pParent, record.id);
+                if (uint32_t payload = record.getPayload())
+                {
+                    pEvent->mFrameData[frameIndex % 2].gpuTimers.push_back(payload - 1);
+                    if (mpTraceWriter) mGpuTraceEvents[frameIndex % 2].push_back({ record.id, payload - 1, record.time });
+                }
+                thread.stack.push_back({ pEvent, record.id, record.time });
+                registerFrameEvent(pEvent);
+            }
+            else
+            {
+                FALCOR_ASSERT(!thread.stack.empty());
+                if (thread.stack.empty()) return;
+
+                OpenEvent openEvent = thread.stack.back();
+                thread.stack.pop_back();
+
+                // Events spanning multiple frames are accounted to the frame they end in.
+                float duration = (float)((record.time - openEvent.startTime) * 1e-6); // ns -> ms
+                openEvent.pEvent->mFrameData[frameIndex % 2].cpuTotalTime += duration;
+                registerFrameEvent(openEvent.pEvent);
+
+                // Thread root events accumulate the time spent in top-level events.
+                if (thread.stack.empty() && thread.pRoot) thread.pRoot->mFrameData[frameIndex % 2].cpuTotalTime += duration;
+
+                if (mpTraceWriter)
+                {
+                    // Clip events that started before the trace.
+                    uint64_t startTime = std::max(openEvent.startTime, mTraceStartTime);
+                    double traceDuration = record.time > startTime ? (double)(record.time - startTime) * 1e-3 : 0.0;
+                    mpTraceWriter->writeCompleteEvent(kTraceCpuPid, threadIndex, getTraceEventName(openEvent.id), "cpu", getTraceTime(startTime), traceDuration);
+                }
+            }
+        },
+        [&](uint32_t threadIndex)
+        {
+            // The thread exited and its index will be reused by a new thread.
+            mThreads.erase(threadIndex);
+        });
+    }
+
+    void Profiler::writeGpuTraceEvents(const std::vector<GpuTimer::SharedPtr>& gpuTimers, const std::vector<GpuTraceEvent>& events)
+    {
+        // Align the GPU timeline of the frame such that no GPU event starts before the CPU recorded it.
+        // This is a lower bound of the actual time, as GPU work only starts after it was submitted.
+        double offset = std::numeric_limits<double>::lowest();
+        for (const auto& event : events)
+        {
+            offset = std::max(offset, getTraceTime(event.cpuTime) - gpuTimers[event.timerIndex]->getStartTime() * 1e3);
+        }
+
+        for (const auto& event : events)
+        {
+            const auto& pTimer = gpuTimers[event.timerIndex];
+            mpTraceWriter->writeCompleteEvent(kTraceGpuPid, 0, getTraceEventName(event.id), "gpu", pTimer->getStartTime() * 1e3 + offset, pTimer->getElapsedTime() * 1e3);
+        }
+    }
+
+    const std::string& Profiler::getTraceEventName(EventId id)
+    {
+        if (id >= mTraceEventNames.size()) mTraceEventNames.resize(id + 1);
+        if (mTraceEventNames[id].empty()) mTraceEventNames[id] = CpuEventRecorder::getEventName(id);
+        return mTraceEventNames[id];
+    }
+
+    void Profiler::updateRecorder()
+    {
+        CpuEventRecorder::setEnabled(mEnabled && !mPaused);
+    }
 
     ScopedProfilerEvent::ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags)
+        : ScopedProfilerEvent(pRenderContext, Profiler::registerEventName(name), flags)
+    {}
+
+    ScopedProfilerEvent::ScopedProfilerEvent(RenderContext* pRenderContext, Profiler::EventId id, Profiler::Flags flags)
         : mpRenderContext(pRenderContext)
-        , mName(name)
+        , mId(id)
         , mFlags(flags)
     {
         FALCOR_ASSERT(mpRenderContext);
-        mpRenderContext->getProfiler()->startEvent(mpRenderContext, mName, mFlags);
+        mpRenderContext->getProfiler()->startEvent(mpRenderContext, mId, mFlags);
     }
 
     ScopedProfilerEvent::~ScopedProfilerEvent()
     {
-        mpRenderContext->getProfiler()->endEvent(mpRenderContext, mName, mFlags);
+        mpRenderContext->getProfiler()->endEvent(mpRenderContext, mId, mFlags);
     }
 
     FALCOR_SCRIPT_BINDING(Profiler)
@@ -453,5 +624,8 @@ namespace Falcor
         profiler.def_property_readonly("events", &Profiler::getPythonEvents);
         profiler.def("startCapture", &Profiler::startCapture, "reservedFrames"_a = 1000);
         profiler.def("endCapture", endCapture);
+        profiler.def_property_readonly("isTracing", &Profiler::isTracing);
+        profiler.def("startTrace", &Profiler::startTrace, "path"_a);
+        profiler.def("endTrace", &Profiler::endTrace);
     }
 }
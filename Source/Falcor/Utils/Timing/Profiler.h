@@ -27,12 +27,18 @@
  **************************************************************************/
 #pragma once
 #include "CpuTimer.h"
+#include "CpuEventRecorder.h"
+#include "TraceWriter.h"
 #include "Core/Macros.h"
 #include "Core/API/GpuTimer.h"
 #include <pybind11/pytypes.h>
 #include <filesystem>
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -43,12 +49,19 @@ namespace Falcor
     /** Container class for CPU/GPU profiling.
         This class uses the most accurately available CPU and GPU timers to profile given events.
         It automatically creates event hierarchies based on the order and nesting of the calls made.
+        Events are recorded through CpuEventRecorder, which also collects CPU-only events from other threads (see FALCOR_PROFILE_CPU).
+        The recorded events are resolved into the event hierarchy once per frame in endFrame(). Events from threads
+        other than the one calling endFrame() are placed below a root event named after the thread.
         This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
         ProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
     */
     class FALCOR_API Profiler
     {
     public:
+        using EventId = CpuEventRecorder::EventId;
+
+        static constexpr EventId kInvalidEventId = CpuEventRecorder::kInvalidEventId;
+
         enum class Flags
         {
             None        = 0x0,
@@ -85,13 +98,14 @@ namespace Falcor
             Stats computeGpuTimeStats() const;
 
         private:
-            Event(const std::string& name);
+            Event(const std::string& name, Event* pParent);
 
-            void start(Profiler& profiler, uint32_t frameIndex);
-            void end(uint32_t frameIndex);
-            void endFrame(uint32_t frameIndex);
+            void endFrame(const std::vector<GpuTimer::SharedPtr>& gpuTimers, uint32_t frameIndex);
 
             std::string mName;                              ///< Nested event name.
+            Event* mpParent = nullptr;                      ///< Parent event or nullptr for root events.
+            std::vector<std::pair<EventId, Event*>> mChildren; ///< Child events by event ID.
+            uint32_t mRegisteredFrame = uint32_t(-1);       ///< Last frame index the event was registered in.
 
             float mCpuTime = 0.0;                           ///< CPU time (previous frame).
             float mGpuTime = 0.0;                           ///< GPU time (previous frame).
@@ -104,18 +118,10 @@ namespace Falcor
             size_t mHistoryWriteIndex = 0;                  ///< History write index.
             size_t mHistorySize = 0;                        ///< History size.
 
-            uint32_t mTriggered = 0;                        ///< Keeping track of nested calls to start().
-
             struct FrameData
             {
-                CpuTimer::TimePoint cpuStartTime;           ///< Last event CPU start time.
                 float cpuTotalTime = 0.0;                   ///< Total accumulated CPU time.
-
-                std::vector<GpuTimer::SharedPtr> pTimers;   ///< Pool of GPU timers.
-                size_t currentTimer = 0;                    ///< Next GPU timer to use from the pool.
-                GpuTimer *pActiveTimer = nullptr;           ///< Currently active GPU timer.
-
-                bool valid = false;                         ///< True when frame data is valid (after begin/end cycle).
+                std::vector<uint32_t> gpuTimers;            ///< Indices of the GPU timers used in the profiler's timer pool.
             };
             FrameData mFrameData[2];                        ///< Double-buffered frame data to avoid GPU flushes.
 
@@ -170,7 +176,7 @@ namespace Falcor
         /** Enable/disable the profiler.
             \param[in] enabled True to enable the profiler.
         */
-        void setEnabled(bool enabled) { mEnabled = enabled; }
+        void setEnabled(bool enabled);
 
         /** Check if the profiler is paused.
             \return Returns true if the profiler is paused.
@@ -180,7 +186,7 @@ namespace Falcor
         /** Pause/resume the profiler.
             \param[in] paused True to pause the profiler.
         */
-        void setPaused(bool paused) { mPaused = paused; }
+        void setPaused(bool paused);
 
         /** Start profile capture.
             \param[in] reservedFrames Number of frames to reserve memory for.
@@ -197,11 +203,45 @@ namespace Falcor
         */
         bool isCapturing() const;
 
+        /** Start writing a trace of the profiler events to a file.
+            The trace uses the Chrome Trace Event format and can be viewed in Perfetto (https://ui.perfetto.dev).
+            CPU events are written with their actual timestamps on the thread that recorded them, including
+            worker threads (see FALCOR_PROFILE_CPU). GPU events are written to a separate track. As the GPU clock is
+            not synchronized with the CPU clock, the GPU events of each frame are shifted such that no GPU event
+            starts before the CPU recorded it. Events are streamed to the file whenever they are drained (see drainEvents()).
+            Note: This enables the profiler until endTrace() is called.
+            \param[in] path File path.
+        */
+        void startTrace(const std::filesystem::path& path);
+
+        /** End writing the trace and close the file.
+            Drains the pending events into the trace and restores the enabled state from before startTrace().
+        */
+        void endTrace();
+
+        /** Check if the profiler is writing a trace.
+            \return Return true if the profiler is writing a trace.
+        */
+        bool isTracing() const { return mpTraceWriter != nullptr; }
+
         /** Finish profiling for the entire frame.
             Note: Must be called once at the end of each frame.
         */
         void endFrame(RenderContext* pRenderContext);
 
+        /** Collect the CPU events recorded on all threads and accumulate them into the current frame.
+            This is done in endFrame() and whenever a recorder buffer fills up while starting or ending events. It should
+            also be called during long-running work without frames (e.g. scene loading), so that no events are dropped.
+            Note: Does nothing if called from a thread other than the one that created the profiler.
+        */
+        void drainEvents();
+
+        /** Register an event name. Registering the same name again returns the same ID.
+            \param[in] name The event name. Must not contain '/'.
+            \return Returns the event ID, or kInvalidEventId if the name is invalid.
+        */
+        static EventId registerEventName(std::string_view name);
+
         /** Start profiling a new event and update the events hierarchies.
             \param[in] pRenderContext Render context for measuring GPU time.
             \param[in] name The event name.
@@ -209,6 +249,13 @@ namespace Falcor
         */
         void startEvent(RenderContext* pRenderContext, const std::string& name, Flags flags = Flags::Default);
 
+        /** Start profiling a new event and update the events hierarchies.
+            \param[in] pRenderContext Render context for measuring GPU time.
+            \param[in] id The event ID (see registerEventName()).
+            \param[in] flags The event flags.
+        */
+        void startEvent(RenderContext* pRenderContext, EventId id, Flags flags = Flags::Default);
+
         /** Finish profiling a new event and update the events hierarchies.
             \param[in] pRenderContext Render context for measuring GPU time.
             \param[in] name The event name.
@@ -216,6 +263,13 @@ namespace Falcor
         */
         void endEvent(RenderContext* pRenderContext, const std::string& name, Flags flags = Flags::Default);
 
+        /** Finish profiling a new event and update the events hierarchies.
+            \param[in] pRenderContext Render context for measuring GPU time.
+            \param[in] id The event ID (see registerEventName()).
+            \param[in] flags The event flags.
+        */
+        void endEvent(RenderContext* pRenderContext, EventId id, Flags flags = Flags::Default);
+
         /** Get the event, or create a new one if the event does not yet exist.
             This is a public interface to facilitate more complicated construction of event names and finegrained control over the profiled region.
             \param[in] name The event name.
@@ -232,11 +286,73 @@ namespace Falcor
         pybind11::dict getPythonEvents() const;
 
     private:
+        struct OpenEvent
+        {
+            Event* pEvent;
+            EventId id;
+            uint64_t startTime;
+        };
+
+        struct ThreadData
+        {
+            Event* pRoot = nullptr;                         ///< Root event of the thread, nullptr for the profiler's thread.
+            std::vector<OpenEvent> stack;                   ///< Currently open events (persists across frames).
+            bool traceNamed = false;                        ///< True if the thread name was written to the trace.
+        };
+
+        struct GpuTraceEvent
+        {
+            EventId id;
+            uint32_t timerIndex;                            ///< Index of the GPU timer in the profiler's timer pool.
+            uint64_t cpuTime;                               ///< Time the event was started on the CPU.
+        };
+
+        struct GpuTimerPool
+        {
+            std::vector<GpuTimer::SharedPtr> timers;
+            size_t used = 0;
+        };
+
         /** Create a new event.
             \param[in] name The event name.
+            \param[in] pParent The parent event or nullptr.
             \return Returns the new event.
         */
-        Event* createEvent(const std::string& name);
+        Event* createEvent(const std::string& name, Event* pParent = nullptr);
+
+        /** Get a child event, or create it if it does not yet exist.
+            \param[in] pParent The parent event or nullptr for root events.
+            \param[in] id The event ID.
+            \return Returns the child event.
+        */
+        Event* getChildEvent(Event* pParent, EventId id);
+
+        /** Add an event and its ancestors to the events of the current frame, unless already added.
+        */
+        void registerFrameEvent(Event* pEvent);
+
+        /** Drain the event records of all threads and accumulate them into the current frame.
+            \param[in] profilerThreadIndex Recorder thread index of the thread calling endFrame().
+        */
+        void processRecords(uint32_t profilerThreadIndex);
+
+        /** Update the recording state of CpuEventRecorder.
+        */
+        void updateRecorder();
+
+        /** Write GPU events of a frame to the trace.
+            \param[in] gpuTimers The GPU timers of the frame.
+            \param[in] events The events to write.
+        */
+        void writeGpuTraceEvents(const std::vector<GpuTimer::SharedPtr>& gpuTimers, const std::vector<GpuTraceEvent>& events);
+
+        /** Get an event name for the trace.
+        */
+        const std::string& getTraceEventName(EventId id);
+
+        /** Convert a recorder time stamp to trace time in microseconds.
+        */
+        double getTraceTime(uint64_t time) const { return (double)(int64_t)(time - mTraceStartTime) * 1e-3; }
 
         /** Find an event that was previously created.
             \param[in] name The event name.
@@ -245,19 +361,28 @@ namespace Falcor
         Event* findEvent(const std::string& name);
 
         Device* mpDevice;
+        std::thread::id mThreadId;                          ///< Thread that created the profiler and calls endFrame().
 
         bool mEnabled = false;
         bool mPaused = false;
 
         std::unordered_map<std::string, std::shared_ptr<Event>> mEvents; ///< Events by name.
-        std::vector<Event*> mCurrentFrameEvents;            ///< Events registered for current frame.
+        std::vector<std::pair<EventId, Event*>> mRootEvents; ///< Root events by event ID.
+        std::vector<Event*> mFrameEvents[2];                ///< Events registered per frame (double-buffered).
         std::vector<Event*> mLastFrameEvents;               ///< Events from last frame.
-        std::string mCurrentEventName;                      ///< Current nested event name.
-        uint32_t mCurrentLevel = 0;                         ///< Current nesting level.
+        std::vector<GpuTimer*> mActiveTimers;               ///< GPU timers of the currently open events (nullptr if not recorded).
+        GpuTimerPool mGpuTimers[2];                         ///< Double-buffered GPU timer pools.
+        std::unordered_map<uint32_t, ThreadData> mThreads;  ///< Per-thread state by recorder thread index.
         uint32_t mFrameIndex = 0;                           ///< Current frame index.
 
         Capture::SharedPtr mpCapture;                       ///< Currently active capture.
 
+        std::unique_ptr<TraceWriter> mpTraceWriter;         ///< Trace writer while tracing.
+        uint64_t mTraceStartTime = 0;                       ///< Recorder time stamp at the start of the trace.
+        bool mTraceWasEnabled = false;                      ///< Enabled state before the trace was started.
+        std::vector<std::string> mTraceEventNames;          ///< Cached event names by event ID.
+        std::vector<GpuTraceEvent> mGpuTraceEvents[2];      ///< GPU events to write to the trace (double-buffered).
+
         GpuFence::SharedPtr mpFence;
         uint64_t mFenceValue = uint64_t(-1);
     };
@@ -273,18 +398,53 @@ namespace Falcor
     {
     public:
         ScopedProfilerEvent(RenderContext* pRenderContext, const std::string& name, Profiler::Flags flags = Profiler::Flags::Default);
+        ScopedProfilerEvent(RenderContext* pRenderContext, Profiler::EventId id, Profiler::Flags flags = Profiler::Flags::Default);
         ~ScopedProfilerEvent();
 
     private:
         RenderContext* mpRenderContext;
-        const std::string mName;
+        Profiler::EventId mId;
         Profiler::Flags mFlags;
     };
+
+    /** Caches the event IDs of a FALCOR_PROFILE call site.
+        Call sites are cached per thread. The IDs are kept per event name, so call sites with changing names, such as the
+        name of the executed render pass, only register a name the first time it is seen on the thread.
+    */
+    class ProfilerEventIdCache
+    {
+    public:
+        Profiler::EventId get(std::string_view name)
+        {
+            // Fast path for call sites with a constant name.
+            if (mLastId != Profiler::kInvalidEventId && name == mLastName) return mLastId;
+
+            auto it = mIds.find(name);
+            if (it == mIds.end())
+            {
+                // Call sites with an unbounded number of names only keep the most recent ones.
+                if (mIds.size() >= kMaxNames) mIds.clear();
+                it = mIds.emplace(std::string(name), Profiler::registerEventName(name)).first;
+            }
+            mLastName = it->first;
+            mLastId = it->second;
+            return mLastId;
+        }
+
+    private:
+        static constexpr size_t kMaxNames = 256;
+
+        std::map<std::string, Profiler::EventId, std::less<>> mIds; ///< Event IDs by name.
+        std::string_view mLastName;                                  ///< Name of the previous call, points into mIds.
+        Profiler::EventId mLastId = Profiler::kInvalidEventId;       ///< Event ID of the previous call.
+    };
 }
 
 #if FALCOR_ENABLE_PROFILER
-#define FALCOR_PROFILE(_pRenderContext, _name) Falcor::ScopedProfilerEvent _profileEvent##__LINE__(_pRenderContext, _name)
-#define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags) Falcor::ScopedProfilerEvent _profileEvent##__LINE__(_pRenderContext, _name, _flags)
+#define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags) \
+    static thread_local Falcor::ProfilerEventIdCache FALCOR_CONCAT_STRINGS(_profileEventId, __LINE__); \
+    Falcor::ScopedProfilerEvent FALCOR_CONCAT_STRINGS(_profileEvent, __LINE__)(_pRenderContext, FALCOR_CONCAT_STRINGS(_profileEventId, __LINE__).get(_name), _flags)
+#define FALCOR_PROFILE(_pRenderContext, _name) FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, Falcor::Profiler::Flags::Default)
 #else
 #define FALCOR_PROFILE(_pRenderContext, _name)
 #define FALCOR_PROFILE_CUSTOM(_pRenderContext, _name, _flags)
@@ -0,0 +1,123 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TraceWriter.h"
+#include "Core/Errors.h"
+#include <fmt/format.h>
+#include <iterator>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Buffered output is written to the file when it exceeds this size.
+        const size_t kFlushSize = 1 << 20;
+    }
+
+    TraceWriter::TraceWriter(const std::filesystem::path& path)
+        : mPath(path)
+    {
+        mpFile = std::fopen(path.string().c_str(), "wb");
+        if (!mpFile) throw RuntimeError("Failed to create trace file '{}'.", path.string());
+        mBuffer.reserve(kFlushSize + 1024);
+        mBuffer += "[";
+    }
+
+    TraceWriter::~TraceWriter()
+    {
+        close();
+    }
+
+    void TraceWriter::setProcessName(uint32_t pid, std::string_view name)
+    {
+        beginEvent();
+        fmt::format_to(std::back_inserter(mBuffer), "{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":{},\"args\":{{\"name\":", pid);
+        appendString(name);
+        mBuffer += "}}";
+    }
+
+    void TraceWriter::setThreadName(uint32_t pid, uint32_t tid, std::string_view name)
+    {
+        beginEvent();
+        fmt::format_to(std::back_inserter(mBuffer), "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":{},\"tid\":{},\"args\":{{\"name\":", pid, tid);
+        appendString(name);
+        mBuffer += "}}";
+    }
+
+    void TraceWriter::writeCompleteEvent(uint32_t pid, uint32_t tid, std::string_view name, std::string_view category, double startTime, double duration)
+    {
+        beginEvent();
+        mBuffer += "{\"name\":";
+        appendString(name);
+        mBuffer += ",\"cat\":";
+        appendString(category);
+        fmt::format_to(std::back_inserter(mBuffer), ",\"ph\":\"X\",\"pid\":{},\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", pid, tid, startTime, duration);
+        if (mBuffer.size() >= kFlushSize) flush();
+    }
+
+    void TraceWriter::flush()
+    {
+        if (!mpFile) return;
+        std::fwrite(mBuffer.data(), 1, mBuffer.size(), mpFile);
+        std::fflush(mpFile);
+        mBuffer.clear();
+    }
+
+    void TraceWriter::close()
+    {
+        if (!mpFile) return;
+        mBuffer += "\n]\n";
+        flush();
+        std::fclose(mpFile);
+        mpFile = nullptr;
+    }
+
+    void TraceWriter::beginEvent()
+    {
+        mBuffer += mFirstEvent ? "\n" : ",\n";
+        mFirstEvent = false;
+    }
+
+    void TraceWriter::appendString(std::string_view str)
+    {
+        mBuffer += '"';
+        for (char c : str)
+        {
+            switch (c)
+            {
+            case '"': mBuffer += "\\\""; break;
+            case '\\': mBuffer += "\\\\"; break;
+            case '\n': mBuffer += "\\n"; break;
+            case '\t': mBuffer += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) fmt::format_to(std::back_inserter(mBuffer), "\\u{:04x}", (unsigned)c);
+                else mBuffer += c;
+            }
+        }
+        mBuffer += '"';
+    }
+}
@@ -0,0 +1,102 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace Falcor
+{
+    /** Streaming writer for trace files in the Chrome Trace Event format.
+        The files can be viewed in Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+        Events are buffered in memory and appended to the file in chunks, so traces of any length can be written.
+        The file uses the JSON array format, which can be loaded even if the writer was not closed properly.
+    */
+    class FALCOR_API TraceWriter
+    {
+    public:
+        /** Create a trace file. Throws a RuntimeError if the file cannot be created.
+            \param[in] path File path.
+        */
+        TraceWriter(const std::filesystem::path& path);
+
+        /** Destructor. Closes the file.
+        */
+        ~TraceWriter();
+
+        TraceWriter(const TraceWriter&) = delete;
+        TraceWriter& operator=(const TraceWriter&) = delete;
+
+        /** Set the display name of a process.
+            \param[in] pid Process ID.
+            \param[in] name Process name.
+        */
+        void setProcessName(uint32_t pid, std::string_view name);
+
+        /** Set the display name of a thread.
+            \param[in] pid Process ID.
+            \param[in] tid Thread ID.
+            \param[in] name Thread name.
+        */
+        void setThreadName(uint32_t pid, uint32_t tid, std::string_view name);
+
+        /** Write an event with a start time and duration.
+            \param[in] pid Process ID.
+            \param[in] tid Thread ID.
+            \param[in] name Event name.
+            \param[in] category Event category.
+            \param[in] startTime Start time in microseconds.
+            \param[in] duration Duration in microseconds.
+        */
+        void writeCompleteEvent(uint32_t pid, uint32_t tid, std::string_view name, std::string_view category, double startTime, double duration);
+
+        /** Write all buffered events to the file.
+        */
+        void flush();
+
+        /** Flush and close the file. Called by the destructor.
+        */
+        void close();
+
+        /** Get the path of the trace file.
+        */
+        const std::filesystem::path& getPath() const { return mPath; }
+
+    private:
+        void beginEvent();
+        void appendString(std::string_view str);
+
+        std::filesystem::path mPath;
+        FILE* mpFile = nullptr;
+        std::string mBuffer;                ///< Events pending to be written to the file.
+        bool mFirstEvent = true;
+    };
+}
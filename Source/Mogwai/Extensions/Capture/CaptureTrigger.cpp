@@ -120,6 +120,8 @@ namespace Mogwai
 
     void CaptureTrigger::endFrame(RenderContext* pRenderContext, const Fbo::SharedPtr& pTargetFbo)
     {
+        pollPending(pRenderContext);
+
         if (!mCurrent.pGraph) return;
         uint64_t frameId = mpRenderer->getGlobalClock().getFrame();
         const auto& ranges = mGraphRanges.at(mCurrent.pGraph);
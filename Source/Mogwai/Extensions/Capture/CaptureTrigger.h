@@ -50,6 +50,7 @@ namespace Mogwai
         virtual void beginRange(RenderGraph* pGraph, const Range& r) {};
         virtual void triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID) {};
         virtual void endRange(RenderGraph* pGraph, const Range& r) {};
+        virtual void pollPending(RenderContext* pCtx) {}; // Called at the end of every frame, also outside of capture ranges, to retire asynchronous work
 
         void addRange(const RenderGraph* pGraph, uint64_t startFrame, uint64_t count);
         void reset(const RenderGraph* pGraph = nullptr);
@@ -41,6 +41,10 @@ namespace Mogwai
         const std::string kUI = "ui";
         const std::string kOutputs = "outputs";
         const std::string kCapture = "capture";
+        const std::string kFlush = "flush";
+
+        const uint64_t kMaxCapturesInFlight = 3;    // Number of captures whose readbacks can be in flight before we wait for the GPU.
+        const size_t kMaxPendingWrites = 8;         // Number of images that can be queued for encoding before we wait for the thread pool.
 
         template<typename T>
         std::vector<typename T::value_type::first_type> getFirstOfPair(const T& pair)
@@ -65,6 +69,11 @@ namespace Mogwai
         mpImageProcessing = std::make_unique<ImageProcessing>(pRenderer->getDevice());
     }
 
+    FrameCapture::~FrameCapture()
+    {
+        flush();
+    }
+
     void FrameCapture::renderUI(Gui* pGui)
     {
         if (mShowUI)
@@ -95,6 +104,7 @@ namespace Mogwai
         auto printGraph = [](FrameCapture* pFC, RenderGraph* pGraph) { pybind11::print(pFC->graphFramesStr(pGraph)); };
         frameCapture.def(kPrintFrames.c_str(), printGraph, "graph"_a);
         frameCapture.def(kCapture.c_str(), &FrameCapture::capture);
+        frameCapture.def(kFlush.c_str(), &FrameCapture::flush);
         auto printAllGraphs = [](FrameCapture* pFC)
         {
             std::string s;
@@ -134,6 +144,8 @@ namespace Mogwai
 
     void FrameCapture::triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID)
     {
+        retireReadbacks(false);
+
         std::vector<std::string> unmarkedOutputs;
 
         if (mCaptureAllOutputs)
@@ -154,6 +166,31 @@ namespace Mogwai
             for (const auto& output : unmarkedOutputs) pGraph->unmarkOutput(output);
             pGraph->compile(pRenderContext);
         }
+
+        mCaptureCount++;
+
+        // Bound the number of captures in flight. This only waits if the GPU fell behind by more than the ring size.
+        while (!mPendingReadbacks.empty() && mPendingReadbacks.front().captureID + kMaxCapturesInFlight <= mCaptureCount)
+        {
+            writeImage(mPendingReadbacks.front());
+            mPendingReadbacks.pop_front();
+        }
+    }
+
+    void FrameCapture::pollPending(RenderContext* pRenderContext)
+    {
+        retireReadbacks(false);
+        retireWrites(kMaxPendingWrites);
+    }
+
+    void FrameCapture::flush()
+    {
+        retireReadbacks(true);
+        retireWrites(0);
+
+        mTempTextures.clear();
+        mFreeStagingBuffers.clear();
+        mFreeImageData.clear();
     }
 
     void FrameCapture::captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex)
@@ -237,7 +274,7 @@ namespace Mogwai
                 }
 
                 // Copy color channel into temporary texture.
-                pTex = Texture::create2D(mpRenderer->getDevice().get(), pOutput->getWidth(), pOutput->getHeight(), outputFormat, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+                pTex = getTempTexture(pOutput->getWidth(), pOutput->getHeight(), outputFormat, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
                 mpImageProcessing->copyColorChannel(pRenderContext, pOutput->getSRV(0, 1, 0, 1), pTex->getUAV(), mask);
             }
 
@@ -248,7 +285,108 @@ namespace Mogwai
             Bitmap::ExportFlags flags = Bitmap::ExportFlags::None;
             if (mask == TextureChannelFlags::RGBA) flags |= Bitmap::ExportFlags::ExportAlpha;
 
-            pTex->captureToFile(0, 0, filename, fileformat, flags);
+            queueImage(pRenderContext, pTex, filename, fileformat, flags);
+        }
+    }
+
+    Texture::SharedPtr FrameCapture::getTempTexture(uint32_t width, uint32_t height, ResourceFormat format, ResourceBindFlags bindFlags)
+    {
+        // Temporary textures are consumed by a copy into a staging buffer right after being written.
+        // As the GPU executes these in order, a single texture per configuration is enough.
+        for (const auto& pTex : mTempTextures)
+        {
+            if (pTex->getWidth() == width && pTex->getHeight() == height && pTex->getFormat() == format && pTex->getBindFlags() == bindFlags) return pTex;
+        }
+        mTempTextures.push_back(Texture::create2D(mpRenderer->getDevice().get(), width, height, format, 1, 1, nullptr, bindFlags));
+        return mTempTextures.back();
+    }
+
+    void FrameCapture::queueImage(RenderContext* pRenderContext, const Texture::SharedPtr& pTex, const std::filesystem::path& path, Bitmap::FileFormat fileFormat, Bitmap::ExportFlags exportFlags)
+    {
+        if (fileFormat == Bitmap::FileFormat::DdsFile) throw RuntimeError("FrameCapture does not support saving to DDS.");
+
+        const Texture* pSrc = pTex.get();
+        const uint32_t width = pTex->getWidth();
+        const uint32_t height = pTex->getHeight();
+        ResourceFormat resourceFormat = pTex->getFormat();
+
+        // Handle the special case where we have an HDR texture with less then 3 channels (same as Texture::captureToFile()).
+        if (getFormatType(resourceFormat) == FormatType::Float && getFormatChannelCount(resourceFormat) < 3)
+        {
+            auto pExpanded = getTempTexture(width, height, ResourceFormat::RGBA32Float, ResourceBindFlags::RenderTarget | ResourceBindFlags::ShaderResource);
+            pRenderContext->blit(pTex->getSRV(0, 1, 0, 1), pExpanded->getRTV(0, 0, 1));
+            pSrc = pExpanded.get();
+            resourceFormat = ResourceFormat::RGBA32Float;
+        }
+
+        // Pick the smallest free staging buffer that fits. The read task falls back to a new buffer if it doesn't fit after row alignment.
+        const size_t minSize = (size_t)width * height * getFormatBytesPerBlock(resourceFormat);
+        auto it = mFreeStagingBuffers.end();
+        for (auto b = mFreeStagingBuffers.begin(); b != mFreeStagingBuffers.end(); b++)
+        {
+            if ((*b)->getSize() >= minSize && (it == mFreeStagingBuffers.end() || (*b)->getSize() < (*it)->getSize())) it = b;
+        }
+        Buffer::SharedPtr pStagingBuffer = it != mFreeStagingBuffers.end() ? *it : nullptr;
+
+        auto pReadTask = pRenderContext->asyncReadTextureSubresource(pSrc, 0, pStagingBuffer);
+        if (pStagingBuffer && pReadTask->getStagingBuffer() == pStagingBuffer) mFreeStagingBuffers.erase(it);
+
+        mPendingReadbacks.push_back({ pReadTask, mCaptureCount, path, width, height, fileFormat, exportFlags, resourceFormat });
+    }
+
+    void FrameCapture::retireReadbacks(bool wait)
+    {
+        while (!mPendingReadbacks.empty() && (wait || mPendingReadbacks.front().pReadTask->isReady()))
+        {
+            writeImage(mPendingReadbacks.front());
+            mPendingReadbacks.pop_front();
+        }
+    }
+
+    void FrameCapture::writeImage(PendingImage& image)
+    {
+        // Make room in the write queue.
+        retireWrites(kMaxPendingWrites - 1);
+
+        std::unique_ptr<std::vector<uint8_t>> pData;
+        if (!mFreeImageData.empty())
+        {
+            pData = std::move(mFreeImageData.back());
+            mFreeImageData.pop_back();
+        }
+        else
+        {
+            pData = std::make_unique<std::vector<uint8_t>>();
+        }
+
+        // Copy the data out of the staging buffer so it can be recycled right away.
+        pData->resize(image.pReadTask->getDataSize());
+        image.pReadTask->getData(pData->data());
+        mFreeStagingBuffers.push_back(image.pReadTask->getStagingBuffer());
+        image.pReadTask = nullptr;
+
+        auto func = [path = image.path, width = image.width, height = image.height, fileFormat = image.fileFormat, exportFlags = image.exportFlags, resourceFormat = image.resourceFormat, pPixels = pData->data()]()
+        {
+            try
+            {
+                Bitmap::saveImage(path, width, height, fileFormat, exportFlags, resourceFormat, true, pPixels);
+            }
+            catch (const std::exception& e)
+            {
+                logError("Failed to write frame capture '{}': {}", path.string(), e.what());
+            }
+        };
+
+        mPendingWrites.push_back({ Threading::dispatchTask(func), std::move(pData) });
+    }
+
+    void FrameCapture::retireWrites(size_t maxPending)
+    {
+        while (!mPendingWrites.empty() && (mPendingWrites.size() > maxPending || !mPendingWrites.front().task.isRunning()))
+        {
+            mPendingWrites.front().task.finish();
+            mFreeImageData.push_back(std::move(mPendingWrites.front().pData));
+            mPendingWrites.pop_front();
         }
     }
 
@@ -28,7 +28,10 @@
 #pragma once
 #include "../../Mogwai.h"
 #include "CaptureTrigger.h"
+#include "Utils/Image/Bitmap.h"
 #include "Utils/Image/ImageProcessing.h"
+#include "Utils/Threading.h"
+#include <deque>
 
 namespace Mogwai
 {
@@ -36,13 +39,22 @@ namespace Mogwai
     {
     public:
         static UniquePtr create(Renderer* pRenderer);
+        virtual ~FrameCapture();
         virtual void renderUI(Gui* pGui) override;
         virtual void registerScriptBindings(pybind11::module& m) override;
         virtual std::string getScriptVar() const override;
         virtual std::string getScript(const std::string& var) const override;
         virtual void triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID) override;
+        virtual void pollPending(RenderContext* pRenderContext) override;
+
+        /** Capture the current frame. The images are written to disk asynchronously, see flush().
+        */
         void capture();
 
+        /** Wait until all captured images have been written to disk and release the pooled capture resources.
+        */
+        void flush();
+
     private:
         FrameCapture(Renderer* pRenderer);
 
@@ -52,7 +64,42 @@ namespace Mogwai
         std::string graphFramesStr(const RenderGraph* pGraph);
         void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex);
 
+        // Images are captured in a pipeline. The texture is first copied into a staging buffer on the GPU.
+        // Once the copy has finished, the data is copied out of the staging buffer, which is then recycled,
+        // and the image is encoded and written on the thread pool.
+
+        struct PendingImage
+        {
+            CopyContext::ReadTextureTask::SharedPtr pReadTask;
+            uint64_t captureID;
+            std::filesystem::path path;
+            uint32_t width;
+            uint32_t height;
+            Bitmap::FileFormat fileFormat;
+            Bitmap::ExportFlags exportFlags;
+            ResourceFormat resourceFormat;
+        };
+
+        struct PendingWrite
+        {
+            Threading::Task task;
+            std::unique_ptr<std::vector<uint8_t>> pData;
+        };
+
+        Texture::SharedPtr getTempTexture(uint32_t width, uint32_t height, ResourceFormat format, ResourceBindFlags bindFlags);
+        void queueImage(RenderContext* pRenderContext, const Texture::SharedPtr& pTex, const std::filesystem::path& path, Bitmap::FileFormat fileFormat, Bitmap::ExportFlags exportFlags);
+        void retireReadbacks(bool wait);
+        void writeImage(PendingImage& image);
+        void retireWrites(size_t maxPending);
+
         bool mCaptureAllOutputs = false;
         std::unique_ptr<ImageProcessing> mpImageProcessing;
+
+        uint64_t mCaptureCount = 0;                                     ///< Number of triggered captures, used to limit the number of captures in flight.
+        std::vector<Texture::SharedPtr> mTempTextures;                  ///< Textures for channel extraction and format conversion, reused across captures.
+        std::deque<PendingImage> mPendingReadbacks;                     ///< Images being copied to staging buffers, oldest first.
+        std::vector<Buffer::SharedPtr> mFreeStagingBuffers;             ///< Staging buffers available for reuse.
+        std::deque<PendingWrite> mPendingWrites;                        ///< Images being encoded and written, oldest first.
+        std::vector<std::unique_ptr<std::vector<uint8_t>>> mFreeImageData; ///< CPU image buffers available for reuse.
     };
 }
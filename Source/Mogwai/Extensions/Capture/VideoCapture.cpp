@@ -44,6 +44,9 @@ namespace Mogwai
         const std::string kPrint = "print";
         const std::string kOutputs = "outputs";
 
+        const uint64_t kMaxFramesInFlight = 3;  // Number of frames whose readbacks can be in flight before we wait for the GPU.
+        const size_t kMaxQueuedFrames = 4;      // Number of frames that can be waiting for the encoder before we block rendering.
+
         Texture::SharedPtr createTextureForBlit(Device* pDevice, const Texture* pSource)
         {
             FALCOR_ASSERT(pSource->getType() == Texture::Type::Texture2D);
@@ -58,6 +61,11 @@ namespace Mogwai
         mpEncoderUI = VideoEncoderUI::create();
     }
 
+    VideoCapture::~VideoCapture()
+    {
+        flush();
+    }
+
     VideoCapture::UniquePtr VideoCapture::create(Renderer* pRenderer)
     {
         return UniquePtr(new VideoCapture(pRenderer));
@@ -110,17 +118,27 @@ namespace Mogwai
             encoder.pEncoder = VideoEncoder::create(d);
             mEncoders.push_back(std::move(encoder));
         }
+
+        mFrameCount = 0;
+        mStopEncoder = false;
+        mEncoderThread = std::thread(&VideoCapture::encoderThread, this);
     }
 
     void VideoCapture::endRange(RenderGraph* pGraph, const Range& r)
     {
+        flush();
         for (const auto& e : mEncoders) e.pEncoder->endCapture();
+        mEncoders.clear();
     }
 
     void VideoCapture::triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID)
     {
-        for (const auto& e : mEncoders)
+        // Retire the frames the GPU is done with.
+        while (!mPendingReadbacks.empty() && mPendingReadbacks.front().pReadTask->isReady()) retireReadback();
+
+        for (size_t i = 0; i < mEncoders.size(); i++)
         {
+            auto& e = mEncoders[i];
             Texture::SharedPtr pTex = std::dynamic_pointer_cast<Texture>(pGraph->getOutput(e.output));
             if (e.pBlitTex)
             {
@@ -128,8 +146,87 @@ namespace Mogwai
                 pTex = e.pBlitTex;
             }
 
-            e.pEncoder->appendFrame(pCtx->readTextureSubresource(pTex.get(), 0).data());
+            Buffer::SharedPtr pStagingBuffer;
+            if (!e.freeStagingBuffers.empty())
+            {
+                pStagingBuffer = std::move(e.freeStagingBuffers.back());
+                e.freeStagingBuffers.pop_back();
+            }
+            mPendingReadbacks.push_back({ pCtx->asyncReadTextureSubresource(pTex.get(), 0, std::move(pStagingBuffer)), i, mFrameCount });
+        }
+
+        mFrameCount++;
+
+        // Bound the number of frames in flight. This only waits if the GPU fell behind by more than the ring size.
+        while (!mPendingReadbacks.empty() && mPendingReadbacks.front().frameCount + kMaxFramesInFlight <= mFrameCount) retireReadback();
+    }
+
+    void VideoCapture::retireReadback()
+    {
+        auto& readback = mPendingReadbacks.front();
+        auto& e = mEncoders[readback.encoderIndex];
+
+        // Wait for room in the encoder queue and grab a frame buffer to reuse.
+        std::vector<uint8_t> frame;
+        {
+            std::unique_lock<std::mutex> lock(mEncodeMutex);
+            mEncodeCondition.wait(lock, [this]() { return mFramesInFlight < kMaxQueuedFrames; });
+            if (!mFreeFrames.empty())
+            {
+                frame = std::move(mFreeFrames.back());
+                mFreeFrames.pop_back();
+            }
+        }
+
+        frame.resize(readback.pReadTask->getDataSize());
+        readback.pReadTask->getData(frame.data());
+        e.freeStagingBuffers.push_back(readback.pReadTask->getStagingBuffer());
+        mPendingReadbacks.pop_front();
+
+        {
+            std::lock_guard<std::mutex> lock(mEncodeMutex);
+            mEncodeQueue.push_back({ e.pEncoder.get(), std::move(frame) });
+            mFramesInFlight++;
         }
+        mEncodeCondition.notify_all();
+    }
+
+    void VideoCapture::encoderThread()
+    {
+        std::unique_lock<std::mutex> lock(mEncodeMutex);
+        while (true)
+        {
+            mEncodeCondition.wait(lock, [this]() { return mStopEncoder || !mEncodeQueue.empty(); });
+            // Drain the queue before stopping.
+            if (mEncodeQueue.empty()) break;
+
+            EncodeJob job = std::move(mEncodeQueue.front());
+            mEncodeQueue.pop_front();
+
+            lock.unlock();
+            job.pEncoder->appendFrame(job.frame.data());
+            lock.lock();
+
+            mFreeFrames.push_back(std::move(job.frame));
+            mFramesInFlight--;
+            mEncodeCondition.notify_all();
+        }
+    }
+
+    void VideoCapture::flush()
+    {
+        if (!mEncoderThread.joinable()) return;
+
+        while (!mPendingReadbacks.empty()) retireReadback();
+
+        {
+            std::lock_guard<std::mutex> lock(mEncodeMutex);
+            mStopEncoder = true;
+        }
+        mEncodeCondition.notify_all();
+        mEncoderThread.join();
+
+        mFreeFrames.clear();
     }
 
     void VideoCapture::registerScriptBindings(pybind11::module& m)
@@ -30,6 +30,10 @@
 #include "CaptureTrigger.h"
 #include "Utils/Video/VideoEncoderUI.h"
 #include "Utils/Video/VideoEncoder.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 namespace Mogwai
 {
@@ -37,6 +41,7 @@ namespace Mogwai
     {
     public:
         static UniquePtr create(Renderer* pRenderer);
+        virtual ~VideoCapture();
         virtual void renderUI(Gui* pGui) override;
         virtual void beginRange(RenderGraph* pGraph, const Range& r) override;
         virtual void endRange(RenderGraph* pGraph, const Range& r) override;
@@ -52,6 +57,12 @@ namespace Mogwai
         void addRanges(const std::string& graphName, const range_vec& ranges);
         std::string graphRangesStr(const RenderGraph* pGraph);
 
+        // Frames are read back through a ring of staging buffers and retired once the GPU copy has finished.
+        // Retired frames are handed to a worker thread that runs the encoders, so FFmpeg doesn't block rendering.
+        void retireReadback();
+        void encoderThread();
+        void flush();
+
         VideoEncoderUI::UniquePtr mpEncoderUI;
 
         struct EncodeData
@@ -59,7 +70,30 @@ namespace Mogwai
             std::string output;
             VideoEncoder::UniquePtr pEncoder;
             Texture::SharedPtr pBlitTex;
+            std::vector<Buffer::SharedPtr> freeStagingBuffers;
         };
         std::vector<EncodeData> mEncoders;
+
+        struct PendingReadback
+        {
+            CopyContext::ReadTextureTask::SharedPtr pReadTask;
+            size_t encoderIndex;
+            uint64_t frameCount;
+        };
+        std::deque<PendingReadback> mPendingReadbacks;  ///< Readbacks in flight on the GPU, oldest first.
+        uint64_t mFrameCount = 0;                       ///< Number of frames captured in the current range.
+
+        struct EncodeJob
+        {
+            VideoEncoder* pEncoder;
+            std::vector<uint8_t> frame;
+        };
+        std::thread mEncoderThread;
+        std::mutex mEncodeMutex;                        ///< Protects the members below.
+        std::condition_variable mEncodeCondition;
+        std::deque<EncodeJob> mEncodeQueue;
+        std::vector<std::vector<uint8_t>> mFreeFrames;  ///< Frame buffers available for reuse.
+        size_t mFramesInFlight = 0;                     ///< Frames queued or being encoded.
+        bool mStopEncoder = false;
     };
 }
@@ -183,75 +183,6 @@ void FLIPPass::updatePrograms()
     mRecompile = false;
 }
 
-static void solveSecondDegree(const float a, const float b, float c, float& xMin, float& xMax)
-{
-    //  Solve a * x^2 + b * x + c = 0.
-    if (a == 0.0f)
-    {
-        xMin = xMax = -c / b;
-        return;
-    }
-
-    float d1 = -0.5f * (b / a);
-    float d2 = std::sqrt((d1 * d1) - (c / a));
-    xMin = d1 - d2;
-    xMax = d1 + d2;
-}
-
-// At some point, we want to replace this with a compute pass. The BitonicSort needs to be updated so it can handle
-// large amounts of floatintpoint numbers.
-static void computeMedianMax(const float* values, const uint32_t numValues, float& median, float& max)
-{
-    std::vector<float> sortedValues(values, values + numValues);
-    std::sort(sortedValues.begin(), sortedValues.end());
-    if (numValues & 1)      // Odd number of values.
-    {
-        median = sortedValues[numValues / 2];
-    }
-    else                    // Even number of values.
-    {
-        uint32_t medianLocation = numValues / 2 - 1;
-        median = (sortedValues[medianLocation] + sortedValues[medianLocation + 1]) * 0.5f;
-    }
-    max = sortedValues[numValues - 1];
-}
-
-void FLIPPass::computeExposureParameters(const float Ymedian, const float Ymax)
-{
-    std::vector<float> tmCoefficients;
-    if (mToneMapper == FLIPToneMapperType::Reinhard)
-    {
-        tmCoefficients = { 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f };
-    }
-    else if (mToneMapper == FLIPToneMapperType::ACES)
-    {
-        tmCoefficients = { 0.6f * 0.6f * 2.51f, 0.6f * 0.03f, 0.0f, 0.6f * 0.6f * 2.43f, 0.6f * 0.59f, 0.14f };  // 0.6 is pre-exposure cancellation.
-    }
-    else if (mToneMapper == FLIPToneMapperType::Hable)
-    {
-        tmCoefficients = { 0.231683f, 0.013791f, 0.0f, 0.18f, 0.3f, 0.018f };
-    }
-    else
-    {
-        FALCOR_UNREACHABLE();
-    }
-
-    const float t = 0.85f;
-    const float a = tmCoefficients[0] - t * tmCoefficients[3];
-    const float b = tmCoefficients[1] - t * tmCoefficients[4];
-    const float c = tmCoefficients[2] - t * tmCoefficients[5];
-
-    float xMin = 0.0f;
-    float xMax = 0.0f;
-    solveSecondDegree(a, b, c, xMin, xMax);
-
-    mStartExposure = std::log2(xMax / Ymax);
-    float stopExposure = std::log2(xMax / Ymedian);
-
-    mNumExposures = uint32_t(std::max(2.0f, std::ceil(stopExposure - mStartExposure)));
-    mExposureDelta = (stopExposure - mStartExposure) / (mNumExposures - 1.0f);
-}
-
 void FLIPPass::execute(RenderContext* pRenderContext, const RenderData& renderData)
 {
     if (!mEnabled) return;
@@ -296,7 +227,7 @@ void FLIPPass::execute(RenderContext* pRenderContext, const RenderData& renderDa
     auto var = mpFLIPPass["PerFrameCB"];
     var["gIsHDR"] = mIsHDR;
     var["gUseMagma"] = mUseMagma;
-    var["gClampInput"] = mUseMagma;
+    var["gClampInput"] = mClampInput;
     var["gResolution"] = outputResolution;
     var["gMonitorWidthPixels"] = mMonitorWidthPixels;
     var["gMonitorWidthMeters"] = mMonitorWidthMeters;
@@ -317,12 +248,14 @@ void FLIPPass::execute(RenderContext* pRenderContext, const RenderData& renderDa
         mpComputeLuminancePass->execute(pRenderContext, uint3(outputResolution.x, outputResolution.y, 1u));
         pRenderContext->flush(true);
 
-        float Ymedian, Ymax;
         const float* luminanceValues = (float*)mpLuminance->map(Buffer::MapType::Read);
-        computeMedianMax(luminanceValues, outputResolution.x * outputResolution.y, Ymedian, Ymax);
+        FLIP::ExposureParameters exposureParameters = FLIP::computeExposureParameters(mToneMapper, luminanceValues, outputResolution.x * outputResolution.y);
         mpLuminance->unmap();
 
-        computeExposureParameters(Ymedian, Ymax);
+        mStartExposure = exposureParameters.startExposure;
+        mStopExposure = exposureParameters.stopExposure;
+        mNumExposures = exposureParameters.numExposures;
+        mExposureDelta = exposureParameters.getExposureDelta();
     }
 
     // Compute FLIP error map and exposure map.
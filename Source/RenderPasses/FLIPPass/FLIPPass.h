@@ -29,7 +29,7 @@
 #include "Falcor.h"
 #include "Core/Platform/MonitorInfo.h"
 #include "Utils/Algorithm/ParallelReduction.h"
-#include "ToneMappers.slang"
+#include "Utils/Image/FLIP.h"
 
 using namespace Falcor;
 
@@ -63,7 +63,6 @@ public:
 
 protected:
     void updatePrograms();
-    void computeExposureParameters(const float Ymedian, const float Ymax);
     void parseDictionary(const Dictionary& dict);
 
 private:
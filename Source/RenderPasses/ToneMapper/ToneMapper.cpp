@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "ToneMapper.h"
+#include "Core/Program/ProgramManager.h"
 #include "Utils/Color/ColorUtils.h"
 #include <fstd/bit.h> // TODO C++20: Replace with <bit>
 
@@ -243,11 +244,11 @@ void ToneMapper::execute(RenderContext* pRenderContext, const RenderData& render
     }
 
     // Run main pass
-    if (mRecreateToneMapPass)
+    if (mUpdateToneMapDefines)
     {
-        createToneMapPass();
+        updateToneMapDefines();
         mUpdateToneMapPass = true;
-        mRecreateToneMapPass = false;
+        mUpdateToneMapDefines = false;
     }
 
     if (mUpdateToneMapPass)
@@ -321,7 +322,7 @@ void ToneMapper::renderUI(Gui::Widgets& widget)
     {
         mUpdateToneMapPass |= exposureGroup.var("Exposure Compensation", mExposureCompensation, kExposureCompensationMin, kExposureCompensationMax, 0.1f, false, "%.1f");
 
-        mRecreateToneMapPass |= exposureGroup.checkbox("Auto Exposure", mAutoExposure);
+        mUpdateToneMapDefines |= exposureGroup.checkbox("Auto Exposure", mAutoExposure);
 
         if (!mAutoExposure)
         {
@@ -388,7 +389,7 @@ void ToneMapper::renderUI(Gui::Widgets& widget)
             mUpdateToneMapPass |= tonemappingGroup.var("Linear White", mWhiteScale, 0.f, 100.f, 0.01f);
         }
 
-        mRecreateToneMapPass |= tonemappingGroup.checkbox("Clamp Output", mClamp);
+        mUpdateToneMapDefines |= tonemappingGroup.checkbox("Clamp Output", mClamp);
     }
 }
 
@@ -413,7 +414,7 @@ void ToneMapper::setExposureCompensation(float exposureCompensation)
 void ToneMapper::setAutoExposure(bool autoExposure)
 {
     mAutoExposure = autoExposure;
-    mRecreateToneMapPass = true;
+    mUpdateToneMapDefines = true;
 }
 
 void ToneMapper::setExposureValue(float exposureValue)
@@ -464,7 +465,7 @@ void ToneMapper::setOperator(Operator op)
     if (op != mOperator)
     {
         mOperator = op;
-        mRecreateToneMapPass = true;
+        mUpdateToneMapDefines = true;
     }
 }
 
@@ -473,7 +474,7 @@ void ToneMapper::setClamp(bool clamp)
     if (clamp != mClamp)
     {
         mClamp = clamp;
-        mRecreateToneMapPass = true;
+        mUpdateToneMapDefines = true;
     }
 }
 
@@ -514,14 +515,33 @@ void ToneMapper::createLuminancePass()
     mpLuminancePass = FullScreenPass::create(mpDevice, kLuminanceFile);
 }
 
-void ToneMapper::createToneMapPass()
+Program::DefineList ToneMapper::getToneMapDefines(Operator op) const
 {
     Program::DefineList defines;
-    defines.add("_TONE_MAPPER_OPERATOR", std::to_string(static_cast<uint32_t>(mOperator)));
+    defines.add("_TONE_MAPPER_OPERATOR", std::to_string(static_cast<uint32_t>(op)));
     if (mAutoExposure) defines.add("_TONE_MAPPER_AUTO_EXPOSURE");
     if (mClamp) defines.add("_TONE_MAPPER_CLAMP");
+    return defines;
+}
+
+void ToneMapper::createToneMapPass()
+{
+    mpToneMapPass = FullScreenPass::create(mpDevice, kToneMappingFile, getToneMapDefines(mOperator));
+    updateToneMapDefines();
+}
+
+void ToneMapper::updateToneMapDefines()
+{
+    mpToneMapPass->getProgram()->setDefines(getToneMapDefines(mOperator));
+    mpToneMapPass->setVars(nullptr);
 
-    mpToneMapPass = FullScreenPass::create(mpDevice, kToneMappingFile, defines);
+    // Compile the other operators for the current settings in the background so switching between them in the UI doesn't stall.
+    std::vector<ProgramManager::ProgramSpecialization> specializations;
+    for (const auto& op : kOperatorList)
+    {
+        specializations.push_back({ mpToneMapPass->getProgram(), getToneMapDefines(static_cast<Operator>(op.value)) });
+    }
+    mpDevice->getProgramManager()->compileProgramVersionsAsync(specializations);
 }
 
 void ToneMapper::updateWhiteBalanceTransform()
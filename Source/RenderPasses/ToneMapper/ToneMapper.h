@@ -91,7 +91,9 @@ private:
     ToneMapper(std::shared_ptr<Device> pDevice, const Dictionary& dict);
     void parseDictionary(const Dictionary& dict);
 
+    Program::DefineList getToneMapDefines(Operator op) const;
     void createToneMapPass();
+    void updateToneMapDefines();
     void createLuminancePass();
     void createLuminanceFbo(const Texture::SharedPtr& pSrc);
 
@@ -133,7 +135,7 @@ private:
     float3 mSourceWhite;                ///< Source illuminant in RGB (the white point to which the image is transformed to conform to).
     rmcv::mat3 mColorTransform;           ///< Final color transform with exposure value baked in.
 
-    bool mRecreateToneMapPass = true;
+    bool mUpdateToneMapDefines = false;
     bool mUpdateToneMapPass = true;
 
     ExposureMode mExposureMode = ExposureMode::AperturePriority;
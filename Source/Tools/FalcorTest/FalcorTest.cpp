@@ -148,6 +148,13 @@ int main(int argc, char** argv)
     // Disable logging to console, we don't want to clutter the test runner output with log messages.
     Logger::setOutputs(Logger::OutputFlags::File | Logger::OutputFlags::DebugWindow);
 
-    FalcorTest falcorTest(config, options);
-    return falcorTest.run();
+    int returnCode = 0;
+    {
+        FalcorTest falcorTest(config, options);
+        returnCode = falcorTest.run();
+    }
+
+    // Write all pending log messages before exiting.
+    Logger::shutdown();
+    return returnCode;
 }
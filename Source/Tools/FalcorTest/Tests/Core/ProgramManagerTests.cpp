@@ -0,0 +1,86 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Core/Program/ProgramManager.h"
+
+namespace Falcor
+{
+namespace
+{
+const char kShaderFile[] = "Tests/Core/ProgramManagerTests.cs.slang";
+
+Program::DefineList getDefines(uint32_t value)
+{
+    return Program::DefineList().add("VALUE", std::to_string(value));
+}
+
+void testValue(GPUUnitTestContext& ctx, uint32_t value)
+{
+    ctx.createVars();
+    ctx.allocateStructuredBuffer("result", 1);
+    ctx.runProgram(1, 1, 1);
+
+    const uint32_t* result = ctx.mapBuffer<const uint32_t>("result");
+    EXPECT_EQ(result[0], value);
+    ctx.unmapBuffer("result");
+}
+} // namespace
+
+GPU_TEST(ProgramManager_CompileAsync)
+{
+    ProgramManager* pProgramManager = ctx.getDevice()->getProgramManager();
+
+    ctx.createProgram(kShaderFile, "main", getDefines(0), Shader::CompilerFlags::None, "", false);
+    Program::SharedPtr pProgram = ctx.getProgram()->shared_from_this();
+
+    // Compile the specializations in the background.
+    std::vector<ProgramManager::ProgramSpecialization> specializations;
+    for (uint32_t i = 1; i <= 4; i++)
+        specializations.push_back({pProgram, getDefines(i)});
+    Threading::Task task = pProgramManager->compileProgramVersionsAsync(specializations);
+
+    // Switching to a specialization that is still compiling waits for the background result.
+    pProgram->setDefines(getDefines(1));
+    EXPECT(pProgram->getActiveVersion()->getDefines() == getDefines(1));
+    testValue(ctx, 1);
+
+    task.finish();
+
+    // The other background results are swapped in as well.
+    for (uint32_t i = 2; i <= 4; i++)
+    {
+        pProgram->setDefines(getDefines(i));
+        testValue(ctx, i);
+    }
+
+    // Versions that already exist are not compiled again.
+    size_t versionCount = pProgramManager->getCompilationStats().programVersionCount;
+    pProgramManager->compileProgramVersionsAsync(specializations).finish();
+    EXPECT_EQ(pProgramManager->getCompilationStats().programVersionCount, versionCount);
+}
+} // namespace Falcor
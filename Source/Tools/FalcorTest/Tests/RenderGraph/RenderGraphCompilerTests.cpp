@@ -0,0 +1,304 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/RenderGraph.h"
+#include "RenderGraph/RenderGraphCompiler.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+
+namespace
+{
+/** Records the pass execution order and the resources bound to the pass fields.
+    Resources are identified by the order in which they were first seen, so that logs of different executables can be compared.
+*/
+struct ExecutionLog
+{
+    std::vector<std::string> entries;
+    std::unordered_map<const Resource*, size_t> resourceIds;
+};
+
+class RecompileTestPass : public RenderPass
+{
+public:
+    FALCOR_PLUGIN_CLASS(RecompileTestPass, "RecompileTestPass", "Render pass for testing render graph recompilation.");
+
+    using SharedPtr = std::shared_ptr<RecompileTestPass>;
+
+    static SharedPtr create(std::shared_ptr<Device> pDevice, const std::vector<std::string>& inputs, ExecutionLog* pLog)
+    {
+        return SharedPtr(new RecompileTestPass(std::move(pDevice), inputs, pLog));
+    }
+
+    RenderPassReflection reflect(const CompileData& compileData) override
+    {
+        RenderPassReflection reflector;
+        for (const auto& input : mInputs) reflector.addInput(input, "");
+        reflector.addOutput("out", "").format(mFormat).texture2D(0, 0, mSampleCount);
+        return reflector;
+    }
+
+    void compile(RenderContext* pRenderContext, const CompileData& compileData) override { mCompileCount++; }
+
+    void execute(RenderContext* pRenderContext, const RenderData& renderData) override
+    {
+        std::vector<std::string> fields = mInputs;
+        fields.push_back("out");
+        for (const auto& field : fields)
+        {
+            auto pTexture = renderData.getTexture(field);
+            if (!pTexture)
+            {
+                mpLog->entries.push_back(getName() + "." + field + ": none");
+                continue;
+            }
+            size_t resourceId = mpLog->resourceIds.emplace(pTexture.get(), mpLog->resourceIds.size()).first->second;
+            mpLog->entries.push_back(fmt::format("{}.{}: {}x{} {} {} samples, resource {}", getName(), field, pTexture->getWidth(), pTexture->getHeight(),
+                to_string(pTexture->getFormat()), pTexture->getSampleCount(), resourceId));
+        }
+    }
+
+    void setOutput(ResourceFormat format, uint32_t sampleCount = 1)
+    {
+        mFormat = format;
+        mSampleCount = sampleCount;
+        requestRecompile();
+    }
+
+    uint32_t getCompileCount() const { return mCompileCount; }
+
+private:
+    RecompileTestPass(std::shared_ptr<Device> pDevice, const std::vector<std::string>& inputs, ExecutionLog* pLog)
+        : RenderPass(std::move(pDevice)), mInputs(inputs), mpLog(pLog)
+    {}
+
+    std::vector<std::string> mInputs;
+    ExecutionLog* mpLog;
+    ResourceFormat mFormat = ResourceFormat::RGBA32Float;
+    uint32_t mSampleCount = 1;
+    uint32_t mCompileCount = 0;
+};
+
+/** Pass that forwards the format of its connected input to its output, like GaussianBlur.
+    It can only be compiled after it was reflected with the connected resources.
+*/
+class ForwardingTestPass : public RenderPass
+{
+public:
+    FALCOR_PLUGIN_CLASS(ForwardingTestPass, "ForwardingTestPass", "Render pass for testing render graph recompilation.");
+
+    using SharedPtr = std::shared_ptr<ForwardingTestPass>;
+
+    static SharedPtr create(std::shared_ptr<Device> pDevice, ExecutionLog* pLog) { return SharedPtr(new ForwardingTestPass(std::move(pDevice), pLog)); }
+
+    RenderPassReflection reflect(const CompileData& compileData) override
+    {
+        RenderPassReflection reflector;
+        const RenderPassReflection::Field* pInput = compileData.connectedResources.getField("in");
+        mReady = pInput != nullptr;
+        if (mReady)
+        {
+            reflector.addInput("in", "").format(pInput->getFormat());
+            reflector.addOutput("out", "").format(pInput->getFormat());
+        }
+        else
+        {
+            reflector.addInput("in", "");
+            reflector.addOutput("out", "");
+        }
+        return reflector;
+    }
+
+    void compile(RenderContext* pRenderContext, const CompileData& compileData) override
+    {
+        if (!mReady) throw RuntimeError("ForwardingTestPass: Missing incoming reflection information");
+    }
+
+    void execute(RenderContext* pRenderContext, const RenderData& renderData) override
+    {
+        for (const char* field : { "in", "out" })
+        {
+            auto pTexture = renderData.getTexture(field);
+            mpLog->entries.push_back(fmt::format("{}.{}: {}", getName(), field, pTexture ? to_string(pTexture->getFormat()) : "none"));
+        }
+    }
+
+private:
+    ForwardingTestPass(std::shared_ptr<Device> pDevice, ExecutionLog* pLog) : RenderPass(std::move(pDevice)), mpLog(pLog) {}
+
+    ExecutionLog* mpLog;
+    bool mReady = false;
+};
+
+struct TestGraph
+{
+    RenderGraph::SharedPtr pGraph;
+    RecompileTestPass::SharedPtr pA, pB, pC, pD;
+    uint32_t nodeA, nodeB, nodeC, nodeD;
+};
+
+/** Create a graph A -> B -> C with an additional edge A -> C and an unconnected pass D.
+*/
+TestGraph createTestGraph(std::shared_ptr<Device> pDevice, ExecutionLog* pLog)
+{
+    TestGraph g;
+    g.pGraph = RenderGraph::create(pDevice, "RecompileTest");
+    g.pA = RecompileTestPass::create(pDevice, {}, pLog);
+    g.pB = RecompileTestPass::create(pDevice, { "in" }, pLog);
+    g.pC = RecompileTestPass::create(pDevice, { "in0", "in1" }, pLog);
+    g.pD = RecompileTestPass::create(pDevice, {}, pLog);
+    g.nodeA = g.pGraph->addPass(g.pA, "A");
+    g.nodeB = g.pGraph->addPass(g.pB, "B");
+    g.nodeC = g.pGraph->addPass(g.pC, "C");
+    g.nodeD = g.pGraph->addPass(g.pD, "D");
+    g.pGraph->addEdge("A.out", "B.in");
+    g.pGraph->addEdge("B.out", "C.in0");
+    g.pGraph->addEdge("A.out", "C.in1");
+    g.pGraph->markOutput("C.out");
+    g.pGraph->markOutput("D.out");
+    return g;
+}
+
+RenderGraphCompiler::Dependencies createDependencies()
+{
+    RenderGraphCompiler::Dependencies dependencies;
+    dependencies.defaultResourceProps.dims = uint2(64, 32);
+    dependencies.defaultResourceProps.format = ResourceFormat::RGBA8UnormSrgb;
+    dependencies.aliasTransientResources = true;
+    return dependencies;
+}
+
+std::vector<std::string> executeAndLog(RenderContext* pRenderContext, RenderGraphExe& exe, const RenderGraphCompiler::Dependencies& dependencies, ExecutionLog& log)
+{
+    log = {};
+    RenderGraphExe::Context context;
+    context.pRenderContext = pRenderContext;
+    context.pGraphDictionary = InternalDictionary::create();
+    context.defaultTexDims = dependencies.defaultResourceProps.dims;
+    context.defaultTexFormat = dependencies.defaultResourceProps.format;
+    exe.execute(context);
+    return log.entries;
+}
+} // namespace
+
+GPU_TEST(RenderGraphCompiler_Recompile)
+{
+    RenderContext* pRenderContext = ctx.getRenderContext();
+    ExecutionLog log;
+    TestGraph g = createTestGraph(ctx.getDevice(), &log);
+    auto dependencies = createDependencies();
+
+    auto pPrevExe = RenderGraphCompiler::compile(*g.pGraph, pRenderContext, dependencies);
+    ASSERT(pPrevExe != nullptr);
+    const uint32_t compileCountD = g.pD->getCompileCount();
+
+    // Change the output of B. The graph topology is unchanged, so an incremental recompilation is possible.
+    g.pB->setOutput(ResourceFormat::RGBA16Float);
+    auto pIncrementalExe = RenderGraphCompiler::recompile(*g.pGraph, pRenderContext, dependencies, *pPrevExe, { g.nodeB });
+    ASSERT(pIncrementalExe != nullptr);
+
+    // Passes that are not connected to B are not compiled again and keep their resources.
+    EXPECT_EQ(g.pD->getCompileCount(), compileCountD);
+    EXPECT(pIncrementalExe->getResource("D.out") == pPrevExe->getResource("D.out"));
+
+    // The result must match a full compilation of the changed graph.
+    auto pFullExe = RenderGraphCompiler::compile(*g.pGraph, pRenderContext, dependencies);
+    ASSERT(pFullExe != nullptr);
+
+    auto incrementalLog = executeAndLog(pRenderContext, *pIncrementalExe, dependencies, log);
+    auto fullLog = executeAndLog(pRenderContext, *pFullExe, dependencies, log);
+    ASSERT_EQ(incrementalLog.size(), fullLog.size());
+    for (size_t i = 0; i < fullLog.size(); i++) EXPECT_EQ(incrementalLog[i], fullLog[i]) << "entry " << i;
+
+    const auto& incrementalStats = pIncrementalExe->getResourceAllocationStats();
+    const auto& fullStats = pFullExe->getResourceAllocationStats();
+    EXPECT_EQ(incrementalStats.requestCount, fullStats.requestCount);
+    EXPECT_EQ(incrementalStats.allocationCount, fullStats.allocationCount);
+    EXPECT_EQ(incrementalStats.requestedBytes, fullStats.requestedBytes);
+    EXPECT_EQ(incrementalStats.allocatedBytes, fullStats.allocatedBytes);
+    EXPECT_EQ(incrementalStats.peakBytes, fullStats.peakBytes);
+}
+
+GPU_TEST(RenderGraphCompiler_RecompileRequiresFullCompile)
+{
+    RenderContext* pRenderContext = ctx.getRenderContext();
+    ExecutionLog log;
+    TestGraph g = createTestGraph(ctx.getDevice(), &log);
+    auto dependencies = createDependencies();
+
+    auto pPrevExe = RenderGraphCompiler::compile(*g.pGraph, pRenderContext, dependencies);
+    ASSERT(pPrevExe != nullptr);
+
+    // A multisampled output connected to single-sampled inputs needs an MSAA resolve pass, which changes the execution order.
+    g.pA->setOutput(ResourceFormat::RGBA32Float, 4);
+    EXPECT(RenderGraphCompiler::recompile(*g.pGraph, pRenderContext, dependencies, *pPrevExe, { g.nodeA }) == nullptr);
+    g.pA->setOutput(ResourceFormat::RGBA32Float, 1);
+
+    // Removing a pass changes the graph topology.
+    g.pGraph->removePass("D");
+    EXPECT(RenderGraphCompiler::recompile(*g.pGraph, pRenderContext, dependencies, *pPrevExe, { g.nodeB }) == nullptr);
+}
+GPU_TEST(RenderGraphCompiler_RecompileConnectedReflection)
+{
+    RenderContext* pRenderContext = ctx.getRenderContext();
+    ExecutionLog log;
+    auto dependencies = createDependencies();
+
+    // Create a graph A -> F -> G, where F and G forward the format of their input.
+    auto pGraph = RenderGraph::create(ctx.getDevice(), "RecompileTest");
+    auto pA = RecompileTestPass::create(ctx.getDevice(), {}, &log);
+    uint32_t nodeA = pGraph->addPass(pA, "A");
+    pGraph->addPass(ForwardingTestPass::create(ctx.getDevice(), &log), "F");
+    pGraph->addPass(ForwardingTestPass::create(ctx.getDevice(), &log), "G");
+    pGraph->addEdge("A.out", "F.in");
+    pGraph->addEdge("F.out", "G.in");
+    pGraph->markOutput("G.out");
+
+    auto pPrevExe = RenderGraphCompiler::compile(*pGraph, pRenderContext, dependencies);
+    ASSERT(pPrevExe != nullptr);
+
+    // Changing the output of A changes the reflection of F, which changes the reflection of G.
+    pA->setOutput(ResourceFormat::RGBA16Float);
+    auto pIncrementalExe = RenderGraphCompiler::recompile(*pGraph, pRenderContext, dependencies, *pPrevExe, { nodeA });
+    ASSERT(pIncrementalExe != nullptr);
+
+    auto incrementalLog = executeAndLog(pRenderContext, *pIncrementalExe, dependencies, log);
+    EXPECT(std::find(incrementalLog.begin(), incrementalLog.end(), "G.out: RGBA16Float") != incrementalLog.end());
+
+    auto pFullExe = RenderGraphCompiler::compile(*pGraph, pRenderContext, dependencies);
+    ASSERT(pFullExe != nullptr);
+    auto fullLog = executeAndLog(pRenderContext, *pFullExe, dependencies, log);
+    ASSERT_EQ(incrementalLog.size(), fullLog.size());
+    for (size_t i = 0; i < fullLog.size(); i++) EXPECT_EQ(incrementalLog[i], fullLog[i]) << "entry " << i;
+}
+} // namespace Falcor
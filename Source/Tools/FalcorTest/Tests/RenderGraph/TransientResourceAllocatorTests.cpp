@@ -0,0 +1,201 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "RenderGraph/TransientResourceAllocator.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+
+namespace
+{
+using Request = TransientResourceAllocator::Request;
+
+Request makeRequest(uint32_t compatibilityClass, uint32_t firstUse, uint32_t lastUse, uint64_t size, bool aliasable = true)
+{
+    Request r;
+    r.compatibilityClass = compatibilityClass;
+    r.firstUse = firstUse;
+    r.lastUse = lastUse;
+    r.size = size;
+    r.aliasable = aliasable;
+    return r;
+}
+
+bool overlaps(const Request& a, const Request& b)
+{
+    return a.firstUse <= b.lastUse && b.firstUse <= a.lastUse;
+}
+} // namespace
+
+CPU_TEST(TransientResourceAllocator_Empty)
+{
+    auto plan = TransientResourceAllocator::plan({});
+    EXPECT(plan.allocationIndices.empty());
+    EXPECT(plan.allocationSizes.empty());
+    EXPECT_EQ(plan.stats.allocationCount, 0);
+    EXPECT_EQ(plan.stats.requestedBytes, 0);
+    EXPECT_EQ(plan.stats.peakBytes, 0);
+}
+
+CPU_TEST(TransientResourceAllocator_Chain)
+{
+    // Linear chain of passes where each output is consumed by the next pass:
+    // pass i writes resource i, pass i + 1 reads it.
+    std::vector<Request> requests;
+    for (uint32_t i = 0; i < 8; i++) requests.push_back(makeRequest(0, i, i + 1, 100));
+
+    auto plan = TransientResourceAllocator::plan(requests);
+    ASSERT_EQ(plan.allocationIndices.size(), requests.size());
+    EXPECT_EQ(plan.stats.requestCount, 8);
+    EXPECT_EQ(plan.stats.allocationCount, 2);
+    EXPECT_EQ(plan.stats.requestedBytes, 800);
+    EXPECT_EQ(plan.stats.allocatedBytes, 200);
+    EXPECT_EQ(plan.stats.getSavedBytes(), 600);
+    EXPECT_EQ(plan.stats.peakBytes, 200);
+
+    // Resources that are live at the same pass must not share an allocation.
+    for (uint32_t i = 0; i + 1 < 8; i++) EXPECT_NE(plan.allocationIndices[i], plan.allocationIndices[i + 1]);
+    // Resources two passes apart can share.
+    for (uint32_t i = 0; i + 2 < 8; i++) EXPECT_EQ(plan.allocationIndices[i], plan.allocationIndices[i + 2]);
+}
+
+CPU_TEST(TransientResourceAllocator_CompatibilityClasses)
+{
+    // Same lifetimes as a chain, but alternating classes, so nothing can be shared across classes.
+    std::vector<Request> requests =
+    {
+        makeRequest(0, 0, 0, 64),
+        makeRequest(1, 1, 1, 32),
+        makeRequest(0, 2, 2, 64),
+        makeRequest(1, 3, 3, 32),
+    };
+
+    auto plan = TransientResourceAllocator::plan(requests);
+    EXPECT_EQ(plan.stats.allocationCount, 2);
+    EXPECT_EQ(plan.allocationIndices[0], plan.allocationIndices[2]);
+    EXPECT_EQ(plan.allocationIndices[1], plan.allocationIndices[3]);
+    EXPECT_NE(plan.allocationIndices[0], plan.allocationIndices[1]);
+    EXPECT_EQ(plan.stats.allocatedBytes, 96);
+    EXPECT_EQ(plan.stats.peakBytes, 64);
+}
+
+CPU_TEST(TransientResourceAllocator_NonAliasable)
+{
+    // Graph outputs live until the end of the execution and persistent resources are never shared.
+    std::vector<Request> requests =
+    {
+        makeRequest(0, 0, 0, 10),
+        makeRequest(0, 1, 1, 10, false),
+        makeRequest(0, 2, uint32_t(-1), 10, false),
+        makeRequest(0, 3, 3, 10),
+    };
+
+    auto plan = TransientResourceAllocator::plan(requests);
+    EXPECT_EQ(plan.stats.allocationCount, 3);
+    EXPECT_EQ(plan.allocationIndices[0], plan.allocationIndices[3]);
+    EXPECT_NE(plan.allocationIndices[1], plan.allocationIndices[0]);
+    EXPECT_NE(plan.allocationIndices[2], plan.allocationIndices[0]);
+    EXPECT_NE(plan.allocationIndices[1], plan.allocationIndices[2]);
+    EXPECT_EQ(plan.stats.requestedBytes, 40);
+    EXPECT_EQ(plan.stats.allocatedBytes, 30);
+    EXPECT_EQ(plan.stats.peakBytes, 20);
+}
+
+CPU_TEST(TransientResourceAllocator_Randomized)
+{
+    std::mt19937 rng(1234);
+
+    for (uint32_t run = 0; run < 50; run++)
+    {
+        const uint32_t passCount = 1 + rng() % 32;
+        const uint32_t requestCount = rng() % 64;
+        const uint32_t classCount = 1 + rng() % 4;
+
+        std::vector<Request> requests;
+        for (uint32_t i = 0; i < requestCount; i++)
+        {
+            uint32_t compatibilityClass = rng() % classCount;
+            uint32_t firstUse = rng() % passCount;
+            uint32_t lastUse = firstUse + rng() % (passCount - firstUse);
+            bool aliasable = rng() % 8 != 0;
+            requests.push_back(makeRequest(compatibilityClass, firstUse, lastUse, 1ull << compatibilityClass, aliasable));
+        }
+
+        auto plan = TransientResourceAllocator::plan(requests);
+        ASSERT_EQ(plan.allocationIndices.size(), requests.size());
+        EXPECT_EQ(plan.stats.allocationCount, plan.allocationSizes.size());
+
+        // Requests sharing an allocation must be aliasable, of the same class and have disjoint lifetimes.
+        for (size_t i = 0; i < requests.size(); i++)
+        {
+            ASSERT_LT(plan.allocationIndices[i], plan.allocationSizes.size());
+            for (size_t j = i + 1; j < requests.size(); j++)
+            {
+                if (plan.allocationIndices[i] != plan.allocationIndices[j]) continue;
+                EXPECT(requests[i].aliasable && requests[j].aliasable) << fmt::format("Run {}: requests {} and {}", run, i, j);
+                EXPECT_EQ(requests[i].compatibilityClass, requests[j].compatibilityClass) << fmt::format("Run {}: requests {} and {}", run, i, j);
+                EXPECT(!overlaps(requests[i], requests[j])) << fmt::format("Run {}: requests {} and {}", run, i, j);
+            }
+        }
+
+        // The number of allocations is optimal: per class the maximum number of simultaneously live aliasable requests,
+        // plus one per non-aliasable request. Peak memory is computed by brute force over all passes.
+        uint32_t expectedAllocationCount = 0;
+        for (uint32_t c = 0; c < classCount; c++)
+        {
+            uint32_t maxLive = 0;
+            for (uint32_t t = 0; t < passCount; t++)
+            {
+                uint32_t live = 0;
+                for (const auto& r : requests) live += (r.aliasable && r.compatibilityClass == c && r.firstUse <= t && t <= r.lastUse) ? 1 : 0;
+                maxLive = std::max(maxLive, live);
+            }
+            expectedAllocationCount += maxLive;
+        }
+        uint64_t expectedPeakBytes = 0;
+        for (uint32_t t = 0; t < passCount; t++)
+        {
+            uint64_t live = 0;
+            for (const auto& r : requests) live += (r.firstUse <= t && t <= r.lastUse) ? r.size : 0;
+            expectedPeakBytes = std::max(expectedPeakBytes, live);
+        }
+        for (const auto& r : requests) expectedAllocationCount += r.aliasable ? 0 : 1;
+
+        EXPECT_EQ(plan.stats.allocationCount, expectedAllocationCount) << fmt::format("Run {}", run);
+        EXPECT_EQ(plan.stats.peakBytes, expectedPeakBytes) << fmt::format("Run {}", run);
+        EXPECT_LE(plan.stats.peakBytes, plan.stats.allocatedBytes) << fmt::format("Run {}", run);
+        EXPECT_LE(plan.stats.allocatedBytes, plan.stats.requestedBytes) << fmt::format("Run {}", run);
+    }
+}
+
+} // namespace Falcor
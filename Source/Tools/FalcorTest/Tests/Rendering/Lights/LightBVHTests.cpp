@@ -0,0 +1,335 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVH.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Settings.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kSphereCount = 4;
+const float kBoundsEpsilon = 1e-2f; // Node extents are stored at half precision.
+const float kFluxEpsilon = 1e-3f;
+
+rmcv::mat4 getSphereTransform(uint32_t i, float3 position)
+{
+    return rmcv::translate(position) * rmcv::scale(float3(1.f + 0.25f * i));
+}
+
+/** Create a scene with enough emissive triangles for the light BVH builder to build subtrees and reduce triangle ranges in parallel.
+    The spheres have degenerate triangles at the poles, which are culled by pre-integration.
+*/
+Scene::SharedPtr createEmissiveScene(std::shared_ptr<Device> pDevice)
+{
+    Settings settings;
+    auto pBuilder = SceneBuilder::create(pDevice, settings);
+
+    auto pMaterial = StandardMaterial::create(pDevice, "Emissive");
+    pMaterial->setEmissiveColor(float3(1.f, 0.5f, 0.25f));
+    auto pMesh = TriangleMesh::createSphere(1.f, 256, 128);
+    MeshID meshID = pBuilder->addTriangleMesh(pMesh, pMaterial);
+
+    for (uint32_t i = 0; i < kSphereCount; ++i)
+    {
+        rmcv::mat4 transform = getSphereTransform(i, float3(3.f * i, 0.5f * i, 0.f));
+        SceneBuilder::Node node = { "Sphere" + std::to_string(i), transform, rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>() };
+        pBuilder->addMeshInstance(pBuilder->addNode(node), meshID);
+    }
+
+    return pBuilder->getScene();
+}
+
+std::vector<PackedNode> buildNodes(RenderContext* pRenderContext, std::shared_ptr<Device> pDevice, const LightCollection::SharedConstPtr& pLightCollection, const LightBVHBuilder::Options& options)
+{
+    LightBVH bvh(pDevice, pLightCollection);
+    LightBVHBuilder builder(options);
+    builder.build(pRenderContext, bvh);
+    return bvh.isValid() ? bvh.getNodes() : std::vector<PackedNode>();
+}
+
+/** Move the spheres to new positions and update the scene, which updates the light collection.
+*/
+void moveSpheres(RenderContext* pRenderContext, const Scene::SharedPtr& pScene, const std::vector<float3>& positions)
+{
+    FALCOR_ASSERT(positions.size() == pScene->getGeometryInstanceCount());
+    for (uint32_t i = 0; i < pScene->getGeometryInstanceCount(); ++i)
+    {
+        pScene->updateNodeTransform(pScene->getGeometryInstance(i).globalMatrixID, getSphereTransform(i, positions[i]));
+    }
+    pScene->update(pRenderContext, 0.0);
+}
+
+bool containsAABB(const SharedNodeAttributes& outer, const SharedNodeAttributes& inner)
+{
+    float3 outerMin, outerMax, innerMin, innerMax;
+    outer.getAABB(outerMin, outerMax);
+    inner.getAABB(innerMin, innerMax);
+    for (int i = 0; i < 3; ++i)
+    {
+        if (innerMin[i] < outerMin[i] - kBoundsEpsilon || innerMax[i] > outerMax[i] + kBoundsEpsilon) return false;
+    }
+    return true;
+}
+
+bool isNearlyEqual(const SharedNodeAttributes& a, const SharedNodeAttributes& b)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        if (std::abs(a.origin[i] - b.origin[i]) > kBoundsEpsilon || std::abs(a.extent[i] - b.extent[i]) > kBoundsEpsilon) return false;
+    }
+    return std::abs(a.flux - b.flux) <= kFluxEpsilon * std::max(a.flux, b.flux);
+}
+
+/** Check that the subtree is consistent: the bounds and flux of the internal nodes match their children,
+    and the leaves reference consecutive ranges of triangle indices in depth-first order.
+    \param[in,out] triangleOffset Offset of the first triangle of the subtree. On return, the offset past the last triangle of the subtree.
+*/
+void validateSubtree(GPUUnitTestContext& ctx, const std::vector<PackedNode>& nodes, uint32_t nodeIndex, uint32_t& triangleOffset)
+{
+    ASSERT(nodeIndex < nodes.size());
+    const PackedNode& node = nodes[nodeIndex];
+    if (node.isLeaf())
+    {
+        LeafNode leaf = node.getLeafNode();
+        EXPECT_EQ(leaf.triangleOffset, triangleOffset) << "node " << nodeIndex;
+        EXPECT(leaf.triangleCount > 0) << "node " << nodeIndex;
+        triangleOffset = leaf.triangleOffset + leaf.triangleCount;
+        return;
+    }
+
+    InternalNode internal = node.getInternalNode();
+    ASSERT(internal.rightChildIdx > nodeIndex + 1 && internal.rightChildIdx < nodes.size()) << "node " << nodeIndex;
+    validateSubtree(ctx, nodes, nodeIndex + 1, triangleOffset);
+    validateSubtree(ctx, nodes, internal.rightChildIdx, triangleOffset);
+
+    SharedNodeAttributes left = nodes[nodeIndex + 1].getNodeAttributes();
+    SharedNodeAttributes right = nodes[internal.rightChildIdx].getNodeAttributes();
+    EXPECT(containsAABB(internal.attribs, left) && containsAABB(internal.attribs, right)) << "node " << nodeIndex;
+    EXPECT(std::abs(internal.attribs.flux - (left.flux + right.flux)) <= kFluxEpsilon * internal.attribs.flux) << "node " << nodeIndex;
+}
+
+/** Validate the BVH and compare its root against a BVH built from scratch with the same options.
+*/
+void validateAgainstRebuild(GPUUnitTestContext& ctx, const std::vector<PackedNode>& nodes, const std::vector<PackedNode>& rebuiltNodes)
+{
+    ASSERT(!nodes.empty() && !rebuiltNodes.empty());
+
+    uint32_t triangleCount = 0;
+    validateSubtree(ctx, nodes, 0, triangleCount);
+    uint32_t rebuiltTriangleCount = 0;
+    validateSubtree(ctx, rebuiltNodes, 0, rebuiltTriangleCount);
+
+    EXPECT_EQ(triangleCount, rebuiltTriangleCount);
+    EXPECT(isNearlyEqual(nodes[0].getNodeAttributes(), rebuiltNodes[0].getNodeAttributes()));
+}
+
+/** Returns the sum of the surface areas of all nodes, i.e. the SAH cost of the hierarchy up to a constant factor.
+*/
+float computeSurfaceAreaCost(const std::vector<PackedNode>& nodes)
+{
+    float cost = 0.f;
+    for (const PackedNode& node : nodes)
+    {
+        float3 extent = node.getNodeAttributes().extent;
+        cost += 8.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+    return cost;
+}
+} // namespace
+
+GPU_TEST(LightBVHParallelBuild)
+{
+    auto pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    auto pScene = createEmissiveScene(pDevice);
+    ASSERT(pScene != nullptr);
+    LightCollection::SharedConstPtr pLightCollection = pScene->getLightCollection(pRenderContext);
+    ASSERT(pLightCollection != nullptr);
+    ASSERT_GE(pLightCollection->getActiveLightCount(pRenderContext), 2u * 16384u);
+
+    for (auto splitHeuristic : { LightBVHBuilder::SplitHeuristic::BinnedSAH, LightBVHBuilder::SplitHeuristic::BinnedSAOH })
+    {
+        LightBVHBuilder::Options options;
+        options.splitHeuristicSelection = splitHeuristic;
+
+        options.useParallelBuild = false;
+        auto serialNodes = buildNodes(pRenderContext, pDevice, pLightCollection, options);
+        options.useParallelBuild = true;
+        auto parallelNodes = buildNodes(pRenderContext, pDevice, pLightCollection, options);
+
+        // The parallel build must produce a bit-identical node array.
+        ASSERT(!serialNodes.empty());
+        ASSERT_EQ(parallelNodes.size(), serialNodes.size()) << "split heuristic " << (uint32_t)splitHeuristic;
+        EXPECT(std::memcmp(parallelNodes.data(), serialNodes.data(), serialNodes.size() * sizeof(PackedNode)) == 0) << "split heuristic " << (uint32_t)splitHeuristic;
+    }
+}
+
+GPU_TEST(LightBVHIncrementalRefit)
+{
+    auto pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    auto pScene = createEmissiveScene(pDevice);
+    ASSERT(pScene != nullptr);
+    pScene->update(pRenderContext, 0.0);
+    LightCollection::SharedConstPtr pLightCollection = pScene->getLightCollection(pRenderContext);
+    ASSERT(pLightCollection != nullptr);
+
+    // Never rebuild subtrees, so that the incremental update only refits the nodes.
+    LightBVHBuilder::Options options;
+    options.useIncrementalUpdates = true;
+    options.rebuildQualityThreshold = std::numeric_limits<float>::max();
+    LightBVH bvh(pDevice, pLightCollection);
+    LightBVHBuilder builder(options);
+    builder.build(pRenderContext, bvh);
+    ASSERT(bvh.isValid());
+
+    // The same hierarchy refitted on the GPU.
+    options.useIncrementalUpdates = false;
+    LightBVH refitBVH(pDevice, pLightCollection);
+    LightBVHBuilder(options).build(pRenderContext, refitBVH);
+    ASSERT(refitBVH.isValid());
+    ASSERT_EQ(refitBVH.getNodes().size(), bvh.getNodes().size());
+
+    std::vector<float3> positions;
+    for (uint32_t i = 0; i < kSphereCount; ++i) positions.push_back(float3(3.f * i, -0.5f * i, 2.f * i));
+    moveSpheres(pRenderContext, pScene, positions);
+
+    builder.update(pRenderContext, bvh);
+    refitBVH.refit(pRenderContext);
+
+    // The hierarchy and triangle ranges are unchanged, the bounds and flux match the GPU refit.
+    const auto& nodes = bvh.getNodes();
+    const auto& refitNodes = refitBVH.getNodes();
+    ASSERT_EQ(nodes.size(), refitNodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        EXPECT_EQ(nodes[i].data[0].x, refitNodes[i].data[0].x) << "node " << i;
+        EXPECT(isNearlyEqual(nodes[i].getNodeAttributes(), refitNodes[i].getNodeAttributes())) << "node " << i;
+    }
+
+    options.useIncrementalUpdates = true;
+    validateAgainstRebuild(ctx, nodes, buildNodes(pRenderContext, pDevice, pLightCollection, options));
+}
+
+GPU_TEST(LightBVHIncrementalRebuildSubtrees)
+{
+    auto pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    auto pScene = createEmissiveScene(pDevice);
+    ASSERT(pScene != nullptr);
+    pScene->update(pRenderContext, 0.0);
+    LightCollection::SharedConstPtr pLightCollection = pScene->getLightCollection(pRenderContext);
+    ASSERT(pLightCollection != nullptr);
+
+    LightBVHBuilder::Options options;
+    options.useIncrementalUpdates = true;
+    LightBVH bvh(pDevice, pLightCollection);
+    LightBVHBuilder builder(options);
+    builder.build(pRenderContext, bvh);
+    ASSERT(bvh.isValid());
+
+    LightBVHBuilder::Options refitOptions = options;
+    refitOptions.rebuildQualityThreshold = std::numeric_limits<float>::max();
+    LightBVH refitBVH(pDevice, pLightCollection);
+    LightBVHBuilder refitBuilder(refitOptions);
+    refitBuilder.build(pRenderContext, refitBVH);
+    ASSERT(refitBVH.isValid());
+
+    // Move all spheres to the same position. The root bounds shrink while the children overlap,
+    // so the quality of the hierarchy degrades and findDegradedSubtrees() selects subtrees for rebuilding.
+    moveSpheres(pRenderContext, pScene, std::vector<float3>(kSphereCount, float3(0.f)));
+
+    builder.update(pRenderContext, bvh);
+    refitBuilder.update(pRenderContext, refitBVH);
+
+    const auto& nodes = bvh.getNodes();
+    const auto& refitNodes = refitBVH.getNodes();
+    auto rebuiltNodes = buildNodes(pRenderContext, pDevice, pLightCollection, options);
+    validateAgainstRebuild(ctx, nodes, rebuiltNodes);
+    validateAgainstRebuild(ctx, refitNodes, rebuiltNodes);
+
+    // The rebuilt subtrees change the hierarchy and improve its quality compared to refitting only.
+    bool isTopologyChanged = nodes.size() != refitNodes.size();
+    for (size_t i = 0; !isTopologyChanged && i < nodes.size(); ++i) isTopologyChanged = nodes[i].data[0].x != refitNodes[i].data[0].x;
+    EXPECT(isTopologyChanged);
+
+    const float cost = computeSurfaceAreaCost(nodes);
+    EXPECT_LT(cost, computeSurfaceAreaCost(refitNodes));
+    EXPECT_LT(cost, 1.1f * computeSurfaceAreaCost(rebuiltNodes));
+}
+
+GPU_TEST(LightBVHIncrementalAddTriangles)
+{
+    auto pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    auto pScene = createEmissiveScene(pDevice);
+    ASSERT(pScene != nullptr);
+    pScene->update(pRenderContext, 0.0);
+    LightCollection::SharedConstPtr pLightCollection = pScene->getLightCollection(pRenderContext);
+    ASSERT(pLightCollection != nullptr);
+
+    // The set of triangles in the light collection is fixed. The degenerate triangles at the poles of the spheres
+    // are culled by pre-integration, so disabling it adds them to the BVH, which requires a full build.
+    const uint32_t triangleCount = pLightCollection->getTotalLightCount();
+    ASSERT_LT(pLightCollection->getActiveLightCount(pRenderContext), triangleCount);
+
+    LightBVHBuilder::Options options;
+    options.useIncrementalUpdates = true;
+    LightBVH bvh(pDevice, pLightCollection);
+    LightBVHBuilder(options).build(pRenderContext, bvh);
+    ASSERT(bvh.isValid());
+
+    std::vector<float3> positions;
+    for (uint32_t i = 0; i < kSphereCount; ++i) positions.push_back(float3(2.f * i, 0.f, -1.f * i));
+    moveSpheres(pRenderContext, pScene, positions);
+
+    options.usePreintegration = false;
+    LightBVHBuilder(options).update(pRenderContext, bvh);
+
+    const auto& nodes = bvh.getNodes();
+    auto rebuiltNodes = buildNodes(pRenderContext, pDevice, pLightCollection, options);
+    ASSERT_EQ(nodes.size(), rebuiltNodes.size());
+    EXPECT(std::memcmp(nodes.data(), rebuiltNodes.data(), nodes.size() * sizeof(PackedNode)) == 0);
+
+    uint32_t leafTriangleCount = 0;
+    validateSubtree(ctx, nodes, 0, leafTriangleCount);
+    EXPECT_EQ(leafTriangleCount, triangleCount);
+}
+} // namespace Falcor
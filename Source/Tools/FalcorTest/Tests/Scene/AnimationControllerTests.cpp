@@ -0,0 +1,170 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Settings.h"
+#include <cmath>
+
+namespace Falcor
+{
+namespace
+{
+// Enough nodes per level for the world matrices of a level to be updated by several tasks.
+const uint32_t kRootCount = 2;
+const uint32_t kChildCount = 4;
+const uint32_t kGrandchildCount = 300;
+const float kMatrixEpsilon = 1e-4f;
+
+rmcv::mat4 createTransform(uint32_t i)
+{
+    float3 axis = normalize(float3(1.f, float(i % 7), float(i % 5) + 1.f));
+    return rmcv::translate(float3(0.1f * (i % 11), -0.2f * (i % 3), 0.05f * i)) * rmcv::rotate(0.01f * i, axis) * rmcv::scale(float3(1.f + 0.001f * (i % 13)));
+}
+
+bool isNearlyEqual(const rmcv::mat4& a, const rmcv::mat4& b)
+{
+    for (unsigned r = 0; r < 4; ++r)
+    {
+        for (unsigned c = 0; c < 4; ++c)
+        {
+            if (std::abs(a[r][c] - b[r][c]) > kMatrixEpsilon * std::max(1.f, std::abs(b[r][c]))) return false;
+        }
+    }
+    return true;
+}
+
+/** Create a scene graph with several levels of nodes. The levels are wide enough to be updated in parallel.
+    The last level is a chain below a subset of the nodes, so the graph is not balanced.
+    \param[out] parents The parent node of each created node.
+    \param[out] transforms The local transform of each created node.
+*/
+Scene::SharedPtr createHierarchyScene(std::shared_ptr<Device> pDevice, std::vector<NodeID>& parents, std::vector<rmcv::mat4>& transforms)
+{
+    Settings settings;
+    auto pBuilder = SceneBuilder::create(pDevice, settings, SceneBuilder::Flags::DontOptimizeGraph);
+
+    auto addNode = [&](NodeID parent)
+    {
+        const uint32_t i = (uint32_t)transforms.size();
+        SceneBuilder::Node node = { "Node" + std::to_string(i), createTransform(i), rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>(), parent };
+        NodeID nodeID = pBuilder->addNode(node);
+        FALCOR_ASSERT(nodeID.get() == i);
+        parents.push_back(parent);
+        transforms.push_back(node.transform);
+        return nodeID;
+    };
+
+    std::vector<NodeID> leaves;
+    for (uint32_t i = 0; i < kRootCount; ++i)
+    {
+        NodeID root = addNode(NodeID::Invalid());
+        for (uint32_t j = 0; j < kChildCount; ++j)
+        {
+            NodeID child = addNode(root);
+            for (uint32_t k = 0; k < kGrandchildCount; ++k)
+            {
+                NodeID grandchild = addNode(child);
+                leaves.push_back(k % 4 == 0 ? addNode(grandchild) : grandchild);
+            }
+        }
+    }
+
+    // Instance a mesh on some of the leaves, the scene needs geometry.
+    auto pMaterial = StandardMaterial::create(pDevice, "Material");
+    MeshID meshID = pBuilder->addTriangleMesh(TriangleMesh::createCube(), pMaterial);
+    for (size_t i = 0; i < leaves.size(); i += 16) pBuilder->addMeshInstance(leaves[i], meshID);
+
+    return pBuilder->getScene();
+}
+
+/** Check the world matrices against a serial evaluation of the scene graph.
+    Parents are created before their children, so a single pass in node order is enough.
+*/
+void checkWorldMatrices(GPUUnitTestContext& ctx, const AnimationController& controller, const std::vector<NodeID>& parents, const std::vector<rmcv::mat4>& transforms)
+{
+    const auto& globalMatrices = controller.getGlobalMatrices();
+    const auto& invTransposeGlobalMatrices = controller.getInvTransposeGlobalMatrices();
+    ASSERT_GE(globalMatrices.size(), transforms.size());
+
+    std::vector<rmcv::mat4> expected(transforms.size());
+    for (size_t i = 0; i < transforms.size(); ++i)
+    {
+        expected[i] = parents[i] != NodeID::Invalid() ? expected[parents[i].get()] * transforms[i] : transforms[i];
+        EXPECT(isNearlyEqual(globalMatrices[i], expected[i])) << "node " << i;
+        EXPECT(isNearlyEqual(invTransposeGlobalMatrices[i], rmcv::transpose(rmcv::inverse(expected[i])))) << "node " << i;
+    }
+}
+} // namespace
+
+GPU_TEST(AnimationControllerWorldMatrices)
+{
+    auto pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    std::vector<NodeID> parents;
+    std::vector<rmcv::mat4> transforms;
+    auto pScene = createHierarchyScene(pDevice, parents, transforms);
+    ASSERT(pScene != nullptr);
+    const AnimationController* pController = pScene->getAnimationController();
+    ASSERT(pController != nullptr);
+
+    // The first update computes all world matrices.
+    pScene->update(pRenderContext, 0.0);
+    checkWorldMatrices(ctx, *pController, parents, transforms);
+
+    // Edit a node on the first level below the first root, which has deeper descendants, and a leaf below the last root.
+    // Only the edited nodes and their descendants are updated and flagged as changed.
+    const uint32_t nodeCount = (uint32_t)transforms.size();
+    const uint32_t editedNodes[] = { 1, nodeCount - 2 };
+    for (uint32_t nodeID : editedNodes)
+    {
+        transforms[nodeID] = rmcv::translate(float3(1.f, 2.f, 3.f)) * transforms[nodeID];
+        pScene->updateNodeTransform(nodeID, transforms[nodeID]);
+    }
+    pScene->update(pRenderContext, 0.0);
+    checkWorldMatrices(ctx, *pController, parents, transforms);
+
+    std::vector<bool> isEdited(nodeCount, false);
+    for (uint32_t nodeID : editedNodes) isEdited[nodeID] = true;
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        const bool expectChanged = isEdited[i] || (parents[i] != NodeID::Invalid() && isEdited[parents[i].get()]);
+        isEdited[i] = expectChanged;
+        EXPECT_EQ(pController->isMatrixChanged(NodeID{ i }), expectChanged) << "node " << i;
+    }
+
+    // Without edits, no matrix changes.
+    pScene->update(pRenderContext, 0.0);
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        EXPECT(!pController->isMatrixChanged(NodeID{ i })) << "node " << i;
+    }
+    checkWorldMatrices(ctx, *pController, parents, transforms);
+}
+} // namespace Falcor
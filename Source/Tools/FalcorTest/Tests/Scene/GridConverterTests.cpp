@@ -0,0 +1,245 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Volume/GridConverter.h"
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4146 4244 4267 4275 4996)
+#endif
+// See Grid.cpp for why this workaround is needed to include GridBuilder.h.
+#define result_of invoke_result
+#include <nanovdb/util/GridBuilder.h>
+#undef result_of
+#include <nanovdb/util/Primitives.h>
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kBrickSize = 8;
+const uint32_t kMipCount = 4;
+const float kRangeEpsilon = 1e-3f; // The ranges are stored at half precision.
+
+struct LeafRange
+{
+    float majorant;
+    float minorant;
+    bool hasLeaf;
+};
+
+float2 unpackMajMin(uint32_t packed)
+{
+    return float2(f16tof32(packed & 0xffff), f16tof32(packed >> 16));
+}
+
+template <typename T>
+T readTexel(const std::vector<uint8_t>& data, size_t index)
+{
+    T value;
+    std::memcpy(&value, data.data() + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+/** Decode a texel of a BC4 block. The texels of a 4x4 block are stored in row-major order.
+*/
+float decodeBC4(uint64_t block, uint32_t texel)
+{
+    const uint32_t r0 = block & 0xff;
+    const uint32_t r1 = (block >> 8) & 0xff;
+    const uint32_t index = (block >> (16 + 3 * texel)) & 7;
+    if (index == 0) return r0 / 255.f;
+    if (index == 1) return r1 / 255.f;
+    if (r0 > r1) return ((8 - index) * r0 + (index - 1) * r1) / (7.f * 255.f);
+    if (index == 6) return 0.f;
+    if (index == 7) return 1.f;
+    return ((6 - index) * r0 + (index - 1) * r1) / (5.f * 255.f);
+}
+
+/** Read a normalized texel of the brick atlas.
+*/
+float readAtlasTexel(const std::vector<uint8_t>& data, uint3 atlasSize, uint3 p, uint32_t bitsPerTexel)
+{
+    if (bitsPerTexel == 4)
+    {
+        const size_t blockIndex = p.x / 4 + (atlasSize.x / 4) * (p.y / 4 + size_t(atlasSize.y / 4) * p.z);
+        return decodeBC4(readTexel<uint64_t>(data, blockIndex), (p.y % 4) * 4 + p.x % 4);
+    }
+    const size_t index = p.x + atlasSize.x * (p.y + size_t(atlasSize.y) * p.z);
+    if (bitsPerTexel == 8) return readTexel<uint8_t>(data, index) / 255.f;
+    return readTexel<uint16_t>(data, index) / 65535.f;
+}
+
+/** Compute the value range of a leaf including its 1-voxel halo, i.e. the range over the voxels the trilinear filter can touch.
+*/
+LeafRange computeLeafRange(const nanovdb::FloatGrid* pGrid, const nanovdb::Coord& origin)
+{
+    auto a = pGrid->getAccessor();
+    LeafRange range = { a.getValue(origin), a.getValue(origin), a.probeLeaf(origin) != nullptr };
+    if (!range.hasLeaf) return range;
+
+    for (int z = -1; z <= (int)kBrickSize; ++z)
+    {
+        for (int y = -1; y <= (int)kBrickSize; ++y)
+        {
+            for (int x = -1; x <= (int)kBrickSize; ++x)
+            {
+                float value = a.getValue(origin + nanovdb::Coord(x, y, z));
+                range.majorant = std::max(range.majorant, value);
+                range.minorant = std::min(range.minorant, value);
+            }
+        }
+    }
+    return range;
+}
+
+template <typename Converter>
+void testConverter(GPUUnitTestContext& ctx, const nanovdb::FloatGrid* pGrid, uint32_t bitsPerTexel)
+{
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    BrickedGrid bricks = Converter(pGrid).convert(ctx.getDevice().get());
+    ASSERT(bricks.range && bricks.indirection && bricks.atlas);
+    ASSERT_EQ(bricks.range->getMipCount(), kMipCount);
+
+    const uint3 leafDim(bricks.range->getWidth(), bricks.range->getHeight(), bricks.range->getDepth());
+    const uint3 atlasSize(bricks.atlas->getWidth(), bricks.atlas->getHeight(), bricks.atlas->getDepth());
+    const uint3 atlasSizeBricks = atlasSize / kBrickSize;
+    EXPECT_EQ(leafDim.x % (1u << (kMipCount - 1)), 0u);
+
+    auto& voxelBox = pGrid->indexBBox();
+    const nanovdb::Coord bbMin(voxelBox.min().x() & ~7, voxelBox.min().y() & ~7, voxelBox.min().z() & ~7);
+
+    std::vector<uint8_t> indirection = pRenderContext->readTextureSubresource(bricks.indirection.get(), 0);
+    std::vector<uint8_t> atlas = pRenderContext->readTextureSubresource(bricks.atlas.get(), 0);
+    std::vector<std::vector<uint8_t>> ranges(kMipCount);
+    for (uint32_t mip = 0; mip < kMipCount; ++mip) ranges[mip] = pRenderContext->readTextureSubresource(bricks.range.get(), bricks.range->getSubresourceIndex(0, mip));
+
+    // Check the mip 0 ranges and the bricks of all leaves. Non-empty leaves are assigned atlas bricks in scan order.
+    uint32_t brickCount = 0;
+    for (uint32_t z = 0, leafIndex = 0; z < leafDim.z; ++z)
+    {
+        for (uint32_t y = 0; y < leafDim.y; ++y)
+        {
+            for (uint32_t x = 0; x < leafDim.x; ++x, ++leafIndex)
+            {
+                const nanovdb::Coord origin = bbMin + nanovdb::Coord(int(x * kBrickSize), int(y * kBrickSize), int(z * kBrickSize));
+                const LeafRange expected = computeLeafRange(pGrid, origin);
+                const float2 majMin = unpackMajMin(readTexel<uint32_t>(ranges[0], leafIndex));
+                EXPECT_GE(majMin.x, expected.majorant - kRangeEpsilon) << "leaf " << leafIndex;
+                EXPECT_LE(majMin.y, expected.minorant + kRangeEpsilon) << "leaf " << leafIndex;
+
+                const uint32_t ptr = readTexel<uint32_t>(indirection, leafIndex);
+                if (!expected.hasLeaf || expected.majorant == expected.minorant)
+                {
+                    EXPECT_EQ(ptr, 0u) << "leaf " << leafIndex;
+                    EXPECT_EQ(majMin.x, majMin.y) << "leaf " << leafIndex;
+                    continue;
+                }
+
+                const uint32_t brick = brickCount++;
+                const uint3 brickCoord(brick % atlasSizeBricks.x, (brick / atlasSizeBricks.x) % atlasSizeBricks.y, brick / (atlasSizeBricks.x * atlasSizeBricks.y));
+                ASSERT_LT(brickCoord.z, atlasSizeBricks.z) << "leaf " << leafIndex;
+                EXPECT_EQ(ptr, brickCoord.x + (brickCoord.y << 8) + (brickCoord.z << 16)) << "leaf " << leafIndex;
+
+                // The brick stores the voxels normalized to the leaf range.
+                const float range = majMin.x - majMin.y;
+                const float tolerance = bitsPerTexel == 4 ? range * (1.f / 255.f + 1.f / 14.f) + kRangeEpsilon : range / ((1 << bitsPerTexel) - 1) + kRangeEpsilon;
+                auto a = pGrid->getAccessor();
+                for (uint32_t i = 0; i < kBrickSize * kBrickSize * kBrickSize; ++i)
+                {
+                    const uint3 voxel(i % kBrickSize, (i / kBrickSize) % kBrickSize, i / (kBrickSize * kBrickSize));
+                    const float value = majMin.y + range * readAtlasTexel(atlas, atlasSize, brickCoord * kBrickSize + voxel, bitsPerTexel);
+                    const float expectedValue = a.getValue(origin + nanovdb::Coord(int(voxel.x), int(voxel.y), int(voxel.z)));
+                    EXPECT_LE(std::abs(value - expectedValue), tolerance) << "leaf " << leafIndex << ", voxel " << i;
+                }
+            }
+        }
+    }
+    EXPECT_GT(brickCount, 0u);
+    EXPECT_GE(atlasSizeBricks.x * atlasSizeBricks.y * atlasSizeBricks.z, brickCount);
+
+    // Each coarser mip stores the union of the ranges of the 2x2x2 finer leaves.
+    for (uint32_t mip = 1; mip < kMipCount; ++mip)
+    {
+        const uint3 dim = leafDim >> mip;
+        const uint3 srcDim = leafDim >> (mip - 1);
+        for (uint32_t z = 0; z < dim.z; ++z)
+        {
+            for (uint32_t y = 0; y < dim.y; ++y)
+            {
+                for (uint32_t x = 0; x < dim.x; ++x)
+                {
+                    float2 expected(-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+                    for (uint32_t i = 0; i < 8; ++i)
+                    {
+                        const uint3 src = uint3(x, y, z) * 2u + uint3(i & 1, (i >> 1) & 1, i >> 2);
+                        const float2 majMin = unpackMajMin(readTexel<uint32_t>(ranges[mip - 1], src.x + srcDim.x * (src.y + srcDim.y * src.z)));
+                        expected = float2(std::max(expected.x, majMin.x), std::min(expected.y, majMin.y));
+                    }
+                    const float2 majMin = unpackMajMin(readTexel<uint32_t>(ranges[mip], x + dim.x * (y + dim.y * z)));
+                    EXPECT_EQ(majMin.x, expected.x) << "mip " << mip << ", leaf (" << x << ", " << y << ", " << z << ")";
+                    EXPECT_EQ(majMin.y, expected.y) << "mip " << mip << ", leaf (" << x << ", " << y << ", " << z << ")";
+                }
+            }
+        }
+    }
+}
+
+nanovdb::GridHandle<nanovdb::HostBuffer> createSphereGrid()
+{
+    // A fog volume sphere has constant leaves inside, varying leaves near the surface and no leaves outside.
+    return nanovdb::createFogVolumeSphere<float>(20.f, nanovdb::Vec3f(3.f, -5.f, 1.f), 1.f, 3.f);
+}
+} // namespace
+
+GPU_TEST(GridConverterBC4)
+{
+    auto handle = createSphereGrid();
+    testConverter<NanoVDBConverterBC4>(ctx, handle.grid<float>(), 4);
+}
+
+GPU_TEST(GridConverterUNORM8)
+{
+    auto handle = createSphereGrid();
+    testConverter<NanoVDBConverterUNORM8>(ctx, handle.grid<float>(), 8);
+}
+
+GPU_TEST(GridConverterUNORM16)
+{
+    auto handle = createSphereGrid();
+    testConverter<NanoVDBConverterUNORM16>(ctx, handle.grid<float>(), 16);
+}
+} // namespace Falcor
@@ -0,0 +1,116 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+GPU_TEST(MaterialHash)
+{
+    auto pA = StandardMaterial::create(ctx.getDevice(), "A");
+    auto pB = StandardMaterial::create(ctx.getDevice(), "B");
+    pA->setBaseColor(float4(0.25f, 0.5f, 0.75f, 1.f));
+    pB->setBaseColor(float4(0.25f, 0.5f, 0.75f, 1.f));
+
+    // Names are not part of the hash.
+    EXPECT(pA->isEqual(pB));
+    EXPECT_EQ(pA->computeHash(), pB->computeHash());
+
+    pB->setRoughness(0.1f);
+    EXPECT(!pA->isEqual(pB));
+    EXPECT_NE(pA->computeHash(), pB->computeHash());
+}
+
+GPU_TEST(MaterialHashSignedZero)
+{
+    auto pA = StandardMaterial::create(ctx.getDevice(), "A");
+    auto pB = StandardMaterial::create(ctx.getDevice(), "B");
+    // Set a non-zero value first as setters skip updates with values that compare equal.
+    pA->setDisplacementOffset(1.f);
+    pA->setDisplacementOffset(0.f);
+    pB->setDisplacementOffset(1.f);
+    pB->setDisplacementOffset(-0.f);
+
+    // -0 and +0 compare equal and must hash equally.
+    EXPECT(pA->isEqual(pB));
+    EXPECT_EQ(pA->computeHash(), pB->computeHash());
+}
+
+GPU_TEST(MaterialHashTextures)
+{
+    auto createTexture = [&]()
+    {
+        return Texture::create2D(ctx.getDevice().get(), 4, 4, ResourceFormat::RGBA8UnormSrgb, 1, 1, nullptr, ResourceBindFlags::ShaderResource);
+    };
+
+    auto pA = StandardMaterial::create(ctx.getDevice(), "A");
+    auto pB = StandardMaterial::create(ctx.getDevice(), "B");
+    pA->setBaseColorTexture(createTexture());
+    pB->setBaseColorTexture(createTexture());
+
+    // Textures compare by identity, but the hash doesn't depend on the texture object.
+    EXPECT(!pA->isEqual(pB));
+    EXPECT_EQ(pA->computeHash(), pB->computeHash());
+
+    pB->setBaseColorTexture(pA->getBaseColorTexture());
+    EXPECT(pA->isEqual(pB));
+    EXPECT_EQ(pA->computeHash(), pB->computeHash());
+}
+
+GPU_TEST(MaterialSystem_RemoveDuplicateMaterials)
+{
+    auto pMaterials = MaterialSystem::create(ctx.getDevice());
+
+    // Create 3 distinct materials with 4 copies each, interleaved.
+    const uint32_t kUniqueCount = 3;
+    const uint32_t kCopyCount = 4;
+    for (uint32_t copy = 0; copy < kCopyCount; ++copy)
+    {
+        for (uint32_t i = 0; i < kUniqueCount; ++i)
+        {
+            auto pMaterial = StandardMaterial::create(ctx.getDevice(), fmt::format("Material{}_{}", i, copy));
+            pMaterial->setBaseColor(float4(0.1f * (i + 1), 0.f, 0.f, 1.f));
+            pMaterials->addMaterial(pMaterial);
+        }
+    }
+    ASSERT_EQ(pMaterials->getMaterialCount(), kUniqueCount * kCopyCount);
+
+    std::vector<MaterialID> idMap;
+    size_t removed = pMaterials->removeDuplicateMaterials(idMap);
+
+    EXPECT_EQ(removed, (size_t)(kUniqueCount * (kCopyCount - 1)));
+    EXPECT_EQ(pMaterials->getMaterialCount(), kUniqueCount);
+    ASSERT_EQ(idMap.size(), (size_t)(kUniqueCount * kCopyCount));
+    for (uint32_t i = 0; i < idMap.size(); ++i)
+    {
+        // The first occurrence of each material is kept, in order.
+        EXPECT_EQ(idMap[i].get(), i % kUniqueCount);
+    }
+}
+} // namespace Falcor
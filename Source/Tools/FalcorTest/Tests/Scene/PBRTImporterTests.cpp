@@ -0,0 +1,114 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Core/Plugin.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Settings.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace Falcor
+{
+namespace
+{
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream fs(path, std::ios_base::binary | std::ios_base::trunc);
+    fs.write(content.data(), content.size());
+}
+
+/// Temporary directory for scene files. Removes all files on destruction.
+struct SceneDirectory
+{
+    std::filesystem::path directory;
+
+    SceneDirectory()
+    {
+        directory = getTempFilePath();
+        std::filesystem::create_directories(directory);
+    }
+
+    ~SceneDirectory()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(directory, ec);
+    }
+};
+
+const char kTriangle[] = R"(Shape "trianglemesh" "point3 P" [ 0 0 0  1 0 0  0 1 0 ] "integer indices" [ 0 1 2 ])";
+} // namespace
+
+GPU_TEST(PBRTImporter_ImportScope)
+{
+    if (!PluginManager::instance().loadPluginByName("PBRTImporter"))
+        throw RuntimeError("Could not load plugin 'PBRTImporter'");
+
+    SceneDirectory dir;
+
+    // The imported file changes the transform and defines a named coordinate system.
+    writeFile(
+        dir.directory / "imported.pbrt",
+        fmt::format(
+            "Translate 10 0 0\n"
+            "CoordinateSystem \"imported\"\n"
+            "{}\n"
+            "Translate 0 100 0\n",
+            kTriangle
+        )
+    );
+
+    // The importing file adds a triangle after the import. Neither the transform nor the named coordinate system of the
+    // imported file may apply to it.
+    writeFile(
+        dir.directory / "scene.pbrt",
+        fmt::format(
+            "LookAt 0 0 -5  0 0 0  0 1 0\n"
+            "Camera \"perspective\"\n"
+            "WorldBegin\n"
+            "Import \"imported.pbrt\"\n"
+            "CoordSysTransform \"imported\"\n"
+            "{}\n",
+            kTriangle
+        )
+    );
+
+    auto pBuilder = SceneBuilder::create(ctx.getDevice(), dir.directory / "scene.pbrt", Settings());
+    auto pScene = pBuilder->getScene();
+    ASSERT(pScene != nullptr);
+    ASSERT_EQ(pScene->getGeometryInstanceCount(), 2u);
+
+    // The imported triangle covers [10,11] x [0,1] and the other one [0,1] x [0,1].
+    const AABB& bounds = pScene->getSceneBounds();
+    EXPECT_EQ(bounds.minPoint.x, 0.f);
+    EXPECT_EQ(bounds.maxPoint.x, 11.f);
+    EXPECT_EQ(bounds.minPoint.y, 0.f);
+    EXPECT_EQ(bounds.maxPoint.y, 1.f);
+}
+} // namespace Falcor
@@ -0,0 +1,219 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/PLYReader.h"
+#include "Core/Errors.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+template<typename T>
+void appendBinary(std::string& data, T value, bool bigEndian)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if (bigEndian) std::reverse(bytes, bytes + sizeof(T));
+    data.append(bytes, sizeof(T));
+}
+
+bool readThrows(const std::string& data)
+{
+    try
+    {
+        PLYReader::readFromMemory(data.data(), data.size());
+    }
+    catch (const RuntimeError&)
+    {
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+CPU_TEST(PLYReader_Ascii)
+{
+    const std::string data =
+        "ply\n"
+        "format ascii 1.0\n"
+        "comment test\n"
+        "element vertex 5\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "property float nx\n"
+        "property float ny\n"
+        "property float nz\n"
+        "property float u\n"
+        "property float v\n"
+        "element face 2\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n"
+        "0 0 0 0 0 1 0 0\n"
+        "1 0 0 0 0 1 1 0\n"
+        "1 1 0 0 0 1 1 1\n"
+        "0 1 0 0 0 1 0 1\n"
+        "2 2 -0.5e1 0 1 0 0.25 0.75\n"
+        "4 0 1 2 3\n"
+        "3 2 3 4\n";
+
+    auto result = PLYReader::readFromMemory(data.data(), data.size());
+    EXPECT(result.hasNormals);
+    EXPECT(result.hasTexCoords);
+    ASSERT_EQ(result.vertices.size(), 5);
+    EXPECT_EQ(result.vertices[4].position.z, -5.f);
+    EXPECT_EQ(result.vertices[4].normal.y, 1.f);
+    EXPECT_EQ(result.vertices[4].texCoord.x, 0.25f);
+    EXPECT_EQ(result.vertices[4].texCoord.y, 0.75f);
+
+    // The quad is triangulated as a fan.
+    const std::vector<uint32_t> expectedIndices = {0, 1, 2, 0, 2, 3, 2, 3, 4};
+    EXPECT(result.indices == expectedIndices);
+}
+
+CPU_TEST(PLYReader_BinaryUniform)
+{
+    // Enough triangles to be converted in multiple chunks.
+    const uint32_t triangleCount = 200000;
+
+    for (bool bigEndian : {false, true})
+    {
+        std::string data = "ply\nformat ";
+        data += bigEndian ? "binary_big_endian" : "binary_little_endian";
+        data +=
+            " 1.0\n"
+            "element vertex " + std::to_string(triangleCount + 2) + "\n"
+            "property float x\n"
+            "property float y\n"
+            "property double z\n"
+            "element face " + std::to_string(triangleCount) + "\n"
+            "property uchar flags\n"
+            "property list uchar uint vertex_indices\n"
+            "end_header\n";
+        for (uint32_t i = 0; i < triangleCount + 2; ++i)
+        {
+            appendBinary(data, float(i), bigEndian);
+            appendBinary(data, 0.5f, bigEndian);
+            appendBinary(data, -double(i), bigEndian);
+        }
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            appendBinary(data, uint8_t(0xff), bigEndian);
+            appendBinary(data, uint8_t(3), bigEndian);
+            appendBinary(data, i, bigEndian);
+            appendBinary(data, i + 1, bigEndian);
+            appendBinary(data, i + 2, bigEndian);
+        }
+
+        auto result = PLYReader::readFromMemory(data.data(), data.size());
+        EXPECT(!result.hasNormals);
+        EXPECT(!result.hasTexCoords);
+        ASSERT_EQ(result.vertices.size(), triangleCount + 2);
+        ASSERT_EQ(result.indices.size(), triangleCount * 3);
+
+        bool verticesMatch = true;
+        for (uint32_t i = 0; i < triangleCount + 2; ++i)
+        {
+            const auto& p = result.vertices[i].position;
+            verticesMatch = verticesMatch && p.x == float(i) && p.y == 0.5f && p.z == -float(i);
+        }
+        EXPECT(verticesMatch);
+
+        bool indicesMatch = true;
+        for (uint32_t i = 0; i < triangleCount * 3; ++i)
+            indicesMatch = indicesMatch && result.indices[i] == i / 3 + i % 3;
+        EXPECT(indicesMatch);
+    }
+}
+
+CPU_TEST(PLYReader_BinaryMixedPolygons)
+{
+    // Faces with different vertex counts and an extra element with list properties use the sequential path.
+    std::string data =
+        "ply\n"
+        "format binary_little_endian 1.0\n"
+        "element vertex 5\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "element face 3\n"
+        "property list uchar int vertex_index\n"
+        "property int face_indices\n"
+        "element edge 1\n"
+        "property list ushort short vertices\n"
+        "end_header\n";
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        appendBinary(data, float(i), false);
+        appendBinary(data, 0.f, false);
+        appendBinary(data, 0.f, false);
+    }
+    const std::vector<std::vector<int32_t>> faces = {{0, 1, 2, 3}, {1, 2}, {2, 3, 4}};
+    for (const auto& face : faces)
+    {
+        appendBinary(data, uint8_t(face.size()), false);
+        for (int32_t index : face)
+            appendBinary(data, index, false);
+        appendBinary(data, int32_t(7), false);
+    }
+    appendBinary(data, uint16_t(2), false);
+    appendBinary(data, int16_t(0), false);
+    appendBinary(data, int16_t(1), false);
+
+    auto result = PLYReader::readFromMemory(data.data(), data.size());
+    ASSERT_EQ(result.vertices.size(), 5);
+    // Degenerate faces with less than 3 vertices are skipped.
+    const std::vector<uint32_t> expectedIndices = {0, 1, 2, 0, 2, 3, 2, 3, 4};
+    EXPECT(result.indices == expectedIndices);
+}
+
+CPU_TEST(PLYReader_Errors)
+{
+    const std::string header =
+        "ply\n"
+        "format ascii 1.0\n"
+        "element vertex 3\n"
+        "property float x\n"
+        "property float y\n"
+        "property float z\n"
+        "element face 1\n"
+        "property list uchar int vertex_indices\n"
+        "end_header\n";
+
+    EXPECT(!readThrows(header + "0 0 0 1 0 0 0 1 0 3 0 1 2\n"));
+    EXPECT(readThrows("plx\nformat ascii 1.0\nend_header\n"));
+    EXPECT(readThrows(header + "0 0 0 1 0 0 0 1 0 3 0 1 3\n"));
+    EXPECT(readThrows(header + "0 0 0 1 0 0 0 1 0 3 0 1\n"));
+    EXPECT(readThrows(header + "0 0 0 1 0 0 0 1 x 3 0 1 2\n"));
+    EXPECT(readThrows("ply\nformat binary_little_endian 1.0\nelement vertex 3\nproperty float x\nproperty float y\nproperty float z\nend_header\n"));
+}
+} // namespace Falcor
@@ -0,0 +1,191 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Settings.h"
+#include <cstring>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<TriangleMesh::SharedPtr> createTriangleMeshes()
+{
+    return {
+        TriangleMesh::createCube(float3(1.f, 2.f, 3.f)),
+        TriangleMesh::createSphere(0.5f, 64, 32),
+        TriangleMesh::createQuad(float2(2.f)),
+        TriangleMesh::createDisk(1.f, 48),
+        TriangleMesh::createSphere(1.5f, 16, 8),
+        TriangleMesh::createCube(),
+    };
+}
+
+std::vector<Material::SharedPtr> createMaterials(std::shared_ptr<Device> pDevice, size_t count)
+{
+    // Use distinct materials so that duplicate material removal doesn't affect the comparison.
+    std::vector<Material::SharedPtr> materials;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto pMaterial = StandardMaterial::create(pDevice, "Material" + std::to_string(i));
+        pMaterial->setBaseColor(float4(float(i + 1) / count, 0.5f, 0.25f, 1.f));
+        if (i % 2 == 1)
+        {
+            Transform transform;
+            transform.setScaling(float3(2.f, 0.5f, 1.f));
+            transform.setTranslation(float3(0.25f, 0.125f, 0.f));
+            pMaterial->setTextureTransform(transform);
+        }
+        materials.push_back(pMaterial);
+    }
+    return materials;
+}
+
+/** Add a triangle mesh through the synchronous addMesh() path.
+*/
+MeshID addMeshSerial(SceneBuilder& builder, const TriangleMesh::SharedPtr& pTriangleMesh, const Material::SharedPtr& pMaterial)
+{
+    const auto& indices = pTriangleMesh->getIndices();
+    const auto& vertices = pTriangleMesh->getVertices();
+
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCoords;
+    for (const auto& v : vertices)
+    {
+        positions.push_back(v.position);
+        normals.push_back(v.normal);
+        texCoords.push_back(v.texCoord);
+    }
+
+    SceneBuilder::Mesh mesh;
+    mesh.name = pTriangleMesh->getName();
+    mesh.faceCount = (uint32_t)(indices.size() / 3);
+    mesh.vertexCount = (uint32_t)vertices.size();
+    mesh.indexCount = (uint32_t)indices.size();
+    mesh.pIndices = indices.data();
+    mesh.topology = Vao::Topology::TriangleList;
+    mesh.isFrontFaceCW = pTriangleMesh->getFrontFaceCW();
+    mesh.pMaterial = pMaterial;
+    mesh.positions = { positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+    mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
+
+    return builder.addMesh(mesh);
+}
+
+std::vector<uint8_t> readBuffer(const Buffer::SharedPtr& pBuffer)
+{
+    if (!pBuffer) return {};
+    const uint8_t* pData = reinterpret_cast<const uint8_t*>(pBuffer->map(Buffer::MapType::Read));
+    std::vector<uint8_t> data(pData, pData + pBuffer->getSize());
+    pBuffer->unmap();
+    return data;
+}
+} // namespace
+
+GPU_TEST(SceneBuilderParallelMeshes)
+{
+    auto pDevice = ctx.getDevice();
+    Settings settings;
+    auto triangleMeshes = createTriangleMeshes();
+
+    // Build the scene with meshes processed on the thread pool.
+    auto parallelTriangleMeshes = createTriangleMeshes();
+    auto parallelMaterials = createMaterials(pDevice, triangleMeshes.size());
+    auto pParallelBuilder = SceneBuilder::create(pDevice, settings);
+    std::vector<MeshID> parallelMeshIDs;
+    for (size_t i = 0; i < parallelTriangleMeshes.size(); ++i)
+    {
+        parallelMeshIDs.push_back(pParallelBuilder->addTriangleMesh(parallelTriangleMeshes[i], parallelMaterials[i]));
+    }
+
+    // Changing or reusing a triangle mesh after adding it must not affect the added mesh.
+    for (auto& pTriangleMesh : parallelTriangleMeshes)
+    {
+        auto vertices = pTriangleMesh->getVertices();
+        for (auto& v : vertices) v.position *= 2.f;
+        pTriangleMesh->setVertices(vertices);
+        pTriangleMesh->setIndices({});
+        pTriangleMesh->setName("Modified");
+    }
+
+    // Changing the texture transform after adding a mesh must not affect the mesh.
+    for (auto& pMaterial : parallelMaterials)
+    {
+        Transform transform = pMaterial->getTextureTransform();
+        transform.setScaling(float3(4.f, 4.f, 1.f));
+        pMaterial->setTextureTransform(transform);
+    }
+
+    // Build the same scene with meshes processed serially on the calling thread.
+    auto serialMaterials = createMaterials(pDevice, triangleMeshes.size());
+    auto pSerialBuilder = SceneBuilder::create(pDevice, settings);
+    std::vector<MeshID> serialMeshIDs;
+    for (size_t i = 0; i < triangleMeshes.size(); ++i)
+    {
+        serialMeshIDs.push_back(addMeshSerial(*pSerialBuilder, triangleMeshes[i], serialMaterials[i]));
+    }
+
+    EXPECT(parallelMeshIDs == serialMeshIDs);
+
+    for (auto pBuilder : { pParallelBuilder, pSerialBuilder })
+    {
+        for (size_t i = 0; i < triangleMeshes.size(); ++i)
+        {
+            SceneBuilder::Node node = { "Node" + std::to_string(i), rmcv::translate(float3(float(i), 0.f, 0.f)), rmcv::identity<rmcv::mat4>(), rmcv::identity<rmcv::mat4>() };
+            pBuilder->addMeshInstance(pBuilder->addNode(node), MeshID{ i });
+        }
+    }
+
+    auto pParallelScene = pParallelBuilder->getScene();
+    auto pSerialScene = pSerialBuilder->getScene();
+    ASSERT(pParallelScene != nullptr && pSerialScene != nullptr);
+
+    // Compare the committed mesh data.
+    ASSERT_EQ(pParallelScene->getMeshCount(), pSerialScene->getMeshCount());
+    for (uint32_t i = 0; i < pSerialScene->getMeshCount(); ++i)
+    {
+        EXPECT_EQ(pParallelScene->getMeshName(i), pSerialScene->getMeshName(i)) << "mesh " << i;
+        const MeshDesc& parallelDesc = pParallelScene->getMesh(MeshID{ i });
+        const MeshDesc& serialDesc = pSerialScene->getMesh(MeshID{ i });
+        EXPECT(std::memcmp(&parallelDesc, &serialDesc, sizeof(MeshDesc)) == 0) << "mesh " << i;
+    }
+
+    const auto& pParallelVao = pParallelScene->getMeshVao();
+    const auto& pSerialVao = pSerialScene->getMeshVao();
+    ASSERT(pParallelVao != nullptr && pSerialVao != nullptr);
+    ASSERT_EQ(pParallelVao->getVertexBuffersCount(), pSerialVao->getVertexBuffersCount());
+    for (uint32_t i = 0; i < pSerialVao->getVertexBuffersCount(); ++i)
+    {
+        EXPECT(readBuffer(pParallelVao->getVertexBuffer(i)) == readBuffer(pSerialVao->getVertexBuffer(i))) << "vertex buffer " << i;
+    }
+    EXPECT(readBuffer(pParallelVao->getIndexBuffer()) == readBuffer(pSerialVao->getIndexBuffer()));
+}
+} // namespace Falcor
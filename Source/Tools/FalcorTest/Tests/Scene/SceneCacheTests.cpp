@@ -0,0 +1,148 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneCache.h"
+#include "Core/Platform/OS.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+/// Access to the dependency manifest functions of the scene cache, which are private.
+struct SceneCacheTestAccess
+{
+    static void writeDependencies(const SceneCache::Key& key, const std::vector<std::filesystem::path>& dependencies, bool hashContents)
+    {
+        SceneCache::writeDependencies(key, dependencies, hashContents);
+    }
+    static bool hasValidDependencies(const SceneCache::Key& key) { return SceneCache::hasValidDependencies(key); }
+    static std::filesystem::path getDependencyPath(const SceneCache::Key& key) { return SceneCache::getDependencyPath(key); }
+};
+
+namespace
+{
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream fs(path, std::ios_base::binary | std::ios_base::trunc);
+    fs.write(content.data(), content.size());
+}
+
+/// Move the modification time of a file forward, independent of the file system's time resolution.
+void touchFile(const std::filesystem::path& path)
+{
+    std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(2));
+}
+
+/// Temporary directory with scene dependencies and a unique cache key. Removes all files on destruction.
+struct DependencyFixture
+{
+    std::filesystem::path directory;
+    SceneCache::Key key;
+
+    DependencyFixture()
+    {
+        directory = getTempFilePath();
+        std::filesystem::create_directories(directory);
+        key = SHA1::compute(directory.string().data(), directory.string().size());
+    }
+
+    ~DependencyFixture()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(directory, ec);
+        std::filesystem::remove(SceneCacheTestAccess::getDependencyPath(key), ec);
+    }
+};
+
+void testDependencies(CPUUnitTestContext& ctx, bool hashContents)
+{
+    DependencyFixture fixture;
+    const auto scenePath = fixture.directory / "scene.pyscene";
+    const auto texturePath = fixture.directory / "texture.exr";
+    const auto missingPath = fixture.directory / "missing.obj";
+
+    auto writeManifest = [&]()
+    {
+        writeFile(scenePath, "scene contents");
+        writeFile(texturePath, "texture contents");
+        std::error_code ec;
+        std::filesystem::remove(missingPath, ec);
+        SceneCacheTestAccess::writeDependencies(fixture.key, {scenePath, texturePath, missingPath}, hashContents);
+    };
+
+    // No manifest.
+    EXPECT(!SceneCacheTestAccess::hasValidDependencies(fixture.key));
+
+    // Unchanged dependencies.
+    writeManifest();
+    EXPECT(SceneCacheTestAccess::hasValidDependencies(fixture.key));
+
+    // Touched file with unchanged contents. Only valid if the contents were hashed.
+    touchFile(scenePath);
+    EXPECT_EQ(SceneCacheTestAccess::hasValidDependencies(fixture.key), hashContents);
+
+    // Modified file with the same size.
+    writeManifest();
+    writeFile(texturePath, "texture CONTENTS");
+    touchFile(texturePath);
+    EXPECT(!SceneCacheTestAccess::hasValidDependencies(fixture.key));
+
+    // Modified file with a different size.
+    writeManifest();
+    writeFile(texturePath, "modified texture contents");
+    EXPECT(!SceneCacheTestAccess::hasValidDependencies(fixture.key));
+
+    // Deleted file.
+    writeManifest();
+    std::filesystem::remove(texturePath);
+    EXPECT(!SceneCacheTestAccess::hasValidDependencies(fixture.key));
+
+    // Created file that was missing when the manifest was written.
+    writeManifest();
+    writeFile(missingPath, "");
+    EXPECT(!SceneCacheTestAccess::hasValidDependencies(fixture.key));
+
+    // Rewriting the manifest records the current state.
+    writeManifest();
+    EXPECT(SceneCacheTestAccess::hasValidDependencies(fixture.key));
+}
+} // namespace
+
+CPU_TEST(SceneCache_Dependencies)
+{
+    testDependencies(ctx, false);
+}
+
+CPU_TEST(SceneCache_DependenciesHashed)
+{
+    testDependencies(ctx, true);
+}
+} // namespace Falcor
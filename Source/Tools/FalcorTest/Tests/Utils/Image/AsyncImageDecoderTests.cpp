@@ -0,0 +1,256 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/AsyncImageDecoder.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kImageSize = 16;
+const size_t kImageByteSize = kImageSize * kImageSize;
+
+/// Decode function creating a small single-channel image without touching the file system.
+Bitmap::UniqueConstPtr decodeTestImage(const std::filesystem::path& path)
+{
+    if (path.filename() == "invalid")
+        return nullptr;
+    std::vector<uint8_t> data(kImageByteSize, 0);
+    return Bitmap::create(kImageSize, kImageSize, ResourceFormat::R8Unorm, data.data());
+}
+
+/// Decode function that blocks on a gate before decoding the image named "gate".
+/// This keeps a single worker busy so that the remaining requests stay pending.
+struct GatedDecoder
+{
+    std::promise<void> started;
+    std::promise<void> gate;
+    std::shared_future<void> gateFuture = gate.get_future().share();
+
+    AsyncImageDecoder::DecodeFunction getFunction()
+    {
+        return [this](const std::filesystem::path& path)
+        {
+            if (path.filename() == "gate")
+            {
+                started.set_value();
+                gateFuture.wait();
+            }
+            return decodeTestImage(path);
+        };
+    }
+};
+} // namespace
+
+CPU_TEST(AsyncImageDecoder_Decode)
+{
+    AsyncImageDecoder decoder(4, AsyncImageDecoder::kDefaultMemoryBudget, decodeTestImage);
+
+    std::atomic<uint32_t> decodedCount = 0;
+    std::atomic<uint32_t> failedCount = 0;
+    for (uint32_t i = 0; i < 32; ++i)
+    {
+        std::filesystem::path path = i % 8 == 7 ? "invalid" : "image" + std::to_string(i);
+        decoder.decode(
+            path,
+            0,
+            [&](Bitmap::UniqueConstPtr pBitmap, bool cancelled)
+            {
+                EXPECT(!cancelled);
+                if (pBitmap)
+                {
+                    EXPECT_EQ(pBitmap->getWidth(), kImageSize);
+                    decoder.release(pBitmap->getSize());
+                    decodedCount++;
+                }
+                else
+                {
+                    failedCount++;
+                }
+            }
+        );
+    }
+    decoder.waitForAll();
+
+    EXPECT_EQ(decodedCount.load(), 28u);
+    EXPECT_EQ(failedCount.load(), 4u);
+    EXPECT_EQ(decoder.getRequestCount(), 0);
+    EXPECT_EQ(decoder.getDecodedByteSize(), 0);
+}
+
+CPU_TEST(AsyncImageDecoder_Priority)
+{
+    GatedDecoder gated;
+    AsyncImageDecoder decoder(1, AsyncImageDecoder::kDefaultMemoryBudget, gated.getFunction());
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto callback = [&](const std::string& name)
+    {
+        return [&, name](Bitmap::UniqueConstPtr pBitmap, bool cancelled)
+        {
+            if (pBitmap)
+                decoder.release(pBitmap->getSize());
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(name);
+        };
+    };
+
+    // The first request occupies the only worker while the others are queued.
+    decoder.decode("gate", 0, callback("gate"));
+    gated.started.get_future().wait();
+
+    decoder.decode("low", -1, callback("low"));
+    auto mediumID = decoder.decode("medium", 0, callback("medium"));
+    decoder.decode("high0", 10, callback("high0"));
+    decoder.decode("high1", 10, callback("high1"));
+    decoder.decode("normal", 0, callback("normal"));
+    auto boostedID = decoder.decode("boosted", 0, callback("boosted"));
+
+    // Re-prioritize pending requests. Requests with equal priority are processed in FIFO order.
+    EXPECT(decoder.setPriority(boostedID, 20));
+    EXPECT(decoder.setPriority(mediumID, 5));
+
+    gated.gate.set_value();
+    decoder.waitForAll();
+
+    std::vector<std::string> expected = {"gate", "boosted", "high0", "high1", "medium", "normal", "low"};
+    EXPECT(order == expected);
+    EXPECT(!decoder.setPriority(mediumID, 0));
+}
+
+CPU_TEST(AsyncImageDecoder_Cancel)
+{
+    GatedDecoder gated;
+    AsyncImageDecoder decoder(1, AsyncImageDecoder::kDefaultMemoryBudget, gated.getFunction());
+
+    std::atomic<uint32_t> decodedCount = 0;
+    std::atomic<uint32_t> cancelledCount = 0;
+    auto callback = [&](Bitmap::UniqueConstPtr pBitmap, bool cancelled)
+    {
+        if (cancelled)
+        {
+            EXPECT(pBitmap == nullptr);
+            cancelledCount++;
+        }
+        if (pBitmap)
+        {
+            decoder.release(pBitmap->getSize());
+            decodedCount++;
+        }
+    };
+
+    auto gateID = decoder.decode("gate", 10, callback);
+    std::vector<AsyncImageDecoder::RequestID> ids;
+    for (uint32_t i = 0; i < 8; ++i)
+        ids.push_back(decoder.decode("image" + std::to_string(i), 0, callback));
+
+    // Cancel every other pending request. The callback is called before cancel() returns.
+    for (size_t i = 0; i < ids.size(); i += 2)
+        EXPECT(decoder.cancel(ids[i]));
+    EXPECT_EQ(cancelledCount.load(), 4u);
+
+    gated.gate.set_value();
+    decoder.waitForAll();
+
+    EXPECT_EQ(decodedCount.load(), 5u);
+    EXPECT_EQ(cancelledCount.load(), 4u);
+
+    // Completed requests can no longer be cancelled.
+    EXPECT(!decoder.cancel(gateID));
+    EXPECT(!decoder.cancel(ids[1]));
+}
+
+CPU_TEST(AsyncImageDecoder_MemoryBudget)
+{
+    // The budget allows a single decoded image to be held at a time.
+    std::atomic<uint32_t> decodeCount = 0;
+    AsyncImageDecoder decoder(
+        4,
+        kImageByteSize,
+        [&](const std::filesystem::path& path)
+        {
+            decodeCount++;
+            return decodeTestImage(path);
+        }
+    );
+
+    std::mutex mutex;
+    std::vector<Bitmap::UniqueConstPtr> bitmaps;
+    auto callback = [&](Bitmap::UniqueConstPtr pBitmap, bool cancelled)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bitmaps.push_back(std::move(pBitmap));
+    };
+
+    // Hold on to the decoded images. Workers may only decode images while the budget is not exceeded,
+    // so at most one image per worker can be decoded before the first one is released.
+    const uint32_t requestCount = 16;
+    for (uint32_t i = 0; i < requestCount; ++i)
+        decoder.decode("image" + std::to_string(i), 0, callback);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_LE(decodeCount.load(), 4u);
+    EXPECT_GE(decodeCount.load(), 1u);
+    EXPECT_LE(decoder.getDecodedByteSize(), 4 * kImageByteSize);
+
+    // Release the images as they arrive until all requests have completed.
+    uint32_t releasedCount = 0;
+    while (releasedCount < requestCount)
+    {
+        Bitmap::UniqueConstPtr pBitmap;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (releasedCount < bitmaps.size())
+                pBitmap = std::move(bitmaps[releasedCount]);
+        }
+        if (pBitmap)
+        {
+            EXPECT_LE(decoder.getDecodedByteSize(), 4 * kImageByteSize);
+            decoder.release(pBitmap->getSize());
+            releasedCount++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    decoder.waitForAll();
+    EXPECT_EQ(decodeCount.load(), requestCount);
+    EXPECT_EQ(decoder.getDecodedByteSize(), 0);
+}
+} // namespace Falcor
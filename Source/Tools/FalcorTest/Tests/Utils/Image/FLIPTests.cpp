@@ -0,0 +1,343 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/FLIP.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Core/Plugin.h"
+#include "RenderGraph/RenderGraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 37;
+const uint32_t kHeight = 29;
+
+std::vector<float4> createImage(uint32_t seed, float scale)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.f, scale);
+    std::vector<float4> image(kWidth * kHeight);
+    for (auto& pixel : image)
+        pixel = float4(dist(rng), dist(rng), dist(rng), 1.f);
+    return image;
+}
+
+float HyAB(float3 a, float3 b)
+{
+    float3 diff = a - b;
+    return std::abs(diff.x) + std::sqrt(diff.y * diff.y + diff.z * diff.z);
+}
+
+float3 Hunt(float3 color)
+{
+    return float3(color.x, 0.01f * color.x * color.y, 0.01f * color.x * color.z);
+}
+
+float3 saturate(float3 c)
+{
+    return float3(std::clamp(c.x, 0.f, 1.f), std::clamp(c.y, 0.f, 1.f), std::clamp(c.z, 0.f, 1.f));
+}
+
+/// Straightforward port of LDRFLIP() in FLIPPass.cs.slang evaluating the full 2D kernels.
+/// HDR input is tone mapped with the Reinhard tone mapper.
+float referenceFLIP(const std::vector<float4>& reference, const std::vector<float4>& test, const FLIP::Options& options, int px, int py, float exposure)
+{
+    const float pi = float(M_PI);
+    const float ppd = options.monitorDistanceMeters * (options.monitorWidthPixels / options.monitorWidthMeters) * (pi / 180.f);
+    const float dx = 1.f / ppd;
+    const float maxDistance = std::pow(HyAB(Hunt(linearRGBToCIELab(float3(0.f, 1.f, 0.f))), Hunt(linearRGBToCIELab(float3(0.f, 0.f, 1.f)))), 0.7f);
+
+    auto getPixel = [&](const std::vector<float4>& image, int x, int y)
+    {
+        float3 c = image[y * kWidth + x].xyz;
+        if (options.isHDR)
+        {
+            c = std::pow(2.f, exposure) * c;
+            c = saturate(c / (luminance(c) + 1.f));
+        }
+        return linearRGBToYCxCz(c);
+    };
+    auto calculateWeight = [&](float dist2, float a1, float a2, float b1, float b2)
+    { return a1 * std::sqrt(pi / b1) * std::exp(dist2 / b1) + a2 * std::sqrt(pi / b2) * std::exp(dist2 / b2); };
+
+    const float sigma2 = (0.5f * 0.082f * ppd) * (0.5f * 0.082f * ppd);
+    const int radius = int(std::ceil(3.f * std::sqrt(0.04f / (2.f * pi * pi)) * ppd));
+
+    float positiveKernelSum = 0.f, negativeKernelSum = 0.f, edgeKernelSum = 0.f;
+    for (int y = -radius; y <= radius; y++)
+    {
+        for (int x = -radius; x <= radius; x++)
+        {
+            float g = std::exp(-(x * x + y * y) / (2.f * sigma2));
+            float pointWeight = (x * x / sigma2 - 1.f) * g;
+            positiveKernelSum += std::max(pointWeight, 0.f);
+            negativeKernelSum += std::max(-pointWeight, 0.f);
+            edgeKernelSum += std::max(-x * g, 0.f);
+        }
+    }
+
+    float3 kernelSum(0.f), referenceSum(0.f), testSum(0.f);
+    float referencePoint[2] = {}, referenceEdge[2] = {}, testPoint[2] = {}, testEdge[2] = {};
+    for (int y = -radius; y <= radius; y++)
+    {
+        for (int x = -radius; x <= radius; x++)
+        {
+            int nx = std::clamp(px + x, 0, int(kWidth) - 1);
+            int ny = std::clamp(py + y, 0, int(kHeight) - 1);
+            float3 referenceColor = getPixel(reference, nx, ny);
+            float3 testColor = getPixel(test, nx, ny);
+
+            float dist2 = -(x * dx * x * dx + y * dx * y * dx) * pi * pi;
+            float3 weight(calculateWeight(dist2, 1.f, 0.f, 0.0047f, 1e-5f), calculateWeight(dist2, 1.f, 0.f, 0.0053f, 1e-5f), calculateWeight(dist2, 34.1f, 13.5f, 0.04f, 0.025f));
+            kernelSum = kernelSum + weight;
+            referenceSum = referenceSum + weight * referenceColor;
+            testSum = testSum + weight * testColor;
+
+            float g = std::exp(-(x * x + y * y) / (2.f * sigma2));
+            float pointWeight[2] = { (x * x / sigma2 - 1.f) * g, (y * y / sigma2 - 1.f) * g };
+            float edgeWeight[2] = { -x * g, -y * g };
+            float referenceLuminance = (referenceColor.x + 16.f) / 116.f;
+            float testLuminance = (testColor.x + 16.f) / 116.f;
+            for (int i = 0; i < 2; i++)
+            {
+                float pointNormalization = 1.f / (pointWeight[i] >= 0.f ? positiveKernelSum : negativeKernelSum);
+                referencePoint[i] += referenceLuminance * pointWeight[i] * pointNormalization;
+                testPoint[i] += testLuminance * pointWeight[i] * pointNormalization;
+                referenceEdge[i] += referenceLuminance * edgeWeight[i] / edgeKernelSum;
+                testEdge[i] += testLuminance * edgeWeight[i] / edgeKernelSum;
+            }
+        }
+    }
+
+    float3 filteredReference = saturate(YCxCzToLinearRGB(float3(referenceSum.x / kernelSum.x, referenceSum.y / kernelSum.y, referenceSum.z / kernelSum.z)));
+    float3 filteredTest = saturate(YCxCzToLinearRGB(float3(testSum.x / kernelSum.x, testSum.y / kernelSum.y, testSum.z / kernelSum.z)));
+    float colorDiff = HyAB(Hunt(linearRGBToCIELab(filteredReference)), Hunt(linearRGBToCIELab(filteredTest)));
+
+    auto length = [](const float v[2]) { return std::sqrt(v[0] * v[0] + v[1] * v[1]); };
+    float edgeDifference = std::abs(length(referenceEdge) - length(testEdge));
+    float pointDifference = std::abs(length(referencePoint) - length(testPoint));
+    float featureDiff = std::pow(std::max(pointDifference, edgeDifference) * float(M_SQRT1_2), 0.5f);
+
+    float error = std::pow(colorDiff, 0.7f);
+    float perceptualCutoff = 0.4f * maxDistance;
+    if (error < perceptualCutoff)
+        error *= 0.95f / perceptualCutoff;
+    else
+        error = 0.95f + ((error - perceptualCutoff) / (maxDistance - perceptualCutoff)) * 0.05f;
+    return std::pow(error, 1.f - featureDiff);
+}
+
+/// Run FLIPPass on the GPU and compare its error map and exposure parameters with FLIP::compute().
+void testFLIPPass(GPUUnitTestContext& ctx, const std::vector<float4>& reference, const std::vector<float4>& test, const FLIP::Options& options)
+{
+    auto pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    // Load the plugin first, it registers the script bindings of the tone mapper type used in the dictionary.
+    if (!PluginManager::instance().loadPluginByName("FLIPPass"))
+        throw RuntimeError("Could not load plugin 'FLIPPass'");
+
+    Dictionary dict;
+    dict["isHDR"] = options.isHDR;
+    dict["toneMapper"] = options.toneMapper;
+    dict["useMagma"] = options.useMagma;
+    dict["clampInput"] = options.clampInput;
+    dict["monitorWidthPixels"] = options.monitorWidthPixels;
+    dict["monitorWidthMeters"] = options.monitorWidthMeters;
+    dict["monitorDistanceMeters"] = options.monitorDistanceMeters;
+    dict["useRealMonitorInfo"] = false;
+    RenderPass::SharedPtr pPass = RenderPass::create("FLIPPass", pDevice, dict);
+    if (!pPass)
+        throw RuntimeError("Could not create render pass 'FLIPPass'");
+
+    auto pReference = Texture::create2D(pDevice.get(), kWidth, kHeight, ResourceFormat::RGBA32Float, 1, 1, reference.data());
+    auto pTest = Texture::create2D(pDevice.get(), kWidth, kHeight, ResourceFormat::RGBA32Float, 1, 1, test.data());
+
+    RenderGraph::SharedPtr pGraph = RenderGraph::create(pDevice, "FLIP");
+    pGraph->addPass(pPass, "FLIPPass");
+    pGraph->setInput("FLIPPass.referenceImage", pReference);
+    pGraph->setInput("FLIPPass.testImage", pTest);
+    pGraph->markOutput("FLIPPass.errorMap");
+    pGraph->onResize(Fbo::create2D(pDevice.get(), kWidth, kHeight, ResourceFormat::RGBA32Float).get());
+    pGraph->execute(pRenderContext);
+
+    std::vector<uint8_t> data = pRenderContext->readTextureSubresource(pGraph->getOutput("FLIPPass.errorMap")->asTexture().get(), 0);
+    ASSERT_EQ(data.size(), sizeof(float4) * kWidth * kHeight);
+    const float4* errorMap = reinterpret_cast<const float4*>(data.data());
+
+    auto expected = FLIP::compute(reference.data(), test.data(), kWidth, kHeight, options);
+
+    if (options.isHDR)
+    {
+        // The pass reports the exposure parameters it computed from the reference image.
+        Dictionary passDict = pPass->getScriptingDictionary();
+        EXPECT_LT(std::abs(float(passDict["startExposure"]) - expected.exposureParameters.startExposure), 1e-4f);
+        EXPECT_LT(std::abs(float(passDict["stopExposure"]) - expected.exposureParameters.stopExposure), 1e-4f);
+        EXPECT_EQ(uint32_t(passDict["numExposures"]), expected.exposureParameters.numExposures);
+    }
+
+    // Only FLIP values are compared. The color map entry of a pixel may differ if its FLIP value is close to an entry boundary.
+    float maxError = 0.f;
+    for (size_t i = 0; i < size_t(kWidth) * kHeight; i++)
+        maxError = std::max(maxError, std::abs(errorMap[i].w - expected.errorMap[i].w));
+    EXPECT_LT(maxError, 1e-3f);
+}
+} // namespace
+
+CPU_TEST(FLIP_IdenticalImages)
+{
+    auto image = createImage(1, 1.f);
+
+    FLIP::Options options;
+    auto result = FLIP::compute(image.data(), image.data(), kWidth, kHeight, options);
+    ASSERT_EQ(result.errorMap.size(), size_t(kWidth * kHeight));
+    EXPECT(result.exposureMap.empty());
+    EXPECT_EQ(result.mean, 0.f);
+    EXPECT_EQ(result.max, 0.f);
+
+    options.isHDR = true;
+    result = FLIP::compute(image.data(), image.data(), kWidth, kHeight, options);
+    EXPECT_EQ(result.exposureMap.size(), size_t(kWidth * kHeight));
+    EXPECT_EQ(result.max, 0.f);
+}
+
+CPU_TEST(FLIP_LDR)
+{
+    auto reference = createImage(1, 1.f);
+    auto test = createImage(2, 1.f);
+
+    FLIP::Options options;
+    auto result = FLIP::compute(reference.data(), test.data(), kWidth, kHeight, options);
+
+    double sum = 0.0;
+    float maxError = 0.f;
+    for (uint32_t y = 0; y < kHeight; y++)
+    {
+        for (uint32_t x = 0; x < kWidth; x++)
+        {
+            float expected = referenceFLIP(reference, test, options, x, y, 0.f);
+            const float4& error = result.errorMap[y * kWidth + x];
+            maxError = std::max(maxError, std::abs(error.w - expected));
+            sum += error.w;
+        }
+    }
+    EXPECT_LT(maxError, 1e-4f);
+    EXPECT_LT(std::abs(result.mean - float(sum / (kWidth * kHeight))), 1e-6f);
+    EXPECT_GT(result.mean, 0.f);
+    EXPECT_LE(result.min, result.mean);
+    EXPECT_GE(result.max, result.mean);
+}
+
+CPU_TEST(FLIP_HDR)
+{
+    auto reference = createImage(3, 8.f);
+    auto test = createImage(4, 8.f);
+
+    FLIP::Options options;
+    options.isHDR = true;
+    options.toneMapper = FLIPToneMapperType::Reinhard;
+    auto result = FLIP::compute(reference.data(), test.data(), kWidth, kHeight, options);
+
+    // Exposure parameters are computed from the median and maximum luminance of the reference.
+    std::vector<float> luminances;
+    for (const auto& pixel : reference)
+        luminances.push_back(luminance(pixel.xyz));
+    std::sort(luminances.begin(), luminances.end());
+    float median = luminances.size() % 2 ? luminances[luminances.size() / 2]
+                                         : 0.5f * (luminances[luminances.size() / 2 - 1] + luminances[luminances.size() / 2]);
+    auto expected = FLIP::computeExposureParameters(FLIPToneMapperType::Reinhard, median, luminances.back());
+    EXPECT_EQ(result.exposureParameters.startExposure, expected.startExposure);
+    EXPECT_EQ(result.exposureParameters.stopExposure, expected.stopExposure);
+    EXPECT_EQ(result.exposureParameters.numExposures, expected.numExposures);
+    EXPECT_GE(expected.numExposures, 2u);
+
+    float maxError = 0.f;
+    for (uint32_t y = 0; y < kHeight; y += 3)
+    {
+        for (uint32_t x = 0; x < kWidth; x += 3)
+        {
+            float hdrflip = 0.f;
+            for (uint32_t i = 0; i < expected.numExposures; i++)
+            {
+                float exposure = expected.startExposure + i * expected.getExposureDelta();
+                hdrflip = std::max(hdrflip, referenceFLIP(reference, test, options, x, y, exposure));
+            }
+            maxError = std::max(maxError, std::abs(result.errorMap[y * kWidth + x].w - hdrflip));
+        }
+    }
+    EXPECT_LT(maxError, 1e-4f);
+}
+
+GPU_TEST(FLIP_FLIPPassLDR)
+{
+    auto reference = createImage(1, 1.f);
+    auto test = createImage(2, 1.f);
+
+    FLIP::Options options;
+    testFLIPPass(ctx, reference, test, options);
+}
+
+GPU_TEST(FLIP_FLIPPassHDR)
+{
+    auto reference = createImage(3, 8.f);
+    auto test = createImage(4, 8.f);
+
+    FLIP::Options options;
+    options.isHDR = true;
+    for (auto toneMapper : {FLIPToneMapperType::ACES, FLIPToneMapperType::Hable, FLIPToneMapperType::Reinhard})
+    {
+        options.toneMapper = toneMapper;
+        testFLIPPass(ctx, reference, test, options);
+    }
+}
+
+CPU_TEST(FLIP_InvalidValues)
+{
+    auto reference = createImage(1, 1.f);
+    auto test = reference;
+    test[5 * kWidth + 7] = float4(std::numeric_limits<float>::quiet_NaN(), 0.f, 0.f, 1.f);
+
+    FLIP::Options options;
+    auto result = FLIP::compute(reference.data(), test.data(), kWidth, kHeight, options);
+
+    // Invalid values are flagged with red in the error map and count as maximum error.
+    const float4& error = result.errorMap[5 * kWidth + 7];
+    EXPECT_EQ(error.x, 1.f);
+    EXPECT_EQ(error.y, 0.f);
+    EXPECT_EQ(error.z, 0.f);
+    EXPECT_EQ(error.w, 1.f);
+    EXPECT_EQ(result.max, 1.f);
+}
+} // namespace Falcor
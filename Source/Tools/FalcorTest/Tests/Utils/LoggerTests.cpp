@@ -0,0 +1,118 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Logger.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Falcor
+{
+
+namespace
+{
+std::string readLogFile()
+{
+    Logger::flush();
+    std::ifstream ifs(Logger::getLogFilePath());
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+size_t countOccurrences(const std::string& str, const std::string& pattern)
+{
+    size_t count = 0;
+    for (size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + pattern.size()))
+        count++;
+    return count;
+}
+} // namespace
+
+CPU_TEST(Logger_Threads)
+{
+    if (!Logger::enabled() || !is_set(Logger::getOutputs(), Logger::OutputFlags::File))
+        throw SkippingTestException("Logging to file is disabled");
+
+    const uint32_t kThreadCount = 8;
+    const uint32_t kMessageCount = 1000;
+
+    auto verbosity = Logger::getVerbosity();
+    Logger::setVerbosity(Logger::Level::Info);
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < kThreadCount; ++i)
+    {
+        threads.emplace_back(
+            [i]()
+            {
+                for (uint32_t j = 0; j < kMessageCount; ++j)
+                    logInfo("Logger_Threads message {} {}", i, j);
+            }
+        );
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    Logger::setVerbosity(verbosity);
+
+    // All messages are written after flushing.
+    std::string log = readLogFile();
+    EXPECT_EQ(countOccurrences(log, "Logger_Threads message"), kThreadCount * kMessageCount);
+    for (uint32_t i = 0; i < kThreadCount; ++i)
+    {
+        EXPECT_EQ(countOccurrences(log, fmt::format("Logger_Threads message {} {}\n", i, 0)), 1);
+        EXPECT_EQ(countOccurrences(log, fmt::format("Logger_Threads message {} {}\n", i, kMessageCount - 1)), 1);
+    }
+}
+
+CPU_TEST(Logger_Repeated)
+{
+    if (!Logger::enabled() || !is_set(Logger::getOutputs(), Logger::OutputFlags::File))
+        throw SkippingTestException("Logging to file is disabled");
+
+    auto verbosity = Logger::getVerbosity();
+    Logger::setVerbosity(Logger::Level::Info);
+
+    // Repeated messages are collapsed.
+    for (uint32_t i = 0; i < 100; ++i)
+        logInfo("Logger_Repeated message");
+    logInfo("Logger_Repeated done");
+
+    Logger::setVerbosity(verbosity);
+
+    std::string log = readLogFile();
+    EXPECT_EQ(countOccurrences(log, "Logger_Repeated message\n"), 1);
+    EXPECT_EQ(countOccurrences(log, "Last message repeated 99 times."), 1);
+    EXPECT_EQ(countOccurrences(log, "Logger_Repeated done\n"), 1);
+}
+
+} // namespace Falcor
@@ -0,0 +1,146 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Threading.h"
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace Falcor
+{
+
+CPU_TEST(Threading_DispatchTask)
+{
+    Threading::start();
+
+    std::atomic<uint32_t> counter = 0;
+    std::vector<Threading::Task> tasks;
+    for (uint32_t i = 0; i < 100; ++i)
+        tasks.push_back(Threading::dispatchTask([&counter]() { counter++; }));
+    for (auto& task : tasks)
+        task.finish();
+
+    EXPECT_EQ(counter.load(), 100u);
+    for (auto& task : tasks)
+        EXPECT_FALSE(task.isRunning());
+
+    Threading::Task empty;
+    EXPECT_FALSE(empty.isValid());
+    EXPECT_FALSE(empty.isRunning());
+}
+
+CPU_TEST(Threading_Continuation)
+{
+    Threading::start();
+
+    std::vector<uint32_t> order;
+    auto first = Threading::dispatchTask([&order]() { order.push_back(1); });
+    auto second = first.then([&order]() { order.push_back(2); });
+    auto third = second.then([&order]() { order.push_back(3); });
+    third.finish();
+
+    EXPECT(!first.isRunning() && !second.isRunning());
+    ASSERT_EQ(order.size(), 3u);
+    EXPECT_EQ(order[0], 1u);
+    EXPECT_EQ(order[1], 2u);
+    EXPECT_EQ(order[2], 3u);
+}
+
+CPU_TEST(Threading_TaskGroup)
+{
+    Threading::start();
+
+    std::atomic<uint32_t> counter = 0;
+    Threading::TaskGroup group;
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        // Nested parallel loops must not deadlock as waiting threads help executing tasks.
+        group.run([&counter]() { Threading::parallelFor(0, 100, [&counter](size_t) { counter++; }); });
+    }
+    group.wait();
+
+    EXPECT_FALSE(group.isRunning());
+    EXPECT_EQ(counter.load(), 6400u);
+}
+
+CPU_TEST(Threading_Exceptions)
+{
+    Threading::start();
+
+    bool caught = false;
+    try
+    {
+        Threading::dispatchTask([]() { throw std::runtime_error("task"); }).finish();
+    }
+    catch (const std::runtime_error&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+
+    caught = false;
+    try
+    {
+        Threading::parallelFor(0, 1000, [](size_t i) { if (i == 500) throw std::runtime_error("parallelFor"); }, 10);
+    }
+    catch (const std::runtime_error&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+}
+
+CPU_TEST(Threading_ParallelFor)
+{
+    Threading::start();
+
+    for (size_t count : { 0, 1, 7, 1000, 100000 })
+    {
+        for (size_t grainSize : { 0, 1, 13, 4096 })
+        {
+            std::vector<uint32_t> values(count, 0);
+            Threading::parallelFor(0, count, [&values](size_t i) { values[i] += 1; }, grainSize);
+            EXPECT_EQ(std::accumulate(values.begin(), values.end(), size_t(0)), count) << fmt::format("count={} grainSize={}", count, grainSize);
+
+            std::atomic<size_t> chunkTotal = 0;
+            std::atomic<bool> chunksValid = true;
+            Threading::parallelForRange(10, 10 + count, [&](size_t begin, size_t end)
+            {
+                if (begin < 10 || begin >= end || end > 10 + count) chunksValid = false;
+                if (grainSize > 0 && end - begin > grainSize) chunksValid = false;
+                chunkTotal += end - begin;
+            }, grainSize);
+            EXPECT(chunksValid.load());
+            EXPECT_EQ(chunkTotal.load(), count);
+        }
+    }
+}
+
+} // namespace Falcor
@@ -0,0 +1,331 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/CpuEventRecorder.h"
+#include "Utils/Timing/Profiler.h"
+#include "Utils/Threading.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Falcor
+{
+
+namespace
+{
+using Record = CpuEventRecorder::Record;
+
+/// Restores the previous recording state on destruction.
+class RecorderStateGuard
+{
+public:
+    RecorderStateGuard() : mWasEnabled(CpuEventRecorder::isEnabled()) {}
+    ~RecorderStateGuard() { CpuEventRecorder::setEnabled(mWasEnabled); }
+
+private:
+    bool mWasEnabled;
+};
+
+/// Drain all records and return them grouped by thread index.
+std::unordered_map<uint32_t, std::vector<Record>> drainAll()
+{
+    std::unordered_map<uint32_t, std::vector<Record>> records;
+    CpuEventRecorder::drain([&](uint32_t threadIndex, const Record& record) { records[threadIndex].push_back(record); });
+    return records;
+}
+
+/// Drain all records into per-thread lists. Records of released threads are moved to the finished list.
+void drainInto(std::unordered_map<uint32_t, std::vector<Record>>& records, std::vector<std::vector<Record>>& finished)
+{
+    CpuEventRecorder::drain(
+        [&](uint32_t threadIndex, const Record& record) { records[threadIndex].push_back(record); },
+        [&](uint32_t threadIndex)
+        {
+            auto it = records.find(threadIndex);
+            if (it == records.end())
+                return;
+            finished.push_back(std::move(it->second));
+            records.erase(it);
+        }
+    );
+}
+
+/// Check that begin/end records are properly nested.
+bool isBalanced(const std::vector<Record>& records)
+{
+    int depth = 0;
+    for (const auto& record : records)
+    {
+        depth += record.isBegin() ? 1 : -1;
+        if (depth < 0)
+            return false;
+    }
+    return depth == 0;
+}
+} // namespace
+
+CPU_TEST(CpuEventRecorder_RegisterEvent)
+{
+    auto a = CpuEventRecorder::registerEvent("CpuEventRecorderTestA");
+    auto b = CpuEventRecorder::registerEvent("CpuEventRecorderTestB");
+    EXPECT_NE(a, b);
+    EXPECT_EQ(a, CpuEventRecorder::registerEvent("CpuEventRecorderTestA"));
+    EXPECT_EQ(CpuEventRecorder::getEventName(a), "CpuEventRecorderTestA");
+    EXPECT_EQ(CpuEventRecorder::getEventName(b), "CpuEventRecorderTestB");
+}
+
+CPU_TEST(ProfilerEventIdCache_ChangingNames)
+{
+    // A call site with alternating names, like the render graph profiling the executed passes.
+    ProfilerEventIdCache cache;
+    auto a = CpuEventRecorder::registerEvent("ProfilerEventIdCacheTestA");
+    auto b = CpuEventRecorder::registerEvent("ProfilerEventIdCacheTestB");
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(cache.get("ProfilerEventIdCacheTestA"), a);
+        EXPECT_EQ(cache.get("ProfilerEventIdCacheTestB"), b);
+    }
+    EXPECT_EQ(cache.get("ProfilerEventIdCacheTest/Invalid"), Profiler::kInvalidEventId);
+}
+
+CPU_TEST(CpuEventRecorder_Nesting)
+{
+    auto outer = CpuEventRecorder::registerEvent("CpuEventRecorderTestOuter");
+    auto inner = CpuEventRecorder::registerEvent("CpuEventRecorderTestInner");
+    const uint32_t threadIndex = CpuEventRecorder::getThreadIndex();
+    RecorderStateGuard stateGuard;
+    drainAll();
+
+    // Events are not recorded while disabled.
+    CpuEventRecorder::setEnabled(false);
+    EXPECT_FALSE(CpuEventRecorder::beginEvent(outer));
+    CpuEventRecorder::endEvent();
+    EXPECT(drainAll()[threadIndex].empty());
+
+    CpuEventRecorder::setEnabled(true);
+    EXPECT(CpuEventRecorder::beginEvent(outer));
+    EXPECT(CpuEventRecorder::beginEvent(inner, 42));
+    CpuEventRecorder::endEvent();
+    CpuEventRecorder::endEvent();
+
+    // An event started while disabled hides its children.
+    CpuEventRecorder::setEnabled(false);
+    CpuEventRecorder::beginEvent(outer);
+    CpuEventRecorder::setEnabled(true);
+    EXPECT_FALSE(CpuEventRecorder::beginEvent(inner));
+    CpuEventRecorder::endEvent();
+    CpuEventRecorder::endEvent();
+
+    auto records = drainAll()[threadIndex];
+    ASSERT_EQ(records.size(), 4);
+    EXPECT(records[0].isBegin());
+    EXPECT_EQ(records[0].id, outer);
+    EXPECT_EQ(records[0].getPayload(), 0u);
+    EXPECT(records[1].isBegin());
+    EXPECT_EQ(records[1].id, inner);
+    EXPECT_EQ(records[1].getPayload(), 42u);
+    EXPECT_FALSE(records[2].isBegin());
+    EXPECT_FALSE(records[3].isBegin());
+    for (size_t i = 1; i < records.size(); ++i)
+        EXPECT_LE(records[i - 1].time, records[i].time);
+}
+
+CPU_TEST(CpuEventRecorder_Overflow)
+{
+    auto outer = CpuEventRecorder::registerEvent("CpuEventRecorderTestOuter");
+    auto inner = CpuEventRecorder::registerEvent("CpuEventRecorderTestInner");
+    const uint32_t threadIndex = CpuEventRecorder::getThreadIndex();
+    RecorderStateGuard stateGuard;
+    drainAll();
+
+    // Record more events than fit into the ring buffer and the staging list without draining.
+    const size_t kMaxRecords = CpuEventRecorder::kBufferCapacity + CpuEventRecorder::kMaxStagedRecords;
+    CpuEventRecorder::setEnabled(true);
+    const uint64_t droppedCount = CpuEventRecorder::getDroppedEventCount();
+    CpuEventRecorder::beginEvent(outer);
+    for (size_t i = 0; i < kMaxRecords; ++i)
+    {
+        CpuEventRecorder::beginEvent(inner);
+        CpuEventRecorder::endEvent();
+    }
+    CpuEventRecorder::endEvent();
+
+    auto records = drainAll()[threadIndex];
+    EXPECT_LT(droppedCount, CpuEventRecorder::getDroppedEventCount());
+    EXPECT_LE(records.size(), kMaxRecords);
+    EXPECT(isBalanced(records));
+}
+
+CPU_TEST(CpuEventRecorder_StagedRecords)
+{
+    auto event = CpuEventRecorder::registerEvent("CpuEventRecorderTestStaged");
+    RecorderStateGuard stateGuard;
+    drainAll();
+
+    // Record more events than fit into the ring buffer on a worker thread without draining, like a scene import does.
+    const uint32_t kEventCount = 4 * CpuEventRecorder::kBufferCapacity;
+    CpuEventRecorder::setEnabled(true);
+    const uint64_t droppedCount = CpuEventRecorder::getDroppedEventCount();
+    uint32_t threadIndex = 0;
+    Threading::dispatchTask(
+        [&]()
+        {
+            threadIndex = CpuEventRecorder::getThreadIndex();
+            for (uint32_t i = 0; i < kEventCount; ++i)
+            {
+                CpuEventRecorder::beginEvent(event, i);
+                CpuEventRecorder::endEvent();
+            }
+        }
+    ).finish();
+
+    // No events are lost and the records are drained in order.
+    auto records = drainAll()[threadIndex];
+    EXPECT_EQ(CpuEventRecorder::getDroppedEventCount(), droppedCount);
+    ASSERT_EQ(records.size(), 2 * size_t(kEventCount));
+    uint32_t outOfOrderCount = 0;
+    for (uint32_t i = 0; i < kEventCount; ++i)
+    {
+        const Record& begin = records[2 * i];
+        const Record& end = records[2 * i + 1];
+        if (!begin.isBegin() || begin.id != event || begin.getPayload() != i || end.isBegin()) outOfOrderCount++;
+    }
+    EXPECT_EQ(outOfOrderCount, 0u);
+}
+
+CPU_TEST(CpuEventRecorder_Threads)
+{
+    const uint32_t kThreadCount = 4;
+    const uint32_t kEventCount = 100000;
+
+    auto outer = CpuEventRecorder::registerEvent("CpuEventRecorderTestOuter");
+    auto inner = CpuEventRecorder::registerEvent("CpuEventRecorderTestInner");
+    RecorderStateGuard stateGuard;
+    drainAll();
+
+    CpuEventRecorder::setEnabled(true);
+    std::atomic<uint32_t> runningCount{kThreadCount};
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < kThreadCount; ++i)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                for (uint32_t j = 0; j < kEventCount; ++j)
+                {
+                    CpuEventRecorder::beginEvent(outer, j);
+                    CpuEventRecorder::beginEvent(inner);
+                    CpuEventRecorder::endEvent();
+                    CpuEventRecorder::endEvent();
+                }
+                runningCount--;
+            }
+        );
+    }
+
+    // Drain concurrently while the threads are recording.
+    // Indices of exited threads may be reused, so records of released threads are kept separately.
+    std::unordered_map<uint32_t, std::vector<Record>> activeRecords;
+    std::vector<std::vector<Record>> records;
+    while (runningCount > 0)
+        drainInto(activeRecords, records);
+    for (auto& thread : threads)
+        thread.join();
+    drainInto(activeRecords, records);
+    for (auto& [threadIndex, threadRecords] : activeRecords)
+        records.push_back(std::move(threadRecords));
+
+    // Each thread recorded complete event trees in order (events may be dropped if the ring buffer fills up).
+    uint32_t recordingThreads = 0;
+    for (const auto& threadRecords : records)
+    {
+        if (threadRecords.empty() || threadRecords[0].id != outer)
+            continue;
+        recordingThreads++;
+        EXPECT(isBalanced(threadRecords));
+        uint32_t lastPayload = 0;
+        for (size_t i = 0; i < threadRecords.size(); ++i)
+        {
+            if (!threadRecords[i].isBegin() || threadRecords[i].id != outer)
+                continue;
+            if (i > 0)
+                EXPECT_LT(lastPayload, threadRecords[i].getPayload());
+            lastPayload = threadRecords[i].getPayload();
+            EXPECT(i + 1 == threadRecords.size() || !threadRecords[i + 1].isBegin() || threadRecords[i + 1].id == inner);
+        }
+    }
+    EXPECT_EQ(recordingThreads, kThreadCount);
+}
+
+CPU_TEST(CpuEventRecorder_ThreadIndexReuse)
+{
+    auto outer = CpuEventRecorder::registerEvent("CpuEventRecorderTestOuter");
+    RecorderStateGuard stateGuard;
+    CpuEventRecorder::setEnabled(true);
+    drainAll();
+
+    auto recordOnThread = [&]()
+    {
+        uint32_t threadIndex = 0;
+        std::thread thread(
+            [&]()
+            {
+                threadIndex = CpuEventRecorder::getThreadIndex();
+                CpuEventRecorder::beginEvent(outer);
+                CpuEventRecorder::endEvent();
+            }
+        );
+        thread.join();
+        return threadIndex;
+    };
+
+    // The index of an exited thread is released once its records are drained.
+    const uint32_t firstIndex = recordOnThread();
+    std::vector<uint32_t> releasedIndices;
+    size_t recordCount = 0;
+    CpuEventRecorder::drain(
+        [&](uint32_t threadIndex, const Record& record)
+        {
+            if (threadIndex == firstIndex)
+                recordCount++;
+        },
+        [&](uint32_t threadIndex) { releasedIndices.push_back(threadIndex); }
+    );
+    EXPECT_EQ(recordCount, 2);
+    EXPECT(std::find(releasedIndices.begin(), releasedIndices.end(), firstIndex) != releasedIndices.end());
+
+    // New threads reuse released indices instead of growing the thread list.
+    const uint32_t secondIndex = recordOnThread();
+    EXPECT_LE(secondIndex, firstIndex);
+    drainAll();
+}
+
+} // namespace Falcor
@@ -0,0 +1,81 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Timing/TraceWriter.h"
+#include "Core/Platform/OS.h"
+
+#include <nlohmann/json.hpp>
+
+#include <fstream>
+
+namespace Falcor
+{
+CPU_TEST(TraceWriter_Events)
+{
+    const auto path = getRuntimeDirectory() / "test_trace.json";
+    const uint32_t kEventCount = 50000; // Large enough to flush multiple times.
+
+    {
+        TraceWriter writer(path);
+        writer.setProcessName(1, "CPU");
+        writer.setThreadName(1, 7, "Worker \"7\"\n");
+        for (uint32_t i = 0; i < kEventCount; ++i)
+            writer.writeCompleteEvent(1, 7, "event\\name", "cpu", i * 10.0, 5.5);
+    }
+
+    std::ifstream ifs(path);
+    auto json = nlohmann::json::parse(ifs, nullptr, false);
+    ifs.close();
+    std::filesystem::remove(path);
+
+    ASSERT(json.is_array());
+    ASSERT_EQ(json.size(), kEventCount + 2);
+
+    EXPECT_EQ(json[0]["ph"], "M");
+    EXPECT_EQ(json[0]["name"], "process_name");
+    EXPECT_EQ(json[0]["pid"], 1);
+    EXPECT_EQ(json[0]["args"]["name"], "CPU");
+
+    EXPECT_EQ(json[1]["ph"], "M");
+    EXPECT_EQ(json[1]["name"], "thread_name");
+    EXPECT_EQ(json[1]["tid"], 7);
+    EXPECT_EQ(json[1]["args"]["name"], "Worker \"7\"\n");
+
+    for (uint32_t i = 0; i < kEventCount; ++i)
+    {
+        const auto& event = json[i + 2];
+        EXPECT_EQ(event["ph"], "X");
+        EXPECT_EQ(event["name"], "event\\name");
+        EXPECT_EQ(event["cat"], "cpu");
+        EXPECT_EQ(event["pid"], 1);
+        EXPECT_EQ(event["tid"], 7);
+        EXPECT_EQ(event["ts"].get<double>(), i * 10.0);
+        EXPECT_EQ(event["dur"].get<double>(), 5.5);
+    }
+}
+} // namespace Falcor
@@ -25,17 +25,27 @@
  # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
+#include "Utils/Image/FLIP.h"
+#include "Utils/Threading.h"
+#include "Utils/Color/ColorHelpers.slang"
 #include <FreeImage.h>
 #include <args.hxx>
+#include <nlohmann/json.hpp>
 
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <vector>
 #include <stdexcept>
 #include <map>
+#include <set>
 #include <functional>
 #include <filesystem>
+#include <thread>
 
 #include <cmath>
 #include <cstring>
@@ -70,44 +80,6 @@ public:
 
     static SharedPtr create(uint32_t width, uint32_t height) { return SharedPtr(new Image(width, height)); }
 
-    static SharedPtr loadFromFile(const std::filesystem::path& path)
-    {
-        FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
-
-        auto pathStr = path.string();
-
-        // Determine file format.
-        fifFormat = FreeImage_GetFileType(pathStr.c_str(), 0);
-        if (fifFormat == FIF_UNKNOWN)
-            fifFormat = FreeImage_GetFIFFromFilename(pathStr.c_str());
-        if (fifFormat == FIF_UNKNOWN)
-            throw std::runtime_error("Unknown image format");
-        if (!FreeImage_FIFSupportsReading(fifFormat))
-            throw std::runtime_error("Unsupported image format");
-
-        // Read image.
-        FIBITMAP* srcBitmap = FreeImage_Load(fifFormat, pathStr.c_str());
-        if (!srcBitmap)
-            throw std::runtime_error("Cannot read image");
-
-        // Convert to RGBA32F.
-        FIBITMAP* floatBitmap = FreeImage_ConvertToRGBAF(srcBitmap);
-        FreeImage_Unload(srcBitmap);
-        if (!floatBitmap)
-            throw std::runtime_error("Cannot convert to RGBA float format");
-
-        // Create image.
-        auto image = create(FreeImage_GetWidth(floatBitmap), FreeImage_GetHeight(floatBitmap));
-        int bytesPerPixel = 4 * sizeof(float);
-        FreeImage_ConvertToRawBits(
-            reinterpret_cast<BYTE*>(image->getData()), floatBitmap, bytesPerPixel * image->getWidth(), bytesPerPixel * 8, FI_RGBA_RED_MASK,
-            FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, true
-        );
-        FreeImage_Unload(floatBitmap);
-
-        return image;
-    }
-
     void saveToFile(const std::filesystem::path& path, bool writeAlpha = true) const
     {
         FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
@@ -181,85 +153,330 @@ private:
     uint32_t mHeight;
     std::unique_ptr<float[]> mData;
 
-    Image(uint32_t width, uint32_t height) : mWidth(width), mHeight(height), mData(std::make_unique<float[]>(width * height * 4)) {}
+    Image(uint32_t width, uint32_t height) : mWidth(width), mHeight(height), mData(std::make_unique<float[]>(size_t(width) * height * 4)) {}
 };
 
+/**
+ * Image file decoded by FreeImage.
+ * Rows are converted to RGBA32F when they are compared instead of converting the whole image up front,
+ * which avoids holding full-size float copies of large images. Rows are numbered from top to bottom.
+ */
+class ImageFile
+{
+public:
+    using SharedPtr = std::shared_ptr<ImageFile>;
+
+    ~ImageFile() { FreeImage_Unload(mpBitmap); }
+
+    uint32_t getWidth() const { return mWidth; }
+    uint32_t getHeight() const { return mHeight; }
+
+    /// Returns true if the image stores integer values, which are assumed to be sRGB encoded.
+    bool isSRGB() const { return mIsSRGB; }
+
+    static SharedPtr loadFromFile(const std::filesystem::path& path)
+    {
+        FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
+
+        auto pathStr = path.string();
+
+        // Determine file format.
+        fifFormat = FreeImage_GetFileType(pathStr.c_str(), 0);
+        if (fifFormat == FIF_UNKNOWN)
+            fifFormat = FreeImage_GetFIFFromFilename(pathStr.c_str());
+        if (fifFormat == FIF_UNKNOWN)
+            throw std::runtime_error("Unknown image format");
+        if (!FreeImage_FIFSupportsReading(fifFormat))
+            throw std::runtime_error("Unsupported image format");
+
+        // Read image.
+        FIBITMAP* bitmap = FreeImage_Load(fifFormat, pathStr.c_str());
+        if (!bitmap)
+            throw std::runtime_error("Cannot read image");
+
+        FREE_IMAGE_TYPE type = FreeImage_GetImageType(bitmap);
+        bool isSRGB = type == FIT_BITMAP || type == FIT_UINT16 || type == FIT_RGB16 || type == FIT_RGBA16;
+
+        // Convert formats that have no row conversion to RGBA32F up front.
+        if (!hasRowConversion(bitmap))
+        {
+            FIBITMAP* floatBitmap = FreeImage_ConvertToRGBAF(bitmap);
+            FreeImage_Unload(bitmap);
+            if (!floatBitmap)
+                throw std::runtime_error("Cannot convert to RGBA float format");
+            bitmap = floatBitmap;
+        }
+
+        return SharedPtr(new ImageFile(bitmap, isSRGB));
+    }
+
+    /**
+     * Get a row of pixels in RGBA32F format.
+     * @param y Row index.
+     * @param scratch Buffer of getWidth() * 4 floats used if the row needs to be converted.
+     * @return Pointer to the row, either pointing into the bitmap or to the scratch buffer.
+     */
+    const float* getRow(uint32_t y, float* scratch) const
+    {
+        const BYTE* src = FreeImage_GetScanLine(mpBitmap, mHeight - y - 1);
+        float* dst = scratch;
+
+        switch (FreeImage_GetImageType(mpBitmap))
+        {
+        case FIT_RGBAF:
+            return reinterpret_cast<const float*>(src);
+        case FIT_RGBF:
+            for (uint32_t x = 0; x < mWidth; ++x, src += sizeof(FIRGBF), dst += 4)
+            {
+                const FIRGBF* pixel = reinterpret_cast<const FIRGBF*>(src);
+                dst[0] = pixel->red;
+                dst[1] = pixel->green;
+                dst[2] = pixel->blue;
+                dst[3] = 1.f;
+            }
+            break;
+        case FIT_RGB16:
+        case FIT_RGBA16:
+        {
+            bool hasAlpha = FreeImage_GetImageType(mpBitmap) == FIT_RGBA16;
+            size_t stride = hasAlpha ? sizeof(FIRGBA16) : sizeof(FIRGB16);
+            for (uint32_t x = 0; x < mWidth; ++x, src += stride, dst += 4)
+            {
+                const WORD* pixel = reinterpret_cast<const WORD*>(src);
+                dst[0] = pixel[0] / 65535.f;
+                dst[1] = pixel[1] / 65535.f;
+                dst[2] = pixel[2] / 65535.f;
+                dst[3] = hasAlpha ? pixel[3] / 65535.f : 1.f;
+            }
+            break;
+        }
+        case FIT_BITMAP:
+        {
+            uint32_t bytesPerPixel = FreeImage_GetBPP(mpBitmap) / 8;
+            for (uint32_t x = 0; x < mWidth; ++x, src += bytesPerPixel, dst += 4)
+            {
+                dst[0] = src[FI_RGBA_RED] / 255.f;
+                dst[1] = src[FI_RGBA_GREEN] / 255.f;
+                dst[2] = src[FI_RGBA_BLUE] / 255.f;
+                dst[3] = bytesPerPixel == 4 ? src[FI_RGBA_ALPHA] / 255.f : 1.f;
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error("Unexpected image type");
+        }
+
+        return scratch;
+    }
+
+private:
+    FIBITMAP* mpBitmap;
+    uint32_t mWidth;
+    uint32_t mHeight;
+    bool mIsSRGB;
+
+    ImageFile(FIBITMAP* pBitmap, bool isSRGB)
+        : mpBitmap(pBitmap), mWidth(FreeImage_GetWidth(pBitmap)), mHeight(FreeImage_GetHeight(pBitmap)), mIsSRGB(isSRGB)
+    {}
+
+    static bool hasRowConversion(FIBITMAP* pBitmap)
+    {
+        switch (FreeImage_GetImageType(pBitmap))
+        {
+        case FIT_RGBAF:
+        case FIT_RGBF:
+        case FIT_RGB16:
+        case FIT_RGBA16:
+            return true;
+        case FIT_BITMAP:
+            return FreeImage_GetBPP(pBitmap) == 24 || (FreeImage_GetBPP(pBitmap) == 32 && FreeImage_GetColorType(pBitmap) == FIC_RGBALPHA);
+        default:
+            return false;
+        }
+    }
+};
+
+// Metric kernels compute the per-channel errors of an RGBA pixel with SSE.
+
+inline __m128 abs(__m128 x)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.f), x);
+}
+
 struct MSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    __m128 operator()(__m128 a, __m128 b) const
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]);
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_mul_ps(d, d);
     }
 };
 
 struct RMSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    __m128 operator()(__m128 a, __m128 b) const
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3);
-        return error / count;
+        __m128 d = _mm_sub_ps(a, b);
+        return _mm_div_ps(_mm_mul_ps(d, d), _mm_add_ps(_mm_mul_ps(a, a), _mm_set1_ps(1e-3f)));
     }
 };
 
 struct MAE
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs(sqr(a[i] - b[i]));
-        return error / count;
-    }
+    __m128 operator()(__m128 a, __m128 b) const { return abs(_mm_sub_ps(a, b)); }
 };
 
 struct MAPE
 {
-    double operator()(const float* a, const float* b, size_t count) const
+    __m128 operator()(__m128 a, __m128 b) const
     {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3));
-        return 100.0 * error / count;
+        return _mm_mul_ps(_mm_set1_ps(100.f), abs(_mm_div_ps(_mm_sub_ps(a, b), _mm_add_ps(a, _mm_set1_ps(1e-3f)))));
     }
 };
 
-template<typename Metric>
-double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+struct MaxAbs
 {
-    Metric metric;
+    __m128 operator()(__m128 a, __m128 b) const { return abs(_mm_sub_ps(a, b)); }
+};
+
+enum class Reduction
+{
+    Mean, ///< Average of the per-channel errors of a pixel and of all pixel errors.
+    Max,  ///< Maximum of the per-channel errors of a pixel and of all pixel errors.
+};
+
+/**
+ * Compare two images row by row on the Falcor thread pool.
+ * Row errors are accumulated in order, so the result does not depend on the thread count.
+ */
+template<typename Metric, Reduction reduction>
+double compare(const ImageFile& imageA, const ImageFile& imageB, bool alpha, float* errorMap)
+{
+    const uint32_t width = imageA.getWidth();
+    const uint32_t height = imageA.getHeight();
+    const __m128 channelMask = _mm_castsi128_ps(_mm_set_epi32(alpha ? -1 : 0, -1, -1, -1));
+    const float channelScale = 1.f / (alpha ? 4 : 3);
+
+    std::vector<double> rowErrors(height);
+    Falcor::Threading::parallelForRange(
+        0,
+        height,
+        [&](size_t begin, size_t end)
+        {
+            Metric metric;
+            std::vector<float> scratchA(size_t(width) * 4), scratchB(size_t(width) * 4);
+            for (size_t y = begin; y < end; ++y)
+            {
+                const float* a = imageA.getRow(uint32_t(y), scratchA.data());
+                const float* b = imageB.getRow(uint32_t(y), scratchB.data());
+                float* rowErrorMap = errorMap ? errorMap + y * width : nullptr;
+                double rowError = 0.0;
+                for (uint32_t x = 0; x < width; ++x, a += 4, b += 4)
+                {
+                    __m128 e = _mm_and_ps(metric(_mm_loadu_ps(a), _mm_loadu_ps(b)), channelMask);
+                    alignas(16) float c[4];
+                    _mm_store_ps(c, e);
+                    float error;
+                    if constexpr (reduction == Reduction::Mean)
+                    {
+                        error = (c[0] + c[1] + c[2] + c[3]) * channelScale;
+                        rowError += error;
+                    }
+                    else
+                    {
+                        // Propagate NaNs so that they are reported as errors.
+                        error = c[0];
+                        for (int i = 1; i < 4; ++i)
+                            error = (c[i] > error || std::isnan(c[i])) ? c[i] : error;
+                        rowError = (error > rowError || std::isnan(error)) ? error : rowError;
+                    }
+                    if (rowErrorMap)
+                        rowErrorMap[x] = error;
+                }
+                rowErrors[y] = rowError;
+            }
+        },
+        1
+    );
+
     double sum = 0.0;
-    const float* a = imageA.getData();
-    const float* b = imageB.getData();
-    size_t count = imageA.getWidth() * imageA.getHeight();
-    for (size_t i = 0; i < count; ++i)
+    for (double rowError : rowErrors)
+    {
+        if constexpr (reduction == Reduction::Mean)
+            sum += rowError;
+        else
+            sum = (rowError > sum || std::isnan(rowError)) ? rowError : sum;
+    }
+    if constexpr (reduction == Reduction::Mean)
+        sum /= double(width) * height;
+    return sum;
+}
+
+/**
+ * Compare two images with the CPU implementation of FLIP in Falcor.
+ * The first image is the reference. Integer images are converted from sRGB to linear RGB first, the alpha channel is ignored.
+ * The error map holds the per-pixel FLIP values and the result is the mean FLIP value.
+ */
+template<bool isHDR>
+double compareFLIP(const ImageFile& imageA, const ImageFile& imageB, bool alpha, float* errorMap)
+{
+    const uint32_t width = imageA.getWidth();
+    const uint32_t height = imageA.getHeight();
+
+    auto readImage = [&](const ImageFile& image)
+    {
+        std::vector<Falcor::float4> pixels(size_t(width) * height);
+        Falcor::Threading::parallelForRange(
+            0,
+            height,
+            [&](size_t begin, size_t end)
+            {
+                std::vector<float> scratch(size_t(width) * 4);
+                for (size_t y = begin; y < end; ++y)
+                {
+                    const float* src = image.getRow(uint32_t(y), scratch.data());
+                    Falcor::float4* dst = pixels.data() + y * width;
+                    for (uint32_t x = 0; x < width; ++x, src += 4)
+                    {
+                        Falcor::float3 color(src[0], src[1], src[2]);
+                        dst[x] = Falcor::float4(image.isSRGB() ? Falcor::sRGBToLinear(color) : color, src[3]);
+                    }
+                }
+            }
+        );
+        return pixels;
+    };
+
+    auto reference = readImage(imageA);
+    auto test = readImage(imageB);
+
+    Falcor::FLIP::Options options;
+    options.isHDR = isHDR;
+    auto result = Falcor::FLIP::compute(reference.data(), test.data(), width, height, options);
+
+    if (errorMap)
     {
-        double error = metric(a, b, alpha ? 4 : 3);
-        if (errorMap)
-            *errorMap++ = float(error);
-        sum += error;
-        a += 4;
-        b += 4;
+        for (size_t i = 0; i < result.errorMap.size(); ++i)
+            errorMap[i] = result.errorMap[i].w;
     }
-    return sum / count;
+    return result.mean;
 }
 
 struct ErrorMetric
 {
     std::string name;
     std::string desc;
-    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)> compare;
+    std::function<double(const ImageFile& imageA, const ImageFile& imageB, bool alpha, float* errorMap)> compare;
 };
 
 static const std::vector<ErrorMetric> errorMetrics = {
-    {"mse", "Mean Squared Error", compare<MSE>},
-    {"rmse", "Relative Mean Squared Error", compare<RMSE>},
-    {"mae", "Mean Absolute Error", compare<MAE>},
-    {"mape", "Mean Absolute Percentage Error", compare<MAPE>},
+    {"mse", "Mean Squared Error", compare<MSE, Reduction::Mean>},
+    {"rmse", "Relative Mean Squared Error", compare<RMSE, Reduction::Mean>},
+    {"mae", "Mean Absolute Error", compare<MAE, Reduction::Mean>},
+    {"mape", "Mean Absolute Percentage Error", compare<MAPE, Reduction::Mean>},
+    {"maxabs", "Maximum Absolute Error", compare<MaxAbs, Reduction::Max>},
+    {"flip", "Mean LDR-FLIP (first image is the reference)", compareFLIP<false>},
+    {"hdrflip", "Mean HDR-FLIP (first image is the reference)", compareFLIP<true>},
 };
 
 static Image::SharedPtr generateHeatMap(uint32_t width, uint32_t height, const float* errorMap)
@@ -280,92 +497,220 @@ static Image::SharedPtr generateHeatMap(uint32_t width, uint32_t height, const f
         *dst++ = 1.f;
     };
 
-    const auto [minValue, maxValue] = std::minmax_element(errorMap, errorMap + width * height);
+    const size_t count = size_t(width) * height;
+    const auto [minValue, maxValue] = std::minmax_element(errorMap, errorMap + count);
     const float range = std::max(1e-5f, *maxValue - *minValue);
     auto image = Image::create(width, height);
     float* dst = image->getData();
-    for (size_t i = 0; i < width * height; ++i)
-    {
-        float t = clamp((errorMap[i] - *minValue) / range, 0.f, 1.f);
-        writeColor(t, dst);
-        dst += 4;
-    }
+    Falcor::Threading::parallelForRange(
+        0,
+        count,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                float t = clamp((errorMap[i] - *minValue) / range, 0.f, 1.f);
+                writeColor(t, dst + i * 4);
+            }
+        },
+        size_t(1) << 16
+    );
 
     return image;
 }
 
-static bool compareImages(
+struct CompareResult
+{
+    bool success = false;
+    double error = 0.0;
+    std::string message; ///< Reason of a failed comparison (other than exceeding the threshold).
+};
+
+static CompareResult compareImages(
     const std::filesystem::path& pathA,
     const std::filesystem::path& pathB,
-    ErrorMetric metric,
+    const ErrorMetric& metric,
     float threshold,
     bool alpha,
     const std::filesystem::path& heatMapPath
 )
 {
-    auto loadImage = [](const std::filesystem::path& path)
-    {
-        try
-        {
-            return Image::loadFromFile(path);
-        }
-        catch (const std::runtime_error& e)
-        {
-            std::cerr << "Cannot load image from '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
-            return Image::SharedPtr();
-        }
-    };
+    CompareResult result;
 
-    auto saveImage = [](const Image& image, const std::filesystem::path& path)
+    auto loadImage = [&result](const std::filesystem::path& path)
     {
         try
         {
-            image.saveToFile(path);
+            return ImageFile::loadFromFile(path);
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot save image to '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
+            result.message = "Cannot load image from '" + path.string() + "' (Error: " + e.what() + ").";
+            return ImageFile::SharedPtr();
         }
     };
 
     // Load images.
     auto imageA = loadImage(pathA);
     if (!imageA)
-        return false;
+        return result;
     auto imageB = loadImage(pathB);
     if (!imageB)
-        return false;
+        return result;
 
     // Check resolution.
     if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
     {
-        std::cerr << "Cannot compare images with different resolutions." << std::endl;
-        return false;
+        result.message = "Cannot compare images with different resolutions.";
+        return result;
     }
 
     uint32_t width = imageA->getWidth();
     uint32_t height = imageB->getHeight();
 
     // Compare images.
-    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(width * height);
-    double error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(size_t(width) * height);
+    result.error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+
+    // Release the images before generating the heat map.
+    imageA.reset();
+    imageB.reset();
 
     // Generate heat map.
     if (errorMap)
     {
         auto heatMap = generateHeatMap(width, height, errorMap.get());
-        saveImage(*heatMap, heatMapPath);
+        try
+        {
+            heatMap->saveToFile(heatMapPath);
+        }
+        catch (const std::runtime_error& e)
+        {
+            std::cerr << "Cannot save image to '" << heatMapPath.string() << "' (Error: " << e.what() << ")." << std::endl;
+        }
     }
 
-    std::cout << error << std::endl;
-
     // Treat nans and infs as errors.
-    if (std::isnan(error) || std::isinf(error))
+    result.success = !std::isnan(result.error) && !std::isinf(result.error) && result.error <= threshold;
+    return result;
+}
+
+static bool isImageFile(const std::filesystem::path& path, const std::string& heatMapSuffix)
+{
+    static const std::set<std::string> extensions = {".png", ".jpg", ".tga", ".bmp", ".pfm", ".exr"};
+
+    auto name = path.filename().string();
+    if (!heatMapSuffix.empty() && name.size() >= heatMapSuffix.size() &&
+        name.compare(name.size() - heatMapSuffix.size(), heatMapSuffix.size(), heatMapSuffix) == 0)
         return false;
 
-    return error <= threshold;
+    auto ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return char(std::tolower(c)); });
+    return extensions.count(ext) > 0;
 }
 
+static std::set<std::string> collectImages(const std::filesystem::path& dir, const std::string& heatMapSuffix)
+{
+    std::set<std::string> images;
+    for (const auto& entry : std::filesystem::directory_iterator(dir))
+    {
+        if (entry.is_regular_file() && isImageFile(entry.path(), heatMapSuffix))
+            images.insert(entry.path().filename().string());
+    }
+    return images;
+}
+
+/**
+ * Compare all images in a result directory with the images of the same name in a reference directory.
+ * Pairs are compared concurrently and a JSON summary is written to stdout.
+ * @return True if all images have a counterpart and all comparisons succeeded.
+ */
+static bool compareDirectories(
+    const std::filesystem::path& refDir,
+    const std::filesystem::path& resultDir,
+    const ErrorMetric& metric,
+    float threshold,
+    bool alpha,
+    const std::string& heatMapSuffix,
+    uint32_t jobCount
+)
+{
+    for (const auto& dir : {refDir, resultDir})
+    {
+        if (!std::filesystem::is_directory(dir))
+        {
+            std::cerr << "Directory '" << dir.string() << "' does not exist." << std::endl;
+            return false;
+        }
+    }
+
+    auto refImages = collectImages(refDir, heatMapSuffix);
+    auto resultImages = collectImages(resultDir, heatMapSuffix);
+
+    std::vector<std::string> names;
+    std::set_union(refImages.begin(), refImages.end(), resultImages.begin(), resultImages.end(), std::back_inserter(names));
+
+    // Run up to jobCount comparisons concurrently. Each comparison distributes its rows over the thread pool as well.
+    jobCount = std::max(1u, std::min(jobCount, uint32_t(names.size())));
+
+    std::vector<CompareResult> results(names.size());
+    std::atomic<size_t> nextIndex = 0;
+    auto runJobs = [&]()
+    {
+        size_t i;
+        while ((i = nextIndex.fetch_add(1)) < names.size())
+        {
+            const auto& name = names[i];
+            if (!refImages.count(name))
+                results[i].message = "Missing reference image.";
+            else if (!resultImages.count(name))
+                results[i].message = "Missing result image.";
+            else
+                results[i] = compareImages(
+                    refDir / name, resultDir / name, metric, threshold, alpha, heatMapSuffix.empty() ? "" : resultDir / (name + heatMapSuffix)
+                );
+        }
+    };
+
+    // The calling thread runs jobs as well.
+    Falcor::Threading::TaskGroup jobs;
+    for (uint32_t i = 1; i < jobCount; ++i)
+        jobs.run(runJobs);
+    runJobs();
+    jobs.finish();
+
+    bool success = true;
+    nlohmann::json images = nlohmann::json::array();
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        const auto& result = results[i];
+        nlohmann::json image = {{"name", names[i]}, {"success", result.success}};
+        if (result.message.empty())
+            image["error"] = result.error;
+        else
+            image["message"] = result.message;
+        images.push_back(image);
+        success &= result.success;
+    }
+
+    nlohmann::json summary = {
+        {"metric", metric.name},
+        {"threshold", threshold},
+        {"success", success},
+        {"images", images},
+    };
+    std::cout << summary.dump(4) << std::endl;
+
+    return success;
+}
+
+/**
+ * Default number of images compared concurrently in batch mode.
+ * Each comparison keeps both images and the heat map in memory, so this bounds the memory use independent of the core count.
+ * The rows of each comparison are still distributed over all threads.
+ */
+static const uint32_t kDefaultJobCount = 4;
+
 static void printMetrics(std::ostream& stream = std::cout)
 {
     stream << "Available error metrics:" << std::endl;
@@ -377,16 +722,27 @@ static void printMetrics(std::ostream& stream = std::cout)
 
 int main(int argc, char** argv)
 {
-    args::ArgumentParser parser("Utility to compare images.");
+    args::ArgumentParser parser(
+        "Utility to compare images.",
+        "Images are loaded into memory in full. A tiled or streaming comparison of images larger than memory is not implemented."
+    );
     parser.helpParams.programName = "ImageCompare";
     args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
     args::Flag listMetricsFlag(parser, "", "List available error metrics.", {'l'});
     args::ValueFlag<std::string> metricFlag(parser, "metric", "The error metric.", {'m'});
     args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold.", {'t'});
     args::Flag alphaFlag(parser, "", "Include alpha channel.", {'a'});
-    args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map.", {'e'});
-    args::Positional<std::string> image1(parser, "image1", "The first image.", args::Options::Required);
-    args::Positional<std::string> image2(parser, "image2", "The second image.", args::Options::Required);
+    args::ValueFlag<std::string> heatMapFlag(
+        parser, "filename", "Generate error heat map. In batch mode, this is a suffix appended to the result image filenames.", {'e'}
+    );
+    args::Flag batchFlag(
+        parser, "", "Batch mode. Compare all images in two directories and write a JSON summary to stdout.", {'b', "batch"}
+    );
+    args::ValueFlag<uint32_t> jobsFlag(
+        parser, "jobs", "Number of images compared concurrently in batch mode (default: " + std::to_string(kDefaultJobCount) + ").", {'j', "jobs"}
+    );
+    args::Positional<std::string> image1(parser, "image1", "The first image (reference directory in batch mode).", args::Options::Required);
+    args::Positional<std::string> image2(parser, "image2", "The second image (result directory in batch mode).", args::Options::Required);
     args::CompletionFlag completionFlag(parser, {"complete"});
 
     try
@@ -437,9 +793,32 @@ int main(int argc, char** argv)
         metric = *it;
     }
 
-    bool success = compareImages(
-        args::get(image1), args::get(image2), metric, thresholdFlag ? args::get(thresholdFlag) : 0.f,
-        alphaFlag ? args::get(alphaFlag) : false, heatMapFlag ? args::get(heatMapFlag) : ""
-    );
-    return success ? 0 : 1;
+    float threshold = thresholdFlag ? args::get(thresholdFlag) : 0.f;
+    bool alpha = alphaFlag ? args::get(alphaFlag) : false;
+    std::string heatMap = heatMapFlag ? args::get(heatMapFlag) : "";
+    uint32_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    // Comparisons distribute their work over the Falcor thread pool.
+    struct ThreadPool
+    {
+        ThreadPool(uint32_t threadCount) { Falcor::Threading::start(threadCount); }
+        ~ThreadPool() { Falcor::Threading::shutdown(); }
+    } threadPool(threadCount);
+
+    if (batchFlag)
+    {
+        uint32_t jobCount = jobsFlag ? args::get(jobsFlag) : kDefaultJobCount;
+        bool success = compareDirectories(args::get(image1), args::get(image2), metric, threshold, alpha, heatMap, jobCount);
+        return success ? 0 : 1;
+    }
+
+    auto result = compareImages(args::get(image1), args::get(image2), metric, threshold, alpha, heatMap);
+    if (!result.message.empty())
+    {
+        std::cerr << result.message << std::endl;
+        return 1;
+    }
+
+    std::cout << result.error << std::endl;
+    return result.success ? 0 : 1;
 }
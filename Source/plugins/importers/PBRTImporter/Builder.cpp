@@ -126,6 +126,11 @@ void BasicScene::addInstances(std::vector<InstanceSceneEntity>& instances)
     std::move(instances.begin(), instances.end(), std::back_inserter(mInstances));
 }
 
+void BasicScene::addFile(std::filesystem::path path)
+{
+    mFiles.push_back(std::move(path));
+}
+
 const MaterialSceneEntity& BasicScene::getMaterial(const MaterialRef& materialRef) const
 {
     if (const uint32_t* pIndex = std::get_if<uint32_t>(&materialRef))
@@ -268,7 +273,7 @@ void BasicSceneBuilder::onAttributeBegin(FileLoc loc)
 {
     VERIFY_WORLD("AttributeBegin");
 
-    mStack.push_back({StackEntry::Type::Attribute, loc, mGraphicsState});
+    mStack.push_back({StackEntry::Type::Attribute, loc, mGraphicsState, {}});
 }
 
 void BasicSceneBuilder::onAttributeEnd(FileLoc loc)
@@ -276,7 +281,7 @@ void BasicSceneBuilder::onAttributeEnd(FileLoc loc)
     VERIFY_WORLD("AttributeEnd");
 
     // Issue warning on unmatched AttributeEnd.
-    if (mStack.empty())
+    if (mStack.empty() || mStack.back().type == StackEntry::Type::Import)
     {
         logWarning(loc, "Unmatched AttributeEnd encountered. Ignoring it.");
         return;
@@ -400,7 +405,7 @@ void BasicSceneBuilder::onObjectBegin(const std::string& name, FileLoc loc)
 {
     VERIFY_WORLD("ObjectBegin");
 
-    mStack.push_back({StackEntry::Type::Object, loc, mGraphicsState});
+    mStack.push_back({StackEntry::Type::Object, loc, mGraphicsState, {}});
 
     if (mpActiveInstanceDefinition)
     {
@@ -429,6 +434,10 @@ void BasicSceneBuilder::onObjectEnd(FileLoc loc)
     {
         throwError(loc, "Mismatched nesting: open AttributeBegin from {} at ObjectEnd.", mStack.back().loc.toString());
     }
+    else if (mStack.back().type == StackEntry::Type::Import)
+    {
+        throwError(loc, "Mismatched nesting: ObjectEnd in file imported at {}.", mStack.back().loc.toString());
+    }
     else
     {
         FALCOR_ASSERT(mStack.back().type == StackEntry::Type::Object);
@@ -455,6 +464,37 @@ void BasicSceneBuilder::onObjectInstance(const std::string& name, FileLoc loc)
     mInstances.push_back(std::move(instance));
 }
 
+void BasicSceneBuilder::onImportBegin(FileLoc loc)
+{
+    VERIFY_WORLD("Import");
+
+    // Imported files start out with the current graphics state, but changes to it are discarded at the end of the file.
+    mStack.push_back({StackEntry::Type::Import, loc, mGraphicsState, mNamedCoordinateSystems});
+}
+
+void BasicSceneBuilder::onImportEnd(FileLoc loc)
+{
+    FALCOR_ASSERT(!mStack.empty());
+
+    if (mStack.back().type == StackEntry::Type::Attribute)
+    {
+        throwError(mStack.back().loc, "Missing end to AttributeBegin in imported file.");
+    }
+    else if (mStack.back().type == StackEntry::Type::Object)
+    {
+        throwError(mStack.back().loc, "Missing end to ObjectBegin in imported file.");
+    }
+
+    mGraphicsState = std::move(mStack.back().graphicsState);
+    mNamedCoordinateSystems = std::move(mStack.back().namedCoordinateSystems);
+    mStack.pop_back();
+}
+
+void BasicSceneBuilder::onFile(const std::filesystem::path& path)
+{
+    mScene.addFile(path);
+}
+
 void BasicSceneBuilder::onEndOfFiles()
 {
     if (mCurrentBlock != BlockState::WorldBlock)
@@ -256,6 +256,7 @@ public:
     void addShapes(std::vector<ShapeSceneEntity>& shapes);
     void addInstanceDefinition(InstanceDefinitionSceneEntity instanceDefinition);
     void addInstances(std::vector<InstanceSceneEntity>& instances);
+    void addFile(std::filesystem::path path);
 
     const CameraSceneEntity& getCamera() const { return mCamera; }
 
@@ -269,6 +270,11 @@ public:
     const std::map<std::string, InstanceDefinitionSceneEntity>& getInstanceDefinitions() const { return mInstanceDefinitions; }
     const std::vector<InstanceSceneEntity>& getInstances() const { return mInstances; }
 
+    /**
+     * Get the scene files that were parsed, including included and imported files.
+     */
+    const std::vector<std::filesystem::path>& getFiles() const { return mFiles; }
+
     /**
      * Get a named or unnamed material.
      */
@@ -301,6 +307,8 @@ private:
 
     std::map<std::string, InstanceDefinitionSceneEntity> mInstanceDefinitions;
     std::vector<InstanceSceneEntity> mInstances;
+
+    std::vector<std::filesystem::path> mFiles;
 };
 
 constexpr uint32_t kMaxTransforms = 2;
@@ -395,6 +403,9 @@ public:
     void onObjectBegin(const std::string& name, FileLoc loc) override;
     void onObjectEnd(FileLoc loc) override;
     void onObjectInstance(const std::string& name, FileLoc loc) override;
+    void onImportBegin(FileLoc loc) override;
+    void onImportEnd(FileLoc loc) override;
+    void onFile(const std::filesystem::path& path) override;
 
     void onEndOfFiles() override;
 
@@ -454,11 +465,13 @@ private:
         enum class Type
         {
             Attribute,
-            Object
+            Object,
+            Import
         };
         Type type;
         FileLoc loc;
         GraphicsState graphicsState;
+        std::map<std::string, TransformSet> namedCoordinateSystems; ///< Only saved for imported files.
     };
     std::vector<StackEntry> mStack;
 
@@ -69,6 +69,8 @@
 #include "Core/API/Device.h"
 #include "Utils/Settings.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuEventRecorder.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/FNVHash.h"
@@ -105,6 +107,9 @@ const rmcv::mat4 kInvertZ = {
     0.f, 0.f, 0.f,  1.f, //
 };
 
+/// Number of shapes whose triangle meshes are created in parallel before they are added to the scene builder.
+const size_t kTriangleMeshBatchSize = 64;
+
 /**
  * Holds the results from creating a camera.
  */
@@ -221,6 +226,8 @@ struct BuilderContext
 
     std::map<std::string, InstanceDefinition> instanceDefinitions;
 
+    std::unordered_map<const ShapeSceneEntity*, Falcor::TriangleMesh::SharedPtr> triangleMeshes; ///< Triangle meshes of the current batch of shapes.
+
     size_t curveCount = 0;
 
     bool usePBRTMaterials = false;
@@ -254,7 +261,13 @@ struct BuilderContext
         return pMaterial;
     }
 
-    Resolver resolver = [this](const std::filesystem::path& path) { return scene.resolvePath(path); };
+    /// Resolves paths of files referenced by the scene and records them as scene dependencies. Thread-safe.
+    Resolver resolver = [this](const std::filesystem::path& path)
+    {
+        auto resolvedPath = scene.resolvePath(path);
+        if (!path.empty()) builder.addDependency(resolvedPath);
+        return resolvedPath;
+    };
 };
 
 inline void warnUnsupportedType(const FileLoc& loc, const std::string_view category, const std::string_view name)
@@ -1393,105 +1406,25 @@ void createAreaLight(BuilderContext& ctx, const SceneEntity& entity, const Falco
     }
 }
 
-Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
+/**
+ * Returns true if the shape type is converted to a triangle mesh that only depends on the shape's parameters.
+ */
+bool isTriangleMeshShape(const std::string& type)
 {
-    auto warnUnsupported = [&]() { warnUnsupportedType(entity.loc, "Shape", entity.name); };
+    return type == "trianglemesh" || type == "plymesh" || type == "loopsubdiv";
+}
 
+/**
+ * Create the triangle mesh of a 'trianglemesh', 'plymesh' or 'loopsubdiv' shape.
+ * This does not access the builder context and is safe to call concurrently for different shapes.
+ * @return The triangle mesh or nullptr if the shape is invalid.
+ */
+Falcor::TriangleMesh::SharedPtr createTriangleMesh(const ShapeSceneEntity& entity, const Resolver& resolver)
+{
     const auto& type = entity.name;
     const auto& params = entity.params;
 
-    warnUnsupportedParameters(params, {"alpha"});
-
-    Shape shape;
-
-    if (type == "sphere")
-    {
-        // Parameters:
-        // Float radius, Float zmin, Float zmax, Float phimax
-        warnUnsupportedParameters(params, {"zmin", "zmax", "phimax"});
-
-        auto radius = params.getFloat("radius", 1.f);
-
-        shape.pTriangleMesh = Falcor::TriangleMesh::createSphere(radius);
-        shape.pTriangleMesh->setName("sphere");
-        shape.transform = entity.transform;
-    }
-    else if (type == "cylinder")
-    {
-        // Parameters:
-        // Float radius, Float zmin, Float zmax, Float phimax
-        warnUnsupported();
-    }
-    else if (type == "disk")
-    {
-        // Parameters:
-        // Float radius, Float height, Float innerradius, Float phimax
-        warnUnsupportedParameters(params, {"innerradius", "phimax"});
-
-        auto radius = params.getFloat("radius", 1.f);
-        auto height = params.getFloat("height", 0.f);
-
-        shape.pTriangleMesh = Falcor::TriangleMesh::createDisk(radius);
-        shape.pTriangleMesh->setName("disk");
-        rmcv::mat4 transform = rmcv::translate(float3(0.f, 0.f, height)) * kYtoZ;
-        shape.pTriangleMesh->applyTransform(transform);
-    }
-    else if (type == "bilinearmesh")
-    {
-        // Parameters:
-        // Int[] indices, Point3[] P, Point2[] uv, Normal3[] N, Int[] faceIndices, String emissionfilename
-        warnUnsupported();
-    }
-    else if (type == "curve")
-    {
-        // Parameters:
-        // Float width, Float width0, Float width1, Int degree, String basis,
-        // Point3[] P, String type, Normal3[] N, Int splitdepth
-        warnUnsupportedParameters(params, {"degree", "N"});
-
-        auto splitdepth = params.getInt("splitdepth", 1);
-
-        auto width = params.getFloat("width", 1.f);
-        auto width0 = params.getFloat("width0", width);
-        auto width1 = params.getFloat("width1", width);
-
-        auto basis = params.getString("basis", "bezier");
-        if (basis != "bspline")
-            logWarning(entity.loc, "Basis '{}' is not supported. Using 'bspline' basis instead.", basis);
-
-        auto type = params.getString("type", "flat");
-        if (type != "cylinder")
-            logWarning(entity.loc, "Curve type '{}' is not supported. Using 'cylinder' type instead.", type);
-
-        auto P = params.getPoint3Array("P");
-
-        // Create or get existing curve aggregate.
-        auto pMaterial = ctx.getMaterial(entity.materialRef);
-        CurveAggregate::Key key{entity.transform, pMaterial.get()};
-        auto it = ctx.curveAggregates.find(key);
-        if (it == ctx.curveAggregates.end())
-        {
-            it = ctx.curveAggregates.emplace(key, CurveAggregate{}).first;
-            it->second.transform = entity.transform;
-            it->second.pMaterial = pMaterial;
-            it->second.splitDepth = splitdepth;
-        }
-        CurveAggregate& aggregate = it->second;
-
-        // Append curve to aggregate.
-        size_t pointCount = P.size();
-        size_t offset = aggregate.points.size();
-        aggregate.strands.push_back(pointCount);
-        aggregate.points.resize(aggregate.points.size() + pointCount);
-        aggregate.widths.resize(aggregate.widths.size() + pointCount);
-        for (size_t i = 0; i < pointCount; ++i)
-        {
-            float t = float(i) / pointCount;
-            aggregate.points[offset + i] = P[i];
-            aggregate.widths[offset + i] = lerp(width0, width1, t);
-        }
-    }
-    else if (type == "trianglemesh")
+    if (type == "trianglemesh")
     {
         // Parameters:
         // Int[] indices, Point3[] P, Point2[] uv, Vector3[] S, Normal3[] N, Int[] faceIndices
@@ -1511,7 +1444,7 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
             else
             {
                 logWarning(entity.loc, "Vertex indices 'indices' missing. Skipping.");
-                return {};
+                return nullptr;
             }
         }
         if (indices.size() % 3 != 0)
@@ -1525,7 +1458,7 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         if (P.empty())
         {
             logWarning(entity.loc, "Vertex positions 'positions' missing. Skipping.");
-            return {};
+            return nullptr;
         }
         if (!uv.empty() && uv.size() != P.size())
         {
@@ -1542,7 +1475,7 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
             if (i < 0 || i >= P.size())
             {
                 logWarning(entity.loc, "Vertex index {} is out of bounds. Skipping.", i);
-                return {};
+                return nullptr;
             }
         }
 
@@ -1559,8 +1492,7 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         for (size_t i = 0; i < indices.size(); ++i)
             indexList[i] = indices[i];
 
-        shape.pTriangleMesh = Falcor::TriangleMesh::create(std::move(vertexList), std::move(indexList));
-        shape.transform = entity.transform;
+        return Falcor::TriangleMesh::create(std::move(vertexList), std::move(indexList));
     }
     else if (type == "plymesh")
     {
@@ -1569,12 +1501,12 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         warnUnsupportedParameters(params, {"displacement", "displacement.edgelength"});
 
         auto filename = params.getString("filename", "");
-        auto path = ctx.resolver(filename);
+        auto path = resolver(filename);
 
-        shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
-        if (shape.pTriangleMesh)
-            shape.pTriangleMesh->setName(filename);
-        shape.transform = entity.transform;
+        auto pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
+        if (pTriangleMesh)
+            pTriangleMesh->setName(filename);
+        return pTriangleMesh;
     }
     else if (type == "loopsubdiv")
     {
@@ -1604,8 +1536,177 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
             vertex.texCoord = float3(0.f);
         }
 
-        shape.pTriangleMesh = Falcor::TriangleMesh::create(vertexList, result.indices);
-        shape.pTriangleMesh->setName("loopsubdiv");
+        auto pTriangleMesh = Falcor::TriangleMesh::create(vertexList, result.indices);
+        pTriangleMesh->setName("loopsubdiv");
+        return pTriangleMesh;
+    }
+
+    FALCOR_UNREACHABLE();
+    return nullptr;
+}
+
+/**
+ * Create the triangle meshes of a range of shapes in parallel.
+ * The results are stored in the builder context and picked up by createShape().
+ */
+void createTriangleMeshes(BuilderContext& ctx, fstd::span<const ShapeSceneEntity> entities)
+{
+    std::vector<const ShapeSceneEntity*> meshEntities;
+    for (const auto& entity : entities)
+    {
+        if (isTriangleMeshShape(entity.name))
+            meshEntities.push_back(&entity);
+    }
+
+    std::vector<Falcor::TriangleMesh::SharedPtr> triangleMeshes(meshEntities.size());
+    Threading::parallelFor(
+        0, meshEntities.size(),
+        [&](size_t i)
+        {
+            FALCOR_PROFILE_CPU("createTriangleMesh");
+            triangleMeshes[i] = createTriangleMesh(*meshEntities[i], ctx.resolver);
+        },
+        1
+    );
+
+    for (size_t i = 0; i < meshEntities.size(); ++i)
+        ctx.triangleMeshes.emplace(meshEntities[i], std::move(triangleMeshes[i]));
+}
+
+/**
+ * Process a list of shapes in batches.
+ * The triangle meshes of each batch are created in parallel before the shapes of the batch are processed. As the scene
+ * builder keeps its own copy of the geometry, this bounds the extra memory to the triangle meshes of a single batch.
+ */
+template<typename ProcessShape>
+void processShapesInBatches(BuilderContext& ctx, const std::vector<ShapeSceneEntity>& entities, ProcessShape processShape)
+{
+    for (size_t first = 0; first < entities.size(); first += kTriangleMeshBatchSize)
+    {
+        auto batch = fstd::span<const ShapeSceneEntity>(entities).subspan(first, std::min(kTriangleMeshBatchSize, entities.size() - first));
+        createTriangleMeshes(ctx, batch);
+        for (const auto& entity : batch)
+            processShape(entity);
+        ctx.triangleMeshes.clear();
+    }
+}
+
+Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
+{
+    auto warnUnsupported = [&]() { warnUnsupportedType(entity.loc, "Shape", entity.name); };
+
+    const auto& type = entity.name;
+    const auto& params = entity.params;
+
+    warnUnsupportedParameters(params, {"alpha"});
+
+    Shape shape;
+
+    if (type == "sphere")
+    {
+        // Parameters:
+        // Float radius, Float zmin, Float zmax, Float phimax
+        warnUnsupportedParameters(params, {"zmin", "zmax", "phimax"});
+
+        auto radius = params.getFloat("radius", 1.f);
+
+        shape.pTriangleMesh = Falcor::TriangleMesh::createSphere(radius);
+        shape.pTriangleMesh->setName("sphere");
+        shape.transform = entity.transform;
+    }
+    else if (type == "cylinder")
+    {
+        // Parameters:
+        // Float radius, Float zmin, Float zmax, Float phimax
+        warnUnsupported();
+    }
+    else if (type == "disk")
+    {
+        // Parameters:
+        // Float radius, Float height, Float innerradius, Float phimax
+        warnUnsupportedParameters(params, {"innerradius", "phimax"});
+
+        auto radius = params.getFloat("radius", 1.f);
+        auto height = params.getFloat("height", 0.f);
+
+        shape.pTriangleMesh = Falcor::TriangleMesh::createDisk(radius);
+        shape.pTriangleMesh->setName("disk");
+        rmcv::mat4 transform = rmcv::translate(float3(0.f, 0.f, height)) * kYtoZ;
+        shape.pTriangleMesh->applyTransform(transform);
+    }
+    else if (type == "bilinearmesh")
+    {
+        // Parameters:
+        // Int[] indices, Point3[] P, Point2[] uv, Normal3[] N, Int[] faceIndices, String emissionfilename
+        warnUnsupported();
+    }
+    else if (type == "curve")
+    {
+        // Parameters:
+        // Float width, Float width0, Float width1, Int degree, String basis,
+        // Point3[] P, String type, Normal3[] N, Int splitdepth
+        warnUnsupportedParameters(params, {"degree", "N"});
+
+        auto splitdepth = params.getInt("splitdepth", 1);
+
+        auto width = params.getFloat("width", 1.f);
+        auto width0 = params.getFloat("width0", width);
+        auto width1 = params.getFloat("width1", width);
+
+        auto basis = params.getString("basis", "bezier");
+        if (basis != "bspline")
+            logWarning(entity.loc, "Basis '{}' is not supported. Using 'bspline' basis instead.", basis);
+
+        auto type = params.getString("type", "flat");
+        if (type != "cylinder")
+            logWarning(entity.loc, "Curve type '{}' is not supported. Using 'cylinder' type instead.", type);
+
+        auto P = params.getPoint3Array("P");
+
+        // Create or get existing curve aggregate.
+        auto pMaterial = ctx.getMaterial(entity.materialRef);
+        CurveAggregate::Key key{entity.transform, pMaterial.get()};
+        auto it = ctx.curveAggregates.find(key);
+        if (it == ctx.curveAggregates.end())
+        {
+            it = ctx.curveAggregates.emplace(key, CurveAggregate{}).first;
+            it->second.transform = entity.transform;
+            it->second.pMaterial = pMaterial;
+            it->second.splitDepth = splitdepth;
+        }
+        CurveAggregate& aggregate = it->second;
+
+        // Append curve to aggregate.
+        size_t pointCount = P.size();
+        size_t offset = aggregate.points.size();
+        aggregate.strands.push_back(pointCount);
+        aggregate.points.resize(aggregate.points.size() + pointCount);
+        aggregate.widths.resize(aggregate.widths.size() + pointCount);
+        for (size_t i = 0; i < pointCount; ++i)
+        {
+            float t = float(i) / pointCount;
+            aggregate.points[offset + i] = P[i];
+            aggregate.widths[offset + i] = lerp(width0, width1, t);
+        }
+    }
+    else if (isTriangleMeshShape(type))
+    {
+        // Use the triangle mesh created in parallel if available.
+        auto it = ctx.triangleMeshes.find(&entity);
+        if (it != ctx.triangleMeshes.end())
+        {
+            shape.pTriangleMesh = std::move(it->second);
+            ctx.triangleMeshes.erase(it);
+        }
+        else
+        {
+            shape.pTriangleMesh = createTriangleMesh(entity, ctx.resolver);
+        }
+
+        // Skip invalid triangle meshes.
+        if (!shape.pTriangleMesh && type == "trianglemesh")
+            return {};
+
         shape.transform = entity.transform;
     }
     else
@@ -1719,7 +1820,7 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
 {
     InstanceDefinition instanceDefinition;
 
-    for (const auto& shapeEntity : entity.shapes)
+    processShapesInBatches(ctx, entity.shapes, [&](const ShapeSceneEntity& shapeEntity)
     {
         // Process shapes and create meshes.
         auto shape = createShape(ctx, shapeEntity);
@@ -1747,7 +1848,7 @@ InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceD
             }
         }
         ctx.curveAggregates.clear();
-    }
+    });
 
     return instanceDefinition;
 }
@@ -1804,7 +1905,7 @@ void buildScene(BuilderContext& ctx)
     }
 
     // Process shapes and create meshes.
-    for (const auto& entity : ctx.scene.getShapes())
+    processShapesInBatches(ctx, ctx.scene.getShapes(), [&](const ShapeSceneEntity& entity)
     {
         auto shape = createShape(ctx, entity);
         if (shape.pTriangleMesh)
@@ -1813,7 +1914,7 @@ void buildScene(BuilderContext& ctx)
             auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
             ctx.builder.addMeshInstance(nodeID, meshID);
         }
-    }
+    });
 
     // Create curves from curve aggregates assembled during the processing step above.
     for (const auto& [_, curveAggregate] : ctx.curveAggregates)
@@ -1883,6 +1984,7 @@ void PBRTImporter::importScene(const std::filesystem::path& path, SceneBuilder&
         pbrt::BasicScene pbrtScene(path.parent_path());
         pbrt::BasicSceneBuilder pbrtBuilder(pbrtScene);
         pbrt::parseFile(pbrtBuilder, path);
+        for (const auto& file : pbrtScene.getFiles()) builder.addDependency(file);
         timeReport.measure("Parsing pbrt scene");
 
         pbrt::BuilderContext ctx{pbrtScene, builder};
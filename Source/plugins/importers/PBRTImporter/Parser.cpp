@@ -36,11 +36,15 @@
 #include "Core/Assert.h"
 #include "Core/Platform/OS.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 
 #include <fast_float/fast_float.h>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <charconv>
+#include <cstring>
 
 namespace Falcor::pbrt
 {
@@ -94,6 +98,11 @@ std::unique_ptr<Tokenizer> Tokenizer::createFromFile(const std::filesystem::path
     }
     else
     {
+        auto pMappedFile = std::make_unique<MemoryMappedFile>(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (pMappedFile->isOpen())
+            return std::make_unique<Tokenizer>(std::move(pMappedFile), path);
+
+        // Fall back to reading the file (e.g. empty files cannot be mapped).
         std::string str = readFile(path);
         return std::make_unique<Tokenizer>(std::move(str), path);
     }
@@ -106,13 +115,28 @@ std::unique_ptr<Tokenizer> Tokenizer::createFromString(std::string str)
 
 Tokenizer::Tokenizer(std::string str, const std::filesystem::path& path) : mPath(path), mContents(std::move(str))
 {
-    auto pFilename = std::make_unique<std::string>(path.string());
+    init(mContents.data(), mContents.size());
+}
+
+Tokenizer::Tokenizer(std::unique_ptr<MemoryMappedFile> pMappedFile, const std::filesystem::path& path)
+    : mPath(path), mpMappedFile(std::move(pMappedFile))
+{
+    FALCOR_ASSERT(mpMappedFile && mpMappedFile->isOpen());
+    init(static_cast<const char*>(mpMappedFile->getData()), mpMappedFile->getMappedSize());
+}
+
+void Tokenizer::init(const char* data, size_t size)
+{
+    auto pFilename = std::make_unique<std::string>(mPath.string());
     mLoc = FileLoc(*pFilename);
-    getFilenames().push_back(std::move(pFilename));
+    {
+        std::lock_guard<std::mutex> lock(getFilenamesMutex());
+        getFilenames().push_back(std::move(pFilename));
+    }
 
-    mPos = mContents.data();
-    mEnd = mPos + mContents.size();
-    if (isUTF16(mContents.data(), mContents.size()))
+    mPos = data;
+    mEnd = mPos + size;
+    if (isUTF16(data, size))
         throwError("File is encoded with UTF-16, which is not currently supported.");
 }
 
@@ -221,45 +245,193 @@ std::optional<Token> Tokenizer::next()
     }
 }
 
-static int32_t parseInt(const Token& t)
+enum class ParseResult
+{
+    Success,
+    NotANumber,
+    OutOfRange,
+};
+
+static ParseResult tryParseNumber(const std::string_view token, int32_t& value)
 {
-    auto begin = t.token.data();
-    auto end = t.token.data() + t.token.size();
+    auto begin = token.data();
+    auto end = token.data() + token.size();
     // Skip '+' character, std::from_chars doesn't handle '+'.
     if (*begin == '+')
         begin++;
-    int64_t value;
-    auto result = std::from_chars(begin, end, value);
-    if (result.ptr != end)
-        throwError(t.loc, "'{}': Expected a number.", t.token);
-    if (value < std::numeric_limits<int32_t>::lowest() || value > std::numeric_limits<int32_t>::max())
-        throwError(t.loc, "'{}': Numeric value cannot be represented as a 32-bit integer.", t.token);
-    return (int32_t)value;
+    int64_t value64;
+    auto result = std::from_chars(begin, end, value64);
+    if (result.ec == std::errc::invalid_argument || result.ptr != end)
+        return ParseResult::NotANumber;
+    if (result.ec == std::errc::result_out_of_range || value64 < std::numeric_limits<int32_t>::lowest() ||
+        value64 > std::numeric_limits<int32_t>::max())
+        return ParseResult::OutOfRange;
+    value = (int32_t)value64;
+    return ParseResult::Success;
 }
 
-static Float parseFloat(const Token& t)
+static ParseResult tryParseNumber(const std::string_view token, Float& value)
 {
     // Fast path for a single digit.
-    if (t.token.size() == 1)
+    if (token.size() == 1)
     {
-        if (!(t.token[0] >= '0' && t.token[0] <= '9'))
-            throwError(t.loc, "'{}': Expected a number.", t.token);
-        return (Float)(t.token[0] - '0');
+        if (!(token[0] >= '0' && token[0] <= '9'))
+            return ParseResult::NotANumber;
+        value = (Float)(token[0] - '0');
+        return ParseResult::Success;
     }
 
-    auto begin = t.token.data();
-    auto end = t.token.data() + t.token.size();
+    auto begin = token.data();
+    auto end = token.data() + token.size();
     // Skip '+' character, std::from_chars (and fast_float::from_chars) doesn't handle '+'.
     if (*begin == '+')
         begin++;
-    Float value;
     // Note: We currently use fast_float::from_chars because std::from_chars for float/double is not well supported yet.
     auto result = fast_float::from_chars(begin, end, value);
-    if (result.ptr != end)
+    if (result.ec != std::errc() || result.ptr != end)
+        return ParseResult::NotANumber;
+    return ParseResult::Success;
+}
+
+static int32_t parseInt(const Token& t)
+{
+    int32_t value = 0;
+    switch (tryParseNumber(t.token, value))
+    {
+    case ParseResult::NotANumber:
+        throwError(t.loc, "'{}': Expected a number.", t.token);
+    case ParseResult::OutOfRange:
+        throwError(t.loc, "'{}': Numeric value cannot be represented as a 32-bit integer.", t.token);
+    default:
+        return value;
+    }
+}
+
+static Float parseFloat(const Token& t)
+{
+    Float value = 0;
+    if (tryParseNumber(t.token, value) != ParseResult::Success)
         throwError(t.loc, "'{}': Expected a number.", t.token);
     return value;
 }
 
+inline bool isSpace(char ch)
+{
+    return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r';
+}
+
+/**
+ * Parse whitespace separated numbers.
+ * @return True if all tokens are valid numbers.
+ */
+template<typename T>
+static bool parseNumbers(const std::string_view str, std::vector<T>& values)
+{
+    const char* p = str.data();
+    const char* end = p + str.size();
+    while (true)
+    {
+        while (p != end && isSpace(*p))
+            ++p;
+        if (p == end)
+            return true;
+        const char* tokenStart = p;
+        while (p != end && !isSpace(*p))
+            ++p;
+        T value;
+        if (tryParseNumber(std::string_view(tokenStart, p - tokenStart), value) != ParseResult::Success)
+            return false;
+        values.push_back(value);
+    }
+}
+
+/// Arrays larger than this (in bytes) are parsed in parallel.
+constexpr size_t kParallelArrayMinSize = 1 << 20;
+/// Approximate size of the chunks that large arrays are split into.
+constexpr size_t kParallelArrayChunkSize = 1 << 18;
+
+bool Tokenizer::readNumericArray(std::vector<Float>& values)
+{
+    return readNumericArrayImpl(values);
+}
+
+bool Tokenizer::readNumericArray(std::vector<int>& values)
+{
+    return readNumericArrayImpl(values);
+}
+
+template<typename T>
+bool Tokenizer::readNumericArrayImpl(std::vector<T>& values)
+{
+    // Find the closing bracket. If it belongs to a string or comment instead,
+    // parsing fails on the quote or comment character and we fall back to the regular path.
+    const char* arrayEnd = static_cast<const char*>(std::memchr(mPos, ']', mEnd - mPos));
+    if (!arrayEnd)
+        return false;
+    const std::string_view str(mPos, arrayEnd - mPos);
+
+    if (str.size() < kParallelArrayMinSize)
+    {
+        size_t prevSize = values.size();
+        if (!parseNumbers(str, values))
+        {
+            values.resize(prevSize);
+            return false;
+        }
+    }
+    else
+    {
+        // Split into chunks at whitespace, so that no number is split between chunks.
+        std::vector<std::string_view> chunks;
+        size_t chunkStart = 0;
+        while (chunkStart < str.size())
+        {
+            size_t chunkEnd = std::min(chunkStart + kParallelArrayChunkSize, str.size());
+            while (chunkEnd < str.size() && !isSpace(str[chunkEnd]))
+                ++chunkEnd;
+            chunks.push_back(str.substr(chunkStart, chunkEnd - chunkStart));
+            chunkStart = chunkEnd;
+        }
+
+        std::vector<std::vector<T>> chunkValues(chunks.size());
+        std::atomic<bool> success{true};
+        Threading::parallelFor(
+            0, chunks.size(),
+            [&](size_t i)
+            {
+                if (!parseNumbers(chunks[i], chunkValues[i]))
+                    success = false;
+            },
+            1
+        );
+        if (!success)
+            return false;
+
+        size_t count = 0;
+        for (const auto& v : chunkValues)
+            count += v.size();
+        values.reserve(values.size() + count);
+        for (const auto& v : chunkValues)
+            values.insert(values.end(), v.begin(), v.end());
+    }
+
+    // Advance past the closing bracket, keeping track of the file location.
+    size_t lineCount = std::count(str.begin(), str.end(), '\n');
+    if (lineCount > 0)
+    {
+        mLoc.line += (uint32_t)lineCount;
+        mLoc.column = (uint32_t)(str.size() - str.rfind('\n') - 1);
+    }
+    else
+    {
+        mLoc.column += (uint32_t)str.size();
+    }
+    ++mLoc.column;
+    mPos = arrayEnd + 1;
+
+    return true;
+}
+
 inline bool isQuotedString(const std::string_view str)
 {
     return str.size() >= 2 && str[0] == '"' && str.back() == '"';
@@ -278,8 +450,8 @@ static std::string_view dequoteString(const Token& t)
 constexpr uint32_t TokenOptional = 0;
 constexpr uint32_t TokenRequired = 1;
 
-template<typename Next, typename Unget>
-static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
+template<typename Next, typename Unget, typename ReadArray>
+static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken, ReadArray readNumericArray)
 {
     ParsedParameterVector parameterVector;
 
@@ -428,7 +600,9 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
 
         if (val.token == "[")
         {
-            while (true)
+            // Read numeric arrays in bulk, directly into the typed value buffer.
+            bool readInBulk = (valType == Int) ? readNumericArray(param.ints) : readNumericArray(param.floats);
+            while (!readInBulk)
             {
                 val = *nextToken(TokenRequired);
                 if (val.token == "]")
@@ -441,60 +615,166 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
             addVal(val);
         }
 
-        parameterVector.push_back(param);
+        parameterVector.push_back(std::move(param));
     }
 
     return parameterVector;
 }
 
-void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
+/**
+ * Parser target recording the directives of a single file.
+ * Files are parsed into recordings in bounded batches, concurrently with replaying the recorded directives
+ * to the actual target in order. Included files are parsed ahead of time on the thread pool.
+ */
+class RecordedFile : public ParserTarget
 {
-    static std::atomic<bool> warnedTransformBeginEndDeprecated{false};
+public:
+    using Command = std::function<void(ParserTarget&)>;
 
-    logInfo("PBRTImporter: Started parsing '{}'.", tokenizer->getPath().string());
+    /// Maximum number of directives parsed into a recording before they are replayed.
+    static constexpr size_t kMaxBatchSize = 4096;
 
-    auto searchPath = tokenizer->getPath().parent_path();
+    RecordedFile(std::filesystem::path path, std::filesystem::path searchPath) : mPath(std::move(path)), mSearchPath(std::move(searchPath)) {}
+    RecordedFile(std::unique_ptr<Tokenizer> pTokenizer, std::filesystem::path searchPath)
+        : mPath(pTokenizer->getPath()), mSearchPath(std::move(searchPath)), mpTokenizer(std::move(pTokenizer))
+    {}
 
-    std::vector<std::unique_ptr<Tokenizer>> fileStack;
-    fileStack.push_back(std::move(tokenizer));
+    void record(Command command) { mCommands.push_back(std::move(command)); }
 
-    std::optional<Token> ungetToken;
+    size_t getRecordedCount() const { return mCommands.size(); }
+
+    /**
+     * Start parsing an included file on the thread pool and record a command that passes on its directives.
+     */
+    void recordInclude(const std::filesystem::path& path, const std::filesystem::path& searchPath);
+
+    /**
+     * Start parsing an imported file on the thread pool and record a command that passes on its directives,
+     * enclosed in onImportBegin()/onImportEnd() calls.
+     */
+    void recordImport(const std::filesystem::path& path, const std::filesystem::path& searchPath, FileLoc loc);
 
     /**
-     * Helper function that handles the file stack, returning the next token from
-     * the file until reaching EOF, at which point it switches to the next file (if any).
+     * Parse the next batch of at most kMaxBatchSize directives into the recording.
      */
-    std::function<std::optional<Token>(uint32_t flags)> nextToken;
-    nextToken = [&](uint32_t flags) -> std::optional<Token>
+    void parseBatch();
+
+    /**
+     * Pass on all directives of the file to the target.
+     * The recorded batch is replayed while the next batch is parsed on the thread pool.
+     * Commands are released once executed, so at most two batches of the file are held in memory.
+     */
+    void replay(ParserTarget& target);
+
+    // clang-format off
+    void onScale(Float sx, Float sy, Float sz, FileLoc loc) override { record([=](ParserTarget& t) { t.onScale(sx, sy, sz, loc); }); }
+    void onShape(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onShape, name, std::move(params), loc); }
+    void onOption(const std::string& name, const std::string& value, FileLoc loc) override { record([=](ParserTarget& t) { t.onOption(name, value, loc); }); }
+    void onIdentity(FileLoc loc) override { record([=](ParserTarget& t) { t.onIdentity(loc); }); }
+    void onTranslate(Float dx, Float dy, Float dz, FileLoc loc) override { record([=](ParserTarget& t) { t.onTranslate(dx, dy, dz, loc); }); }
+    void onRotate(Float angle, Float ax, Float ay, Float az, FileLoc loc) override { record([=](ParserTarget& t) { t.onRotate(angle, ax, ay, az, loc); }); }
+    void onLookAt(Float ex, Float ey, Float ez, Float lx, Float ly, Float lz, Float ux, Float uy, Float uz, FileLoc loc) override { record([=](ParserTarget& t) { t.onLookAt(ex, ey, ez, lx, ly, lz, ux, uy, uz, loc); }); }
+    void onConcatTransform(Float transform[16], FileLoc loc) override { recordTransform(&ParserTarget::onConcatTransform, transform, loc); }
+    void onTransform(Float transform[16], FileLoc loc) override { recordTransform(&ParserTarget::onTransform, transform, loc); }
+    void onCoordinateSystem(const std::string& name, FileLoc loc) override { record([=](ParserTarget& t) { t.onCoordinateSystem(name, loc); }); }
+    void onCoordSysTransform(const std::string& name, FileLoc loc) override { record([=](ParserTarget& t) { t.onCoordSysTransform(name, loc); }); }
+    void onActiveTransformAll(FileLoc loc) override { record([=](ParserTarget& t) { t.onActiveTransformAll(loc); }); }
+    void onActiveTransformEndTime(FileLoc loc) override { record([=](ParserTarget& t) { t.onActiveTransformEndTime(loc); }); }
+    void onActiveTransformStartTime(FileLoc loc) override { record([=](ParserTarget& t) { t.onActiveTransformStartTime(loc); }); }
+    void onTransformTimes(Float start, Float end, FileLoc loc) override { record([=](ParserTarget& t) { t.onTransformTimes(start, end, loc); }); }
+    void onColorSpace(const std::string& name, FileLoc loc) override { record([=](ParserTarget& t) { t.onColorSpace(name, loc); }); }
+    void onPixelFilter(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onPixelFilter, name, std::move(params), loc); }
+    void onFilm(const std::string& type, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onFilm, type, std::move(params), loc); }
+    void onAccelerator(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onAccelerator, name, std::move(params), loc); }
+    void onIntegrator(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onIntegrator, name, std::move(params), loc); }
+    void onCamera(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onCamera, name, std::move(params), loc); }
+    void onMakeNamedMedium(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onMakeNamedMedium, name, std::move(params), loc); }
+    void onMediumInterface(const std::string& insideName, const std::string& outsideName, FileLoc loc) override { record([=](ParserTarget& t) { t.onMediumInterface(insideName, outsideName, loc); }); }
+    void onSampler(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onSampler, name, std::move(params), loc); }
+    void onWorldBegin(FileLoc loc) override { record([=](ParserTarget& t) { t.onWorldBegin(loc); }); }
+    void onAttributeBegin(FileLoc loc) override { record([=](ParserTarget& t) { t.onAttributeBegin(loc); }); }
+    void onAttributeEnd(FileLoc loc) override { record([=](ParserTarget& t) { t.onAttributeEnd(loc); }); }
+    void onAttribute(const std::string& target, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onAttribute, target, std::move(params), loc); }
+    void onTexture(const std::string& name, const std::string& type, const std::string& texname, ParsedParameterVector params, FileLoc loc) override
+    {
+        record([=, params = std::move(params)](ParserTarget& t) mutable { t.onTexture(name, type, texname, std::move(params), loc); });
+    }
+    void onMaterial(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onMaterial, name, std::move(params), loc); }
+    void onMakeNamedMaterial(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onMakeNamedMaterial, name, std::move(params), loc); }
+    void onNamedMaterial(const std::string& name, FileLoc loc) override { record([=](ParserTarget& t) { t.onNamedMaterial(name, loc); }); }
+    void onLightSource(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onLightSource, name, std::move(params), loc); }
+    void onAreaLightSource(const std::string& name, ParsedParameterVector params, FileLoc loc) override { recordParams(&ParserTarget::onAreaLightSource, name, std::move(params), loc); }
+    void onReverseOrientation(FileLoc loc) override { record([=](ParserTarget& t) { t.onReverseOrientation(loc); }); }
+    void onObjectBegin(const std::string& name, FileLoc loc) override { record([=](ParserTarget& t) { t.onObjectBegin(name, loc); }); }
+    void onObjectEnd(FileLoc loc) override { record([=](ParserTarget& t) { t.onObjectEnd(loc); }); }
+    void onObjectInstance(const std::string& name, FileLoc loc) override { record([=](ParserTarget& t) { t.onObjectInstance(name, loc); }); }
+    void onImportBegin(FileLoc loc) override { record([=](ParserTarget& t) { t.onImportBegin(loc); }); }
+    void onImportEnd(FileLoc loc) override { record([=](ParserTarget& t) { t.onImportEnd(loc); }); }
+    void onFile(const std::filesystem::path& path) override { record([=](ParserTarget& t) { t.onFile(path); }); }
+    void onEndOfFiles() override { FALCOR_UNREACHABLE(); }
+    // clang-format on
+
+private:
+    /**
+     * Start parsing a file on the thread pool.
+     * @return Command waiting for the parsing to finish and passing on the directives of the file.
+     */
+    static Command parseAsync(const std::filesystem::path& path, const std::filesystem::path& searchPath);
+
+    void recordParams(void (ParserTarget::*func)(const std::string&, ParsedParameterVector, FileLoc), const std::string& name, ParsedParameterVector params, FileLoc loc)
+    {
+        record([=, params = std::move(params)](ParserTarget& t) mutable { (t.*func)(name, std::move(params), loc); });
+    }
+
+    void recordTransform(void (ParserTarget::*func)(Float[16], FileLoc), const Float transform[16], FileLoc loc)
+    {
+        std::array<Float, 16> m;
+        std::copy(transform, transform + 16, m.begin());
+        record([=](ParserTarget& t) mutable { (t.*func)(m.data(), loc); });
+    }
+
+    std::filesystem::path mPath;
+    std::filesystem::path mSearchPath;
+    std::unique_ptr<Tokenizer> mpTokenizer;  ///< Created when the first batch is parsed, unless given on construction.
+    std::optional<Token> mUngetToken;        ///< Token read ahead by the previous batch.
+    bool mEndOfFile = false;
+    std::vector<Command> mCommands;
+};
+
+/**
+ * Parse directives of a file into a recording until the recording holds at least the given number of commands.
+ * Included files are parsed concurrently into their own recordings.
+ * @param[in,out] ungetToken Token read ahead by the parser. Must be kept for parsing the next batch.
+ * @return True if the end of the file has been reached.
+ */
+static bool parse(RecordedFile& target, Tokenizer& tokenizer, std::optional<Token>& ungetToken, const std::filesystem::path& searchPath, size_t maxRecordedCount)
+{
+    static std::atomic<bool> warnedTransformBeginEndDeprecated{false};
+
+    /**
+     * Helper function returning the next token from the file, skipping comments.
+     */
+    auto nextToken = [&](uint32_t flags) -> std::optional<Token>
     {
         if (ungetToken.has_value())
             return std::exchange(ungetToken, {});
 
-        if (fileStack.empty())
+        while (true)
         {
-            if ((flags & TokenRequired) != 0)
-                throwError("Premature end of file.");
-            return {};
-        }
+            std::optional<Token> tok = tokenizer.next();
 
-        std::optional<Token> tok = fileStack.back()->next();
-
-        if (!tok)
-        {
-            // We've reached EOF in the current file. Anything more to parse?
-            logInfo("PBRTImporter: Finished parsing '{}'.", fileStack.back()->getPath().string());
-            fileStack.pop_back();
-            return nextToken(flags);
-        }
-        else if (tok->token[0] == '#')
-        {
-            // Swallow comments.
-            return nextToken(flags);
-        }
-        else
-        {
-            // Regular token.
-            return tok;
+            if (!tok)
+            {
+                // We've reached EOF.
+                if ((flags & TokenRequired) != 0)
+                    throwError("Premature end of file.");
+                return {};
+            }
+            else if (tok->token[0] != '#')
+            {
+                // Regular token (comments are swallowed).
+                return tok;
+            }
         }
     };
 
@@ -504,6 +784,8 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         ungetToken = t;
     };
 
+    auto readNumericArray = [&](auto& values) { return tokenizer.readNumericArray(values); };
+
     /**
      * Helper function for pbrt API entrypoints that take a single string
      * parameter and a ParameterVector (e.g. onShape()).
@@ -513,7 +795,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         Token t = *nextToken(TokenRequired);
         std::string_view dequoted = dequoteString(t);
         std::string n = toString(dequoted);
-        ParsedParameterVector parameterVector = parseParameters(nextToken, unget);
+        ParsedParameterVector parameterVector = parseParameters(nextToken, unget, readNumericArray);
         (target.*apiFunc)(n, std::move(parameterVector), loc);
     };
 
@@ -527,11 +809,11 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
 
     std::optional<Token> tok;
 
-    while (true)
+    while (target.getRecordedCount() < maxRecordedCount)
     {
         tok = nextToken(TokenOptional);
         if (!tok.has_value())
-            break;
+            return true;
 
         switch (tok->token[0])
         {
@@ -631,14 +913,13 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
             {
                 Token filenameToken = *nextToken(TokenRequired);
                 std::string filename = toString(dequoteString(filenameToken));
-                auto path = searchPath / filename;
-                std::unique_ptr<Tokenizer> includeTokenizer = Tokenizer::createFromFile(path);
-                logInfo("PBRTImporter: Started parsing '{}'.", includeTokenizer->getPath().string());
-                fileStack.push_back(std::move(includeTokenizer));
+                target.recordInclude(searchPath / filename, searchPath);
             }
             else if (tok->token == "Import")
             {
-                throwError(tok->loc, "'Import' directive not supported yet.");
+                Token filenameToken = *nextToken(TokenRequired);
+                std::string filename = toString(dequoteString(filenameToken));
+                target.recordImport(searchPath / filename, searchPath, tok->loc);
             }
             else if (tok->token == "Identity")
             {
@@ -803,10 +1084,11 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
         case 'T':
             if (tok->token == "TransformBegin")
             {
-                if (!warnedTransformBeginEndDeprecated)
+                if (!warnedTransformBeginEndDeprecated.exchange(true))
                 {
-                    logWarning(tok->loc, "TransformBegin/End are deprecated and should be replaced with AttributeBegin/End.");
-                    warnedTransformBeginEndDeprecated = true;
+                    // Log on the calling thread when the directives are passed on.
+                    target.record([loc = tok->loc](ParserTarget&)
+                                  { logWarning(loc, "TransformBegin/End are deprecated and should be replaced with AttributeBegin/End."); });
                 }
                 target.onAttributeBegin(tok->loc);
             }
@@ -849,7 +1131,7 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 Token t = *nextToken(TokenRequired);
                 std::string_view dequoted = dequoteString(t);
                 std::string texName = toString(dequoted);
-                ParsedParameterVector params = parseParameters(nextToken, unget);
+                ParsedParameterVector params = parseParameters(nextToken, unget, readNumericArray);
                 target.onTexture(name, type, texName, std::move(params), tok->loc);
             }
             else
@@ -873,19 +1155,105 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
             syntaxError(*tok);
         }
     }
+
+    return false;
+}
+
+RecordedFile::Command RecordedFile::parseAsync(const std::filesystem::path& path, const std::filesystem::path& searchPath)
+{
+    // Only the first batch of directives is parsed ahead of time. The rest of the file is parsed while it is replayed.
+    auto pFile = std::make_shared<RecordedFile>(path, searchPath);
+    auto task = Threading::dispatchTask([pFile]() { pFile->parseBatch(); });
+
+    return [pFile, task](ParserTarget& target) mutable
+    {
+        // Rethrows parsing errors of the file.
+        task.finish();
+        logInfo("PBRTImporter: Processing '{}'.", pFile->mPath.string());
+        target.onFile(pFile->mPath);
+        pFile->replay(target);
+    };
+}
+
+void RecordedFile::parseBatch()
+{
+    FALCOR_ASSERT(!mEndOfFile);
+    if (!mpTokenizer)
+        mpTokenizer = Tokenizer::createFromFile(mPath);
+    mEndOfFile = parse(*this, *mpTokenizer, mUngetToken, mSearchPath, kMaxBatchSize);
+    if (mEndOfFile)
+        mpTokenizer.reset();
+}
+
+void RecordedFile::replay(ParserTarget& target)
+{
+    std::vector<Command> batch;
+    while (!mCommands.empty() || !mEndOfFile)
+    {
+        batch.clear();
+        std::swap(batch, mCommands);
+
+        // Parse the next batch while replaying the current one.
+        Threading::Task parseTask;
+        if (!mEndOfFile)
+            parseTask = Threading::dispatchTask([this]() { parseBatch(); });
+
+        try
+        {
+            for (auto& command : batch)
+            {
+                command(target);
+                command = nullptr;
+            }
+        }
+        catch (...)
+        {
+            // The parse task refers to this recording, so it needs to finish before the error is passed on.
+            try
+            {
+                parseTask.finish();
+            }
+            catch (...)
+            {
+            }
+            throw;
+        }
+
+        // Rethrows parsing errors of the next batch.
+        parseTask.finish();
+    }
+}
+
+void RecordedFile::recordInclude(const std::filesystem::path& path, const std::filesystem::path& searchPath)
+{
+    record(parseAsync(path, searchPath));
+}
+
+void RecordedFile::recordImport(const std::filesystem::path& path, const std::filesystem::path& searchPath, FileLoc loc)
+{
+    onImportBegin(loc);
+    record(parseAsync(path, searchPath));
+    onImportEnd(loc);
 }
 
 void parseFile(ParserTarget& target, const std::filesystem::path& path)
 {
+    logInfo("PBRTImporter: Started parsing '{}'.", path.string());
     auto tokenizer = Tokenizer::createFromFile(path);
-    parse(target, std::move(tokenizer));
+    std::filesystem::path searchPath = tokenizer->getPath().parent_path();
+    RecordedFile file(std::move(tokenizer), searchPath);
+    target.onFile(path);
+    file.replay(target);
+    logInfo("PBRTImporter: Finished parsing '{}'.", path.string());
     target.onEndOfFiles();
 }
 
 void parseString(ParserTarget& target, std::string str)
 {
     auto tokenizer = Tokenizer::createFromString(std::move(str));
-    parse(target, std::move(tokenizer));
+    std::filesystem::path searchPath = tokenizer->getPath().parent_path();
+    RecordedFile file(std::move(tokenizer), searchPath);
+    file.replay(target);
     target.onEndOfFiles();
 }
 
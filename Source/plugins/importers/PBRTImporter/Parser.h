@@ -35,11 +35,14 @@
 
 #include "Types.h"
 #include "Parameters.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include <functional>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace Falcor::pbrt
 {
@@ -98,9 +101,26 @@ public:
     virtual void onObjectEnd(FileLoc loc) = 0;
     virtual void onObjectInstance(const std::string& name, FileLoc loc) = 0;
 
+    /**
+     * Called before and after the directives of a file referenced by an 'Import' directive.
+     * Imported files may only add scene entities, they cannot change the graphics state of the importing file.
+     */
+    virtual void onImportBegin(FileLoc loc) = 0;
+    virtual void onImportEnd(FileLoc loc) = 0;
+
+    /**
+     * Called before the directives of each parsed file, including files referenced by 'Include' and 'Import' directives.
+     */
+    virtual void onFile(const std::filesystem::path& path) = 0;
+
     virtual void onEndOfFiles() = 0;
 };
 
+/**
+ * Parse a scene file.
+ * Files referenced by 'Include' and 'Import' directives are parsed concurrently on the thread pool.
+ * The directives of all files are then passed to the target in order on the calling thread.
+ */
 void parseFile(ParserTarget& target, const std::filesystem::path& path);
 void parseString(ParserTarget& target, std::string str);
 
@@ -117,6 +137,7 @@ class Tokenizer
 {
 public:
     Tokenizer(std::string str, const std::filesystem::path& path);
+    Tokenizer(std::unique_ptr<MemoryMappedFile> pMappedFile, const std::filesystem::path& path);
 
     static std::unique_ptr<Tokenizer> createFromFile(const std::filesystem::path& path);
     static std::unique_ptr<Tokenizer> createFromString(std::string str);
@@ -127,6 +148,17 @@ public:
      */
     std::optional<Token> next();
 
+    /**
+     * Read the values of a numeric array directly into a typed buffer.
+     * Must be called after the opening bracket has been read. Consumes everything up to and including the closing bracket.
+     * Large arrays are parsed in parallel.
+     * @param[out] values Parsed values are appended to this buffer.
+     * @return True if successful. False if the array contains anything other than numbers, in which case
+     * the tokenizer state is unchanged and the array needs to be read token by token.
+     */
+    bool readNumericArray(std::vector<Float>& values);
+    bool readNumericArray(std::vector<int>& values);
+
     const std::filesystem::path& getPath() const { return mPath; }
 
 private:
@@ -140,6 +172,18 @@ private:
         return filenames;
     }
 
+    /// Mutex protecting the list of filenames, tokenizers are created concurrently for included files.
+    static std::mutex& getFilenamesMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    void init(const char* data, size_t size);
+
+    template<typename T>
+    bool readNumericArrayImpl(std::vector<T>& values);
+
     bool isUTF16(const void* ptr, size_t len) const;
 
     int getChar()
@@ -170,9 +214,10 @@ private:
         }
     }
 
-    std::filesystem::path mPath; ///< File path we're reading from.
-    FileLoc mLoc;                ///< File location.
-    std::string mContents;       ///< File contents we're parsing.
+    std::filesystem::path mPath;                    ///< File path we're reading from.
+    FileLoc mLoc;                                   ///< File location.
+    std::string mContents;                          ///< File contents we're parsing (if not memory mapped).
+    std::unique_ptr<MemoryMappedFile> mpMappedFile; ///< Memory mapped file we're parsing.
 
     const char* mPos; ///< Current position in the file.
     const char* mEnd; ///< End of the file (one past).
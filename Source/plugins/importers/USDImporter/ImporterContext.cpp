@@ -1560,6 +1560,7 @@ namespace Falcor
             return;
         }
 
+        builder.addDependency(envMapPath);
         EnvMap::SharedPtr pEnvMap = EnvMap::createFromFile(builder.getDevice(), envMapPath);
 
         if (pEnvMap == nullptr)
@@ -13,6 +13,9 @@ m.loadScene('Arcade/Arcade.pyscene', SceneBuilderFlags.RebuildCache)
 render_frames(m, 'arcade', frames=[64])
 m.loadScene('Arcade/Arcade.pyscene', SceneBuilderFlags.UseCache)
 render_frames(m, 'arcade.cached', frames=[64])
+m.loadScene('Arcade/Arcade.pyscene', SceneBuilderFlags.RebuildCache | SceneBuilderFlags.MappedCache)
+m.loadScene('Arcade/Arcade.pyscene', SceneBuilderFlags.UseCache)
+render_frames(m, 'arcade.mapped', frames=[64])
 
 # grey_and_white_room
 m.loadScene('grey_and_white_room/grey_and_white_room.fbx', SceneBuilderFlags.RebuildCache)
@@ -259,34 +259,37 @@ class Test:
         messages = []
         image_reports = []
 
-        # Compare every result image with the corresponding reference image and report missing references.
-        processes = {}
+        # Compare all result images with their reference images in a single batch.
+        args = [str(image_compare_exe), '--batch', '-m', 'mse', '-t', str(self.tolerance), '-e', config.ERROR_IMAGE_SUFFIX, str(ref_dir), str(result_dir)]
+        process = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        if not self.process_controller.add_process(self.name + ":images", process):
+            return Test.Result.FAILED, ['Process killed due to global exit'], []
+
+        output, errors = process.communicate()
+        try:
+            compare_results = {image['name']: image for image in json.loads(output)['images']}
+        except (json.JSONDecodeError, KeyError):
+            return Test.Result.FAILED, [f'ImageCompare failed: {errors.decode().strip()}'], []
+
+        # Report the comparison results and missing references.
         for image in result_images:
             if not image in ref_images:
                 result = Test.Result.FAILED
                 messages.append(f'Test has generated image "{image}" with no corresponding reference image.')
                 continue
 
-            ref_file = ref_dir / image
-            result_file = result_dir / image
-            error_file = result_dir / (str(image) + config.ERROR_IMAGE_SUFFIX)
-
-            args = [str(image_compare_exe), '-m', 'mse', '-t', str(self.tolerance), str(ref_file), str(result_file)]
-            if error_file:
-                args += ['-e', str(error_file)]
-            processes[image] = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
-            if not self.process_controller.add_process(self.name + ":image:" + str(image), processes[image]):
-                return Test.Result.FAILED, ['Process killed due to global exit']
-
-        for image, process in processes.items():
-
-            output = process.communicate()[0]
-            compare_success =  process.returncode == 0
-            compare_error = float(output.strip())
+            compare = compare_results[str(image)]
+            compare_success = compare['success']
+            compare_error = compare.get('error')
+            if compare_error is None:
+                compare_error = float('nan')
 
             if not compare_success:
                 result = Test.Result.FAILED
-                messages.append(f'Test image "{image}" failed with error {compare_error}.')
+                if 'message' in compare:
+                    messages.append(f'Test image "{image}" failed: {compare["message"]}')
+                else:
+                    messages.append(f'Test image "{image}" failed with error {compare_error}.')
 
             image_reports.append({
                 'name': str(image),